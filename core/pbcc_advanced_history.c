@@ -17,6 +17,229 @@
 
 #define PUBNUB_MIN_TIMETOKEN_LEN 4
 
+/** Number of channels there is room for when the parsed
+    'message_counts' reply is first allocated */
+#define MSG_COUNTS_INITIAL_CAPACITY 16
+
+/** Least number of buckets of the hash table of the channels of the
+    'message_counts' reply. Must be a power of 2. */
+#define MSG_COUNTS_MIN_BUCKETS 16
+
+
+/** FNV-1a hash of the channel name @p s of length @p len */
+static unsigned hash_channel(char const* s, size_t len)
+{
+    unsigned h = 2166136261u;
+    size_t   i;
+
+    for (i = 0; i < len; ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+
+/** Reads the next `"channel":count` pair of the 'channels' object of
+    the 'message_counts' reply on @p p, starting from @p *ps (up to @p
+    end), and moves @p *ps past it. Pairs that are not well formed are
+    skipped.
+    @retval true pair read
+    @retval false no more pairs
+ */
+static bool next_msg_count(struct pbcc_context* p,
+                           char const**         ps,
+                           char const*          end,
+                           pubnub_chamebl_t*    o_channel,
+                           size_t*              o_count)
+{
+    char const* s = pbjson_skip_whitespace(*ps, end);
+
+    while ((s < end) && ('"' == *s)) {
+        char const* ch_end = pbjson_find_end_element(s, end);
+        char const* digits;
+        size_t      count = 0;
+
+        o_channel->ptr  = (char*)s + 1;
+        o_channel->size = ch_end - s - 1;
+        s               = pbjson_skip_whitespace(ch_end + 1, end);
+        if ((s >= end) || (*s != ':')) {
+            PUBNUB_LOG_DEBUG("Note: message_counts(pbcc=%p) - "
+                             "colon missing after channel name='%.*s'\n",
+                             p,
+                             (int)o_channel->size,
+                             o_channel->ptr);
+        }
+        else {
+            s      = pbjson_skip_whitespace(s + 1, end);
+            digits = s;
+            while ((s < end) && (*s >= '0') && (*s <= '9')) {
+                count = 10 * count + (*s++ - '0');
+            }
+            if (s == digits) {
+                PUBNUB_LOG_DEBUG("Note: message_counts(pbcc=%p) - "
+                                 "failed to read the message count for channel='%.*s'\n",
+                                 p,
+                                 (int)o_channel->size,
+                                 o_channel->ptr);
+            }
+            else {
+                while ((s < end) && (*s != ',')) {
+                    ++s;
+                }
+                *ps      = (s < end) ? s + 1 : end;
+                *o_count = count;
+                return true;
+            }
+        }
+        while ((s < end) && (*s != ',')) {
+            ++s;
+        }
+        s = (s < end) ? pbjson_skip_whitespace(s + 1, end) : end;
+    }
+    *ps = end;
+
+    return false;
+}
+
+
+/** Adds the @p channel with its @p count to the parsed
+    'message_counts' reply @p mc, growing it if needed.
+    @retval 0 OK, @retval -1 failed to allocate
+ */
+static int add_msg_count(struct pbcc_msg_counts* mc, pubnub_chamebl_t channel, size_t count)
+{
+    struct pbcc_msg_count_item* item;
+
+    if (mc->count == mc->capacity) {
+        unsigned new_cap = (0 == mc->capacity) ? MSG_COUNTS_INITIAL_CAPACITY
+                                               : 2 * mc->capacity;
+        item = (struct pbcc_msg_count_item*)realloc(mc->item, new_cap * sizeof *item);
+        if (NULL == item) {
+            return -1;
+        }
+        mc->item     = item;
+        mc->capacity = new_cap;
+    }
+    item                = &mc->item[mc->count++];
+    item->channel       = channel;
+    item->message_count = count;
+    item->hash          = hash_channel(channel.ptr, channel.size);
+    item->next          = -1;
+
+    return 0;
+}
+
+
+/** Builds the hash table of the channels of the parsed
+    'message_counts' reply @p mc.
+    @retval 0 OK, @retval -1 failed to allocate
+ */
+static int hash_msg_counts(struct pbcc_msg_counts* mc)
+{
+    unsigned n = MSG_COUNTS_MIN_BUCKETS;
+    unsigned i;
+
+    while (n < 2 * mc->count) {
+        n *= 2;
+    }
+    if (n > mc->bucket_count) {
+        int* bucket = (int*)realloc(mc->bucket, n * sizeof *bucket);
+        if (NULL == bucket) {
+            return -1;
+        }
+        mc->bucket       = bucket;
+        mc->bucket_count = n;
+    }
+    for (i = 0; i < mc->bucket_count; ++i) {
+        mc->bucket[i] = -1;
+    }
+    /* Backwards, so that the first of (unexpected) duplicates is
+       found first */
+    for (i = mc->count; i > 0; --i) {
+        struct pbcc_msg_count_item* item = &mc->item[i - 1];
+        int* head  = &mc->bucket[item->hash & (mc->bucket_count - 1)];
+        item->next = *head;
+        *head      = (int)(i - 1);
+    }
+
+    return 0;
+}
+
+
+/** Parses the 'channels' object of the 'message_counts' reply on @p p
+    (between `msg_ofs` and `msg_end`) into `msg_counts`. If it fails
+    to allocate, `msg_counts` is not valid and the counts are read
+    from the reply itself.
+ */
+static void parse_msg_counts(struct pbcc_context* p)
+{
+    struct pbcc_msg_counts* mc  = &p->msg_counts;
+    char const*             s   = p->http_reply + p->msg_ofs;
+    char const*             end = p->http_reply + p->msg_end;
+    pubnub_chamebl_t        channel;
+    size_t                  count;
+
+    mc->ofs   = p->msg_ofs;
+    mc->end   = p->msg_end;
+    mc->count = 0;
+    mc->valid = true;
+    while (next_msg_count(p, &s, end, &channel, &count)) {
+        if (add_msg_count(mc, channel, count) != 0) {
+            mc->valid = false;
+            break;
+        }
+    }
+    if (mc->valid && (hash_msg_counts(mc) != 0)) {
+        mc->valid = false;
+    }
+    if (!mc->valid) {
+        PUBNUB_LOG_WARNING("Warning: message_counts(pbcc=%p) - "
+                           "failed to allocate the parsed reply\n",
+                           p);
+    }
+}
+
+
+/** Looks up the message count of the channel @p name of length @p
+    len in the 'message_counts' reply on @p p.
+    @retval 0 found, @retval -1 not found
+ */
+static int find_msg_count(struct pbcc_context* p, char const* name, size_t len, size_t* o_count)
+{
+    struct pbcc_msg_counts const* mc = &p->msg_counts;
+
+    if (mc->valid) {
+        int i;
+        if (0 == mc->bucket_count) {
+            return -1;
+        }
+        for (i = mc->bucket[hash_channel(name, len) & (mc->bucket_count - 1)]; i >= 0;
+             i = mc->item[i].next) {
+            struct pbcc_msg_count_item const* item = &mc->item[i];
+            if ((item->channel.size == len) && (memcmp(item->channel.ptr, name, len) == 0)) {
+                *o_count = item->message_count;
+                return 0;
+            }
+        }
+    }
+    else {
+        char const*      s   = p->http_reply + mc->ofs;
+        char const*      end = p->http_reply + mc->end;
+        pubnub_chamebl_t channel;
+        size_t           count;
+
+        while (next_msg_count(p, &s, end, &channel, &count)) {
+            if ((channel.size == len) && (memcmp(channel.ptr, name, len) == 0)) {
+                *o_count = count;
+                return 0;
+            }
+        }
+    }
+
+    return -1;
+}
+
 
 enum pubnub_res pbcc_parse_message_counts_response(struct pbcc_context* p)
 {
@@ -69,6 +292,7 @@ enum pubnub_res pbcc_parse_message_counts_response(struct pbcc_context* p)
         return PNR_FORMAT_ERROR;
     }
     p->chan_ofs = p->chan_end = 0;
+    parse_msg_counts(p);
 
     return PNR_OK;
 }
@@ -107,196 +331,122 @@ int pbcc_get_error_message(struct pbcc_context* p, pubnub_chamebl_t* o_msg)
 
 int pbcc_get_chan_msg_counts_size(struct pbcc_context* p)
 {
-    char const* next;
-    char const* end;
-    int number_of_key_value_pairs = 0;
+    char const*      s;
+    char const*      end;
+    pubnub_chamebl_t channel;
+    size_t           count;
+    int              number_of_key_value_pairs = 0;
 
-    end = p->http_reply + p->msg_end;
-    next = p->http_reply + p->msg_ofs;
-    if (next >= end) {
+    if (p->msg_ofs >= p->msg_end) {
         return 0;
     }
-    for (;next < end; next++) {
-        if (',' == *next) {
-            ++number_of_key_value_pairs;
-        }
+    if (p->msg_counts.valid) {
+        return p->msg_counts.count;
+    }
+    s   = p->http_reply + p->msg_ofs;
+    end = p->http_reply + p->msg_end;
+    while (next_msg_count(p, &s, end, &channel, &count)) {
+        ++number_of_key_value_pairs;
     }
 
-    return ++number_of_key_value_pairs; 
+    return number_of_key_value_pairs;
 }
 
 
-int pbcc_get_chan_msg_counts(struct pbcc_context* p, 
-                             size_t* io_count, 
+int pbcc_get_chan_msg_counts(struct pbcc_context* p,
+                             size_t* io_count,
                              struct pubnub_chan_msg_count* chan_msg_counters)
 {
-    char const*  ch_start;
-    char const*  end;
-    size_t count = 0;
+    struct pbcc_msg_counts const* mc    = &p->msg_counts;
+    size_t                        count = 0;
 
-    ch_start = p->http_reply + p->msg_ofs;
-    end = p->http_reply + p->msg_end + 1;
-    if (ch_start >= end - 1) {
+    if (p->msg_ofs >= p->msg_end) {
         *io_count = 0;
         return 0;
     }
-    ch_start = pbjson_skip_whitespace(ch_start, end);
-    while ((ch_start < end) && (count < *io_count)) {
-        char const* ch_end = pbjson_find_end_element(ch_start, end);
-        
-        chan_msg_counters[count].channel.size = ch_end - ch_start - 1;
-        chan_msg_counters[count].channel.ptr = (char*)(ch_start + 1),
-        ch_start = pbjson_skip_whitespace(ch_end + 1, end);
-        if (*ch_start != ':') {
-            PUBNUB_LOG_DEBUG("Note: pubnub_get_chan_msg_counts(pbcc=%p) - "
-                             "colon missing after channel name=%*.s\n"
-                             "characters after channel name='%s'\n",
-                             p,
-                             (int)chan_msg_counters[count].channel.size,
-                             chan_msg_counters[count].channel.ptr,
-                             ch_start);
+    if (mc->valid) {
+        for (; (count < *io_count) && (count < mc->count); ++count) {
+            chan_msg_counters[count].channel       = mc->item[count].channel;
+            chan_msg_counters[count].message_count = mc->item[count].message_count;
         }
-        else if (sscanf(++ch_start,
-                        "%lu",
-                        (unsigned long*)&(chan_msg_counters[count].message_count)) != 1) {
+        if (count < mc->count) {
             PUBNUB_LOG_DEBUG("Note: pubnub_get_chan_msg_counts(pbcc=%p) - "
-                             "failed to read the message count for channel='%*.s'\n"
-                             "got these characters instead='%s'\n",
+                             "%u more than expected message counters\n",
                              p,
-                             (int)chan_msg_counters[count].channel.size,
-                             chan_msg_counters[count].channel.ptr,                             
-                             ch_start - 1);
-        }
-        else {
-            ++count;
+                             mc->count - (unsigned)count);
         }
-        while((*ch_start != ',') && (ch_start < end)) {
-            ch_start++;
-        }
-        if (ch_start == end) {
-            break;
-        }
-        ch_start = pbjson_skip_whitespace(ch_start + 1, end);
-    }
-    if ((count == *io_count) && (ch_start != end)) {
-        PUBNUB_LOG_DEBUG("Note: pubnub_get_chan_msg_counts(pbcc=%p) - "
-                         "more than expected message counters,\n"
-                         "unhandled part of the response='%s'\n",
-                         p,
-                         ch_start);
     }
     else {
-        *io_count = count;
+        char const* s   = p->http_reply + p->msg_ofs;
+        char const* end = p->http_reply + p->msg_end;
+
+        while ((count < *io_count)
+               && next_msg_count(p,
+                                 &s,
+                                 end,
+                                 &chan_msg_counters[count].channel,
+                                 &chan_msg_counters[count].message_count)) {
+            ++count;
+        }
     }
+    *io_count  = count;
     p->msg_ofs = p->msg_end;
-    
-    return 0;
-}
-
 
-static int initialize_msg_counters(char const* channel, int* o_count)
-{
-    int         n = 0;
-    char const* next;
-    
-    for (next = channel; ' ' == *next; next++) continue;
-    o_count[n++] = -(next - channel) - 1;    
-    for (next = strchr(next, ','); next != NULL; next = strchr(next + 1, ','), n++) {
-        for (++next; ' ' == *next; next++) continue ;
-        /* Saving negative channel offsets(-1) in the array of counters.
-           That is, if channel name from the 'channel' list is not found in the answer
-           corresponding array member stays negative, while when channel name(from the
-           'channel' list) is found in the response this value is used for locating
-           channel name within the list od channels before it is changed to its
-           corresponding message counter value(which could, also, be zero).
-         */
-        o_count[n] = -(next - channel) - 1;
-    }
-    return n;
+    return 0;
 }
 
 
 int pbcc_get_message_counts(struct pbcc_context* p, char const* channel, int* o_count)
 {
-    char const* ch_start;
-    char const* end;
-    int         n = initialize_msg_counters(channel, o_count);
-    int         counts = 0;
-
-    ch_start = p->http_reply + p->msg_ofs;
-    end = p->http_reply + p->msg_end + 1;
-    if (ch_start >= end - 1) {
-        /* Response message carries no counters */
-        return 0;
-    }
-    ch_start = pbjson_skip_whitespace(ch_start, end);
-    while((ch_start < end) && (counts < n)) {
-        /* index in the array of message counters */
-        int         i = 0;
-        /* channel name length */
-        unsigned    len;
-        char const* ptr_ch;
-        char const* ch_end;
-        ch_end = (char*)pbjson_find_end_element(ch_start++, end);
-        len = ch_end - ch_start;
-        for (i = 0; i < n ; i++) {
-            ptr_ch = channel - o_count[i] - 1;
-            /* Comparing channel name found in response message with name from 'channel' list. */
-            if ((memcmp(ptr_ch, ch_start, len) == 0) &&
-                ((' ' == *(ptr_ch + len)) || (',' == *(ptr_ch + len)) || ('\0' == *(ptr_ch + len)))) {
-                break;
-            }
+    char const* name = channel;
+    int         n    = 0;
+    bool        have_counts = (p->msg_ofs < p->msg_end);
+
+    /* Each channel in the list is looked up in the reply, so, a
+       channel not in the reply has a negative count */
+    for (;;) {
+        size_t      len;
+        size_t      count;
+        char const* name_end;
+
+        while (' ' == *name) {
+            ++name;
         }
-        if (i == n) {
-            PUBNUB_LOG_DEBUG("Note: pubnub_get_msg_counts(pbcc=%p) - "
-                             "channel not present in the query list 'channel',\n"
-                             "unhandled channel from the response='%*.s'\n",
-                             p,
-                             len,
-                             ch_start);
+        for (name_end = name; (*name_end != ',') && (*name_end != ' ') && (*name_end != '\0');
+             ++name_end) {
+            continue;
         }
-        ch_start = pbjson_skip_whitespace(ch_end + 1, end);
-        if (*ch_start != ':') {
-            PUBNUB_LOG_DEBUG("Note: pubnub_get_msg_counts(pbcc=%p) - "
-                             "colon missing after channel name='%*.s'\n"
-                             "characters after channel name='%s'",
-                             p,
-                             len,
-                             ptr_ch,
-                             ch_start);
-        }    /* Saving message count value in the array provided */
-        else if (sscanf(++ch_start, "%u", (unsigned*)(o_count + i)) != 1) {
-            PUBNUB_LOG_DEBUG("Note: pubnub_get_msg_counts(pbcc=%p) - "
-                             "failed to read the message count for channel='%*.s'\n"
-                             "got these characters instead='%s'\n",
-                             p,
-                             len,
-                             ptr_ch,
-                             ch_start - 1);
+        len = name_end - name;
+        if (have_counts && (find_msg_count(p, name, len, &count) == 0)) {
+            o_count[n] = (int)count;
         }
         else {
-            ++counts;
-        }
-        while((*ch_start != ',') && (ch_start < end)) {
-            ch_start++;
+            PUBNUB_LOG_DEBUG("Note: pubnub_get_msg_counts(pbcc=%p) - "
+                             "channel '%.*s' not present in the response\n",
+                             p,
+                             (int)len,
+                             name);
+            o_count[n] = -1;
         }
-        if (ch_start == end) {
+        ++n;
+        name = strchr(name_end, ',');
+        if (NULL == name) {
             break;
         }
-        ch_start = pbjson_skip_whitespace(ch_start + 1, end);
-    }
-    if ((counts == n) && (ch_start != end)) {
-        PUBNUB_LOG_DEBUG("Note: pubnub_get_msg_counts(pbcc=%p) - "
-                         "more than expected message counters,\n"
-                         "unhandled part of the response='%s'\n",
-                         p,
-                         ch_start);
+        ++name;
     }
     p->msg_ofs = p->msg_end;
+
     return 0;
 }
 
 
+int pbcc_get_chan_msg_count(struct pbcc_context* p, char const* channel, size_t* o_count)
+{
+    return find_msg_count(p, channel, strlen(channel), o_count);
+}
+
+
 static enum pubnub_parameter_error check_timetoken(struct pbcc_context* p,
                                                    char const* timetoken)
 {
@@ -492,6 +642,9 @@ enum pubnub_res pbcc_message_counts_prep(struct pbcc_context* p,
 
     p->http_content_len = 0;
     p->msg_ofs = p->msg_end = 0;
+    p->msg_counts.count = 0;
+    p->msg_counts.ofs   = p->msg_counts.end = 0;
+    p->msg_counts.valid = false;
 
     p->http_buf_len = snprintf(p->http_buf,
                                sizeof p->http_buf,
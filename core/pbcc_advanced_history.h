@@ -61,6 +61,13 @@ int pbcc_get_chan_msg_counts(struct pbcc_context* p,
  */
 int pbcc_get_message_counts(struct pbcc_context* p, char const* channel, int* o_count);
 
+/** Looks up the message count of the @p channel in the response, in
+    O(1). Doesn't "use up" the message counts.
+    @retval 0 found, the count is in @p o_count
+    @retval -1 not found
+ */
+int pbcc_get_chan_msg_count(struct pbcc_context* p, char const* channel, size_t* o_count);
+
 /** Prepares the 'message_counts' operation (transaction), mostly by
     formatting the URI of the HTTP request.
  */
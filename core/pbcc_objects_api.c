@@ -80,7 +80,7 @@ enum pubnub_res pbcc_fetch_all_users_prep(struct pbcc_context* pb,
     char const*       uuid = pbcc_uuid_get(pb);
     enum pubnub_res   rslt;
 
-    PUBNUB_ASSERT_OPT(limit > MAX_OBJECTS_LIMIT);
+    PUBNUB_ASSERT_OPT(limit <= MAX_OBJECTS_LIMIT);
 
     pb->http_content_len = 0;
     pb->http_buf_len = snprintf(pb->http_buf,
@@ -268,7 +268,7 @@ enum pubnub_res pbcc_fetch_all_spaces_prep(struct pbcc_context* pb,
     char const*       uuid = pbcc_uuid_get(pb);
     enum pubnub_res   rslt;
 
-    PUBNUB_ASSERT_OPT(limit > MAX_OBJECTS_LIMIT);
+    PUBNUB_ASSERT_OPT(limit <= MAX_OBJECTS_LIMIT);
 
     pb->http_content_len = 0;
     pb->http_buf_len = snprintf(pb->http_buf,
@@ -458,7 +458,7 @@ enum pubnub_res pbcc_fetch_users_space_memberships_prep(struct pbcc_context* pb,
     char const*       uuid = pbcc_uuid_get(pb);
     enum pubnub_res   rslt;
 
-    PUBNUB_ASSERT_OPT(limit > MAX_OBJECTS_LIMIT);
+    PUBNUB_ASSERT_OPT(limit <= MAX_OBJECTS_LIMIT);
 
     pb->http_content_len = 0;
     pb->http_buf_len = snprintf(pb->http_buf,
@@ -589,7 +589,7 @@ enum pubnub_res pbcc_fetch_members_in_space_prep(struct pbcc_context* pb,
     char const*       uuid = pbcc_uuid_get(pb);
     enum pubnub_res   rslt;
 
-    PUBNUB_ASSERT_OPT(limit > MAX_OBJECTS_LIMIT);
+    PUBNUB_ASSERT_OPT(limit <= MAX_OBJECTS_LIMIT);
 
     pb->http_content_len = 0;
     pb->http_buf_len = snprintf(pb->http_buf,
@@ -645,6 +645,30 @@ enum pubnub_res pbcc_update_members_in_space_prep(struct pbcc_context* pb,
 }
 
 
+/** Finds the `data` array and the `next` page cursor in the Objects
+    API response from @p start to @p end (one past its `}`), for
+    pbcc_get_object() and pbcc_get_objects_next().
+ */
+static void parse_objects_page(struct pbcc_context* pb, char const* start, char const* end)
+{
+    struct pbjson_elem elem;
+    struct pbjson_elem found;
+
+    elem.start = start;
+    elem.end   = end;
+    if ((jonmpOK == pbjson_get_object_value(&elem, "data", &found))
+        && ('[' == *found.start)) {
+        pb->obj_ofs = found.start + 1 - pb->http_reply;
+        pb->obj_end = found.end - 1 - pb->http_reply;
+    }
+    if ((jonmpOK == pbjson_get_object_value(&elem, "next", &found))
+        && ('"' == *found.start) && (found.end - found.start > 2)) {
+        pb->obj_next_ofs = found.start + 1 - pb->http_reply;
+        pb->obj_next_len = found.end - found.start - 2;
+    }
+}
+
+
 enum pubnub_res pbcc_parse_objects_api_response(struct pbcc_context* pb)
 {
     char* reply    = pb->http_reply;
@@ -658,7 +682,10 @@ enum pubnub_res pbcc_parse_objects_api_response(struct pbcc_context* pb)
     }
 
     pb->chan_ofs = pb->chan_end = 0;
-    pb->msg_ofs = pb->msg_end = 0;
+    pb->msg_ofs = 0;
+    pb->msg_end = replylen;
+    pb->obj_ofs = pb->obj_end = 0;
+    pb->obj_next_ofs = pb->obj_next_len = 0;
 
     elem.end = pbjson_find_end_element(reply, reply + replylen);
     if ((*reply != '{') || (*elem.end != '}')) {
@@ -682,6 +709,56 @@ enum pubnub_res pbcc_parse_objects_api_response(struct pbcc_context* pb)
     if (strncmp("\"ok\"", parsed_status.start, parsed_status.end - parsed_status.start) != 0) {
         return PNR_OBJECTS_API_ERROR;
     }
+    parse_objects_page(pb, elem.start, elem.end + 1);
 
     return PNR_OBJECTS_API_OK;
 }
+
+
+pubnub_chamebl_t pbcc_get_object(struct pbcc_context* pb)
+{
+    pubnub_chamebl_t rslt = { NULL, 0 };
+    char const*      end  = pb->http_reply + pb->obj_end;
+    char const*      s;
+    char const*      obj_end;
+
+    if (pb->obj_ofs >= pb->obj_end) {
+        return rslt;
+    }
+    s = pbjson_skip_whitespace(pb->http_reply + pb->obj_ofs, end);
+    if (s == end) {
+        pb->obj_ofs = pb->obj_end;
+        return rslt;
+    }
+    obj_end = pbjson_find_end_element(s, end);
+    if (obj_end == end) {
+        PUBNUB_LOG_ERROR("pbcc_get_object(pbcc=%p) - Invalid: "
+                         "object not terminated: '%.*s'\n",
+                         pb,
+                         (int)(end - s),
+                         s);
+        pb->obj_ofs = pb->obj_end;
+        return rslt;
+    }
+    rslt.ptr  = (char*)s;
+    rslt.size = obj_end + 1 - s;
+    s         = pbjson_skip_whitespace(obj_end + 1, end);
+    if ((s < end) && (',' == *s)) {
+        ++s;
+    }
+    pb->obj_ofs = s - pb->http_reply;
+
+    return rslt;
+}
+
+
+pubnub_chamebl_t pbcc_get_objects_next(struct pbcc_context* pb)
+{
+    pubnub_chamebl_t rslt = { NULL, 0 };
+
+    if (pb->obj_next_len > 0) {
+        rslt.ptr  = pb->http_reply + pb->obj_next_ofs;
+        rslt.size = pb->obj_next_len;
+    }
+    return rslt;
+}
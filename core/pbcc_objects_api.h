@@ -3,6 +3,7 @@
 #define INC_PBCC_OBJECTS_API
 
 #include "pubnub_api_types.h"
+#include "pubnub_memory_block.h"
 
 struct pbcc_context;
 
@@ -156,5 +157,17 @@ enum pubnub_res pbcc_update_members_in_space_prep(struct pbcc_context* pb,
   */
 enum pubnub_res pbcc_parse_objects_api_response(struct pbcc_context* pb);
 
+/** Returns the next object (the JSON element) from the `data` array
+    of the last Objects API response, or {NULL, 0} if there are no
+    more (or the response has no `data` array).
+  */
+pubnub_chamebl_t pbcc_get_object(struct pbcc_context* pb);
+
+/** Returns the `next` page cursor (without the quotes) from the last
+    Objects API response, or {NULL, 0} if there is none (the last
+    page was received).
+  */
+pubnub_chamebl_t pbcc_get_objects_next(struct pbcc_context* pb);
+
 
 #endif /* !defined INC_PBCC_OBJECTS_API */
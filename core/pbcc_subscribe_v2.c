@@ -26,8 +26,9 @@ enum pubnub_res pbcc_subscribe_v2_prep(struct pbcc_context* p,
                                        unsigned*            heartbeat,
                                        char const*          filter_expr)
 {
-    char        region_str[20];
-    char const* tr;
+    char            region_str[20];
+    char const*     tr;
+    enum pubnub_res rslt;
 
     if (NULL == channel) {
         if (NULL == channel_group) {
@@ -51,18 +52,25 @@ enum pubnub_res pbcc_subscribe_v2_prep(struct pbcc_context* p,
     p->http_content_len = 0;
     p->msg_ofs = p->msg_end = 0;
 
-    p->http_buf_len = snprintf(
-        p->http_buf, sizeof p->http_buf, "/v2/subscribe/%s/", p->subscribe_key);
+    rslt = pbcc_start_url_with_keys(
+        p, "/v2/subscribe/", sizeof "/v2/subscribe/" - 1, false);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    APPEND_URL_LITERAL_M(p, "/");
     APPEND_URL_ENCODED_M(p, channel);
-    p->http_buf_len += snprintf(p->http_buf + p->http_buf_len,
-                                sizeof p->http_buf - p->http_buf_len,
-                                "/0?tt=%s&pnsdk=%s",
-                                p->timetoken,
-                                pubnub_uname());
+    APPEND_URL_LITERAL_M(p, "/0");
+    APPEND_URL_PARAM_M(p, "tt", p->timetoken, '?');
+    rslt = pbcc_append_url_pnsdk(p, '&');
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
     APPEND_URL_PARAM_M(p, "tr", tr, '&');
     APPEND_URL_PARAM_M(p, "channel-group", channel_group, '&');
-    APPEND_URL_PARAM_M(p, "uuid", p->uuid, '&');
-    APPEND_URL_PARAM_M(p, "auth", p->auth, '&');
+    rslt = pbcc_append_url_identity(p, true);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
     APPEND_URL_PARAM_ENCODED_M(p, "filter-expr", filter_expr, '&');
     APPEND_URL_OPT_PARAM_UNSIGNED_M(p, "heartbeat", heartbeat, '&');
 
@@ -16,7 +16,7 @@ static enum pubnub_res deflate_total_to_context_buffer(pubnub_t*   pb,
                                                        size_t      message_size)
 {
     size_t unpacked_size = message_size;
-    size_t compressed = sizeof pb->core.gzip_msg_buf -
+    size_t compressed = PUBNUB_COMPRESSED_MAXLEN -
                         (GZIP_HEADER_LENGTH_BYTES + GZIP_FOOTER_LENGTH_BYTES);
     char* gzip_msg_buf = pb->core.gzip_msg_buf;
     tdefl_compressor comp;
@@ -100,7 +100,7 @@ static enum pubnub_res deflate_total_to_context_buffer(pubnub_t*   pb,
 }
 
 /* Compile-time assertion */
-PUBNUB_STATIC_ASSERT(sizeof (*(pubnub_t*)(NULL)).core.gzip_msg_buf
+PUBNUB_STATIC_ASSERT(PUBNUB_COMPRESSED_MAXLEN
                      > (GZIP_HEADER_LENGTH_BYTES + GZIP_FOOTER_LENGTH_BYTES),
                      gzip_msg_buf_too_small_);
 
@@ -111,7 +111,14 @@ enum pubnub_res pbgzip_compress(pubnub_t* pb, char const* message)
 
     PUBNUB_ASSERT_OPT(pb != NULL);
     PUBNUB_ASSERT_OPT(message != NULL);
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    data = pbscratch_ensure(&pb->core.gzip_msg_buf);
+    if (NULL == data) {
+        return PNR_BAD_COMPRESSION_FORMAT;
+    }
+#else
     data = pb->core.gzip_msg_buf;
+#endif
     /* Gzip format */
     data[0] = 0x1f;
     data[1] = 0x8b; 
@@ -10,6 +10,13 @@
     means some messages were (possibly) lost, but allows us to recover
     from bad situations, e.g. too many messages queued or unexpected
     problem caused by a particular message.
+
+    Items left in the publish pipeline, if any, are reported before
+    the state is set, so a new transaction can't be started from the
+    pipeline callback. The history stream (if any) is done. Then,
+    "scratch" buffers (if dynamic) are given back to the pool. At the
+    end, those waiting to free a context are notified, as it may be
+    possible now.
 */
 #define PBNTF_TRANS_OUTCOME_COMMON(pb, state)                                      \
     do {                                                                           \
@@ -26,7 +33,11 @@
             break;                                                                 \
         }                                                                          \
         M_pb_->method = pubnubSendViaGET;                                          \
+        PBPIPE_TRANS_OUTCOME(M_pb_);                                               \
+        PBHS_TRANS_OUTCOME(M_pb_);                                                 \
+        PBSCRATCH_RELEASE_CTX(M_pb_);                                              \
         M_pb_->state = state;                                                      \
+        PBFREE_NOTIFY();                                                           \
     } while (0)
 
 #endif /* INC_PBNTF_TRANS_OUTCOME_COMMON */
@@ -220,6 +220,54 @@ int pbpal_close(pubnub_t *pb);
 /** Sets blocking I/O option on the context for the communication */
 int pbpal_set_blocking_io(pubnub_t *pb);
 
+#if PUBNUB_USE_SYNC_POLL
+/** What I/O a context waits for */
+enum pbpal_io_wait {
+    /** No I/O, or it is not known */
+    pbpalWaitNone,
+    /** The socket to become readable */
+    pbpalWaitIn,
+    /** The socket to become writable */
+    pbpalWaitOut
+};
+
+/** Waits (sleeps) for up to @p timeout_ms milliseconds for the socket
+    of the context @p pb to become ready for reading or, if @p out, for
+    writing. Doesn't wait if the PAL already has data to read.
+
+    Has to be called with the context locked. It is unlocked while
+    waiting, so others (like pubnub_cancel()) can get to it, thus the
+    context may have changed when this returns.
+
+    @return 0: timed out, +1: ready (or woken up), -1: error
+*/
+int pbpal_wait_io(pubnub_t *pb, bool out, int timeout_ms);
+
+/** Wakes up pbpal_wait_io() waiting on the context @p pb, as its
+    socket is about to be closed. Called with the context locked.
+*/
+void pbpal_interrupt_wait_io(pubnub_t *pb);
+
+/** Waits (sleeps) for up to @p timeout_ms milliseconds for the socket
+    of any of the @p n contexts @p pbs to become ready for the I/O in
+    @p waits (contexts waiting for #pbpalWaitNone are skipped).
+
+    Has to be called with the contexts unlocked, each one is locked
+    only while its socket is looked up.
+
+    @param ready Set to true for the contexts which are ready (or
+    have data in the PAL, or don't have a socket any more), false for
+    the others
+    @return The number of contexts that are ready, 0: timed out,
+    -1: error
+*/
+int pbpal_wait_io_any(pubnub_t *const *pbs,
+                      enum pbpal_io_wait const *waits,
+                      bool *ready,
+                      unsigned n,
+                      int timeout_ms);
+#endif
+
 /** Frees-up any resources allocated by the PAL for the given
     context. After this call, context is not safe for use by PAL any
     more (it is assumed it will be freed-up by the caller).
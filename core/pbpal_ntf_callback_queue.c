@@ -5,113 +5,227 @@
 
 #include "pubnub_assert.h"
 
+#include <stddef.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+
+/* Atomic operations we need. GCC (and Clang) have builtins, MSVC has
+   "interlocked" functions (which are full barriers).
+ */
+#if defined(_MSC_VER)
+
+static struct pbntf_queue_node* xchg_node(struct pbntf_queue_node** p,
+                                          struct pbntf_queue_node*  v)
+{
+    return (struct pbntf_queue_node*)InterlockedExchangePointer((PVOID volatile*)p, v);
+}
+
+static struct pbntf_queue_node* load_node(struct pbntf_queue_node** p)
+{
+    struct pbntf_queue_node* rslt = *(struct pbntf_queue_node* volatile*)p;
+    MemoryBarrier();
+    return rslt;
+}
+
+static void store_node(struct pbntf_queue_node** p, struct pbntf_queue_node* v)
+{
+    MemoryBarrier();
+    *(struct pbntf_queue_node* volatile*)p = v;
+}
+
+static bool cas_queued(long* p, long expected, long desired)
+{
+    return InterlockedCompareExchange((LONG volatile*)p, desired, expected) == expected;
+}
+
+static long xchg_queued(long* p, long v)
+{
+    return InterlockedExchange((LONG volatile*)p, v);
+}
+
+static long load_queued(long* p)
+{
+    long rslt = *(long volatile*)p;
+    MemoryBarrier();
+    return rslt;
+}
+
+#else
+
+static struct pbntf_queue_node* xchg_node(struct pbntf_queue_node** p,
+                                          struct pbntf_queue_node*  v)
+{
+    return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+}
+
+static struct pbntf_queue_node* load_node(struct pbntf_queue_node** p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static void store_node(struct pbntf_queue_node** p, struct pbntf_queue_node* v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+static bool cas_queued(long* p, long expected, long desired)
+{
+    return __atomic_compare_exchange_n(
+        p, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static long xchg_queued(long* p, long v)
+{
+    return __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL);
+}
+
+static long load_queued(long* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+#endif
+
+
+#define CONTEXT_OF(node) \
+    ((pubnub_t*)((char*)(node)-offsetof(struct pubnub_, ntf_node)))
+
+
+/** Puts the @p node at the head of the @p queue. Can be called from
+    any thread.
+ */
+static void push(struct pbpal_ntf_callback_queue* queue, struct pbntf_queue_node* node)
+{
+    struct pbntf_queue_node* prev;
+
+    store_node(&node->next, NULL);
+    prev = xchg_node(&queue->head, node);
+    /* Between the exchange and this store, the queue is "broken" at
+       `prev`, the consumer will wait for us to finish. */
+    store_node(&prev->next, node);
+}
+
+
+/** Takes a node from the tail of the @p queue. Can only be called
+    from the consumer thread.
+    @return The node, NULL if queue is empty or a producer is in the
+    middle of putting a node in it
+ */
+static struct pbntf_queue_node* pop(struct pbpal_ntf_callback_queue* queue)
+{
+    struct pbntf_queue_node* tail = queue->tail;
+    struct pbntf_queue_node* next = load_node(&tail->next);
+
+    if (tail == &queue->stub) {
+        if (NULL == next) {
+            return NULL;
+        }
+        queue->tail = next;
+        tail        = next;
+        next        = load_node(&next->next);
+    }
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+    if (tail != load_node(&queue->head)) {
+        return NULL;
+    }
+    push(queue, &queue->stub);
+    next = load_node(&tail->next);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
 
 void pbpal_ntf_callback_queue_init(struct pbpal_ntf_callback_queue* queue)
 {
-    pubnub_mutex_init(queue->monitor);
-    queue->size = sizeof queue->apb / sizeof queue->apb[0];
-    queue->head = queue->tail = 0;
+    queue->stub.next = NULL;
+    queue->head = queue->tail = &queue->stub;
 }
 
 
 void pbpal_ntf_callback_queue_deinit(struct pbpal_ntf_callback_queue* queue)
 {
-    pubnub_mutex_destroy(queue->monitor);
-    queue->head = queue->tail = 0;
+    queue->stub.next = NULL;
+    queue->head = queue->tail = &queue->stub;
 }
 
 
 int pbpal_ntf_callback_enqueue_for_processing(struct pbpal_ntf_callback_queue* queue,
                                               pubnub_t* pb)
 {
-    int    result;
-    size_t next_head;
-
     PUBNUB_ASSERT_OPT(queue != NULL);
     PUBNUB_ASSERT_OPT(pb != NULL);
 
-    pubnub_mutex_lock(queue->monitor);
-    next_head = queue->head + 1;
-    if (next_head == queue->size) {
-        next_head = 0;
-    }
-    if (next_head != queue->tail) {
-        queue->apb[queue->head] = pb;
-        queue->head             = next_head;
-        result                  = +1;
-    }
-    else {
-        result = -1;
-    }
-    pubnub_mutex_unlock(queue->monitor);
+    pbpal_ntf_callback_requeue_for_processing(queue, pb);
 
-    return result;
+    return +1;
 }
 
 
 int pbpal_ntf_callback_requeue_for_processing(struct pbpal_ntf_callback_queue* queue,
                                               pubnub_t* pb)
 {
-    bool   found = false;
-    size_t i;
-
+    PUBNUB_ASSERT_OPT(queue != NULL);
     PUBNUB_ASSERT_OPT(pb != NULL);
 
-    pubnub_mutex_lock(queue->monitor);
-    for (i = queue->tail; i != queue->head;
-         i = (((i + 1) == queue->size) ? 0 : i + 1)) {
-        if (queue->apb[i] == pb) {
-            found = true;
+    for (;;) {
+        switch (load_queued(&pb->ntf_queued)) {
+        case PBNTF_QUEUE_QUEUED:
+            return 0;
+        case PBNTF_QUEUE_REMOVED:
+            /* Still in the queue, just "undo" the removal */
+            if (cas_queued(&pb->ntf_queued, PBNTF_QUEUE_REMOVED, PBNTF_QUEUE_QUEUED)) {
+                return 0;
+            }
+            break;
+        default:
+            if (cas_queued(&pb->ntf_queued, PBNTF_QUEUE_NONE, PBNTF_QUEUE_QUEUED)) {
+                push(queue, &pb->ntf_node);
+                return +1;
+            }
             break;
         }
     }
-    pubnub_mutex_unlock(queue->monitor);
-
-    return !found ? pbpal_ntf_callback_enqueue_for_processing(queue, pb) : 0;
 }
 
 
 void pbpal_ntf_callback_remove_from_queue(struct pbpal_ntf_callback_queue* queue,
                                           pubnub_t*                        pb)
 {
-    size_t i;
-
     PUBNUB_ASSERT_OPT(queue != NULL);
     PUBNUB_ASSERT_OPT(pb != NULL);
 
-    pubnub_mutex_lock(queue->monitor);
-    for (i = queue->tail; i != queue->head;
-         i = (((i + 1) == queue->size) ? 0 : i + 1)) {
-        if (queue->apb[i] == pb) {
-            queue->apb[i] = NULL;
-            break;
-        }
-    }
-    pubnub_mutex_unlock(queue->monitor);
+    cas_queued(&pb->ntf_queued, PBNTF_QUEUE_QUEUED, PBNTF_QUEUE_REMOVED);
 }
 
 
 void pbpal_ntf_callback_process_queue(struct pbpal_ntf_callback_queue* queue)
 {
-    pubnub_mutex_lock(queue->monitor);
-    while (queue->head != queue->tail) {
-        pubnub_t* pbp = queue->apb[queue->tail++];
-        if (queue->tail == queue->size) {
-            queue->tail = 0;
+    struct pbntf_queue_node* node;
+
+    while ((node = pop(queue)) != NULL) {
+        pubnub_t* pbp = CONTEXT_OF(node);
+        /* From now on, it may be queued again */
+        if (xchg_queued(&pbp->ntf_queued, PBNTF_QUEUE_NONE) != PBNTF_QUEUE_QUEUED) {
+            continue;
         }
-        if (pbp != NULL) {
-            pubnub_mutex_unlock(queue->monitor);
-            pubnub_mutex_lock(pbp->monitor);
-            if (pbp->state == PBS_NULL) {
-                pubnub_mutex_unlock(pbp->monitor);
-                pballoc_free_at_last(pbp);
-            }
-            else {
-                pbnc_fsm(pbp);
-                pubnub_mutex_unlock(pbp->monitor);
-            }
-            pubnub_mutex_lock(queue->monitor);
+        pubnub_mutex_lock(pbp->monitor);
+        if (pbp->state == PBS_NULL) {
+            pubnub_mutex_unlock(pbp->monitor);
+            pballoc_free_at_last(pbp);
+        }
+        else {
+            pbnc_fsm(pbp);
+            pubnub_mutex_unlock(pbp->monitor);
         }
     }
-    pubnub_mutex_unlock(queue->monitor);
 }
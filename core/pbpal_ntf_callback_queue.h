@@ -2,7 +2,7 @@
 #if !defined(INC_PBPAL_NTF_CALLBACK_QUEUE)
 #define INC_PBPAL_NTF_CALLBACK_QUEUE
 
-#include "pubnub_mutex.h"
+#include "pubnub_internal.h"
 
 
 /** @file pbpal_ntf_callback_queue.h
@@ -16,20 +16,38 @@
     thread). This module does the common stuff related to this queue,
     while other modules deal with platform-specific handling.
 
+    The queue is a lock-free, intrusive, multiple-producer
+    single-consumer queue (D. Vyukov's design): the links are in the
+    contexts themselves (`pubnub_t::ntf_node`), so there is no limit
+    on the number of contexts in the queue, and any thread may put a
+    context in the queue, but only one thread (the one that calls
+    pbpal_ntf_callback_process_queue()) may take them out.
+
+    Each context has a "queued" state, so that we never put the same
+    context in the queue twice and requeueing is O(1). Removal is
+    lazy: the context is just marked as removed and is skipped when
+    it comes out of the queue.
  */
 
 
-#define PBPAL_NTF_CALLBACK_QUEUE_LIMIT 1024
+/** Context is not in the queue */
+#define PBNTF_QUEUE_NONE 0
+/** Context is in the queue */
+#define PBNTF_QUEUE_QUEUED 1
+/** Context is in the queue, but was removed, so is to be skipped */
+#define PBNTF_QUEUE_REMOVED 2
 
-/** The queue data. It's a simple circular buffer of (pointers to)
-    contexts, with a mutex as a monitor for multithreading.
- */
+
+/** The queue data. */
 struct pbpal_ntf_callback_queue {
-    pubnub_mutex_t monitor;
-    size_t         size;
-    size_t         head;
-    size_t         tail;
-    pubnub_t*      apb[PBPAL_NTF_CALLBACK_QUEUE_LIMIT];
+    /** The last node put in the queue - producers put new nodes
+        after it. */
+    struct pbntf_queue_node* head;
+    /** The first node in the queue - the consumer takes nodes from
+        here. */
+    struct pbntf_queue_node* tail;
+    /** The "stub" node, so that the queue is never really empty */
+    struct pbntf_queue_node stub;
 };
 
 
@@ -41,7 +59,10 @@ void pbpal_ntf_callback_queue_init(struct pbpal_ntf_callback_queue* queue);
 void pbpal_ntf_callback_queue_deinit(struct pbpal_ntf_callback_queue* queue);
 
 
-/** Enqueue Pubnub context @p pb for processing in the @p queue */
+/** Enqueue Pubnub context @p pb for processing in the @p queue. If
+    it's already in the queue, it is not enqueued again.
+    @return +1: context is (now) in the queue
+ */
 int pbpal_ntf_callback_enqueue_for_processing(struct pbpal_ntf_callback_queue* queue,
                                               pubnub_t* pb);
 
@@ -49,17 +70,23 @@ int pbpal_ntf_callback_enqueue_for_processing(struct pbpal_ntf_callback_queue* q
 /** Requeue Pubnub context @p pb for processing in the @p queue. That
     is, if context is already in queue, let it be. If it's not,
     enqueue it.
+    @return 0: context was already in the queue, +1: context enqueued
  */
 int pbpal_ntf_callback_requeue_for_processing(struct pbpal_ntf_callback_queue* queue,
                                               pubnub_t* pb);
 
 
-/** Remove Pubnub context @p pb from @p queue */
+/** Remove Pubnub context @p pb from @p queue. It will be skipped
+    when it comes out of the queue, unless it is (re)queued before
+    that.
+ */
 void pbpal_ntf_callback_remove_from_queue(struct pbpal_ntf_callback_queue* queue,
                                           pubnub_t*                        pb);
 
 
-/** Process all the context in the @p queue. */
+/** Process all the context in the @p queue. Must be called from
+    only one thread.
+ */
 void pbpal_ntf_callback_process_queue(struct pbpal_ntf_callback_queue* queue);
 
 
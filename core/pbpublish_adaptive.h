@@ -0,0 +1,34 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PBPUBLISH_ADAPTIVE
+#define INC_PBPUBLISH_ADAPTIVE
+
+#include "pubnub_coreapi_ex.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/** Starts the publish of the @p message, with the context @p pb
+    locked and ready to start a transaction. Shared by
+    pubnub_publish_ex() and pubnub_publish_json().
+
+    With #pubnubSendAdaptive, the method is chosen from the length of
+    the message, @p len, and the number of its characters which would
+    be URL encoded, @p url_unsafe. If GET is chosen, but the message
+    doesn't fit in the URL, it is sent via POST instead.
+
+    If @p from_buffer, via POST (without compression), the message is
+    sent directly from @p message (if the build supports sending the
+    body from the user's buffer), instead of being copied to the
+    context.
+ */
+enum pubnub_res pbpublish_start(pubnub_t*                     pb,
+                                char const*                   channel,
+                                char const*                   message,
+                                size_t                        len,
+                                size_t                        url_unsafe,
+                                struct pubnub_publish_options opts,
+                                bool                          from_buffer);
+
+
+#endif /* !defined INC_PBPUBLISH_ADAPTIVE */
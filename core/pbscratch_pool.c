@@ -0,0 +1,120 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+#include "pbscratch_pool.h"
+
+#include "pubnub_mutex.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <stdlib.h>
+
+
+/** A free buffer in the pool, the "link" is kept in the buffer
+    itself.
+ */
+struct pbscratch_free_block {
+    struct pbscratch_free_block* next;
+};
+
+static struct pbscratch_free_block* m_free_list pubnub_guarded_by(m_lock);
+static struct pbscratch_stats m_stats           pubnub_guarded_by(m_lock);
+pubnub_mutex_static_decl_and_init(m_lock);
+
+
+static char* acquire(void)
+{
+    char* rslt;
+
+    pubnub_mutex_init_static(m_lock);
+    pubnub_mutex_lock(m_lock);
+    if (m_free_list != NULL) {
+        rslt        = (char*)m_free_list;
+        m_free_list = m_free_list->next;
+        --m_stats.free;
+    }
+    else {
+        rslt = (char*)malloc(PBSCRATCH_BLOCK_SIZE);
+        if (NULL == rslt) {
+            pubnub_mutex_unlock(m_lock);
+            PUBNUB_LOG_ERROR("Failed to allocate a scratch buffer of %u bytes\n",
+                             (unsigned)PBSCRATCH_BLOCK_SIZE);
+            return NULL;
+        }
+    }
+    if (++m_stats.in_use > m_stats.in_use_max) {
+        m_stats.in_use_max = m_stats.in_use;
+    }
+    pubnub_mutex_unlock(m_lock);
+
+    return rslt;
+}
+
+
+static void release(char* buf)
+{
+    pubnub_mutex_init_static(m_lock);
+    pubnub_mutex_lock(m_lock);
+    PUBNUB_ASSERT_OPT(m_stats.in_use > 0);
+    --m_stats.in_use;
+    if (m_stats.free < PUBNUB_SCRATCH_POOL_MAX_FREE) {
+        struct pbscratch_free_block* block = (struct pbscratch_free_block*)buf;
+        block->next                        = m_free_list;
+        m_free_list                        = block;
+        ++m_stats.free;
+        buf = NULL;
+    }
+    pubnub_mutex_unlock(m_lock);
+
+    free(buf);
+}
+
+
+char* pbscratch_ensure(char** pbuf)
+{
+    PUBNUB_ASSERT_OPT(pbuf != NULL);
+    if (NULL == *pbuf) {
+        *pbuf = acquire();
+    }
+    return *pbuf;
+}
+
+
+void pbscratch_put(char** pbuf)
+{
+    PUBNUB_ASSERT_OPT(pbuf != NULL);
+    if (*pbuf != NULL) {
+        release(*pbuf);
+        *pbuf = NULL;
+    }
+}
+
+
+void pbscratch_release_ctx(pubnub_t* pb)
+{
+#if PUBNUB_CRYPTO_API
+    pbscratch_put(&pb->core.encrypted_msg_buf);
+#endif
+#if PUBNUB_USE_GZIP_COMPRESSION
+    pbscratch_put(&pb->core.gzip_msg_buf);
+    pb->core.gzip_msg_len = 0;
+#endif
+#if PUBNUB_PROXY_API
+    pbscratch_put(&pb->proxy_saved_path);
+    pb->proxy_saved_path_len = 0;
+#endif
+}
+
+
+void pbscratch_get_stats(struct pbscratch_stats* stats)
+{
+    PUBNUB_ASSERT_OPT(stats != NULL);
+
+    pubnub_mutex_init_static(m_lock);
+    pubnub_mutex_lock(m_lock);
+    *stats = m_stats;
+    pubnub_mutex_unlock(m_lock);
+}
+
+#endif /* PUBNUB_DYNAMIC_SCRATCH_BUFFERS */
@@ -0,0 +1,75 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PBSCRATCH_POOL
+#define INC_PBSCRATCH_POOL
+
+
+/** @file pbscratch_pool.h
+
+    A pool of "scratch" buffers, shared by all the contexts. Used
+    (with #PUBNUB_DYNAMIC_SCRATCH_BUFFERS) for the buffers that a
+    context needs only during some transactions, so that they don't
+    have to be a part of every context.
+
+    All the buffers in the pool are of the same size, big enough for
+    any of the "scratch" buffers of the context.
+*/
+
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+
+#include "pubnub_api_types.h"
+
+
+#if PUBNUB_USE_GZIP_COMPRESSION && (PUBNUB_COMPRESSED_MAXLEN > PUBNUB_BUF_MAXLEN)
+#define PBSCRATCH_BLOCK_SIZE PUBNUB_COMPRESSED_MAXLEN
+#else
+#define PBSCRATCH_BLOCK_SIZE PUBNUB_BUF_MAXLEN
+#endif
+
+#if !defined PUBNUB_SCRATCH_POOL_MAX_FREE
+#define PUBNUB_SCRATCH_POOL_MAX_FREE 4
+#endif
+
+
+/** Statistics of the scratch pool, as returned by
+    pbscratch_get_stats()
+ */
+struct pbscratch_stats {
+    /** Number of buffers currently used by contexts */
+    unsigned in_use;
+    /** Maximum number of buffers that were used at the same time */
+    unsigned in_use_max;
+    /** Number of free buffers kept in the pool */
+    unsigned free;
+};
+
+
+/** If there is no buffer in @p *pbuf, gets one from the pool and
+    stores it to @p *pbuf.
+    @return The buffer, NULL if there is none and the pool couldn't
+    allocate one
+ */
+char* pbscratch_ensure(char** pbuf);
+
+/** If there is a buffer in @p *pbuf, gives it back to the pool and
+    sets @p *pbuf to NULL.
+*/
+void pbscratch_put(char** pbuf);
+
+/** Gives all the "scratch" buffers of the context @p pb back to the
+    pool. Called on the outcome of a transaction and when the context
+    is freed.
+ */
+void pbscratch_release_ctx(pubnub_t* pb);
+
+/** Gets the current statistics of the scratch pool to @p stats */
+void pbscratch_get_stats(struct pbscratch_stats* stats);
+
+#define PBSCRATCH_RELEASE_CTX(pb) pbscratch_release_ctx(pb)
+
+#else
+
+#define PBSCRATCH_RELEASE_CTX(pb)
+
+#endif /* PUBNUB_DYNAMIC_SCRATCH_BUFFERS */
+
+#endif /* !defined INC_PBSCRATCH_POOL */
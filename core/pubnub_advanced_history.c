@@ -123,4 +123,26 @@ int pubnub_get_message_counts(pubnub_t* pb, char const* channel, int* o_count)
     return rslt;
 }
 
+
+int pubnub_get_chan_msg_count(pubnub_t* pb, char const* channel, size_t* o_count)
+{
+    int rslt = -1;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(channel != NULL);
+    PUBNUB_ASSERT_OPT(o_count != NULL);
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return -1;
+    }
+    if ((PBTT_MESSAGE_COUNTS == pb->trans) && (PNR_OK == pb->core.last_result)) {
+        rslt = pbcc_get_chan_msg_count(&(pb->core), channel, o_count);
+    }
+
+    pubnub_mutex_unlock(pb->monitor);
+    return rslt;
+}
+
 #endif /* PUBNUB_USE_ADVANCED_HISTORY */
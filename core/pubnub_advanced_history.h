@@ -59,5 +59,18 @@ int pubnub_get_chan_msg_counts(pubnub_t* pb,
   */
 int pubnub_get_message_counts(pubnub_t* pb, char const*channel, int* o_count);
 
+/** Looks up the message count of the @p channel in the answer of the
+    last (successful) 'message_counts' transaction on @p pb. Channels
+    in the answer are hashed when it is received, so this takes the
+    same time regardless of how many channels there are in it. Unlike
+    pubnub_get_chan_msg_counts() and pubnub_get_message_counts(),
+    it doesn't "use up" the answer, so it can be called for as many
+    channels as needed.
+    @retval 0 on success, the message count is in @p o_count
+    @retval -1 on error(transaction in progress, last transaction was
+    not a successful 'message_counts', or @p channel not in the answer)
+  */
+int pubnub_get_chan_msg_count(pubnub_t* pb, char const* channel, size_t* o_count);
+
 
 #endif /* !defined INC_PUBNUB_ADVANCED_HISTORY */
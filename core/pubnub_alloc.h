@@ -16,6 +16,19 @@
  */
 pubnub_t *pubnub_alloc(void);
 
+/** Makes sure that (at least) @p n contexts can be allocated with
+    pubnub_alloc() without allocating any more memory. Use this at
+    start-up if you know how many contexts you will need, to avoid
+    allocating (and fragmenting the heap) later.
+
+    With static allocation of contexts, just checks that there are
+    that many contexts.
+
+    @param n Number of contexts to reserve
+    @return 0: OK, -1: could not reserve that many contexts
+ */
+int pubnub_alloc_reserve(unsigned n);
+
 /** Frees a previously allocated context, if it is not in a
     transaction.  If a context is in a transaction, it will cancel it
     (as if you called pubnub_cancel()), but there's no guarantee that
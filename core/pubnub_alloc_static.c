@@ -42,6 +42,23 @@ pubnub_t *pubnub_alloc(void)
 }
 
 
+int pubnub_alloc_reserve(unsigned n)
+{
+    unsigned free_count = 0;
+    size_t   i;
+
+    for (i = 0; i < PUBNUB_CTX_MAX; ++i) {
+        pubnub_mutex_lock(m_aCtx[i].monitor);
+        if (m_aCtx[i].state == PBS_NULL) {
+            ++free_count;
+        }
+        pubnub_mutex_unlock(m_aCtx[i].monitor);
+    }
+
+    return (free_count >= n) ? 0 : -1;
+}
+
+
 void pballoc_free_at_last(pubnub_t *pb)
 {
     PUBNUB_ASSERT_OPT(pb != NULL);
@@ -50,10 +67,15 @@ void pballoc_free_at_last(pubnub_t *pb)
 
     PUBNUB_ASSERT_OPT(pb->state == PBS_NULL);
 
+    PBSCRATCH_RELEASE_CTX(pb);
+    PBHS_FREE(pb);
+    PBOBJC_FREE(pb);
     pbcc_deinit(&pb->core);
     pbpal_free(pb);
     pubnub_mutex_unlock(pb->monitor);
     pubnub_mutex_destroy(pb->monitor);
+
+    PBFREE_NOTIFY();
 }
 
 
@@ -6,75 +6,196 @@
 #include "pbpal.h"
 
 #include <stdlib.h>
-#include <string.h>
+#include <stdint.h>
 
 
-#if defined       PUBNUB_ASSERT_LEVEL_EX
-static pubnub_t** m_allocated;
-static unsigned   m_n;
-static unsigned   m_cap;
+/** Number of contexts in a slab - contexts are allocated from slabs,
+    which are allocated from the heap as needed.
+*/
+#if !defined PUBNUB_ALLOC_SLAB_CONTEXTS
+#define PUBNUB_ALLOC_SLAB_CONTEXTS 8
+#endif
+
+/** Size of a cache line. Contexts are aligned to it, so that two
+    contexts (used from different threads) don't share a cache line.
+*/
+#if !defined PUBNUB_CACHE_LINE_SIZE
+#define PUBNUB_CACHE_LINE_SIZE 64
+#endif
+
+#define ROUND_UP(n, to) ((((n) + (to)-1) / (to)) * (to))
+
+/** Header of a slot for a context in a slab, placed just before the
+    context itself.
+*/
+struct pballoc_slot {
+    /** Next free slot, if this one is free */
+    struct pballoc_slot* next_free;
+    /** Incremented on every allocation and release of the slot */
+    unsigned generation;
+};
+
+#define SLOT_HEADER_SIZE ROUND_UP(sizeof(struct pballoc_slot), PUBNUB_CACHE_LINE_SIZE)
+#define SLOT_SIZE (SLOT_HEADER_SIZE + ROUND_UP(sizeof(pubnub_t), PUBNUB_CACHE_LINE_SIZE))
+#define SLAB_SIZE (SLOT_SIZE * PUBNUB_ALLOC_SLAB_CONTEXTS)
+
 pubnub_mutex_static_decl_and_init(m_lock);
+/** List of free slots */
+static struct pballoc_slot* m_free pubnub_guarded_by(m_lock);
+/** Number of free slots */
+static unsigned m_free_count pubnub_guarded_by(m_lock);
+
+#if defined PUBNUB_ASSERT_LEVEL_EX
+/** Open addressing hash table of the contexts of all the slots of all
+    the slabs, to check a context pointer in O(1), without reading
+    anything it points to. Slots are never removed, as slabs are never
+    freed. The size is a power of 2, at least twice the number of
+    slots.
+*/
+static pubnub_t const** m_slot_table pubnub_guarded_by(m_lock);
+/** Size of #m_slot_table */
+static size_t m_slot_table_size pubnub_guarded_by(m_lock);
+/** Number of slots in #m_slot_table */
+static size_t m_slot_count pubnub_guarded_by(m_lock);
 #endif
 
 
-static void save_allocated(pubnub_t* pb)
-{
+#define SLOT_OF(pb) ((struct pballoc_slot*)((char*)(pb)-SLOT_HEADER_SIZE))
+#define CTX_OF(slot) ((pubnub_t*)((char*)(slot) + SLOT_HEADER_SIZE))
+
+/** A slot is in use iff its generation is odd */
+#define SLOT_IN_USE(slot) ((slot)->generation & 1)
+
+
 #if defined PUBNUB_ASSERT_LEVEL_EX
-    pubnub_mutex_init_static(m_lock);
-    pubnub_mutex_lock(m_lock);
-    if (m_n == m_cap) {
-        pubnub_t** npalloc =
-            (pubnub_t**)realloc(m_allocated, sizeof m_allocated[0] * (m_n + 1));
-        if (NULL == npalloc) {
-            PUBNUB_LOG_WARNING("Couldn't allocate memory for pubnub_alloc_std bookkeeping");
-            pubnub_mutex_unlock(m_lock);
-            return;
-        }
-        m_allocated        = npalloc;
-        m_allocated[m_n++] = pb;
-        m_cap              = m_n;
+/** Index of @p pb in a slot table of @p size (a power of 2), if there
+    are no collisions. Contexts are cache line aligned, so the low bits
+    are dropped, and the rest are mixed (Fibonacci hashing).
+ */
+static size_t slot_hash(pubnub_t const* pb, size_t size)
+{
+    uintptr_t const key = (uintptr_t)pb / PUBNUB_CACHE_LINE_SIZE;
+    return (size_t)(key * 2654435761u) & (size - 1);
+}
+
+
+static void slot_table_insert(pubnub_t const** table, size_t size, pubnub_t const* pb)
+{
+    size_t i = slot_hash(pb, size);
+    while (table[i] != NULL) {
+        i = (i + 1) & (size - 1);
     }
-    else {
-        m_allocated[m_n++] = pb;
+    table[i] = pb;
+}
+
+
+/** Makes sure that #m_slot_table has room for @p n more slots.
+    Has to be called with #m_lock locked.
+    @retval 0 OK, @retval -1 failed to allocate
+ */
+static int slot_table_reserve(size_t n)
+{
+    pubnub_t const** table;
+    size_t           size;
+    size_t           i;
+
+    if (2 * (m_slot_count + n) <= m_slot_table_size) {
+        return 0;
     }
-    pubnub_mutex_unlock(m_lock);
-#endif
+    size = (0 == m_slot_table_size) ? 16 : m_slot_table_size;
+    while (size < 2 * (m_slot_count + n)) {
+        size *= 2;
+    }
+    table = (pubnub_t const**)calloc(size, sizeof table[0]);
+    if (NULL == table) {
+        PUBNUB_LOG_ERROR("Couldn't allocate memory for the slot table\n");
+        return -1;
+    }
+    for (i = 0; i < m_slot_table_size; ++i) {
+        if (m_slot_table[i] != NULL) {
+            slot_table_insert(table, size, m_slot_table[i]);
+        }
+    }
+    free(m_slot_table);
+    m_slot_table      = table;
+    m_slot_table_size = size;
+
+    return 0;
 }
 
 
-static void remove_allocated(pubnub_t* pb)
+/** Checks if @p pb is the context of one of the slots in
+    #m_slot_table. Has to be called with #m_lock locked.
+ */
+static bool slot_table_has(pubnub_t const* pb)
 {
-#if defined PUBNUB_ASSERT_LEVEL_EX
     size_t i;
-    for (i = 0; i < m_n; ++i) {
-        if (m_allocated[i] == pb) {
-            if (i != m_n - 1) {
-                memmove(m_allocated + i,
-                        m_allocated + i + 1,
-                        sizeof m_allocated[0] * (m_n - i - 1));
-            }
-            if (0 == --m_n) {
-                free(m_allocated);
-                m_allocated = NULL;
-                m_cap = 0;
-            }
-            break;
+
+    if (0 == m_slot_table_size) {
+        return false;
+    }
+    for (i = slot_hash(pb, m_slot_table_size); m_slot_table[i] != NULL;
+         i = (i + 1) & (m_slot_table_size - 1)) {
+        if (m_slot_table[i] == pb) {
+            return true;
         }
     }
+    return false;
+}
+#endif /* defined PUBNUB_ASSERT_LEVEL_EX */
+
+
+/** Allocates a new slab and puts all of its slots on the free list.
+    Has to be called with #m_lock locked.
+    @retval 0 OK, @retval -1 failed to allocate
+ */
+static int add_slab(void)
+{
+    char*    raw;
+    char*    slots;
+    unsigned i;
+
+#if defined PUBNUB_ASSERT_LEVEL_EX
+    if (slot_table_reserve(PUBNUB_ALLOC_SLAB_CONTEXTS) != 0) {
+        return -1;
+    }
 #endif
+    raw = (char*)malloc(SLAB_SIZE + PUBNUB_CACHE_LINE_SIZE - 1);
+    if (NULL == raw) {
+        PUBNUB_LOG_ERROR("Couldn't allocate a slab of %u contexts\n",
+                         (unsigned)PUBNUB_ALLOC_SLAB_CONTEXTS);
+        return -1;
+    }
+    slots = raw + (PUBNUB_CACHE_LINE_SIZE - 1)
+            - ((uintptr_t)(raw + PUBNUB_CACHE_LINE_SIZE - 1) % PUBNUB_CACHE_LINE_SIZE);
+    for (i = PUBNUB_ALLOC_SLAB_CONTEXTS; i > 0; --i) {
+        struct pballoc_slot* slot = (struct pballoc_slot*)(slots + (i - 1) * SLOT_SIZE);
+        slot->generation          = 0;
+        slot->next_free           = m_free;
+        m_free                    = slot;
+#if defined PUBNUB_ASSERT_LEVEL_EX
+        slot_table_insert(m_slot_table, m_slot_table_size, CTX_OF(slot));
+        ++m_slot_count;
+#endif
+    }
+    m_free_count += PUBNUB_ALLOC_SLAB_CONTEXTS;
+
+    return 0;
 }
 
 
+/** Checks that @p pb points to a context in one of our slabs, which is
+    allocated. O(1): the slot table is looked up first, so the slot
+    header (its generation) is read only if @p pb is known to be ours.
+    Has to be called with #m_lock locked.
+ */
 static bool check_ctx_ptr(pubnub_t const* pb)
 {
 #if defined PUBNUB_ASSERT_LEVEL_EX
-    size_t i;
-    for (i = 0; i < m_n; ++i) {
-        if (m_allocated[i] == pb) {
-            return true;
-        }
+    if ((NULL == pb) || (((uintptr_t)pb % PUBNUB_CACHE_LINE_SIZE) != 0)) {
+        return false;
     }
-    return false;
+    return slot_table_has(pb) && SLOT_IN_USE(SLOT_OF(pb));
 #else
     return pb != NULL;
 #endif
@@ -100,16 +221,44 @@ bool pb_valid_ctx_ptr(pubnub_t const* pb)
 
 pubnub_t* pubnub_alloc(void)
 {
-    pubnub_t* pb = (pubnub_t*)malloc(sizeof(pubnub_t));
-    if (pb != NULL) {
-        save_allocated(pb);
+    struct pballoc_slot* slot;
+
+    pubnub_mutex_init_static(m_lock);
+    pubnub_mutex_lock(m_lock);
+    if ((NULL == m_free) && (add_slab() != 0)) {
+        pubnub_mutex_unlock(m_lock);
+        return NULL;
+    }
+    slot   = m_free;
+    m_free = slot->next_free;
+    --m_free_count;
+    ++slot->generation;
+    PUBNUB_ASSERT_OPT(SLOT_IN_USE(slot));
+    pubnub_mutex_unlock(m_lock);
+
+    return CTX_OF(slot);
+}
+
+
+int pubnub_alloc_reserve(unsigned n)
+{
+    int rslt = 0;
+
+    pubnub_mutex_init_static(m_lock);
+    pubnub_mutex_lock(m_lock);
+    while ((m_free_count < n) && (0 == rslt)) {
+        rslt = add_slab();
     }
-    return pb;
+    pubnub_mutex_unlock(m_lock);
+
+    return rslt;
 }
 
 
 void pballoc_free_at_last(pubnub_t* pb)
 {
+    struct pballoc_slot* slot;
+
     PUBNUB_LOG_TRACE("pballoc_free_at_last(%p)\n", pb);
 
     PUBNUB_ASSERT_OPT(pb != NULL);
@@ -122,13 +271,23 @@ void pballoc_free_at_last(pubnub_t* pb)
 
     PUBNUB_ASSERT_OPT(pb->state == PBS_NULL);
 
+    PBSCRATCH_RELEASE_CTX(pb);
+    PBHS_FREE(pb);
+    PBOBJC_FREE(pb);
     pbcc_deinit(&pb->core);
     pbpal_free(pb);
-    remove_allocated(pb);
     pubnub_mutex_unlock(pb->monitor);
     pubnub_mutex_destroy(pb->monitor);
+
+    slot = SLOT_OF(pb);
+    PUBNUB_ASSERT_OPT(SLOT_IN_USE(slot));
+    ++slot->generation;
+    slot->next_free = m_free;
+    m_free          = slot;
+    ++m_free_count;
     pubnub_mutex_unlock(m_lock);
-    free(pb);
+
+    PBFREE_NOTIFY();
 }
 
 
@@ -136,7 +295,7 @@ int pubnub_free(pubnub_t* pb)
 {
     int result = -1;
 
-    PUBNUB_ASSERT(check_ctx_ptr(pb));
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
 
     PUBNUB_LOG_TRACE("pubnub_free(%p)\n", pb);
 
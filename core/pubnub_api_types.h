@@ -105,7 +105,9 @@ enum pubnub_res {
     /** Objects API transaction has finished successfully */
     PNR_OBJECTS_API_OK,
     /** Objects API transaction reported an error */
-    PNR_OBJECTS_API_ERROR
+    PNR_OBJECTS_API_ERROR,
+    /** A (bounded) request queue is full, try again later */
+    PNR_QUEUE_FULL
 };
 
 /** 'pubnub_cancel()' return value */
@@ -250,7 +252,28 @@ enum pubnub_method {
     pubnubUsePATCH,
     pubnubSendViaPOSTwithGZIP,
     pubnubUsePATCHwithGZIP,
-    pubnubUseDELETE
+    pubnubUseDELETE,
+    /** Publish only: GET, POST or POST with GZIP, whichever puts the
+        fewest bytes on the wire for the message, see
+        pubnub_publish_ex() */
+    pubnubSendAdaptive
+};
+
+/** Counters of the publish requests of a context, by the method
+    they were sent with, and of the bytes they put on the wire (the
+    URL and the body, without the other HTTP headers). Requests that
+    are re-sent are counted again. */
+struct pubnub_publish_stats {
+    /** Requests sent via GET, the message URL encoded in the path */
+    unsigned long via_get;
+    /** Requests sent via POST, the message as-is in the body */
+    unsigned long via_post;
+    /** Requests sent via POST, the message compressed in the body */
+    unsigned long via_gzip;
+    /** Bytes of the requests sent via GET */
+    unsigned long get_bytes;
+    /** Bytes of the requests sent via POST (compressed or not) */
+    unsigned long post_bytes;
 };
 
 /** Enum that describes an error when checking parameters passed to a function */
@@ -8,6 +8,20 @@
 #include "pubnub_assert.h"
 #include "pubnub_log.h"
 
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Header of an entry (message or failed subscribe outcome) in the
+    ring buffer of a decoupled subscribe loop. The message follows it.
+ */
+struct sublup_ring_header {
+    /** Length of the message, 0 if this is a failed subscribe */
+    size_t len;
+    /** The outcome of the subscribe */
+    enum pubnub_res result;
+};
+
 
 /** Subscribe loop descriptor */
 struct pubnub_subloop_descriptor {
@@ -23,6 +37,27 @@ struct pubnub_subloop_descriptor {
     pubnub_guarded_by(monitor) pubnub_callback_t saved_context_cb;
     /** Saved user data for callback from the #pbp context */
     pubnub_guarded_by(monitor) void* saved_context_user_data;
+    /** Ring buffer of a decoupled loop, NULL if loop is not decoupled */
+    pubnub_guarded_by(monitor) char* ring;
+    /** Size of the #ring */
+    pubnub_guarded_by(monitor) size_t ring_capacity;
+    /** Offset of the first (oldest) entry in the #ring */
+    pubnub_guarded_by(monitor) size_t ring_head;
+    /** Number of bytes used in the #ring */
+    pubnub_guarded_by(monitor) size_t ring_used;
+    /** Number of entries in the #ring */
+    pubnub_guarded_by(monitor) unsigned ring_count;
+    /** What to do when an entry doesn't fit in the #ring */
+    pubnub_guarded_by(monitor) enum pubnub_subloop_overflow policy;
+    /** Number of messages dropped because they didn't fit */
+    pubnub_guarded_by(monitor) unsigned long dropped;
+    /** Function to call when entries are put in the #ring */
+    pubnub_guarded_by(monitor) pubnub_subloop_notify_t notify;
+    /** Data to pass to #notify */
+    pubnub_guarded_by(monitor) void* notify_data;
+    /** Buffer to copy a message to, from the #ring, to give it to the
+        callback in pubnub_subloop_drain() */
+    char* drained;
 
 #if PUBNUB_THREADSAFE
     pubnub_mutex_t monitor;
@@ -30,6 +65,129 @@ struct pubnub_subloop_descriptor {
 };
 
 
+static void ring_write(pubnub_subloop_t* pbsld, size_t ofs, void const* src, size_t n)
+{
+    size_t first;
+
+    ofs %= pbsld->ring_capacity;
+    first = pbsld->ring_capacity - ofs;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(pbsld->ring + ofs, src, first);
+    memcpy(pbsld->ring, (char const*)src + first, n - first);
+}
+
+
+static void ring_read(pubnub_subloop_t* pbsld, size_t ofs, void* dst, size_t n)
+{
+    size_t first;
+
+    ofs %= pbsld->ring_capacity;
+    first = pbsld->ring_capacity - ofs;
+    if (first > n) {
+        first = n;
+    }
+    memcpy(dst, pbsld->ring + ofs, first);
+    memcpy((char*)dst + first, pbsld->ring, n - first);
+}
+
+
+/** Removes the oldest entry from the ring. If @p dst is not NULL, the
+    message is copied to it (and NUL terminated).
+    @return The header of the entry removed
+ */
+static struct sublup_ring_header ring_pop(pubnub_subloop_t* pbsld, char* dst)
+{
+    struct sublup_ring_header hdr;
+
+    PUBNUB_ASSERT_OPT(pbsld->ring_count > 0);
+    ring_read(pbsld, pbsld->ring_head, &hdr, sizeof hdr);
+    if (dst != NULL) {
+        ring_read(pbsld, pbsld->ring_head + sizeof hdr, dst, hdr.len);
+        dst[hdr.len] = '\0';
+    }
+    pbsld->ring_head = (pbsld->ring_head + sizeof hdr + hdr.len) % pbsld->ring_capacity;
+    pbsld->ring_used -= sizeof hdr + hdr.len;
+    --pbsld->ring_count;
+
+    return hdr;
+}
+
+
+/** Puts the @p message (or, if NULL, the failed subscribe @p result)
+    in the ring, if there is (or, depending on the policy, we can
+    make) room for it.
+    @return 1: put in the ring, 0: dropped
+ */
+static unsigned ring_push(pubnub_subloop_t* pbsld, char const* message, enum pubnub_res result)
+{
+    struct sublup_ring_header hdr;
+
+    hdr.len    = (NULL == message) ? 0 : strlen(message);
+    hdr.result = result;
+    if (sizeof hdr + hdr.len > pbsld->ring_capacity) {
+        ++pbsld->dropped;
+        return 0;
+    }
+    while (pbsld->ring_used + sizeof hdr + hdr.len > pbsld->ring_capacity) {
+        if (pbsloDropNewest == pbsld->policy) {
+            ++pbsld->dropped;
+            return 0;
+        }
+        ring_pop(pbsld, NULL);
+        ++pbsld->dropped;
+    }
+    ring_write(pbsld, pbsld->ring_head + pbsld->ring_used, &hdr, sizeof hdr);
+    if (hdr.len > 0) {
+        /* An error has no message, and memcpy() from NULL is undefined,
+           even of 0 bytes */
+        ring_write(pbsld, pbsld->ring_head + pbsld->ring_used + sizeof hdr, message, hdr.len);
+    }
+    pbsld->ring_used += sizeof hdr + hdr.len;
+    ++pbsld->ring_count;
+
+    return 1;
+}
+
+
+/** The context callback of a decoupled subscribe loop: copies the
+    messages to the ring, subscribes again and only then notifies
+    the consumer.
+ */
+static void decoupled_context_callback(pubnub_t*         pb,
+                                       pubnub_subloop_t* pbsld,
+                                       enum pubnub_res   result)
+{
+    pubnub_subloop_notify_t notify;
+    void*                   notify_data;
+    unsigned                count = 0;
+
+    if (PNR_OK == result) {
+        char const* msg;
+        for (msg = pubnub_get(pb); msg != NULL; msg = pubnub_get(pb)) {
+            count += ring_push(pbsld, msg, PNR_OK);
+        }
+    }
+    else {
+        count = ring_push(pbsld, NULL, result);
+    }
+    result = pubnub_subscribe_ex(pbsld->pbp, pbsld->channel, pbsld->options);
+    if (result != PNR_STARTED) {
+        PUBNUB_LOG_ERROR("Failed to re-subscribe in the subscribe loop, "
+                         "error code = %d\n",
+                         result);
+    }
+    notify      = pbsld->notify;
+    notify_data = pbsld->notify_data;
+    pubnub_mutex_unlock(pbsld->monitor);
+
+    if ((notify != NULL) && (count > 0)) {
+        notify(pbsld, notify_data);
+    }
+}
+
+
 static void sublup_context_callback(pubnub_t*         pb,
                                     enum pubnub_trans trans,
                                     enum pubnub_res   result,
@@ -40,6 +198,11 @@ static void sublup_context_callback(pubnub_t*         pb,
     PUBNUB_ASSERT_OPT(pbsld != NULL);
 
     pubnub_mutex_lock(pbsld->monitor);
+    if ((PBTT_SUBSCRIBE == trans) && (pbsld->ring != NULL)) {
+        /* Unlocks the loop */
+        decoupled_context_callback(pb, pbsld, result);
+        return;
+    }
     if (PBTT_SUBSCRIBE == trans) {
         if (PNR_OK == result) {
             char const* msg;
@@ -76,6 +239,16 @@ pubnub_subloop_t* pubnub_subloop_define(pubnub_t*                       p,
     rslt->options          = options;
     rslt->cb               = cb;
     rslt->saved_context_cb = NULL;
+    rslt->ring             = NULL;
+    rslt->ring_capacity    = 0;
+    rslt->ring_head        = 0;
+    rslt->ring_used        = 0;
+    rslt->ring_count       = 0;
+    rslt->policy           = pbsloDropNewest;
+    rslt->dropped          = 0;
+    rslt->notify           = NULL;
+    rslt->notify_data      = NULL;
+    rslt->drained          = NULL;
     pubnub_mutex_init(rslt->monitor);
 
     return rslt;
@@ -120,6 +293,87 @@ void pubnub_subloop_stop(pubnub_subloop_t* pbsld)
 }
 
 
+enum pubnub_res pubnub_subloop_set_ring(pubnub_subloop_t*            pbsld,
+                                        size_t                       capacity,
+                                        enum pubnub_subloop_overflow policy,
+                                        pubnub_subloop_notify_t      notify,
+                                        void*                        notify_data)
+{
+    char* ring    = NULL;
+    char* drained = NULL;
+
+    PUBNUB_ASSERT_OPT(NULL != pbsld);
+
+    if (capacity > 0) {
+        ring = (char*)malloc(capacity);
+        /* A message is shorter than the ring, to NUL terminate it */
+        drained = (char*)malloc(capacity);
+        if ((NULL == ring) || (NULL == drained)) {
+            free(drained);
+            free(ring);
+            return PNR_INTERNAL_ERROR;
+        }
+    }
+
+    pubnub_mutex_lock(pbsld->monitor);
+    free(pbsld->ring);
+    free(pbsld->drained);
+    pbsld->ring          = ring;
+    pbsld->drained       = drained;
+    pbsld->ring_capacity = capacity;
+    pbsld->ring_head     = 0;
+    pbsld->ring_used     = 0;
+    pbsld->ring_count    = 0;
+    pbsld->policy        = policy;
+    pbsld->notify        = notify;
+    pbsld->notify_data   = notify_data;
+    pubnub_mutex_unlock(pbsld->monitor);
+
+    return PNR_OK;
+}
+
+
+unsigned pubnub_subloop_drain(pubnub_subloop_t* pbsld, unsigned max)
+{
+    unsigned i;
+
+    PUBNUB_ASSERT_OPT(NULL != pbsld);
+
+    for (i = 0; (0 == max) || (i < max); ++i) {
+        struct sublup_ring_header hdr;
+        pubnub_t*                 pbp;
+
+        pubnub_mutex_lock(pbsld->monitor);
+        if (0 == pbsld->ring_count) {
+            pubnub_mutex_unlock(pbsld->monitor);
+            break;
+        }
+        hdr = ring_pop(pbsld, pbsld->drained);
+        pbp = pbsld->pbp;
+        pubnub_mutex_unlock(pbsld->monitor);
+
+        /* Not holding the lock, so that the loop can go on */
+        pbsld->cb(pbp, (PNR_OK == hdr.result) ? pbsld->drained : NULL, hdr.result);
+    }
+
+    return i;
+}
+
+
+unsigned long pubnub_subloop_dropped(pubnub_subloop_t* pbsld)
+{
+    unsigned long rslt;
+
+    PUBNUB_ASSERT_OPT(NULL != pbsld);
+
+    pubnub_mutex_lock(pbsld->monitor);
+    rslt = pbsld->dropped;
+    pubnub_mutex_unlock(pbsld->monitor);
+
+    return rslt;
+}
+
+
 void pubnub_subloop_undef(pubnub_subloop_t* pbsld)
 {
     PUBNUB_ASSERT_OPT(NULL != pbsld);
@@ -134,5 +388,7 @@ void pubnub_subloop_undef(pubnub_subloop_t* pbsld)
     pubnub_mutex_unlock(pbsld->monitor);
     pubnub_mutex_destroy(pbsld->monitor);
 
+    free(pbsld->drained);
+    free(pbsld->ring);
     free(pbsld);
 }
@@ -26,6 +26,29 @@ typedef struct pubnub_subloop_descriptor pubnub_subloop_t;
 */
 typedef void (*pubnub_subloop_callback_t)(pubnub_t *pbp, char const* message, enum pubnub_res result);
 
+/** What to do with a message received by a decoupled subscribe loop
+    when there is no room for it in its ring buffer, see
+    pubnub_subloop_set_ring().
+ */
+enum pubnub_subloop_overflow {
+    /** Drop the message received, keep the (older) messages in the
+        ring */
+    pbsloDropNewest,
+    /** Drop the oldest messages from the ring, to make room for the
+        message received */
+    pbsloDropOldest
+};
+
+/** Prototype of a function that will be called back when messages
+    are put in the ring buffer of a decoupled subscribe loop, so that
+    the consumer can (wake up and) drain them, with
+    pubnub_subloop_drain().
+
+    @note Called from the context callback, so, don't drain the
+    messages in it - just notify your consumer.
+*/
+typedef void (*pubnub_subloop_notify_t)(pubnub_subloop_t* pbsld, void* user_data);
+
 /** Helper to create a subscribe loop descriptor. For the values that
     are part of the descriptor, but are not provided as parameters of
     this function, defaults will be used.
@@ -82,6 +105,57 @@ enum pubnub_res pubnub_subloop_start(pubnub_subloop_t* pbsld);
  */
 void pubnub_subloop_stop(pubnub_subloop_t* pbsld);
 
+/** Makes the subscribe loop "decoupled": instead of calling the
+    callback for each message received (and then subscribing again),
+    the loop copies the messages (and the failed subscribe outcomes)
+    into a ring buffer, subscribes again right away and notifies the
+    consumer, which then calls pubnub_subloop_drain() to get the
+    messages. Thus, a slow consumer doesn't delay the next subscribe
+    (long-poll) - if it is too slow, messages are dropped, as
+    specified by @p policy.
+
+    Call before pubnub_subloop_start(), or with the loop stopped.
+
+    @param[in] pbsld The subscribe loop descriptor
+    @param[in] capacity Size of the ring buffer, in bytes. Each
+    message takes its length and a few bytes more. If 0, the loop is
+    not decoupled any more, messages are given to the callback from
+    the context callback, as usual.
+    @param[in] policy What to do when a message doesn't fit in the ring
+    @param[in] notify Function to call when messages are put in the
+    ring, can be NULL (if the consumer polls)
+    @param[in] notify_data Passed to @p notify
+
+    @retval PNR_OK Success
+    @retval PNR_INTERNAL_ERROR Failed to allocate the ring buffer
+ */
+enum pubnub_res pubnub_subloop_set_ring(pubnub_subloop_t*            pbsld,
+                                        size_t                       capacity,
+                                        enum pubnub_subloop_overflow policy,
+                                        pubnub_subloop_notify_t      notify,
+                                        void*                        notify_data);
+
+/** Takes (at most @p max) messages from the ring buffer of a
+    decoupled subscribe loop and calls the callback (given in
+    pubnub_subloop_define()) for each of them, from the calling
+    thread. The message given to the callback is valid only during
+    the call.
+
+    Should be called from one (consumer) thread at a time.
+
+    @param[in] pbsld The subscribe loop descriptor
+    @param[in] max The maximum number of messages to take, 0: all
+    that are in the ring
+    @return The number of messages taken
+ */
+unsigned pubnub_subloop_drain(pubnub_subloop_t* pbsld, unsigned max);
+
+/** Returns the number of messages dropped by the decoupled subscribe
+    loop @p pbsld because there was no room for them in its ring
+    buffer.
+ */
+unsigned long pubnub_subloop_dropped(pubnub_subloop_t* pbsld);
+
 /** Undefines - releases the subscribe loop descriptor */
 void pubnub_subloop_undef(pubnub_subloop_t* pbsld);
 
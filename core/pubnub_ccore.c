@@ -27,7 +27,7 @@ static enum pubnub_res simple_parse_response(struct pbcc_context* p)
     p->msg_end          = replylen - 1;
     reply[replylen - 1] = '\0';
 
-    return pbcc_split_array(reply + p->msg_ofs) ? PNR_OK : PNR_FORMAT_ERROR;
+    return pbcc_split_messages(p, reply + p->msg_ofs) ? PNR_OK : PNR_FORMAT_ERROR;
 }
 
 
@@ -180,7 +180,7 @@ enum pubnub_res pbcc_history_prep(struct pbcc_context* pb,
     APPEND_URL_PARAM_TRIBOOL_M(pb, "stringtoken", string_token, '&');
     APPEND_URL_PARAM_TRIBOOL_M(pb, "reverse", reverse, '&');
     APPEND_URL_PARAM_M(pb, "start", start, '&');
-    APPEND_URL_PARAM_M(pb, "start", end, '&');
+    APPEND_URL_PARAM_M(pb, "end", end, '&');
 
     return PNR_STARTED;
 }
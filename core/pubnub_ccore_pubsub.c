@@ -21,7 +21,22 @@ void pbcc_init(struct pbcc_context* p, const char* publish_key, const char* subs
     p->timetoken[1]  = '\0';
     p->uuid[0]       = '\0';
     p->auth          = NULL;
+#if PUBNUB_USE_URL_CACHE
+    p->url_cache.valid = false;
+#endif
     p->msg_ofs = p->msg_end = 0;
+#if PUBNUB_USE_REPLY_INDEX
+    memset(&p->msg_index, 0, sizeof p->msg_index);
+    memset(&p->chan_index, 0, sizeof p->chan_index);
+    p->msg_index.valid = p->chan_index.valid = true;
+#endif
+#if PUBNUB_USE_ADVANCED_HISTORY
+    memset(&p->msg_counts, 0, sizeof p->msg_counts);
+#endif
+#if PUBNUB_USE_OBJECTS_API
+    p->obj_ofs = p->obj_end = 0;
+    p->obj_next_ofs = p->obj_next_len = 0;
+#endif
 #if PUBNUB_DYNAMIC_REPLY_BUFFER
     p->http_reply = NULL;
 #if PUBNUB_RECEIVE_GZIP_RESPONSE
@@ -30,15 +45,41 @@ void pbcc_init(struct pbcc_context* p, const char* publish_key, const char* subs
 #endif /* PUBNUB_RECEIVE_GZIP_RESPONSE */
 #endif /* PUBNUB_DYNAMIC_REPLY_BUFFER */
     p->message_to_send = NULL;
+    p->message_len     = 0;
+    memset(&p->publish_stats, 0, sizeof p->publish_stats);
+#if PUBNUB_USE_REQUEST_BODY
+    memset(&p->next_body, 0, sizeof p->next_body);
+    memset(&p->chunked, 0, sizeof p->chunked);
+#endif
 
 #if PUBNUB_CRYPTO_API
     p->secret_key = NULL;
 #endif
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+#if PUBNUB_CRYPTO_API
+    p->encrypted_msg_buf = NULL;
+#endif
+#if PUBNUB_USE_GZIP_COMPRESSION
+    p->gzip_msg_buf = NULL;
+    p->gzip_msg_len = 0;
+#endif
+#endif /* PUBNUB_DYNAMIC_SCRATCH_BUFFERS */
 }
 
 
 void pbcc_deinit(struct pbcc_context* p)
 {
+#if PUBNUB_USE_REPLY_INDEX
+    free(p->msg_index.item);
+    free(p->chan_index.item);
+    memset(&p->msg_index, 0, sizeof p->msg_index);
+    memset(&p->chan_index, 0, sizeof p->chan_index);
+#endif
+#if PUBNUB_USE_ADVANCED_HISTORY
+    free(p->msg_counts.item);
+    free(p->msg_counts.bucket);
+    memset(&p->msg_counts, 0, sizeof p->msg_counts);
+#endif
 #if PUBNUB_DYNAMIC_REPLY_BUFFER
     if (p->http_reply != NULL) {
         free(p->http_reply);
@@ -125,6 +166,9 @@ void pbcc_set_uuid(struct pbcc_context* pb, const char* uuid)
     else {
         pb->uuid[0] = '\0';
     }
+#if PUBNUB_USE_URL_CACHE
+    pb->url_cache.valid = false;
+#endif
 }
 
 
@@ -137,6 +181,9 @@ char const* pbcc_uuid_get(struct pbcc_context* pb)
 void pbcc_set_auth(struct pbcc_context* pb, const char* auth)
 {
     pb->auth = auth;
+#if PUBNUB_USE_URL_CACHE
+    pb->url_cache.valid = false;
+#endif
 }
 
 
@@ -155,11 +202,58 @@ static int find_string_start(char const* buf, int len)
 }
 
 
-bool pbcc_split_array(char* buf)
+#if PUBNUB_USE_REPLY_INDEX
+void pbcc_reply_index_reset(struct pbcc_context* p)
 {
-    bool escaped       = false;
-    bool in_string     = false;
-    int  bracket_level = 0;
+    p->msg_index.count  = 0;
+    p->msg_index.valid  = true;
+    p->chan_index.count = 0;
+    p->chan_index.valid = true;
+}
+
+
+/** Adds the string at @p ptr, of @p size characters, at the end of
+    the @p index, growing it if need be.
+ */
+static void index_add(struct pbcc_reply_index* index, char* ptr, size_t size)
+{
+    if (!index->valid) {
+        return;
+    }
+    if (index->count == index->capacity) {
+        unsigned          capacity = index->capacity ? 2 * index->capacity : 16;
+        pubnub_chamebl_t* item =
+            (pubnub_chamebl_t*)realloc(index->item, capacity * sizeof *item);
+        if (NULL == item) {
+            PUBNUB_LOG_ERROR("Failed to grow the reply index to %u strings\n",
+                             capacity);
+            index->valid = false;
+            return;
+        }
+        index->item     = item;
+        index->capacity = capacity;
+    }
+    index->item[index->count].ptr  = ptr;
+    index->item[index->count].size = size;
+    ++index->count;
+}
+#endif /* PUBNUB_USE_REPLY_INDEX */
+
+
+/** Does the work of pbcc_split_array(), putting the strings in the
+    @p index, if it's not NULL.
+ */
+static bool split_array(char* buf, struct pbcc_reply_index* index)
+{
+    bool  escaped       = false;
+    bool  in_string     = false;
+    int   bracket_level = 0;
+#if PUBNUB_USE_REPLY_INDEX
+    char* start = buf;
+    bool  split = false;
+#else
+    PUBNUB_UNUSED(index);
+#endif
 
     for (; *buf != '\0'; ++buf) {
         if (escaped) {
@@ -185,6 +279,13 @@ bool pbcc_split_array(char* buf)
             case ',':
                 if (bracket_level == 0) {
                     *buf = '\0';
+#if PUBNUB_USE_REPLY_INDEX
+                    if (index != NULL) {
+                        index_add(index, start, buf - start);
+                        start = buf + 1;
+                        split = true;
+                    }
+#endif
                 }
                 break;
             default:
@@ -192,11 +293,34 @@ bool pbcc_split_array(char* buf)
             }
         }
     }
+#if PUBNUB_USE_REPLY_INDEX
+    /* The last one - unless the array is empty */
+    if ((index != NULL) && ((buf > start) || split)) {
+        index_add(index, start, buf - start);
+    }
+#endif
 
     return !(escaped || in_string || (bracket_level > 0));
 }
 
 
+bool pbcc_split_array(char* buf)
+{
+    return split_array(buf, NULL);
+}
+
+
+bool pbcc_split_messages(struct pbcc_context* p, char* buf)
+{
+#if PUBNUB_USE_REPLY_INDEX
+    return split_array(buf, &p->msg_index);
+#else
+    PUBNUB_UNUSED(p);
+    return split_array(buf, NULL);
+#endif
+}
+
+
 enum pubnub_res pbcc_parse_publish_response(struct pbcc_context* p)
 {
     char* reply    = p->http_reply;
@@ -260,13 +384,23 @@ enum pubnub_res pbcc_parse_subscribe_response(struct pbcc_context* p)
        or a channel list. */
     if (reply[i - 2] == '"') {
         int k;
+        int chan_start = i + 1;
         /* It is a channel list, there is another string argument in front
          * of us. Process the channel list ... */
-        for (k = replylen - 2; k > i + 1; --k) {
+        for (k = i + 2; k < replylen - 2; ++k) {
             if (reply[k] == ',') {
                 reply[k] = '\0';
+#if PUBNUB_USE_REPLY_INDEX
+                index_add(&p->chan_index, reply + chan_start, k - chan_start);
+#endif
+                chan_start = k + 1;
             }
         }
+#if PUBNUB_USE_REPLY_INDEX
+        index_add(&p->chan_index, reply + chan_start, k - chan_start);
+#else
+        PUBNUB_UNUSED(chan_start);
+#endif
 
         /* The previous argument is either a timetoken or a channel group
            list. */
@@ -320,7 +454,7 @@ enum pubnub_res pbcc_parse_subscribe_response(struct pbcc_context* p)
     p->msg_ofs = 2;
     p->msg_end = i - 2;
 
-    return pbcc_split_array(reply + p->msg_ofs) ? PNR_OK : PNR_FORMAT_ERROR;
+    return pbcc_split_messages(p, reply + p->msg_ofs) ? PNR_OK : PNR_FORMAT_ERROR;
 }
 
 
@@ -347,6 +481,54 @@ enum pubnub_res pbcc_append_url_param(struct pbcc_context* pb,
 }
 
 
+enum pubnub_res pbcc_append_message_body(struct pbcc_context* pb, char const* message)
+{
+    size_t len;
+
+    pb->http_buf[pb->http_buf_len] = '\0';
+#if PUBNUB_USE_REQUEST_BODY
+    pb->chunked.producer = NULL;
+    if ((pb->next_body.ptr != NULL) || (pb->next_body.producer != NULL)) {
+#if PUBNUB_USE_GZIP_COMPRESSION
+        pb->gzip_msg_len = 0;
+#endif
+        pb->message_to_send = (char const*)pb->next_body.ptr;
+        pb->message_len     = pb->next_body.len;
+        if (pb->next_body.producer != NULL) {
+            memset(&pb->chunked, 0, sizeof pb->chunked);
+            pb->chunked.producer      = pb->next_body.producer;
+            pb->chunked.producer_data = pb->next_body.producer_data;
+        }
+        memset(&pb->next_body, 0, sizeof pb->next_body);
+        return PNR_OK;
+    }
+#endif
+#if PUBNUB_USE_GZIP_COMPRESSION
+    if (pb->gzip_msg_len != 0) {
+        pb->message_to_send = message;
+        pb->message_len     = pb->gzip_msg_len;
+        return PNR_OK;
+    }
+#endif
+    len = pb_strnlen_s(message, PUBNUB_MAX_OBJECT_LENGTH);
+    if ((len >= PUBNUB_MAX_OBJECT_LENGTH)
+        || (len > sizeof pb->http_buf - pb->http_buf_len - 2)) {
+        PUBNUB_LOG_ERROR("Error: Request buffer too small - cannot pack the message body:\n"
+                         "current_buffer_size = %lu\n"
+                         "required_buffer_size = %lu\n",
+                         (unsigned long)(sizeof pb->http_buf),
+                         (unsigned long)(pb->http_buf_len + 2 + len));
+        return PNR_TX_BUFF_TOO_SMALL;
+    }
+    pb->message_to_send = pb->http_buf + pb->http_buf_len + 1;
+    memcpy(pb->http_buf + pb->http_buf_len + 1, message, len);
+    pb->http_buf[pb->http_buf_len + 1 + len] = '\0';
+    pb->message_len                          = len;
+
+    return PNR_OK;
+}
+
+
 void pbcc_via_post_headers(struct pbcc_context* pb,
                            char*                header,
                            size_t               max_length)
@@ -355,9 +537,17 @@ void pbcc_via_post_headers(struct pbcc_context* pb,
     unsigned length;
 
     PUBNUB_ASSERT_OPT(pb != NULL);
-    PUBNUB_ASSERT_OPT(pb->message_to_send != NULL);
     PUBNUB_ASSERT_OPT(header != NULL);
     PUBNUB_ASSERT_OPT(max_length > sizeof lines);
+#if PUBNUB_USE_REQUEST_BODY
+    if (pb->chunked.producer != NULL) {
+        char const chunked[] = "Content-Type: application/json\r\nTransfer-Encoding: chunked";
+        PUBNUB_ASSERT_OPT(max_length > sizeof chunked);
+        memcpy(header, chunked, sizeof chunked);
+        return;
+    }
+#endif
+    PUBNUB_ASSERT_OPT(pb->message_to_send != NULL);
     memcpy(header, lines, sizeof lines - 1);
     header += sizeof lines - 1;
     max_length -= sizeof lines - 1;
@@ -370,10 +560,7 @@ void pbcc_via_post_headers(struct pbcc_context* pb,
         return;
     }
 #endif
-    length = snprintf(header,
-                      max_length,
-                      "%lu",
-                      (unsigned long)pb_strnlen_s(pb->message_to_send, PUBNUB_MAX_OBJECT_LENGTH));
+    length = snprintf(header, max_length, "%lu", (unsigned long)pb->message_len);
     PUBNUB_ASSERT_OPT(max_length > length);
 }
 
@@ -413,6 +600,159 @@ enum pubnub_res pbcc_append_url_param_encoded(struct pbcc_context* pb,
 }
 
 
+/** Appends @p len characters of @p s to the URL in the HTTP buffer
+    of @p pb, as they are.
+ */
+static enum pubnub_res append_url_fragment(struct pbcc_context* pb,
+                                           char const*          s,
+                                           size_t               len)
+{
+    if (pb->http_buf_len + len + 1 > sizeof pb->http_buf) {
+        return PNR_TX_BUFF_TOO_SMALL;
+    }
+    memcpy(pb->http_buf + pb->http_buf_len, s, len);
+    pb->http_buf_len += len;
+    pb->http_buf[pb->http_buf_len] = '\0';
+
+    return PNR_OK;
+}
+
+
+#if PUBNUB_USE_URL_CACHE
+/** Returns the URL cache of @p pb, building it first if it is not
+    valid. Returns NULL if the cache can't be used.
+ */
+static struct pbcc_url_cache const* url_cache_get(struct pbcc_context* pb)
+{
+    struct pbcc_url_cache* cache = &pb->url_cache;
+
+    if (!cache->valid) {
+        char const* auth = pb->auth;
+        int         keys;
+        int         pnsdk;
+        int         identity;
+
+        cache->valid = true;
+        cache->fits  = false;
+        if ((NULL == pb->publish_key) || (NULL == pb->subscribe_key)) {
+            return NULL;
+        }
+        keys = snprintf(
+            cache->buf, sizeof cache->buf, "%s/%s", pb->publish_key, pb->subscribe_key);
+        if ((keys < 0) || ((size_t)keys >= sizeof cache->buf)) {
+            return NULL;
+        }
+        pnsdk = snprintf(
+            cache->buf + keys, sizeof cache->buf - keys, "pnsdk=%s", pubnub_uname());
+        if ((pnsdk < 0) || ((size_t)(keys + pnsdk) >= sizeof cache->buf)) {
+            return NULL;
+        }
+        identity = snprintf(cache->buf + keys + pnsdk,
+                            sizeof cache->buf - keys - pnsdk,
+                            "&uuid=%s%s%s",
+                            pb->uuid,
+                            (NULL == auth) ? "" : "&auth=",
+                            (NULL == auth) ? "" : auth);
+        if ((identity < 0) || ((size_t)(keys + pnsdk + identity) >= sizeof cache->buf)) {
+            return NULL;
+        }
+        cache->pub_len      = strlen(pb->publish_key);
+        cache->keys_len     = keys;
+        cache->pnsdk_len    = pnsdk;
+        cache->identity_len = identity;
+        cache->fits         = true;
+    }
+
+    return cache->fits ? cache : NULL;
+}
+#endif /* PUBNUB_USE_URL_CACHE */
+
+
+enum pubnub_res pbcc_start_url_with_keys(struct pbcc_context* pb,
+                                         char const*          prefix,
+                                         size_t               prefix_len,
+                                         bool                 publish)
+{
+    int n;
+#if PUBNUB_USE_URL_CACHE
+    struct pbcc_url_cache const* cache = url_cache_get(pb);
+
+    if (cache != NULL) {
+        size_t const skip = publish ? 0 : cache->pub_len + 1;
+        if (prefix_len + cache->keys_len - skip + 1 > sizeof pb->http_buf) {
+            pb->http_buf_len = 0;
+            return PNR_TX_BUFF_TOO_SMALL;
+        }
+        memcpy(pb->http_buf, prefix, prefix_len);
+        pb->http_buf_len = prefix_len;
+        return append_url_fragment(pb, cache->buf + skip, cache->keys_len - skip);
+    }
+#else
+    (void)prefix_len;
+#endif
+    if (publish) {
+        n = snprintf(pb->http_buf,
+                     sizeof pb->http_buf,
+                     "%s%s/%s",
+                     prefix,
+                     pb->publish_key,
+                     pb->subscribe_key);
+    }
+    else {
+        n = snprintf(pb->http_buf, sizeof pb->http_buf, "%s%s", prefix, pb->subscribe_key);
+    }
+    if ((n < 0) || ((size_t)n >= sizeof pb->http_buf)) {
+        pb->http_buf_len = 0;
+        return PNR_TX_BUFF_TOO_SMALL;
+    }
+    pb->http_buf_len = n;
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pbcc_append_url_pnsdk(struct pbcc_context* pb, char separator)
+{
+#if PUBNUB_USE_URL_CACHE
+    struct pbcc_url_cache const* cache = url_cache_get(pb);
+
+    if (cache != NULL) {
+        if (pb->http_buf_len + 1 + cache->pnsdk_len + 1 > sizeof pb->http_buf) {
+            return PNR_TX_BUFF_TOO_SMALL;
+        }
+        pb->http_buf[pb->http_buf_len++] = separator;
+        return append_url_fragment(pb, cache->buf + cache->keys_len, cache->pnsdk_len);
+    }
+#endif
+    return pbcc_append_url_param(pb, "pnsdk", sizeof "pnsdk" - 1, pubnub_uname(), separator);
+}
+
+
+enum pubnub_res pbcc_append_url_identity(struct pbcc_context* pb, bool empty_uuid)
+{
+    enum pubnub_res rslt = PNR_OK;
+#if PUBNUB_USE_URL_CACHE
+    struct pbcc_url_cache const* cache = url_cache_get(pb);
+
+    if (cache != NULL) {
+        size_t const skip =
+            (empty_uuid || (pb->uuid[0] != '\0')) ? 0 : sizeof "&uuid=" - 1;
+        return append_url_fragment(pb,
+                                   cache->buf + cache->keys_len + cache->pnsdk_len + skip,
+                                   cache->identity_len - skip);
+    }
+#endif
+    if (empty_uuid || (pb->uuid[0] != '\0')) {
+        rslt = pbcc_append_url_param(pb, "uuid", sizeof "uuid" - 1, pb->uuid, '&');
+    }
+    if ((PNR_OK == rslt) && (pb->auth != NULL)) {
+        rslt = pbcc_append_url_param(pb, "auth", sizeof "auth" - 1, pb->auth, '&');
+    }
+
+    return rslt;
+}
+
+
 enum pubnub_res pbcc_publish_prep(struct pbcc_context* pb,
                                   const char*          channel,
                                   const char*          message,
@@ -421,27 +761,26 @@ enum pubnub_res pbcc_publish_prep(struct pbcc_context* pb,
                                   char const*          meta,
                                   enum pubnub_method   method)
 {
-    char const* const uname = pubnub_uname();
-    char const*       uuid  = pbcc_uuid_get(pb);
-    enum pubnub_res   rslt  = PNR_OK;
+    enum pubnub_res rslt;
 
     PUBNUB_ASSERT_OPT(message != NULL);
 
     pb->http_content_len = 0;
-    pb->http_buf_len     = snprintf(pb->http_buf,
-                                sizeof pb->http_buf,
-                                "/publish/%s/%s/0/",
-                                pb->publish_key,
-                                pb->subscribe_key);
+    rslt = pbcc_start_url_with_keys(pb, "/publish/", sizeof "/publish/" - 1, true);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    APPEND_URL_LITERAL_M(pb, "/0/");
     APPEND_URL_ENCODED_M(pb, channel);
     APPEND_URL_LITERAL_M(pb, "/0");
     if (pubnubSendViaGET == method) {
         pb->http_buf[pb->http_buf_len++] = '/';
         APPEND_URL_ENCODED_M(pb, message);
     }
-    APPEND_URL_PARAM_M(pb, "pnsdk", uname, '?');
-    APPEND_URL_PARAM_M(pb, "uuid", uuid, '&');
-    APPEND_URL_PARAM_M(pb, "auth", pb->auth, '&');
+    rslt = pbcc_append_url_pnsdk(pb, '?');
+    if (PNR_OK == rslt) {
+        rslt = pbcc_append_url_identity(pb, false);
+    }
     if ((PNR_OK == rslt) && !store_in_history) {
         rslt = pbcc_append_url_param(pb, "store", sizeof "store" - 1, "0", '&');
     }
@@ -459,11 +798,28 @@ enum pubnub_res pbcc_publish_prep(struct pbcc_context* pb,
         pb->http_buf[pb->http_buf_len++] = '=';
         rslt                             = pbcc_url_encode(pb, meta);
     }
-    if ((PNR_OK == rslt) && (method != pubnubSendViaGET)) {
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    if (pubnubSendViaGET == method) {
+        ++pb->publish_stats.via_get;
+        pb->publish_stats.get_bytes += pb->http_buf_len;
+    }
+    else {
         APPEND_MESSAGE_BODY_M(pb, message);
+#if PUBNUB_USE_GZIP_COMPRESSION
+        if (pb->gzip_msg_len != 0) {
+            ++pb->publish_stats.via_gzip;
+        }
+        else
+#endif
+        {
+            ++pb->publish_stats.via_post;
+        }
+        pb->publish_stats.post_bytes += pb->http_buf_len + pb->message_len;
     }
 
-    return (rslt != PNR_OK) ? rslt : PNR_STARTED;
+    return PNR_STARTED;
 }
 
 
@@ -471,25 +827,25 @@ enum pubnub_res pbcc_signal_prep(struct pbcc_context* pb,
                                  const char* channel,
                                  const char* message)
 {
-    char const* const uname = pubnub_uname();
-    char const*       uuid = pbcc_uuid_get(pb);
+    enum pubnub_res rslt;
 
     PUBNUB_ASSERT_OPT(message != NULL);
 
     pb->http_content_len = 0;
-    pb->http_buf_len = snprintf(pb->http_buf,
-                                sizeof pb->http_buf,
-                                "/signal/%s/%s/0/",
-                                pb->publish_key,
-                                pb->subscribe_key);
+    rslt = pbcc_start_url_with_keys(pb, "/signal/", sizeof "/signal/" - 1, true);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    APPEND_URL_LITERAL_M(pb, "/0/");
     APPEND_URL_ENCODED_M(pb, channel);
     APPEND_URL_LITERAL_M(pb, "/0/");
     APPEND_URL_ENCODED_M(pb, message);
-    APPEND_URL_PARAM_M(pb, "pnsdk", uname, '?');
-    APPEND_URL_PARAM_M(pb, "uuid", uuid, '&');
-    APPEND_URL_PARAM_M(pb, "auth", pb->auth, '&');
-        
-    return PNR_STARTED;
+    rslt = pbcc_append_url_pnsdk(pb, '?');
+    if (PNR_OK == rslt) {
+        rslt = pbcc_append_url_identity(pb, false);
+    }
+
+    return (rslt != PNR_OK) ? rslt : PNR_STARTED;
 }
 
 
@@ -498,7 +854,7 @@ enum pubnub_res pbcc_subscribe_prep(struct pbcc_context* p,
                                     char const*          channel_group,
                                     unsigned*            heartbeat)
 {
-    char const* uuid = pbcc_uuid_get(p);
+    enum pubnub_res rslt;
 
     if (NULL == channel) {
         if (NULL == channel_group) {
@@ -513,17 +869,25 @@ enum pubnub_res pbcc_subscribe_prep(struct pbcc_context* p,
     p->http_content_len = 0;
     p->msg_ofs = p->msg_end = 0;
 
-    p->http_buf_len = snprintf(
-        p->http_buf, sizeof p->http_buf, "/subscribe/%s/", p->subscribe_key);
+    rslt = pbcc_start_url_with_keys(p, "/subscribe/", sizeof "/subscribe/" - 1, false);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    APPEND_URL_LITERAL_M(p, "/");
     APPEND_URL_ENCODED_M(p, channel);
-    p->http_buf_len += snprintf(p->http_buf + p->http_buf_len,
-                                sizeof p->http_buf - p->http_buf_len,
-                                "/0/%s?pnsdk=%s",
-                                p->timetoken,
-                                pubnub_uname());
+    APPEND_URL_LITERAL_M(p, "/0/");
+    rslt = append_url_fragment(p, p->timetoken, strlen(p->timetoken));
+    if (PNR_OK == rslt) {
+        rslt = pbcc_append_url_pnsdk(p, '?');
+    }
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
     APPEND_URL_PARAM_M(p, "channel-group", channel_group, '&');
-    APPEND_URL_PARAM_M(p, "uuid", uuid, '&');
-    APPEND_URL_PARAM_M(p, "auth", p->auth, '&');
+    rslt = pbcc_append_url_identity(p, false);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
     APPEND_URL_OPT_PARAM_UNSIGNED_M(p, "heartbeat", heartbeat, '&');
 
     return PNR_STARTED;
@@ -5,6 +5,12 @@
 #include "pubnub_config.h"
 #include "pubnub_api_types.h"
 #include "pubnub_generate_uuid.h"
+#if PUBNUB_USE_REPLY_INDEX || PUBNUB_USE_ADVANCED_HISTORY
+#include "pubnub_memory_block.h"
+#endif
+#if PUBNUB_USE_REQUEST_BODY
+#include "pubnub_request_body.h"
+#endif
 
 #include <stdbool.h>
 #include <stdlib.h>
@@ -18,6 +24,136 @@
 */
 
 
+#if PUBNUB_USE_REPLY_INDEX
+/** An index of the strings (messages or channels) in a reply: the
+    pointer to and the length of each, in the order they are in the
+    reply. Filled while parsing the reply.
+ */
+struct pbcc_reply_index {
+    /** The strings. Allocated as needed and kept for the next
+        replies. */
+    pubnub_chamebl_t* item;
+    /** Number of strings in the index */
+    unsigned count;
+    /** Number of strings there is room for in `item` */
+    unsigned capacity;
+    /** If false, we failed to allocate the index, so it is not valid */
+    bool valid;
+};
+#else
+struct pbcc_reply_index;
+#endif /* PUBNUB_USE_REPLY_INDEX */
+
+
+#if PUBNUB_USE_ADVANCED_HISTORY
+/** A channel and its message count in a 'message_counts' reply */
+struct pbcc_msg_count_item {
+    /** The channel name, in the reply */
+    pubnub_chamebl_t channel;
+    size_t           message_count;
+    /** Hash of the channel name */
+    unsigned hash;
+    /** Index of the next item in the same bucket of the hash table,
+        -1 if none */
+    int next;
+};
+
+/** The channels and message counts of a 'message_counts' reply,
+    parsed once, with a hash table of the channels, for lookup by
+    name. The arrays are allocated as needed and kept for the next
+    replies.
+ */
+struct pbcc_msg_counts {
+    /** The channels, in the order they are in the reply */
+    struct pbcc_msg_count_item* item;
+    /** Number of channels in the reply */
+    unsigned count;
+    /** Number of channels there is room for in `item` */
+    unsigned capacity;
+    /** Heads of the buckets of the hash table: indexes in `item`, -1
+        for an empty bucket */
+    int* bucket;
+    /** Number of buckets, a power of 2 */
+    unsigned bucket_count;
+    /** If false, we failed to allocate the arrays, so the counts are
+        read from the reply itself */
+    bool valid;
+    /** Offset of the start of the 'channels' object of the reply */
+    size_t ofs;
+    /** Offset of the end of the 'channels' object of the reply */
+    size_t end;
+};
+#endif /* PUBNUB_USE_ADVANCED_HISTORY */
+
+
+#if PUBNUB_USE_URL_CACHE
+#if !defined PUBNUB_URL_CACHE_MAXLEN
+/** Size of the buffer of the URL cache of a context. If the static
+    URL fragments don't fit, the cache is not used.
+*/
+#define PUBNUB_URL_CACHE_MAXLEN 256
+#endif
+
+/** The static fragments of the request URLs of a context, ready to
+    be copied to the HTTP buffer: the keys, the `pnsdk` and the
+    identity (`uuid` and `auth`) parameters. Built when first needed
+    and invalidated when the keys, UUID or `auth` are set.
+
+    The fragments are, one after the other, in `buf`:
+    `<publish_key>/<subscribe_key>`, `pnsdk=<uname>` and
+    `&uuid=<uuid>[&auth=<auth>]`.
+ */
+struct pbcc_url_cache {
+    char buf[PUBNUB_URL_CACHE_MAXLEN];
+    /** Length of the publish key, the subscribe key starts after it
+        (and a slash) */
+    size_t pub_len;
+    /** Length of the keys fragment */
+    size_t keys_len;
+    /** Length of the `pnsdk` fragment */
+    size_t pnsdk_len;
+    /** Length of the identity fragment */
+    size_t identity_len;
+    /** If false, the fragments have to be built (again) */
+    bool valid;
+    /** If false, the fragments don't fit in `buf` (or there are no
+        keys), so they are not used */
+    bool fits;
+};
+#endif /* PUBNUB_USE_URL_CACHE */
+
+
+#if PUBNUB_USE_REQUEST_BODY
+/** The body of a request given by the user: either a buffer (`ptr`
+    and `len`) or a `producer` of chunks. If both `ptr` and `producer`
+    are NULL, there is no such body.
+ */
+struct pbcc_request_body {
+    void const*            ptr;
+    size_t                 len;
+    pubnub_body_producer_t producer;
+    void*                  producer_data;
+};
+
+/** The state of sending a body in chunks */
+struct pbcc_chunked_body {
+    /** The producer of the chunks, NULL if the body being sent is not
+        chunked */
+    pubnub_body_producer_t producer;
+    void*                  producer_data;
+    /** The chunk to send after its header (which is being sent) */
+    void const* chunk;
+    size_t      chunk_len;
+    /** If true, the producer was called */
+    bool started;
+    /** If true, the last (empty) chunk is being sent */
+    bool finished;
+    /** The chunk header (with the end of the previous chunk) */
+    char header[32];
+};
+#endif /* PUBNUB_USE_REQUEST_BODY */
+
+
 /** The Pubnub "(C) core" context, contains context data
     that is shared among all Pubnub C clients.
  */
@@ -31,8 +167,26 @@ struct pbcc_context {
     /** The `auth` parameter to be sent to server. If NULL, don't send
      * any */
     char const* auth;
+#if PUBNUB_USE_URL_CACHE
+    /** The static URL fragments, built from the keys, `uuid` and
+        `auth`. As those strings are not copied (except for `uuid`),
+        changing their contents without setting them again makes the
+        cache stale. */
+    struct pbcc_url_cache url_cache;
+#endif
     /** Pointer to the message to send via POST method */
     char const* message_to_send;
+    /** The length of the message to send via POST method */
+    size_t message_len;
+    /** Counters of the publish requests prepared */
+    struct pubnub_publish_stats publish_stats;
+#if PUBNUB_USE_REQUEST_BODY
+    /** The body to send, instead of the message, by the next
+        transaction with a body */
+    struct pbcc_request_body next_body;
+    /** The state of sending a chunked body */
+    struct pbcc_chunked_body chunked;
+#endif
 
     /** The last recived subscribe time token. */
     char timetoken[20];
@@ -55,12 +209,20 @@ struct pbcc_context {
 
 #if PUBNUB_CRYPTO_API
     /** Holds encrypted message */
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    char* encrypted_msg_buf;
+#else
     char encrypted_msg_buf[PUBNUB_BUF_MAXLEN];
 #endif
+#endif
 
 #if PUBNUB_USE_GZIP_COMPRESSION
     /** Buffer for compressed message */
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    char* gzip_msg_buf;
+#else
     char gzip_msg_buf[PUBNUB_COMPRESSED_MAXLEN];
+#endif
     
     /** The length of compressed data in 'comp_http_buf' ready to be sent */
     size_t gzip_msg_len;
@@ -104,6 +266,29 @@ struct pbcc_context {
     */
     unsigned chan_ofs, chan_end;
 
+#if PUBNUB_USE_REPLY_INDEX
+    /** Index of the messages in the reply */
+    struct pbcc_reply_index msg_index;
+    /** Index of the channels in the reply */
+    struct pbcc_reply_index chan_index;
+#endif
+
+#if PUBNUB_USE_ADVANCED_HISTORY
+    /** The parsed reply of the last 'message_counts' transaction */
+    struct pbcc_msg_counts msg_counts;
+#endif
+
+#if PUBNUB_USE_OBJECTS_API
+    /** Offset of the next object to yield and the end of the `data`
+        array (its `]`) in the reply of the last Objects API list
+        transaction */
+    unsigned obj_ofs, obj_end;
+    /** Offset and length of the `next` page cursor (without the
+        quotes) in the reply of the last Objects API transaction,
+        length is 0 if there is none */
+    unsigned obj_next_ofs, obj_next_len;
+#endif
+
 #if PUBNUB_CRYPTO_API
     /** Secret key to use for encryption/decryption */
     char const* secret_key;
@@ -191,35 +376,12 @@ struct pbcc_context {
         APPEND_URL_PARAM_M(pbc, name, v_, separator);                          \
     }
 
-#if PUBNUB_USE_GZIP_COMPRESSION
-#define CHECK_IF_GZIP_COMPRESSED(pbc, message)                                 \
-    if ((pbc)->gzip_msg_len != 0) {                                            \
-        (pbc)->message_to_send = (message);                                    \
-    }                                                                          \
-    else {                                                                     \
-        (pbc)->message_to_send = strcpy((pbc)->http_buf + (pbc)->http_buf_len + 1,\
-                                        (message));                            \
-    }
-#else
-#define CHECK_IF_GZIP_COMPRESSED(pbc, message)                                 \
-    (pbc)->message_to_send = strcpy((pbc)->http_buf + (pbc)->http_buf_len + 1, \
-                                    (message))
-#endif /* PUBNUB_USE_GZIP_COMPRESSION */
-
 #define APPEND_MESSAGE_BODY_M(pbc, message)                                    \
     if ((message) != NULL) {                                                   \
-        if (pb_strnlen_s(message, PUBNUB_MAX_OBJECT_LENGTH) >                  \
-            sizeof (pbc)->http_buf - (pbc)->http_buf_len - 2) {                \
-            PUBNUB_LOG_ERROR("Error: Request buffer too small - cannot pack the message body:\n"\
-                             "current_buffer_size = %lu\n"                     \
-                             "required_buffer_size = %lu\n",                   \
-                             (unsigned long)(sizeof (pbc)->http_buf),          \
-                             (unsigned long)((pbc)->http_buf_len + 2 + pb_strnlen_s(message,\
-                                                                                    PUBNUB_MAX_OBJECT_LENGTH)));\
-            return PNR_TX_BUFF_TOO_SMALL;                                      \
+        enum pubnub_res rslt_ = pbcc_append_message_body((pbc), (message));    \
+        if (rslt_ != PNR_OK) {                                                 \
+            return rslt_;                                                      \
         }                                                                      \
-        (pbc)->http_buf[(pbc)->http_buf_len] = '\0';                           \
-        CHECK_IF_GZIP_COMPRESSED((pbc), (message));                            \
     }
 
 
@@ -288,6 +450,16 @@ enum pubnub_res pbcc_parse_subscribe_response(struct pbcc_context* p);
 */
 enum pubnub_res pbcc_parse_publish_response(struct pbcc_context* p);
 
+/** Sets the @p message as the body of the request being prepared in
+    @p pb: copies it to the HTTP buffer, after the URL, unless it is
+    compressed (GZIP) or a body was given by the user (in which case,
+    @p message is ignored).
+
+    @retval PNR_OK body set
+    @retval PNR_TX_BUFF_TOO_SMALL @p message doesn't fit in the buffer
+ */
+enum pubnub_res pbcc_append_message_body(struct pbcc_context* pb, char const* message);
+
 /** Prepares HTTP header lines specific for sending message 'via POST' method.
     @param p The Pubnub C core context with all necessary information
     @param header pointer to char array provided for placing these headers
@@ -327,6 +499,19 @@ enum pubnub_res pbcc_subscribe_prep(struct pbcc_context* p,
  */
 bool pbcc_split_array(char* buf);
 
+/** Like pbcc_split_array(), but the strings in @p buf are the
+    messages of the reply in the context @p p, so, they are also put
+    in its index of messages (if there is one).
+ */
+bool pbcc_split_messages(struct pbcc_context* p, char* buf);
+
+#if PUBNUB_USE_REPLY_INDEX
+/** Empties the indexes of messages and channels of the reply in the
+    context @p p. To be called before parsing a reply.
+ */
+void pbcc_reply_index_reset(struct pbcc_context* p);
+#endif
+
 
 enum pubnub_res pbcc_append_url_param(struct pbcc_context* pb,
                                       char const*          param_name,
@@ -336,6 +521,27 @@ enum pubnub_res pbcc_append_url_param(struct pbcc_context* pb,
 
 enum pubnub_res pbcc_url_encode(struct pbcc_context* pb, char const* what);
 
+/** Starts the URL in the HTTP buffer of @p pb with
+    "<prefix><subscribe_key>" or, if @p publish, with
+    "<prefix><publish_key>/<subscribe_key>". The @p prefix (of @p
+    prefix_len characters) is not URL encoded.
+ */
+enum pubnub_res pbcc_start_url_with_keys(struct pbcc_context* pb,
+                                         char const*          prefix,
+                                         size_t               prefix_len,
+                                         bool                 publish);
+
+/** Appends the `pnsdk` parameter, with the @p separator in front of
+    it, to the URL in the HTTP buffer of @p pb.
+ */
+enum pubnub_res pbcc_append_url_pnsdk(struct pbcc_context* pb, char separator);
+
+/** Appends the `uuid` and `auth` parameters (if set) to the URL in
+    the HTTP buffer of @p pb. If @p empty_uuid, the `uuid` parameter
+    is appended even if it is not set (is empty).
+ */
+enum pubnub_res pbcc_append_url_identity(struct pbcc_context* pb, bool empty_uuid);
+
 enum pubnub_res pbcc_append_url_param_encoded(struct pbcc_context* pb,
                                               char const*          param_name,
                                               size_t      param_name_len,
@@ -9,6 +9,9 @@
 #include "pubnub_memory_block.h"
 #include "pubnub_advanced_history.h"
 #endif
+#if PUBNUB_USE_REPLY_INDEX
+#include "pubnub_reply_index.h"
+#endif
 #include "pubnub_assert.h"
 #include "pubnub_alloc.h"
 #include "pubnub_log.h"
@@ -1606,6 +1609,41 @@ Ensure(single_context_pubnub,
     attest(pubnub_last_http_code(pbp), equals(200));
 }
 
+Ensure(single_context_pubnub,
+       get_chan_msg_count_looks_up_channels_without_using_up_the_response)
+{
+    size_t count;
+    int    o_count[2];
+
+    pubnub_init(pbp, "pub-delta", "sub-echo");
+
+    expect_have_dns_for_pubnub_origin();
+
+    expect_outgoing_with_url("/v3/history/sub-key/sub-echo/message-counts/"
+                             "bravo,alfa?pnsdk=unit-test-0.1&timetoken=15378854953886727");
+    incoming("HTTP/1.1 200\r\nContent-Length: 91\r\n\r\n"
+             "{\"status\":200, \"error\": false, \"error_message\": \"\", \"channels\": {\"alfa\":196 ,  \"bravo\":0 }}",
+             NULL);
+    expect(pbntf_lost_socket, when(pb, equals(pbp)));
+    expect(pbntf_trans_outcome, when(pb, equals(pbp)));
+    attest(pubnub_message_counts(pbp, "bravo,alfa", "15378854953886727"), equals(PNR_OK));
+
+    attest(pubnub_get_chan_msg_count(pbp, "bravo", &count), equals(0));
+    attest(count, equals(0));
+    attest(pubnub_get_chan_msg_count(pbp, "alfa", &count), equals(0));
+    attest(count, equals(196));
+    attest(pubnub_get_chan_msg_count(pbp, "alf", &count), equals(-1));
+    attest(pubnub_get_chan_msg_count(pbp, "charlie", &count), equals(-1));
+    /* Lookup doesn't use up the response */
+    attest(pubnub_get_message_counts(pbp, "alfa,bravo", o_count), equals(0));
+    attest(o_count[0], equals(196));
+    attest(o_count[1], equals(0));
+    attest(pubnub_get_chan_msg_count(pbp, "alfa", &count), equals(0));
+    attest(count, equals(196));
+
+    attest(pubnub_last_http_code(pbp), equals(200));
+}
+
 Ensure(single_context_pubnub,
        handles_an_error_reported_from_server_on_message_counts_request)
 {
@@ -3330,6 +3368,73 @@ Ensure(single_context_pubnub,
     attest(pubnub_last_http_code(pbp), equals(200));
 }
 
+#if PUBNUB_USE_REPLY_INDEX
+Ensure(single_context_pubnub, subscribe_reply_index)
+{
+    pubnub_chamebl_t const* msgs;
+    pubnub_chamebl_t const* chans;
+
+    pubnub_init(pbp, "publ-key", "sub-Key");
+
+    expect_have_dns_for_pubnub_origin();
+    expect_outgoing_with_url("/subscribe/sub-Key/ch1/0/0?pnsdk=unit-test-0.1");
+    incoming("HTTP/1.1 200\r\nContent-Length: "
+             "26\r\n\r\n[[],\"3516149789251234578\"]",
+             NULL);
+    expect(pbntf_lost_socket, when(pb, equals(pbp)));
+    expect(pbntf_trans_outcome, when(pb, equals(pbp)));
+    attest(pubnub_subscribe(pbp, "ch1", NULL), equals(PNR_OK));
+    attest(pubnub_get_messages(pbp, &msgs), equals(0));
+    attest(pubnub_get_channels(pbp, NULL), equals(0));
+
+    expect(pbntf_enqueue_for_processing, when(pb, equals(pbp)), returns(0));
+    expect(pbntf_got_socket, when(pb, equals(pbp)), returns(0));
+    expect_outgoing_with_url("/subscribe/sub-Key/ch1/0/"
+                             "3516149789251234578?pnsdk=unit-test-0.1");
+    incoming("HTTP/1.1 200\r\nContent-Length: "
+             "74\r\n\r\n[[msg1,{\"text\":\"Hello, World!\"},msg3],"
+             "\"352624978925123458\",\"ch5,ch17,ch1\"]",
+             NULL);
+    expect(pbntf_lost_socket, when(pb, equals(pbp)));
+    expect(pbntf_trans_outcome, when(pb, equals(pbp)));
+    attest(pubnub_subscribe(pbp, "ch1", NULL), equals(PNR_OK));
+
+    attest(pubnub_get_messages(pbp, &msgs), equals(3));
+    attest(msgs[0].size, equals(4));
+    attest(msgs[0].ptr, streqs("msg1"));
+    attest(msgs[1].size, equals(sizeof "{\"text\":\"Hello, World!\"}" - 1));
+    attest(msgs[1].ptr, streqs("{\"text\":\"Hello, World!\"}"));
+    attest(msgs[2].size, equals(4));
+    attest(msgs[2].ptr, streqs("msg3"));
+    attest(pubnub_get_channels(pbp, &chans), equals(3));
+    attest(chans[0].size, equals(3));
+    attest(chans[0].ptr, streqs("ch5"));
+    attest(chans[1].size, equals(4));
+    attest(chans[1].ptr, streqs("ch17"));
+    attest(chans[2].size, equals(3));
+    attest(chans[2].ptr, streqs("ch1"));
+
+    /* Reading the messages one by one doesn't change the index */
+    attest(pubnub_get(pbp), streqs("msg1"));
+    attest(pubnub_get_channel(pbp), streqs("ch5"));
+    attest(pubnub_get_messages(pbp, NULL), equals(3));
+    attest(pubnub_get_channels(pbp, NULL), equals(3));
+
+    /* Consuming gives (and reads) the ones not read yet */
+    attest(pubnub_consume_messages(pbp, &msgs), equals(2));
+    attest(msgs[0].ptr, streqs("{\"text\":\"Hello, World!\"}"));
+    attest(msgs[1].size, equals(4));
+    attest(msgs[1].ptr, streqs("msg3"));
+    attest(pubnub_get(pbp), equals(NULL));
+    attest(pubnub_consume_messages(pbp, &msgs), equals(0));
+    attest(pubnub_consume_channels(pbp, &chans), equals(2));
+    attest(chans[0].size, equals(4));
+    attest(chans[0].ptr, streqs("ch17"));
+    attest(pubnub_get_channel(pbp), equals(NULL));
+    attest(pubnub_get_messages(pbp, NULL), equals(3));
+}
+#endif /* PUBNUB_USE_REPLY_INDEX */
+
 Ensure(single_context_pubnub, subscribe_no_channel_and_no_channelgroups)
 {
     pubnub_init(pbp, "publ-something", "sub-something");
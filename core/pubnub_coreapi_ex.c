@@ -1,5 +1,6 @@
 /* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
 #include "pubnub_coreapi_ex.h"
+#include "pbpublish_adaptive.h"
 
 #include "pubnub_ccore.h"
 #include "pubnub_netcore.h"
@@ -7,6 +8,7 @@
 #include "pubnub_assert.h"
 #include "pubnub_timers.h"
 #include "pubnub_crypto.h"
+#include "pubnub_url_encode.h"
 
 #include "pbpal.h"
 
@@ -26,12 +28,132 @@ struct pubnub_publish_options pubnub_publish_defopts(void)
     return result;
 }
 
+/** Chooses the method to send a message of @p len characters, @p
+    url_unsafe of which would be URL encoded, with, for
+    #pubnubSendAdaptive.
+ */
+static enum pubnub_method adaptive_method(size_t len, size_t url_unsafe)
+{
+    if (2 * url_unsafe <= PUBNUB_ADAPTIVE_PUBLISH_POST_OVERHEAD) {
+        return pubnubSendViaGET;
+    }
+#if PUBNUB_USE_GZIP_COMPRESSION
+    if (len >= PUBNUB_ADAPTIVE_PUBLISH_GZIP_MIN) {
+        return pubnubSendViaPOSTwithGZIP;
+    }
+#else
+    PUBNUB_UNUSED(len);
+#endif
+    return pubnubSendViaPOST;
+}
+
+
+/** Returns the length of the @p message and puts the number of its
+    characters which would be URL encoded to @p o_url_unsafe.
+ */
+static size_t scan_message(char const* message, size_t* o_url_unsafe)
+{
+    size_t len        = 0;
+    size_t url_unsafe = 0;
+
+    for (;;) {
+        size_t okspan = strspn(message + len, OK_SPAN_CHARACTERS);
+        len += okspan;
+        if ('\0' == message[len]) {
+            break;
+        }
+        ++len;
+        ++url_unsafe;
+    }
+    *o_url_unsafe = url_unsafe;
+
+    return len;
+}
+
+
+/** Prepares the publish of the @p message of @p len characters via
+    the method in @p opts, from the buffer of the message if @p
+    from_buffer and the build supports it.
+ */
+static enum pubnub_res publish_prep(pubnub_t*                     pb,
+                                    char const*                   channel,
+                                    char const*                   message,
+                                    size_t                        len,
+                                    struct pubnub_publish_options opts,
+                                    bool                          from_buffer)
+{
+#if PUBNUB_USE_REQUEST_BODY
+    if (from_buffer && (pubnubSendViaPOST == opts.method)) {
+        enum pubnub_res rslt;
+
+        pb->core.next_body.ptr           = message;
+        pb->core.next_body.len           = len;
+        pb->core.next_body.producer      = NULL;
+        pb->core.next_body.producer_data = NULL;
+        rslt                             = pbcc_publish_prep(
+            &pb->core, channel, "", opts.store, !opts.replicate, opts.meta, opts.method);
+        if (rslt != PNR_STARTED) {
+            memset(&pb->core.next_body, 0, sizeof pb->core.next_body);
+        }
+        return rslt;
+    }
+#else
+    PUBNUB_UNUSED(len);
+    PUBNUB_UNUSED(from_buffer);
+#endif
+    return pbcc_publish_prep(
+        &pb->core, channel, message, opts.store, !opts.replicate, opts.meta, opts.method);
+}
+
+
+enum pubnub_res pbpublish_start(pubnub_t*                     pb,
+                                char const*                   channel,
+                                char const*                   message,
+                                size_t                        len,
+                                size_t                        url_unsafe,
+                                struct pubnub_publish_options opts,
+                                bool                          from_buffer)
+{
+    enum pubnub_res rslt;
+    bool const      adaptive = (pubnubSendAdaptive == opts.method);
+
+    if (adaptive) {
+        opts.method = adaptive_method(len, url_unsafe);
+    }
+#if PUBNUB_USE_GZIP_COMPRESSION
+    pb->core.gzip_msg_len = 0;
+    if (pubnubSendViaPOSTwithGZIP == opts.method) {
+        if (pbgzip_compress(pb, message) == PNR_OK) {
+            message = pb->core.gzip_msg_buf;
+        }
+    }
+#endif
+    rslt = publish_prep(pb, channel, message, len, opts, from_buffer);
+    if (adaptive && (PNR_TX_BUFF_TOO_SMALL == rslt) && (pubnubSendViaGET == opts.method)) {
+        /* Too long for the URL, but may fit in the body */
+        opts.method = pubnubSendViaPOST;
+        rslt        = publish_prep(pb, channel, message, len, opts, from_buffer);
+    }
+    if (PNR_STARTED == rslt) {
+        pb->trans            = PBTT_PUBLISH;
+        pb->core.last_result = PNR_STARTED;
+        pb->method           = opts.method;
+        pbnc_fsm(pb);
+        rslt = pb->core.last_result;
+    }
+
+    return rslt;
+}
+
+
 enum pubnub_res pubnub_publish_ex(pubnub_t*                     pb,
                                   const char*                   channel,
                                   const char*                   message,
                                   struct pubnub_publish_options opts)
 {
     enum pubnub_res rslt;
+    size_t          len        = 0;
+    size_t          url_unsafe = 0;
 
     PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
     PUBNUB_ASSERT_OPT(message != NULL);
@@ -44,8 +166,16 @@ enum pubnub_res pubnub_publish_ex(pubnub_t*                     pb,
 #if PUBNUB_CRYPTO_API
     if (NULL != opts.cipher_key) {
         pubnub_bymebl_t to_encrypt;
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+        char* encrypted_msg = pbscratch_ensure(&pb->core.encrypted_msg_buf);
+#else
         char* encrypted_msg = pb->core.encrypted_msg_buf;
-        size_t          n  = sizeof pb->core.encrypted_msg_buf - sizeof("\"\"");
+#endif
+        size_t          n  = PUBNUB_BUF_MAXLEN - sizeof("\"\"");
+
+        if (NULL == encrypted_msg) {
+            return PNR_INTERNAL_ERROR;
+        }
 
         to_encrypt.ptr   = (uint8_t*)message;
         to_encrypt.size  = strlen(message);
@@ -58,29 +188,37 @@ enum pubnub_res pubnub_publish_ex(pubnub_t*                     pb,
         message            = encrypted_msg;
     }
 #endif
-#if PUBNUB_USE_GZIP_COMPRESSION
-    pb->core.gzip_msg_len = 0;
-    if (pubnubSendViaPOSTwithGZIP == opts.method) {
-        if (pbgzip_compress(pb, message) == PNR_OK) {
-            message = pb->core.gzip_msg_buf;
-        }
-    }
-#endif
-    rslt = pbcc_publish_prep(
-        &pb->core, channel, message, opts.store, !opts.replicate, opts.meta, opts.method);
-    if (PNR_STARTED == rslt) {
-        pb->trans            = PBTT_PUBLISH;
-        pb->core.last_result = PNR_STARTED;
-        pb->method           = opts.method;
-        pbnc_fsm(pb);
-        rslt = pb->core.last_result;
+    if (pubnubSendAdaptive == opts.method) {
+        len = scan_message(message, &url_unsafe);
     }
+    rslt = pbpublish_start(pb, channel, message, len, url_unsafe, opts, false);
     pubnub_mutex_unlock(pb->monitor);
 
     return rslt;
 }
 
 
+void pubnub_get_publish_stats(pubnub_t* pb, struct pubnub_publish_stats* o_stats)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(o_stats != NULL);
+
+    pubnub_mutex_lock(pb->monitor);
+    *o_stats = pb->core.publish_stats;
+    pubnub_mutex_unlock(pb->monitor);
+}
+
+
+void pubnub_reset_publish_stats(pubnub_t* pb)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    memset(&pb->core.publish_stats, 0, sizeof pb->core.publish_stats);
+    pubnub_mutex_unlock(pb->monitor);
+}
+
+
 /** Minimal presence heartbeat interval supported by
     Pubnub, in seconds.
 */
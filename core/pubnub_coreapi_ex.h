@@ -29,6 +29,24 @@
 */
 
 
+#if !defined PUBNUB_ADAPTIVE_PUBLISH_POST_OVERHEAD
+/** With #pubnubSendAdaptive, the message is sent via GET if URL
+    encoding adds at most this many bytes to it - about the size of
+    the `Content-Type` and `Content-Length` headers of a POST.
+ */
+#define PUBNUB_ADAPTIVE_PUBLISH_POST_OVERHEAD 48
+#endif
+
+#if !defined PUBNUB_ADAPTIVE_PUBLISH_GZIP_MIN
+/** With #pubnubSendAdaptive, messages sent via POST are compressed
+    (if the GZIP compression is available) if they are at least this
+    long. For shorter ones, the GZIP header and trailer and the CPU
+    time are not worth it.
+ */
+#define PUBNUB_ADAPTIVE_PUBLISH_GZIP_MIN 1024
+#endif
+
+
 /** Options for "extended" publish V1. */
 struct pubnub_publish_options {
     /** If true, the message is stored in history. If false,
@@ -57,7 +75,12 @@ struct pubnub_publish_options {
         about the message, which can be used for stream filtering.
      */
     char const* meta;
-    /** Defines the method by which publish transaction will be performed */
+    /** Defines the method by which publish transaction will be
+        performed. With #pubnubSendAdaptive, it is chosen for each
+        message: GET if URL encoding does not make it (much) longer
+        than a POST would be, otherwise POST - with GZIP, if the
+        message is long enough to be worth compressing.
+     */
     enum pubnub_method method; 
 };
 
@@ -87,6 +110,16 @@ enum pubnub_res pubnub_publish_ex(pubnub_t*                     p,
                                   const char*                   message,
                                   struct pubnub_publish_options opts);
 
+/** Gets the counters of the publish requests of the context @p p
+    (made with any publish function, including the publish pipeline)
+    to @p o_stats. Useful to see which methods #pubnubSendAdaptive
+    chooses for your messages and how many bytes they take.
+ */
+void pubnub_get_publish_stats(pubnub_t* p, struct pubnub_publish_stats* o_stats);
+
+/** Resets the counters of the publish requests of the context @p p */
+void pubnub_reset_publish_stats(pubnub_t* p);
+
 
 /** Options for "extended" subscribe. */
 struct pubnub_subscribe_options {
@@ -0,0 +1,655 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_SYNC_POLL
+
+#include "pubnub_fanout.h"
+
+#include "pubnub_pubsubapi.h"
+#include "pubnub_coreapi.h"
+#include "pubnub_ntf_sync.h"
+#include "pubnub_blocking_io.h"
+#include "pubnub_alloc.h"
+#include "pubnub_free_with_timeout.h"
+#include "pubnub_json_parse.h"
+#include "pubnub_url_encode.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+#if PUBNUB_USE_ADVANCED_HISTORY
+#include "pubnub_advanced_history.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Least number of buckets of the hash table of the channels of a
+    request. Must be a power of 2. */
+#define FANOUT_MIN_BUCKETS 64
+
+
+/** The operation the fan-out is doing */
+enum fanout_op {
+    fanoutMessageCounts,
+    fanoutHereNow
+};
+
+/** A channel in the list of a request of the fan-out */
+struct fanout_name {
+    /** The channel name, in the user's list */
+    char const* name;
+    size_t      len;
+    /** Length of the name in the URL (URL encoded) */
+    size_t encoded_len;
+    /** The timetoken of this channel, in the user's list, if there is
+        a timetoken per channel */
+    char const* tt;
+    size_t      tt_len;
+    /** Hash of the name */
+    unsigned hash;
+    /** Index of the next name in the same bucket of the hash table,
+        -1 if none */
+    int next;
+};
+
+/** A context of the fan-out pool */
+struct fanout_slot {
+    /** The context itself */
+    pubnub_t* pb;
+    /** Buffer for the comma-separated list of channels of the batch */
+    char* channels;
+    /** Buffer for the comma-separated list of timetokens of the batch */
+    char* timetokens;
+    /** Capacity of the #channels and #timetokens buffers */
+    size_t cap;
+    /** Index (in the list) of the first channel of the batch */
+    unsigned first;
+    /** Number of channels in the batch, 0 if the context is idle */
+    unsigned count;
+};
+
+/** Fan-out descriptor */
+struct pubnub_fanout {
+    /** The contexts of the pool */
+    struct fanout_slot* slots;
+    /** The contexts of the pool, for pubnub_free_all_with_timeout() */
+    pubnub_t** pbs;
+    unsigned   size;
+    /** Maximum length of the channels (and timetokens) in the URL of
+        one batch */
+    size_t url_budget;
+    /** The channels of the current request, kept for the next one */
+    struct fanout_name* names;
+    unsigned            name_count;
+    unsigned            name_cap;
+    /** The hash table of the channels of the current request */
+    int*     buckets;
+    unsigned bucket_count;
+    /** The request being done */
+    enum fanout_op op;
+    /** The timetoken of all the channels, NULL if there is one per
+        channel */
+    char const* timetoken;
+    /** The merged results */
+    int* o_value;
+    int  total;
+};
+
+
+static int add_name(pubnub_fanout_t* fo, char const* name, size_t len)
+{
+    struct fanout_name* entry;
+
+    if (fo->name_count == fo->name_cap) {
+        unsigned new_cap = (0 == fo->name_cap) ? FANOUT_MIN_BUCKETS : 2 * fo->name_cap;
+        entry = (struct fanout_name*)realloc(fo->names, new_cap * sizeof *entry);
+        if (NULL == entry) {
+            return -1;
+        }
+        fo->names    = entry;
+        fo->name_cap = new_cap;
+    }
+    entry              = &fo->names[fo->name_count++];
+    entry->name        = name;
+    entry->len         = len;
+    entry->encoded_len = pubnub_url_encoded_len(name, len);
+    entry->tt          = NULL;
+    entry->tt_len      = 0;
+    entry->hash        = pbhash_fnv1a(PBHASH_FNV1A_INIT, name, len);
+
+    return 0;
+}
+
+
+/** Splits the @p channel list (and the @p timetoken list, if there is
+    one) of a request to the names of @p fo. Leading spaces of names
+    are skipped and a name ends at a space, like in
+    pubnub_get_message_counts().
+ */
+static enum pubnub_res split_list(pubnub_fanout_t* fo, char const* channel, char const* timetoken)
+{
+    char const* name = channel;
+    unsigned    i;
+
+    fo->name_count = 0;
+    for (;;) {
+        char const* name_end;
+        while (' ' == *name) {
+            ++name;
+        }
+        for (name_end = name; (*name_end != ',') && (*name_end != ' ') && (*name_end != '\0');
+             ++name_end) {
+            continue;
+        }
+        if (name_end == name) {
+            PUBNUB_LOG_ERROR("Fan-out %p: empty channel name in the list\n", fo);
+            return PNR_INVALID_PARAMETERS;
+        }
+        if (add_name(fo, name, name_end - name) != 0) {
+            PUBNUB_LOG_ERROR("Fan-out %p: failed to allocate the channel list\n", fo);
+            return PNR_INTERNAL_ERROR;
+        }
+        if (fo->names[fo->name_count - 1].encoded_len + 1 > fo->url_budget) {
+            PUBNUB_LOG_ERROR("Fan-out %p: channel '%.*s' doesn't fit in the URL\n",
+                             fo,
+                             (int)(name_end - name),
+                             name);
+            return PNR_TX_BUFF_TOO_SMALL;
+        }
+        name = strchr(name_end, ',');
+        if (NULL == name) {
+            break;
+        }
+        ++name;
+    }
+
+    fo->timetoken = timetoken;
+    if ((timetoken != NULL) && (strchr(timetoken, ',') != NULL)) {
+        char const* tt = timetoken;
+        for (i = 0; i < fo->name_count; ++i) {
+            char const* tt_end = strchr(tt, ',');
+            bool        last   = (i + 1 == fo->name_count);
+            if ((NULL == tt_end) != last) {
+                PUBNUB_LOG_ERROR("Fan-out %p: number of channels and "
+                                 "timetokens don't match\n",
+                                 fo);
+                return PNR_INVALID_PARAMETERS;
+            }
+            if (last) {
+                tt_end = tt + strlen(tt);
+            }
+            fo->names[i].tt     = tt;
+            fo->names[i].tt_len = tt_end - tt;
+            tt                  = tt_end + 1;
+        }
+        fo->timetoken = NULL;
+    }
+
+    return PNR_OK;
+}
+
+
+/** Builds the hash table of the names of @p fo */
+static int hash_names(pubnub_fanout_t* fo)
+{
+    unsigned n = FANOUT_MIN_BUCKETS;
+    unsigned i;
+
+    while (n < 2 * fo->name_count) {
+        n *= 2;
+    }
+    if (n > fo->bucket_count) {
+        int* buckets = (int*)realloc(fo->buckets, n * sizeof *buckets);
+        if (NULL == buckets) {
+            return -1;
+        }
+        fo->buckets      = buckets;
+        fo->bucket_count = n;
+    }
+    for (i = 0; i < fo->bucket_count; ++i) {
+        fo->buckets[i] = -1;
+    }
+    for (i = fo->name_count; i > 0; --i) {
+        struct fanout_name* entry = &fo->names[i - 1];
+        int* head   = &fo->buckets[entry->hash & (fo->bucket_count - 1)];
+        entry->next = *head;
+        *head       = (int)(i - 1);
+    }
+
+    return 0;
+}
+
+
+/** Sets the @p value of all the channels named @p s (of length @p
+    len) in the batch of @p slot.
+ */
+static void set_value(pubnub_fanout_t* fo,
+                      struct fanout_slot const* slot,
+                      char const*      s,
+                      size_t           len,
+                      int              value)
+{
+    unsigned const h = pbhash_fnv1a(PBHASH_FNV1A_INIT, s, len);
+    int            i;
+
+    for (i = fo->buckets[h & (fo->bucket_count - 1)]; i >= 0; i = fo->names[i].next) {
+        struct fanout_name const* entry = &fo->names[i];
+        if (((unsigned)i >= slot->first) && ((unsigned)i < slot->first + slot->count)
+            && (entry->len == len) && (memcmp(entry->name, s, len) == 0)) {
+            fo->o_value[i] = value;
+        }
+    }
+}
+
+
+static int occupancy(struct pbjson_elem const* el)
+{
+    struct pbjson_elem found;
+
+    if (pbjson_get_object_value(el, "occupancy", &found) != jonmpOK) {
+        return -1;
+    }
+    return atoi(found.start);
+}
+
+
+/** Merges the here-now response on the context of @p slot. A
+    response for many channels has the occupancy of each of them in
+    the "channels" object of the "payload", while a response for one
+    channel has it at the top level.
+ */
+static enum pubnub_res merge_here_now(pubnub_fanout_t* fo, struct fanout_slot const* slot)
+{
+    char const*        reply = pubnub_get(slot->pb);
+    struct pbjson_elem el;
+    struct pbjson_elem payload;
+    struct pbjson_elem channels;
+    char const*        s;
+
+    if (NULL == reply) {
+        return PNR_FORMAT_ERROR;
+    }
+    el.start = reply;
+    el.end   = reply + strlen(reply);
+    if (pbjson_get_object_value(&el, "payload", &payload) != jonmpOK) {
+        int value = occupancy(&el);
+        if ((slot->count != 1) || (value < 0)) {
+            return PNR_FORMAT_ERROR;
+        }
+        fo->o_value[slot->first] = value;
+        fo->total += value;
+        return PNR_OK;
+    }
+    if (pbjson_get_object_value(&payload, "channels", &channels) != jonmpOK) {
+        return PNR_FORMAT_ERROR;
+    }
+    s = pbjson_skip_whitespace(channels.start + 1, channels.end);
+    while ((s < channels.end) && ('"' == *s)) {
+        char const*        key     = s + 1;
+        char const*        key_end = pbjson_find_end_element(s, channels.end);
+        struct pbjson_elem value;
+        int                n;
+
+        s = pbjson_skip_whitespace(key_end + 1, channels.end);
+        if ((s >= channels.end) || (*s != ':')) {
+            return PNR_FORMAT_ERROR;
+        }
+        value.start = pbjson_skip_whitespace(s + 1, channels.end);
+        if (value.start >= channels.end) {
+            return PNR_FORMAT_ERROR;
+        }
+        value.end = pbjson_find_end_element(value.start, channels.end) + 1;
+        n         = occupancy(&value);
+        if (n >= 0) {
+            set_value(fo, slot, key, key_end - key, n);
+            fo->total += n;
+        }
+        s = pbjson_skip_whitespace(value.end, channels.end);
+        if ((s < channels.end) && (',' == *s)) {
+            s = pbjson_skip_whitespace(s + 1, channels.end);
+        }
+    }
+
+    return PNR_OK;
+}
+
+
+#if PUBNUB_USE_ADVANCED_HISTORY
+/** Merges the message counts response on the context of @p slot. The
+    channels of the batch are looked up in the response in the order
+    they are in the batch, which is the order of the list.
+ */
+static enum pubnub_res merge_message_counts(pubnub_fanout_t* fo, struct fanout_slot const* slot)
+{
+    return (pubnub_get_message_counts(slot->pb, slot->channels, fo->o_value + slot->first) == 0)
+               ? PNR_OK
+               : PNR_FORMAT_ERROR;
+}
+#endif
+
+
+/** Makes sure the buffers of @p slot can hold @p len characters */
+static int reserve_slot(struct fanout_slot* slot, size_t len)
+{
+    if (slot->cap < len) {
+        char* channels   = (char*)realloc(slot->channels, len);
+        char* timetokens;
+        if (NULL == channels) {
+            return -1;
+        }
+        slot->channels = channels;
+        timetokens     = (char*)realloc(slot->timetokens, len);
+        if (NULL == timetokens) {
+            return -1;
+        }
+        slot->timetokens = timetokens;
+        slot->cap        = len;
+    }
+    return 0;
+}
+
+
+/** Starts the next batch of channels, starting at @p *next, on the
+    (idle) @p slot and moves @p *next past it.
+    @return The outcome of starting the transaction of the batch
+ */
+static enum pubnub_res start_batch(pubnub_fanout_t* fo, struct fanout_slot* slot, unsigned* next)
+{
+    size_t   url_len = 0;
+    size_t   len     = 0;
+    size_t   tt_len  = 0;
+    unsigned i;
+
+    for (i = *next; i < fo->name_count; ++i) {
+        struct fanout_name const* entry = &fo->names[i];
+        size_t cost = entry->encoded_len + 1 + ((entry->tt != NULL) ? entry->tt_len + 1 : 0);
+        if ((i > *next) && (url_len + cost > fo->url_budget)) {
+            break;
+        }
+        url_len += cost;
+        len += entry->len + 1;
+        tt_len += entry->tt_len + 1;
+    }
+    if (reserve_slot(slot, (len > tt_len) ? len : tt_len) != 0) {
+        PUBNUB_LOG_ERROR("Fan-out %p: failed to allocate a batch\n", fo);
+        return PNR_INTERNAL_ERROR;
+    }
+    slot->first = *next;
+    slot->count = i - *next;
+    *next       = i;
+
+    len    = 0;
+    tt_len = 0;
+    for (i = slot->first; i < slot->first + slot->count; ++i) {
+        struct fanout_name const* entry = &fo->names[i];
+        if (i > slot->first) {
+            slot->channels[len++]      = ',';
+            slot->timetokens[tt_len++] = ',';
+        }
+        memcpy(slot->channels + len, entry->name, entry->len);
+        len += entry->len;
+        if (entry->tt != NULL) {
+            memcpy(slot->timetokens + tt_len, entry->tt, entry->tt_len);
+            tt_len += entry->tt_len;
+        }
+    }
+    slot->channels[len]      = '\0';
+    slot->timetokens[tt_len] = '\0';
+
+    switch (fo->op) {
+#if PUBNUB_USE_ADVANCED_HISTORY
+    case fanoutMessageCounts:
+        return pubnub_message_counts(slot->pb,
+                                     slot->channels,
+                                     (fo->timetoken != NULL) ? fo->timetoken
+                                                             : slot->timetokens);
+#endif
+    case fanoutHereNow:
+        return pubnub_here_now(slot->pb, slot->channels, NULL);
+    default:
+        return PNR_INTERNAL_ERROR;
+    }
+}
+
+
+/** Called when the transaction of the batch of @p slot is done, with
+    the outcome @p result. Merges its results and makes the slot idle.
+    @return The outcome of the batch
+ */
+static enum pubnub_res finish_batch(pubnub_fanout_t* fo, struct fanout_slot* slot, enum pubnub_res result)
+{
+    if (PNR_OK == result) {
+        switch (fo->op) {
+#if PUBNUB_USE_ADVANCED_HISTORY
+        case fanoutMessageCounts:
+            result = merge_message_counts(fo, slot);
+            break;
+#endif
+        case fanoutHereNow:
+            result = merge_here_now(fo, slot);
+            break;
+        default:
+            result = PNR_INTERNAL_ERROR;
+            break;
+        }
+    }
+    if (result != PNR_OK) {
+        PUBNUB_LOG_WARNING("Fan-out %p: batch of %u channels (from %u) failed: %d\n",
+                           fo,
+                           slot->count,
+                           slot->first,
+                           result);
+    }
+    slot->count = 0;
+
+    return result;
+}
+
+
+/** Runs the request (already split) of @p fo: starts a batch on each
+    idle context while there are channels left, and waits for any of
+    the batches in progress to finish.
+ */
+static enum pubnub_res run(pubnub_fanout_t* fo)
+{
+    pubnub_t*       busy[PUBNUB_AWAIT_MAX_CONTEXTS];
+    unsigned        busy_slot[PUBNUB_AWAIT_MAX_CONTEXTS];
+    unsigned        next = 0;
+    unsigned        i;
+    enum pubnub_res rslt = PNR_OK;
+
+    for (i = 0; i < fo->name_count; ++i) {
+        fo->o_value[i] = -1;
+    }
+    fo->total = 0;
+    if (hash_names(fo) != 0) {
+        PUBNUB_LOG_ERROR("Fan-out %p: failed to allocate the hash table\n", fo);
+        return PNR_INTERNAL_ERROR;
+    }
+    for (;;) {
+        unsigned n = 0;
+        int      done;
+
+        for (i = 0; i < fo->size; ++i) {
+            struct fanout_slot* slot = &fo->slots[i];
+            while ((0 == slot->count) && (next < fo->name_count)) {
+                enum pubnub_res res = start_batch(fo, slot, &next);
+                if (res != PNR_STARTED) {
+                    res = finish_batch(fo, slot, res);
+                    if ((res != PNR_OK) && (PNR_OK == rslt)) {
+                        rslt = res;
+                    }
+                }
+            }
+            if (slot->count > 0) {
+                busy[n]        = slot->pb;
+                busy_slot[n++] = i;
+            }
+        }
+        if (0 == n) {
+            break;
+        }
+        done = pubnub_await_any(busy, n);
+        if (done >= 0) {
+            enum pubnub_res res = finish_batch(
+                fo, &fo->slots[busy_slot[done]], pubnub_last_result(busy[done]));
+            if ((res != PNR_OK) && (PNR_OK == rslt)) {
+                rslt = res;
+            }
+        }
+    }
+
+    return rslt;
+}
+
+
+pubnub_fanout_t* pubnub_fanout_create(char const* publish_key,
+                                      char const* subscribe_key,
+                                      unsigned    size)
+{
+    pubnub_fanout_t* fo;
+    unsigned         i;
+
+    PUBNUB_ASSERT_OPT(publish_key != NULL);
+    PUBNUB_ASSERT_OPT(subscribe_key != NULL);
+
+    if ((0 == size) || (size > PUBNUB_AWAIT_MAX_CONTEXTS)) {
+        return NULL;
+    }
+    if (PUBNUB_FANOUT_URL_RESERVE >= PUBNUB_BUF_MAXLEN) {
+        PUBNUB_LOG_ERROR("Fan-out: no room for channels in "
+                         "the URL of %d characters\n",
+                         PUBNUB_BUF_MAXLEN);
+        return NULL;
+    }
+    fo = (pubnub_fanout_t*)calloc(1, sizeof *fo);
+    if (NULL == fo) {
+        return NULL;
+    }
+    fo->slots = (struct fanout_slot*)calloc(size, sizeof fo->slots[0]);
+    fo->pbs   = (pubnub_t**)calloc(size, sizeof fo->pbs[0]);
+    if ((NULL == fo->slots) || (NULL == fo->pbs)) {
+        free(fo->pbs);
+        free(fo->slots);
+        free(fo);
+        return NULL;
+    }
+    fo->size       = size;
+    fo->url_budget = PUBNUB_BUF_MAXLEN - PUBNUB_FANOUT_URL_RESERVE;
+
+    for (i = 0; i < size; ++i) {
+        pubnub_t* pb = pubnub_alloc();
+        if (NULL == pb) {
+            PUBNUB_LOG_ERROR("Failed to allocate context %u of %u for the "
+                             "fan-out\n",
+                             i,
+                             size);
+            pubnub_fanout_destroy(fo, 0);
+            return NULL;
+        }
+        pubnub_init(pb, publish_key, subscribe_key);
+        pubnub_set_non_blocking_io(pb);
+        fo->slots[i].pb = pb;
+        fo->pbs[i]      = pb;
+    }
+
+    return fo;
+}
+
+
+unsigned pubnub_fanout_size(pubnub_fanout_t const* fo)
+{
+    PUBNUB_ASSERT_OPT(fo != NULL);
+    return fo->size;
+}
+
+
+pubnub_t* pubnub_fanout_context(pubnub_fanout_t* fo, unsigned i)
+{
+    PUBNUB_ASSERT_OPT(fo != NULL);
+    return (i < fo->size) ? fo->slots[i].pb : NULL;
+}
+
+
+#if PUBNUB_USE_ADVANCED_HISTORY
+enum pubnub_res pubnub_fanout_message_counts(pubnub_fanout_t* fo,
+                                             char const*      channel,
+                                             char const*      timetoken,
+                                             int*             o_count)
+{
+    enum pubnub_res rslt;
+
+    PUBNUB_ASSERT_OPT(fo != NULL);
+    PUBNUB_ASSERT_OPT(channel != NULL);
+    PUBNUB_ASSERT_OPT(timetoken != NULL);
+    PUBNUB_ASSERT_OPT(o_count != NULL);
+
+    rslt = split_list(fo, channel, timetoken);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    fo->op      = fanoutMessageCounts;
+    fo->o_value = o_count;
+
+    return run(fo);
+}
+#endif /* PUBNUB_USE_ADVANCED_HISTORY */
+
+
+enum pubnub_res pubnub_fanout_here_now(pubnub_fanout_t* fo,
+                                       char const*      channel,
+                                       int*             o_occupancy,
+                                       int*             o_total)
+{
+    enum pubnub_res rslt;
+
+    PUBNUB_ASSERT_OPT(fo != NULL);
+    PUBNUB_ASSERT_OPT(channel != NULL);
+    PUBNUB_ASSERT_OPT(o_occupancy != NULL);
+
+    rslt = split_list(fo, channel, NULL);
+    if (rslt != PNR_OK) {
+        return rslt;
+    }
+    fo->op      = fanoutHereNow;
+    fo->o_value = o_occupancy;
+    rslt        = run(fo);
+    if (o_total != NULL) {
+        *o_total = fo->total;
+    }
+
+    return rslt;
+}
+
+
+int pubnub_fanout_destroy(pubnub_fanout_t* fo, unsigned millisec)
+{
+    unsigned i;
+    unsigned n = 0;
+
+    PUBNUB_ASSERT_OPT(fo != NULL);
+
+    for (i = 0; i < fo->size; ++i) {
+        if (fo->pbs[i] != NULL) {
+            fo->pbs[n++] = fo->pbs[i];
+        }
+    }
+    if (pubnub_free_all_with_timeout(fo->pbs, n, millisec) != 0) {
+        PUBNUB_LOG_ERROR("Failed to free the contexts of the fan-out %p\n", fo);
+        return -1;
+    }
+    for (i = 0; i < fo->size; ++i) {
+        free(fo->slots[i].channels);
+        free(fo->slots[i].timetokens);
+    }
+    free(fo->buckets);
+    free(fo->names);
+    free(fo->pbs);
+    free(fo->slots);
+    free(fo);
+
+    return 0;
+}
+
+
+#endif /* PUBNUB_USE_SYNC_POLL */
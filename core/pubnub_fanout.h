@@ -0,0 +1,142 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_FANOUT
+#define INC_PUBNUB_FANOUT
+
+
+#include "pubnub_api_types.h"
+
+#if defined PUBNUB_CALLBACK_API
+#error The fan-out is available only in the sync interface
+#endif
+#if !PUBNUB_USE_SYNC_POLL
+#error To use the fan-out you must define PUBNUB_USE_SYNC_POLL=1
+#endif
+
+
+/** @file pubnub_fanout.h
+
+    This module implements a "fan-out" for the sync interface - a
+    pool of Pubnub contexts, owned by the fan-out, used to make
+    requests for (very) long lists of channels.
+
+    The channel list of a request has to fit in the URL, that is, in
+    #PUBNUB_BUF_MAXLEN, otherwise the request fails with
+    #PNR_TX_BUFF_TOO_SMALL. The fan-out splits the channel list into
+    batches that fit in the URL, runs the batches in parallel (one per
+    context of the pool, with pubnub_await_any()) and merges their
+    results back, in the order of the channels in the list. So, you
+    can query tens of thousands of channels without rebuilding with a
+    larger #PUBNUB_BUF_MAXLEN.
+
+    The contexts of the pool use non-blocking I/O. A fan-out may be
+    used from one thread at a time.
+
+    To subscribe to a long list of channels, use the subscribe
+    multiplexer (pubnub_subscribe_mux.h) of the callback interface.
+*/
+
+
+/** How much of the URL (#PUBNUB_BUF_MAXLEN) of a request of the
+    fan-out to reserve for everything but the channels (and channel
+    timetokens): subscribe key, UUID, auth key, etc.
+ */
+#if !defined PUBNUB_FANOUT_URL_RESERVE
+#define PUBNUB_FANOUT_URL_RESERVE 512
+#endif
+
+
+/** A fan-out descriptor. An opaque data structure. */
+struct pubnub_fanout;
+
+/** A helper typedef of a fan-out descriptor */
+typedef struct pubnub_fanout pubnub_fanout_t;
+
+
+/** Creates a fan-out with a pool of @p size contexts, all initialized
+    with the given keys.
+
+    To change other settings of the contexts (UUID, auth, proxy...),
+    use pubnub_fanout_context().
+
+    @param publish_key The string of the key to use when publishing
+    @param subscribe_key The string of the key to use when subscribing
+    @param size Number of contexts in the pool, at least 1 and at most
+    #PUBNUB_AWAIT_MAX_CONTEXTS
+
+    @retval NULL Failed to create a fan-out
+    @result The fan-out created
+ */
+pubnub_fanout_t* pubnub_fanout_create(char const* publish_key,
+                                      char const* subscribe_key,
+                                      unsigned    size);
+
+/** Returns the number of contexts in the pool of the fan-out */
+unsigned pubnub_fanout_size(pubnub_fanout_t const* fo);
+
+/** Returns the context with the index @p i in the pool of the
+    fan-out, so that its settings may be changed.
+
+    @warning Do not start transactions on the context. Do not free
+    it, it's owned by the fan-out.
+
+    @retval NULL @p i out of range
+    @result The context
+*/
+pubnub_t* pubnub_fanout_context(pubnub_fanout_t* fo, unsigned i);
+
+#if PUBNUB_USE_ADVANCED_HISTORY
+/** Gets the message counts of the channels in the @p channel list,
+    like pubnub_message_counts() followed by pubnub_get_message_counts(),
+    but for a list of any length. Waits until all the batches are
+    done.
+
+    @param fo The fan-out
+    @param channel The string with the comma-delimited list of
+    channels
+    @param timetoken The timetoken to count the messages since, or a
+    comma-delimited list of them, one for each channel in @p channel
+    @param o_count The array of message counts, one for each channel
+    in @p channel, in the same order. If a channel is not in the
+    response (or its batch failed), its count is negative.
+
+    @retval PNR_OK all the batches succeeded
+    @return The outcome of the (first) batch that failed, otherwise
+ */
+enum pubnub_res pubnub_fanout_message_counts(pubnub_fanout_t* fo,
+                                             char const*      channel,
+                                             char const*      timetoken,
+                                             int*             o_count);
+#endif /* PUBNUB_USE_ADVANCED_HISTORY */
+
+/** Gets the occupancy of the channels in the @p channel list, like
+    pubnub_here_now(), but for a list of any length. Waits until all
+    the batches are done.
+
+    @param fo The fan-out
+    @param channel The string with the comma-delimited list of
+    channels
+    @param o_occupancy The array of occupancies, one for each channel
+    in @p channel, in the same order. If a channel is not in the
+    response (or its batch failed), its occupancy is negative.
+    @param o_total The sum of the occupancies of the channels in the
+    responses, can be NULL
+
+    @retval PNR_OK all the batches succeeded
+    @return The outcome of the (first) batch that failed, otherwise
+ */
+enum pubnub_res pubnub_fanout_here_now(pubnub_fanout_t* fo,
+                                       char const*      channel,
+                                       int*             o_occupancy,
+                                       int*             o_total);
+
+/** Destroys the fan-out, freeing all its contexts, waiting at most @p
+    millisec for them.
+
+    @retval 0 fan-out destroyed
+    @retval -1 failed to free some context(s) in due time, fan-out
+    can't be destroyed (it is "leaked")
+ */
+int pubnub_fanout_destroy(pubnub_fanout_t* fo, unsigned millisec);
+
+
+#endif /* !defined INC_PUBNUB_FANOUT */
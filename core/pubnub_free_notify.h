@@ -0,0 +1,58 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_FREE_NOTIFY
+#define INC_PUBNUB_FREE_NOTIFY
+
+
+/** @file pubnub_free_notify.h
+
+    This is the (internal) notification for pubnub_free_with_timeout()
+    and pubnub_free_all_with_timeout(), so that they can sleep while
+    waiting for the contexts to finish the cancellation, instead of
+    trying pubnub_free() in a tight loop.
+
+    The notification is "global": it is given when a transaction on
+    any context is done (which is what pubnub_free() waits for) and
+    when any context is freed at last. Notifications are counted, so
+    that one which comes after a failed pubnub_free(), but before the
+    wait started, is not lost.
+
+    As transactions are done all the time, while freeing is rare, a
+    notification is given only if somebody is waiting for it, that
+    is, between pbfree_wait_begin() and pbfree_wait_end(). Otherwise,
+    it costs just an atomic read.
+ */
+
+#if PUBNUB_USE_FREE_NOTIFY
+
+/** Notifies everybody waiting in pbfree_wait(), if there is anybody
+    between pbfree_wait_begin() and pbfree_wait_end() */
+void pbfree_notify(void);
+
+/** Starts waiting for notifications: the ones given from now on are
+    counted. Has to be called before trying to free the contexts (and
+    before getting pbfree_notification_count()) and matched with a
+    call to pbfree_wait_end().
+ */
+void pbfree_wait_begin(void);
+
+/** Done waiting for notifications */
+void pbfree_wait_end(void);
+
+/** Returns the number of notifications given so far */
+unsigned pbfree_notification_count(void);
+
+/** Waits for a notification after the first @p count ones, for up to
+    @p timeout_ms milliseconds. Returns at once if it was already
+    given.
+ */
+void pbfree_wait(unsigned count, unsigned timeout_ms);
+
+#define PBFREE_NOTIFY() pbfree_notify()
+
+#else
+
+#define PBFREE_NOTIFY()
+
+#endif /* PUBNUB_USE_FREE_NOTIFY */
+
+#endif /* !defined INC_PUBNUB_FREE_NOTIFY */
@@ -3,12 +3,14 @@
 #define	INC_PUBNUB_FREE_WITH_TIMEOUT
 
 
-/** Tries pubnub_free() in a tight loop until either:
+/** Tries pubnub_free() until either:
     - it succeeds
     - time specified in @p millisec elapses
 
     Essentially, it waits for the context to finish the cancellation
-    (which is implied with pubnub_free()) and then frees it.
+    (which is implied with pubnub_free()) and then frees it. If built
+    with PUBNUB_USE_FREE_NOTIFY, it sleeps between the tries, until
+    a transaction is done, otherwise, it tries in a tight loop.
 
     This function is more useful in the callback interface. In the
     sync interface, there's a reasonable chance that a pubnub_free()
@@ -26,5 +28,22 @@
  */
 int pubnub_free_with_timeout(pubnub_t* pbp, unsigned millisec);
 
+/** Frees the @p n contexts @p pbs, like pubnub_free_with_timeout(),
+    but cancels the transactions on all of them at once and waits
+    for all of them with the one deadline. This is much faster than
+    freeing them one by one, as the cancellations go on concurrently.
+
+    @param[in,out] pbs The contexts to free. The ones that are freed
+    are set to NULL, the ones left are the ones that could not be
+    freed. NULL contexts are skipped.
+    @param[in] n The number of contexts in @p pbs
+    @param[in] millisec Max time to wait for freeing all the contexts,
+    in milliseconds
+
+    @return The number of contexts that could not be freed in
+    @p millisec, 0 if all were freed
+ */
+int pubnub_free_all_with_timeout(pubnub_t** pbs, unsigned n, unsigned millisec);
+
 
 #endif /* !defined INC_PUBNUB_FREE_WITH_TIMEOUT */
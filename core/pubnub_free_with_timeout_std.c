@@ -3,28 +3,107 @@
 
 #include "pubnub_free_with_timeout.h"
 #include "pubnub_alloc.h"
+#include "pubnub_pubsubapi.h"
 #include "pubnub_assert.h"
 #include "pubnub_log.h"
 
-#include "time.h"
+#include "lib/msstopwatch/msstopwatch.h"
 
 
+/** The longest time (in milliseconds) to sleep between two tries to
+    free the contexts. In the callback interface, we are woken up by
+    the notification when a transaction is done, so this is just a
+    safety net. In the sync interface, nobody else drives the
+    cancellation, so we need to get back to it.
+ */
+#if !defined PUBNUB_FREE_WAIT_MAX_MS
+#if defined(PUBNUB_CALLBACK_API)
+#define PUBNUB_FREE_WAIT_MAX_MS 100
+#else
+#define PUBNUB_FREE_WAIT_MAX_MS 10
+#endif
+#endif
 
-int pubnub_free_with_timeout(pubnub_t* pbp, unsigned millisec)
+
+/** Tries to pubnub_free() every context in @p pbs (which is not NULL),
+    setting the freed ones to NULL. Returns the number of contexts
+    that are left.
+ */
+static unsigned try_free(pubnub_t** pbs, unsigned n)
 {
-    const clock_t t0 = clock();
-    const clock_t clocks_till_timeout = (millisec * CLOCKS_PER_SEC) / 1000;
+    unsigned left = 0;
+    unsigned i;
 
-    PUBNUB_ASSERT_OPT(pbp != NULL);
+    for (i = 0; i < n; ++i) {
+        if (NULL == pbs[i]) {
+            continue;
+        }
+#if !defined(PUBNUB_CALLBACK_API)
+        /* Drive the cancellation, if it is waiting for something */
+        pubnub_last_result(pbs[i]);
+#endif
+        if (0 == pubnub_free(pbs[i])) {
+            pbs[i] = NULL;
+        }
+        else {
+            ++left;
+        }
+    }
+
+    return left;
+}
+
+
+int pubnub_free_all_with_timeout(pubnub_t** pbs, unsigned n, unsigned millisec)
+{
+    pbmsref_t const t0 = pbms_start();
+    unsigned        left;
+
+    PUBNUB_ASSERT_OPT((pbs != NULL) || (0 == n));
+
+#if PUBNUB_USE_FREE_NOTIFY
+    pbfree_wait_begin();
+#endif
+    for (;;) {
+#if PUBNUB_USE_FREE_NOTIFY
+        unsigned const count = pbfree_notification_count();
+#endif
+        pbms_t elapsed;
 
-    while (pubnub_free(pbp) != 0) {
-        const clock_t elapsed = clock() - t0;
-        if (elapsed  > clocks_till_timeout) {
-            PUBNUB_LOG_ERROR("Failed to free the context in %u milli seconds\n", millisec);
-            return -1;
+        left = try_free(pbs, n);
+        if (0 == left) {
+            break;
         }
+        elapsed = pbms_elapsed(t0);
+        if (elapsed >= (pbms_t)millisec) {
+            PUBNUB_LOG_ERROR("Failed to free %u of %u contexts in %u milli seconds\n",
+                             left,
+                             n,
+                             millisec);
+#if PUBNUB_USE_FREE_NOTIFY
+            pbfree_wait_end();
+#endif
+            return (int)left;
+        }
+#if PUBNUB_USE_FREE_NOTIFY
+        elapsed = millisec - elapsed;
+        pbfree_wait(count,
+                    (elapsed > PUBNUB_FREE_WAIT_MAX_MS) ? PUBNUB_FREE_WAIT_MAX_MS
+                                                        : (unsigned)elapsed);
+#endif
     }
-    PUBNUB_LOG_TRACE("Freed the context in %lf seconds\n",  ((float)clock() - t0) / CLOCKS_PER_SEC);
+#if PUBNUB_USE_FREE_NOTIFY
+    pbfree_wait_end();
+#endif
+    PUBNUB_LOG_TRACE("Freed %u contexts in %d milli seconds\n", n, (int)pbms_elapsed(t0));
 
     return 0;
 }
+
+
+int pubnub_free_with_timeout(pubnub_t* pbp, unsigned millisec)
+{
+    PUBNUB_ASSERT_OPT(pbp != NULL);
+
+    return (0 == pubnub_free_all_with_timeout(&pbp, 1, millisec)) ? 0 : -1;
+}
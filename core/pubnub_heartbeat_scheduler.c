@@ -0,0 +1,887 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "pubnub_heartbeat_scheduler.h"
+
+#include "pubnub_coreapi.h"
+#include "pubnub_pubsubapi.h"
+#include "pubnub_ntf_callback.h"
+#include "pubnub_alloc.h"
+#include "pubnub_free_with_timeout.h"
+#include "pubnub_url_encode.h"
+#include "pubnub_mutex.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/** Initial number of buckets of the hash table. Must be a power of 2. */
+#define HBSCHED_INITIAL_BUCKETS 64
+
+/** Heap index of an entry which is not in the heap */
+#define HBSCHED_NOT_IN_HEAP ((unsigned)-1)
+
+
+/** A UUID the scheduler sends heartbeats for */
+struct hbsched_entry {
+    /** Next entry in the same bucket of the hash table */
+    struct hbsched_entry* next;
+    /** Hash of the UUID */
+    unsigned hash;
+    /** Index of this entry in the heap, #HBSCHED_NOT_IN_HEAP while
+        its heartbeat is being sent */
+    unsigned heap_index;
+    /** When is the next heartbeat due, in milliseconds of the
+        scheduler clock */
+    unsigned long long due;
+    /** Set while the UUID has a subscribe going on */
+    bool subscribed;
+    /** Set when the UUID was removed while its heartbeat was being
+        sent, so the entry is to be freed when it's done */
+    bool removed;
+    /** Comma-separated list of the channels of the UUID */
+    char* channels;
+    /** Length of the #channels */
+    size_t channels_len;
+    /** Length of the #channels in the URL (URL encoded) */
+    size_t channels_url_len;
+    /** Length of the UUID */
+    size_t len;
+    /** The UUID itself, the entry is allocated to hold it all */
+    char uuid[1];
+};
+
+struct hbsched_slot;
+
+/** A heartbeat to start, taken by the ticker */
+struct hbsched_start {
+    /** The slot to start the heartbeat on */
+    struct hbsched_slot* slot;
+    /** Generation of the slot when the heartbeat was taken */
+    unsigned generation;
+};
+
+/** A context of the scheduler pool */
+struct hbsched_slot {
+    /** The context itself */
+    pubnub_t* pb;
+    /** The scheduler this slot belongs to */
+    pubnub_hbsched_t* hbs;
+    /** The entry whose heartbeat the context is sending */
+    struct hbsched_entry* entry;
+    /** Copy of the UUID of the #entry */
+    char* uuid;
+    /** Copy of the channels of the #entry */
+    char* channels;
+    /** Capacity of the #uuid buffer */
+    size_t uuid_cap;
+    /** Capacity of the #channels buffer */
+    size_t channels_cap;
+    /** Incremented each time a heartbeat of this slot is done, so we
+        can tell if a heartbeat was already accounted for.
+     */
+    unsigned generation;
+};
+
+/** Heartbeat scheduler descriptor */
+struct pubnub_heartbeat_scheduler {
+    /** The pool of contexts */
+    struct hbsched_slot* slots;
+    /** Number of contexts in the pool */
+    unsigned size;
+    /** The heartbeat interval, in milliseconds */
+    unsigned interval;
+    /** Maximum length of the channels in the URL of one heartbeat */
+    size_t url_budget;
+    /** Slots to start heartbeats on, used only from the ticker */
+    struct hbsched_start* starting;
+    /** Stack of indexes of idle slots */
+    pubnub_guarded_by(monitor) unsigned* idle;
+    /** Number of idle slots */
+    pubnub_guarded_by(monitor) unsigned idle_count;
+    /** The hash table of the UUIDs */
+    pubnub_guarded_by(monitor) struct hbsched_entry** buckets;
+    /** Number of buckets in the hash table, a power of 2 */
+    pubnub_guarded_by(monitor) unsigned bucket_count;
+    /** Number of entries in the hash table */
+    pubnub_guarded_by(monitor) unsigned entry_count;
+    /** Min-heap of the entries (not being sent), by their due time */
+    pubnub_guarded_by(monitor) struct hbsched_entry** heap;
+    /** Number of entries in the #heap */
+    pubnub_guarded_by(monitor) unsigned heap_count;
+    /** Capacity of the #heap */
+    pubnub_guarded_by(monitor) unsigned heap_cap;
+    /** The scheduler clock, in milliseconds since its creation */
+    pubnub_guarded_by(monitor) unsigned long long now;
+    /** State of the (xorshift) pseudo-random number generator used
+        to spread the heartbeats */
+    pubnub_guarded_by(monitor) unsigned random;
+    /** Set when the scheduler is being destroyed */
+    pubnub_guarded_by(monitor) bool stopping;
+    /** Metrics of the scheduler (`uuids` and `busy` are calculated) */
+    pubnub_guarded_by(monitor) struct pubnub_hbsched_metrics metrics;
+
+#if PUBNUB_THREADSAFE
+    pubnub_mutex_t monitor;
+#endif
+};
+
+
+/** Returns a pseudo-random number less than @p n (which is > 0). Has
+    to be called with the scheduler locked.
+ */
+static unsigned random_below(pubnub_hbsched_t* hbs, unsigned n)
+{
+    unsigned x = hbs->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    hbs->random = x;
+    return x % n;
+}
+
+
+/** When is the next heartbeat due, after one was just sent: an
+    interval later, less up to #PUBNUB_HBSCHED_JITTER_PERCENT of it.
+ */
+static unsigned long long next_due(pubnub_hbsched_t* hbs)
+{
+    unsigned jitter = hbs->interval / 100 * PUBNUB_HBSCHED_JITTER_PERCENT
+                      + hbs->interval % 100 * PUBNUB_HBSCHED_JITTER_PERCENT / 100;
+    return hbs->now + hbs->interval - random_below(hbs, jitter + 1);
+}
+
+
+static void heap_swap(struct hbsched_entry** heap, unsigned i, unsigned j)
+{
+    struct hbsched_entry* e = heap[i];
+    heap[i]                 = heap[j];
+    heap[j]                 = e;
+    heap[i]->heap_index     = i;
+    heap[j]->heap_index     = j;
+}
+
+
+static void sift_up(pubnub_hbsched_t* hbs, unsigned i)
+{
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (hbs->heap[parent]->due <= hbs->heap[i]->due) {
+            break;
+        }
+        heap_swap(hbs->heap, i, parent);
+        i = parent;
+    }
+}
+
+
+static void sift_down(pubnub_hbsched_t* hbs, unsigned i)
+{
+    for (;;) {
+        unsigned least = i;
+        unsigned left  = 2 * i + 1;
+        unsigned right = left + 1;
+        if ((left < hbs->heap_count) && (hbs->heap[left]->due < hbs->heap[least]->due)) {
+            least = left;
+        }
+        if ((right < hbs->heap_count) && (hbs->heap[right]->due < hbs->heap[least]->due)) {
+            least = right;
+        }
+        if (least == i) {
+            break;
+        }
+        heap_swap(hbs->heap, i, least);
+        i = least;
+    }
+}
+
+
+/** Puts the @p entry in the heap. There is always room, as the heap
+    is grown when entries are added to the hash table.
+ */
+static void heap_push(pubnub_hbsched_t* hbs, struct hbsched_entry* entry)
+{
+    PUBNUB_ASSERT_OPT(hbs->heap_count < hbs->heap_cap);
+    entry->heap_index           = hbs->heap_count;
+    hbs->heap[hbs->heap_count++] = entry;
+    sift_up(hbs, entry->heap_index);
+}
+
+
+static void heap_remove(pubnub_hbsched_t* hbs, struct hbsched_entry* entry)
+{
+    unsigned i = entry->heap_index;
+
+    PUBNUB_ASSERT_OPT(i < hbs->heap_count);
+    PUBNUB_ASSERT_OPT(hbs->heap[i] == entry);
+    entry->heap_index = HBSCHED_NOT_IN_HEAP;
+    if (i != --hbs->heap_count) {
+        hbs->heap[i]             = hbs->heap[hbs->heap_count];
+        hbs->heap[i]->heap_index = i;
+        sift_up(hbs, i);
+        sift_down(hbs, hbs->heap[i]->heap_index);
+    }
+}
+
+
+/** Changes the due time of the @p entry, which is in the heap */
+static void reschedule(pubnub_hbsched_t*     hbs,
+                       struct hbsched_entry* entry,
+                       unsigned long long    due)
+{
+    entry->due = due;
+    sift_up(hbs, entry->heap_index);
+    sift_down(hbs, entry->heap_index);
+}
+
+
+/** Looks up the @p uuid. Has to be called with the scheduler locked.
+ */
+static struct hbsched_entry* find(pubnub_hbsched_t* hbs, char const* uuid)
+{
+    size_t                len = strlen(uuid);
+    unsigned              h   = pbhash_fnv1a(PBHASH_FNV1A_INIT, uuid, len);
+    struct hbsched_entry* e;
+
+    for (e = hbs->buckets[h & (hbs->bucket_count - 1)]; e != NULL; e = e->next) {
+        if ((e->hash == h) && (e->len == len) && (0 == memcmp(e->uuid, uuid, len))) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+
+/** Doubles the number of buckets of the hash table. If it fails, the
+    table is left as it was (just with longer chains).
+ */
+static void grow_table(pubnub_hbsched_t* hbs)
+{
+    unsigned               n = hbs->bucket_count * 2;
+    struct hbsched_entry** buckets;
+    unsigned               i;
+
+    buckets = (struct hbsched_entry**)calloc(n, sizeof buckets[0]);
+    if (NULL == buckets) {
+        return;
+    }
+    for (i = 0; i < hbs->bucket_count; ++i) {
+        struct hbsched_entry* e = hbs->buckets[i];
+        while (e != NULL) {
+            struct hbsched_entry* next = e->next;
+            e->next                    = buckets[e->hash & (n - 1)];
+            buckets[e->hash & (n - 1)] = e;
+            e                          = next;
+        }
+    }
+    free(hbs->buckets);
+    hbs->buckets      = buckets;
+    hbs->bucket_count = n;
+}
+
+
+static void unlink_from_table(pubnub_hbsched_t* hbs, struct hbsched_entry* entry)
+{
+    struct hbsched_entry** pp = &hbs->buckets[entry->hash & (hbs->bucket_count - 1)];
+    while (*pp != entry) {
+        PUBNUB_ASSERT_OPT(*pp != NULL);
+        pp = &(*pp)->next;
+    }
+    *pp = entry->next;
+    --hbs->entry_count;
+}
+
+
+static void free_entry(struct hbsched_entry* entry)
+{
+    free(entry->channels);
+    free(entry);
+}
+
+
+/** Removes the @p entry from the scheduler, freeing it, unless its
+    heartbeat is being sent (then it's freed when that is done). Has
+    to be called with the scheduler locked.
+*/
+static void remove_entry(pubnub_hbsched_t* hbs, struct hbsched_entry* entry)
+{
+    unlink_from_table(hbs, entry);
+    if (HBSCHED_NOT_IN_HEAP == entry->heap_index) {
+        entry->removed = true;
+        return;
+    }
+    heap_remove(hbs, entry);
+    free_entry(entry);
+}
+
+
+/** Finds the @p channel in the comma-separated list of the @p entry.
+    @return Offset of the channel in the list, or -1 if not found
+ */
+static long find_channel(struct hbsched_entry const* entry, char const* channel, size_t len)
+{
+    char const* s   = entry->channels;
+    char const* end = s + entry->channels_len;
+
+    while (s < end) {
+        char const* comma = (char const*)memchr(s, ',', end - s);
+        size_t      n     = (NULL == comma) ? (size_t)(end - s) : (size_t)(comma - s);
+        if ((n == len) && (0 == memcmp(s, channel, len))) {
+            return (long)(s - entry->channels);
+        }
+        s += n + 1;
+    }
+    return -1;
+}
+
+
+/** Copies @p len characters of @p s to the buffer @p buf of capacity
+    @p cap, growing it if need be.
+    @retval 0 OK
+    @retval -1 failed to grow the buffer
+ */
+static int copy_to(char** buf, size_t* cap, char const* s, size_t len)
+{
+    if (len + 1 > *cap) {
+        char* p = (char*)realloc(*buf, len + 1);
+        if (NULL == p) {
+            return -1;
+        }
+        *buf = p;
+        *cap = len + 1;
+    }
+    memcpy(*buf, s, len);
+    (*buf)[len] = '\0';
+    return 0;
+}
+
+
+static void account(pubnub_hbsched_t* hbs, enum pubnub_res result)
+{
+    if (PNR_OK == result) {
+        ++hbs->metrics.sent;
+    }
+    else {
+        ++hbs->metrics.failed;
+    }
+}
+
+
+/** The heartbeat of the @p slot, started in its @p generation, is
+    done, with the @p result. Reschedules its entry (or frees it, if
+    it was removed) and makes the slot idle. Does nothing if this
+    heartbeat was already done.
+*/
+static void heartbeat_done(struct hbsched_slot* slot,
+                           unsigned             generation,
+                           enum pubnub_res      result)
+{
+    pubnub_hbsched_t*     hbs = slot->hbs;
+    struct hbsched_entry* entry;
+
+    pubnub_mutex_lock(hbs->monitor);
+    if ((generation != slot->generation) || (NULL == slot->entry)) {
+        /* Already done, from the context callback */
+        pubnub_mutex_unlock(hbs->monitor);
+        return;
+    }
+    entry       = slot->entry;
+    slot->entry = NULL;
+    ++slot->generation;
+    account(hbs, result);
+    if (entry->removed) {
+        free_entry(entry);
+    }
+    else {
+        entry->due = next_due(hbs);
+        heap_push(hbs, entry);
+    }
+    PUBNUB_ASSERT_OPT(hbs->idle_count < hbs->size);
+    hbs->idle[hbs->idle_count++] = (unsigned)(slot - hbs->slots);
+    pubnub_mutex_unlock(hbs->monitor);
+}
+
+
+static void hbsched_context_callback(pubnub_t*         pb,
+                                     enum pubnub_trans trans,
+                                     enum pubnub_res   result,
+                                     void*             user_data)
+{
+    struct hbsched_slot* slot = (struct hbsched_slot*)user_data;
+    unsigned             generation;
+
+    PUBNUB_ASSERT_OPT(slot != NULL);
+    PUBNUB_ASSERT_OPT(slot->pb == pb);
+
+    if (PBTT_NONE == trans) {
+        /* Context being freed, not a heartbeat of ours */
+        return;
+    }
+    if (trans != PBTT_HEARTBEAT) {
+        PUBNUB_LOG_WARNING("pb=%p heartbeat scheduler: unexpected transaction "
+                           "%d outcome %d\n",
+                           pb,
+                           trans,
+                           result);
+        return;
+    }
+    PUBNUB_LOG_TRACE("pb=%p heartbeat scheduler: heartbeat for uuid='%s' "
+                     "done, result=%d\n",
+                     pb,
+                     slot->uuid,
+                     result);
+    /* The reply is of no interest, but has to be read for the context
+       to start the next heartbeat */
+    while (pubnub_get(pb) != NULL) {
+        continue;
+    }
+    pubnub_mutex_lock(slot->hbs->monitor);
+    generation = slot->generation;
+    pubnub_mutex_unlock(slot->hbs->monitor);
+    heartbeat_done(slot, generation, result);
+}
+
+
+/** Takes the due heartbeats, as long as there are idle slots, and
+    starts them. Called periodically from the callback thread.
+ */
+static void hbsched_tick(void* data, int elapsed)
+{
+    pubnub_hbsched_t* hbs = (pubnub_hbsched_t*)data;
+    unsigned          n   = 0;
+    unsigned          i;
+
+    pubnub_mutex_lock(hbs->monitor);
+    hbs->now += elapsed;
+    while (!hbs->stopping && (hbs->heap_count > 0) && (hbs->heap[0]->due <= hbs->now)) {
+        struct hbsched_entry* entry = hbs->heap[0];
+        struct hbsched_slot*  slot;
+
+        if (entry->subscribed) {
+            ++hbs->metrics.skipped;
+            reschedule(hbs, entry, next_due(hbs));
+            continue;
+        }
+        if (0 == hbs->idle_count) {
+            break;
+        }
+        slot = &hbs->slots[hbs->idle[hbs->idle_count - 1]];
+        if ((copy_to(&slot->uuid, &slot->uuid_cap, entry->uuid, entry->len) != 0)
+            || (copy_to(&slot->channels,
+                        &slot->channels_cap,
+                        entry->channels,
+                        entry->channels_len)
+                != 0)) {
+            PUBNUB_LOG_ERROR("Heartbeat scheduler %p: failed to allocate "
+                             "buffers for uuid='%s'\n",
+                             hbs,
+                             entry->uuid);
+            ++hbs->metrics.failed;
+            reschedule(hbs, entry, next_due(hbs));
+            continue;
+        }
+        --hbs->idle_count;
+        heap_remove(hbs, entry);
+        slot->entry      = entry;
+        hbs->starting[n].slot       = slot;
+        hbs->starting[n].generation = slot->generation;
+        ++n;
+    }
+    pubnub_mutex_unlock(hbs->monitor);
+
+    /* Not holding the scheduler lock while locking the context, as
+       the context callback locks them the other way around.
+    */
+    for (i = 0; i < n; ++i) {
+        struct hbsched_slot* slot = hbs->starting[i].slot;
+        enum pubnub_res      rslt;
+
+        pubnub_set_uuid(slot->pb, slot->uuid);
+        rslt = pubnub_heartbeat(slot->pb, slot->channels, NULL);
+        if (rslt != PNR_STARTED) {
+            heartbeat_done(slot, hbs->starting[i].generation, rslt);
+        }
+    }
+}
+
+
+static void free_contexts(pubnub_hbsched_t* hbs, unsigned n)
+{
+    unsigned i;
+    for (i = 0; i < n; ++i) {
+        pubnub_free(hbs->slots[i].pb);
+    }
+}
+
+
+static void free_scheduler(pubnub_hbsched_t* hbs)
+{
+    unsigned i;
+
+    for (i = 0; i < hbs->bucket_count; ++i) {
+        struct hbsched_entry* e = hbs->buckets[i];
+        while (e != NULL) {
+            struct hbsched_entry* next = e->next;
+            free_entry(e);
+            e = next;
+        }
+    }
+    for (i = 0; i < hbs->size; ++i) {
+        struct hbsched_entry* e = hbs->slots[i].entry;
+        if ((e != NULL) && e->removed) {
+            free_entry(e);
+        }
+        free(hbs->slots[i].uuid);
+        free(hbs->slots[i].channels);
+    }
+    pubnub_mutex_destroy(hbs->monitor);
+    free(hbs->heap);
+    free(hbs->buckets);
+    free(hbs->starting);
+    free(hbs->idle);
+    free(hbs->slots);
+    free(hbs);
+}
+
+
+pubnub_hbsched_t* pubnub_hbsched_create(char const* publish_key,
+                                        char const* subscribe_key,
+                                        unsigned    size,
+                                        unsigned    interval_ms)
+{
+    pubnub_hbsched_t* hbs;
+    unsigned          i;
+
+    PUBNUB_ASSERT_OPT(publish_key != NULL);
+    PUBNUB_ASSERT_OPT(subscribe_key != NULL);
+
+    if ((0 == size) || (0 == interval_ms)) {
+        return NULL;
+    }
+    hbs = (pubnub_hbsched_t*)calloc(1, sizeof *hbs);
+    if (NULL == hbs) {
+        return NULL;
+    }
+    hbs->slots    = (struct hbsched_slot*)calloc(size, sizeof hbs->slots[0]);
+    hbs->idle     = (unsigned*)malloc(size * sizeof hbs->idle[0]);
+    hbs->starting = (struct hbsched_start*)malloc(size * sizeof hbs->starting[0]);
+    hbs->buckets  = (struct hbsched_entry**)calloc(HBSCHED_INITIAL_BUCKETS,
+                                                  sizeof hbs->buckets[0]);
+    hbs->heap     = (struct hbsched_entry**)malloc(HBSCHED_INITIAL_BUCKETS
+                                               * sizeof hbs->heap[0]);
+    if ((NULL == hbs->slots) || (NULL == hbs->idle) || (NULL == hbs->starting)
+        || (NULL == hbs->buckets) || (NULL == hbs->heap)) {
+        free(hbs->heap);
+        free(hbs->buckets);
+        free(hbs->starting);
+        free(hbs->idle);
+        free(hbs->slots);
+        free(hbs);
+        return NULL;
+    }
+    hbs->size         = size;
+    hbs->interval     = interval_ms;
+    hbs->url_budget   = PUBNUB_BUF_MAXLEN - PUBNUB_HBSCHED_URL_RESERVE;
+    hbs->bucket_count = HBSCHED_INITIAL_BUCKETS;
+    hbs->heap_cap     = HBSCHED_INITIAL_BUCKETS;
+    hbs->random       = (unsigned)time(NULL) ^ (unsigned)(size_t)hbs;
+    if (0 == hbs->random) {
+        hbs->random = 0x9e3779b9u;
+    }
+    pubnub_mutex_init(hbs->monitor);
+
+    for (i = 0; i < size; ++i) {
+        struct hbsched_slot* slot = &hbs->slots[i];
+        slot->hbs                 = hbs;
+        slot->pb                  = pubnub_alloc();
+        if (NULL == slot->pb) {
+            PUBNUB_LOG_ERROR("Failed to allocate context %u of %u for the "
+                             "heartbeat scheduler\n",
+                             i,
+                             size);
+            free_contexts(hbs, i);
+            free_scheduler(hbs);
+            return NULL;
+        }
+        pubnub_init(slot->pb, publish_key, subscribe_key);
+        pubnub_register_callback(slot->pb, hbsched_context_callback, slot);
+        /* So that the first context is the first one used */
+        hbs->idle[size - 1 - i] = i;
+    }
+    hbs->idle_count = size;
+
+    if (pbntf_add_ticker(hbsched_tick, hbs) != 0) {
+        PUBNUB_LOG_ERROR("Failed to add the ticker of the heartbeat scheduler\n");
+        free_contexts(hbs, size);
+        free_scheduler(hbs);
+        return NULL;
+    }
+
+    return hbs;
+}
+
+
+unsigned pubnub_hbsched_size(pubnub_hbsched_t const* hbs)
+{
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    return hbs->size;
+}
+
+
+pubnub_t* pubnub_hbsched_context(pubnub_hbsched_t* hbs, unsigned i)
+{
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    return (i < hbs->size) ? hbs->slots[i].pb : NULL;
+}
+
+
+/** Creates the entry for the @p uuid, with no channels, scheduling
+    its first heartbeat at a random time within the interval. Has to
+    be called with the scheduler locked.
+*/
+static struct hbsched_entry* add_entry(pubnub_hbsched_t* hbs, char const* uuid)
+{
+    size_t                len = strlen(uuid);
+    struct hbsched_entry* entry;
+
+    /* Entries whose heartbeat is being sent are not in the heap, but
+       are pushed back to it when it is done, so the heap has to have
+       room for all of them */
+    if (hbs->entry_count >= hbs->heap_cap) {
+        unsigned               cap  = hbs->heap_cap * 2;
+        struct hbsched_entry** heap = (struct hbsched_entry**)realloc(
+            hbs->heap, cap * sizeof heap[0]);
+        if (NULL == heap) {
+            return NULL;
+        }
+        hbs->heap     = heap;
+        hbs->heap_cap = cap;
+    }
+    entry = (struct hbsched_entry*)calloc(1, sizeof *entry + len);
+    if (NULL == entry) {
+        return NULL;
+    }
+    memcpy(entry->uuid, uuid, len + 1);
+    entry->len  = len;
+    entry->hash = pbhash_fnv1a(PBHASH_FNV1A_INIT, uuid, len);
+    entry->due  = hbs->now + random_below(hbs, hbs->interval);
+
+    if (hbs->entry_count >= hbs->bucket_count) {
+        grow_table(hbs);
+    }
+    entry->next = hbs->buckets[entry->hash & (hbs->bucket_count - 1)];
+    hbs->buckets[entry->hash & (hbs->bucket_count - 1)] = entry;
+    ++hbs->entry_count;
+    heap_push(hbs, entry);
+
+    return entry;
+}
+
+
+int pubnub_hbsched_add(pubnub_hbsched_t* hbs, char const* uuid, char const* channel)
+{
+    struct hbsched_entry* entry;
+    size_t                len;
+    size_t                url_len;
+    size_t                needed;
+    bool                  created = false;
+
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    PUBNUB_ASSERT_OPT(uuid != NULL);
+    PUBNUB_ASSERT_OPT(channel != NULL);
+
+    len = strlen(channel);
+    if ((0 == len) || (strchr(channel, ',') != NULL) || ('\0' == *uuid)) {
+        return -1;
+    }
+    url_len = pubnub_url_encoded_len(channel, len);
+
+    pubnub_mutex_lock(hbs->monitor);
+    if (hbs->stopping) {
+        pubnub_mutex_unlock(hbs->monitor);
+        return -1;
+    }
+    entry = find(hbs, uuid);
+    if (NULL == entry) {
+        entry = add_entry(hbs, uuid);
+        if (NULL == entry) {
+            pubnub_mutex_unlock(hbs->monitor);
+            return -1;
+        }
+        created = true;
+    }
+    else if (find_channel(entry, channel, len) >= 0) {
+        pubnub_mutex_unlock(hbs->monitor);
+        return 0;
+    }
+    needed = entry->channels_len + (created ? 0 : 1) + len;
+    if (entry->channels_url_len + (created ? 0 : 1) + url_len > hbs->url_budget) {
+        PUBNUB_LOG_ERROR("Heartbeat scheduler %p: channels of uuid='%s' would "
+                         "not fit in the URL\n",
+                         hbs,
+                         uuid);
+    }
+    else {
+        char* channels = (char*)realloc(entry->channels, needed + 1);
+        if (channels != NULL) {
+            if (!created) {
+                channels[entry->channels_len++] = ',';
+                ++entry->channels_url_len;
+            }
+            memcpy(channels + entry->channels_len, channel, len + 1);
+            entry->channels = channels;
+            entry->channels_len += len;
+            entry->channels_url_len += url_len;
+            pubnub_mutex_unlock(hbs->monitor);
+            return 0;
+        }
+    }
+    if (created) {
+        remove_entry(hbs, entry);
+    }
+    pubnub_mutex_unlock(hbs->monitor);
+
+    return -1;
+}
+
+
+int pubnub_hbsched_remove(pubnub_hbsched_t* hbs, char const* uuid, char const* channel)
+{
+    struct hbsched_entry* entry;
+    size_t                len;
+    long                  ofs;
+
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    PUBNUB_ASSERT_OPT(uuid != NULL);
+    PUBNUB_ASSERT_OPT(channel != NULL);
+
+    len = strlen(channel);
+    pubnub_mutex_lock(hbs->monitor);
+    entry = find(hbs, uuid);
+    ofs   = (NULL == entry) ? -1 : find_channel(entry, channel, len);
+    if (ofs < 0) {
+        pubnub_mutex_unlock(hbs->monitor);
+        return -1;
+    }
+    if (len == entry->channels_len) {
+        remove_entry(hbs, entry);
+    }
+    else {
+        /* Remove the channel with the comma after it, or, if it's the
+           last one, with the comma before it */
+        size_t from = (size_t)ofs;
+        size_t n    = len + 1;
+        if (from + len == entry->channels_len) {
+            --from;
+        }
+        memmove(entry->channels + from,
+                entry->channels + from + n,
+                entry->channels_len - from - n + 1);
+        entry->channels_len -= n;
+        entry->channels_url_len -= pubnub_url_encoded_len(channel, len) + 1;
+    }
+    pubnub_mutex_unlock(hbs->monitor);
+
+    return 0;
+}
+
+
+int pubnub_hbsched_remove_uuid(pubnub_hbsched_t* hbs, char const* uuid)
+{
+    struct hbsched_entry* entry;
+
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    PUBNUB_ASSERT_OPT(uuid != NULL);
+
+    pubnub_mutex_lock(hbs->monitor);
+    entry = find(hbs, uuid);
+    if (NULL == entry) {
+        pubnub_mutex_unlock(hbs->monitor);
+        return -1;
+    }
+    remove_entry(hbs, entry);
+    pubnub_mutex_unlock(hbs->monitor);
+
+    return 0;
+}
+
+
+int pubnub_hbsched_set_subscribed(pubnub_hbsched_t* hbs, char const* uuid, bool subscribed)
+{
+    struct hbsched_entry* entry;
+
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    PUBNUB_ASSERT_OPT(uuid != NULL);
+
+    pubnub_mutex_lock(hbs->monitor);
+    entry = find(hbs, uuid);
+    if (NULL == entry) {
+        pubnub_mutex_unlock(hbs->monitor);
+        return -1;
+    }
+    if (entry->subscribed && !subscribed
+        && (entry->heap_index != HBSCHED_NOT_IN_HEAP)) {
+        /* The long-poll kept it present until now */
+        reschedule(hbs, entry, hbs->now + hbs->interval);
+    }
+    entry->subscribed = subscribed;
+    pubnub_mutex_unlock(hbs->monitor);
+
+    return 0;
+}
+
+
+void pubnub_hbsched_get_metrics(pubnub_hbsched_t* hbs, struct pubnub_hbsched_metrics* metrics)
+{
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+    PUBNUB_ASSERT_OPT(metrics != NULL);
+
+    pubnub_mutex_lock(hbs->monitor);
+    *metrics       = hbs->metrics;
+    metrics->uuids = hbs->entry_count;
+    metrics->busy  = hbs->size - hbs->idle_count;
+    pubnub_mutex_unlock(hbs->monitor);
+}
+
+
+int pubnub_hbsched_destroy(pubnub_hbsched_t* hbs, unsigned millisec)
+{
+    pubnub_t** pbs;
+    unsigned   i;
+    int        rslt;
+
+    PUBNUB_ASSERT_OPT(hbs != NULL);
+
+    pubnub_mutex_lock(hbs->monitor);
+    hbs->stopping = true;
+    pubnub_mutex_unlock(hbs->monitor);
+
+    /* After this, no more heartbeats are started */
+    pbntf_remove_ticker(hbsched_tick, hbs);
+
+    pbs = (pubnub_t**)malloc(hbs->size * sizeof pbs[0]);
+    if (NULL == pbs) {
+        return -1;
+    }
+    for (i = 0; i < hbs->size; ++i) {
+        pbs[i] = hbs->slots[i].pb;
+    }
+    rslt = pubnub_free_all_with_timeout(pbs, hbs->size, millisec);
+    for (i = 0; i < hbs->size; ++i) {
+        /* The ones that were freed are NULL */
+        hbs->slots[i].pb = pbs[i];
+    }
+    free(pbs);
+    if (rslt != 0) {
+        PUBNUB_LOG_ERROR("Failed to free the contexts of the heartbeat "
+                         "scheduler %p\n",
+                         hbs);
+        return -1;
+    }
+    free_scheduler(hbs);
+
+    return 0;
+}
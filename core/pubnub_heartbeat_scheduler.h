@@ -0,0 +1,164 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_HEARTBEAT_SCHEDULER
+#define INC_PUBNUB_HEARTBEAT_SCHEDULER
+
+
+#include "pubnub_api_types.h"
+
+#include <stdbool.h>
+
+
+/** @file pubnub_heartbeat_scheduler.h
+
+    This module implements a presence heartbeat scheduler for the
+    callback interface - it keeps (many) UUIDs present on their
+    channels by sending their heartbeats, on a pool of Pubnub
+    contexts, owned by the scheduler, instead of each UUID having its
+    own context and timer.
+
+    The channels of a UUID are coalesced in one heartbeat (the UUID
+    is present on all of them). Heartbeats are sent every `interval`
+    (given on creation), but spread over it, to avoid a "thundering
+    herd" of requests: the first heartbeat of a UUID is sent at a
+    random time within the interval, and each next one a random
+    little bit (up to #PUBNUB_HBSCHED_JITTER_PERCENT of the interval)
+    before the interval has passed. If all the contexts are busy,
+    heartbeats that are due wait for one to become idle, the ones
+    due first are sent first.
+
+    While a UUID has a subscribe long-poll on its channels (which
+    keeps it present), its heartbeats are skipped, see
+    pubnub_hbsched_set_subscribed().
+
+    The scheduler is driven from the callback thread (so it is
+    available only on platforms which support the "ticker" in their
+    callback thread, for now, POSIX). Its functions may be called
+    from any thread, but pubnub_hbsched_destroy() must not be called
+    from a Pubnub context callback.
+*/
+
+
+/** How much (in percent of the interval) before the interval has
+    passed can the next heartbeat of a UUID be sent, at most.
+ */
+#if !defined PUBNUB_HBSCHED_JITTER_PERCENT
+#define PUBNUB_HBSCHED_JITTER_PERCENT 10
+#endif
+
+/** How much of the URL (#PUBNUB_BUF_MAXLEN) of a heartbeat to
+    reserve for everything but the channels: subscribe key, UUID,
+    auth key, etc.
+ */
+#if !defined PUBNUB_HBSCHED_URL_RESERVE
+#define PUBNUB_HBSCHED_URL_RESERVE 512
+#endif
+
+
+/** A heartbeat scheduler descriptor. An opaque data structure. */
+struct pubnub_heartbeat_scheduler;
+
+/** A helper typedef of a heartbeat scheduler descriptor */
+typedef struct pubnub_heartbeat_scheduler pubnub_hbsched_t;
+
+/** Heartbeat scheduler metrics, as returned by
+    pubnub_hbsched_get_metrics() */
+struct pubnub_hbsched_metrics {
+    /** Number of heartbeats successfully sent */
+    unsigned long sent;
+    /** Number of heartbeats that failed */
+    unsigned long failed;
+    /** Number of heartbeats skipped because the UUID was subscribed */
+    unsigned long skipped;
+    /** Number of UUIDs */
+    unsigned uuids;
+    /** Number of contexts currently sending a heartbeat */
+    unsigned busy;
+};
+
+
+/** Creates a heartbeat scheduler with a pool of @p size contexts, all
+    initialized with the given keys, which sends the heartbeat of
+    each UUID every @p interval_ms milliseconds.
+
+    To change other settings of the contexts (auth, proxy...), use
+    pubnub_hbsched_context().
+
+    @param publish_key The string of the key to use when publishing
+    @param subscribe_key The string of the key to use when subscribing
+    @param size Number of contexts in the pool, at least 1
+    @param interval_ms Heartbeat interval, should be less than the
+    presence timeout. At least 1.
+
+    @retval NULL Failed to create a scheduler
+    @result The scheduler created
+ */
+pubnub_hbsched_t* pubnub_hbsched_create(char const* publish_key,
+                                        char const* subscribe_key,
+                                        unsigned    size,
+                                        unsigned    interval_ms);
+
+/** Returns the number of contexts in the pool of the scheduler */
+unsigned pubnub_hbsched_size(pubnub_hbsched_t const* hbs);
+
+/** Returns the context with the index @p i in the pool of the
+    scheduler, so that its settings may be changed.
+
+    @warning Do not start transactions on the context, change its
+    callback or UUID. Do not free it, it's owned by the scheduler.
+
+    @retval NULL @p i out of range
+    @result The context
+*/
+pubnub_t* pubnub_hbsched_context(pubnub_hbsched_t* hbs, unsigned i);
+
+/** Makes the @p uuid present on the @p channel, that is, adds the @p
+    channel to the heartbeat of the @p uuid. If the @p uuid has no
+    channels yet, its heartbeats start.
+
+    @retval 0 OK (also if the @p uuid already was on the @p channel)
+    @retval -1 failed to allocate, or the channels of the @p uuid
+    would not fit in the URL of a heartbeat
+ */
+int pubnub_hbsched_add(pubnub_hbsched_t* hbs, char const* uuid, char const* channel);
+
+/** Removes the @p channel from the heartbeat of the @p uuid. If it
+    was the last channel of the @p uuid, its heartbeats stop.
+
+    @retval 0 OK
+    @retval -1 the @p uuid is not on the @p channel
+ */
+int pubnub_hbsched_remove(pubnub_hbsched_t* hbs, char const* uuid, char const* channel);
+
+/** Stops the heartbeats of the @p uuid, removing all its channels.
+
+    @retval 0 OK
+    @retval -1 there are no heartbeats for the @p uuid
+ */
+int pubnub_hbsched_remove_uuid(pubnub_hbsched_t* hbs, char const* uuid);
+
+/** Tells the scheduler if the @p uuid has a subscribe long-poll (on
+    all its channels) going on, or not. While it has, its heartbeats
+    are skipped, since the long-poll keeps it present. When it has no
+    more, the heartbeats resume an interval later.
+
+    @retval 0 OK
+    @retval -1 there are no heartbeats for the @p uuid
+ */
+int pubnub_hbsched_set_subscribed(pubnub_hbsched_t* hbs, char const* uuid, bool subscribed);
+
+/** Gets the current metrics of the scheduler @p hbs to @p metrics */
+void pubnub_hbsched_get_metrics(pubnub_hbsched_t* hbs, struct pubnub_hbsched_metrics* metrics);
+
+/** Destroys the scheduler. Heartbeats in progress are cancelled and
+    all the contexts are freed, waiting at most @p millisec for them.
+    The UUIDs are not made to leave their channels, they will time
+    out.
+
+    @retval 0 scheduler destroyed
+    @retval -1 failed to free some context(s) in due time, scheduler
+    can't be destroyed (it is "leaked")
+ */
+int pubnub_hbsched_destroy(pubnub_hbsched_t* hbs, unsigned millisec);
+
+
+#endif /* !defined INC_PUBNUB_HEARTBEAT_SCHEDULER */
@@ -71,6 +71,7 @@ char const* pubnub_res_2_string(enum pubnub_res e)
     case PNR_OBJECTS_API_INVALID_PARAM: return "Objects API invalid parameter";
     case PNR_OBJECTS_API_OK: return "Objects API transaction successfully finished";
     case PNR_OBJECTS_API_ERROR: return "Objects API transaction reported an error";
+    case PNR_QUEUE_FULL: return "Request queue is full";
     default: return "!?!?!";
     }
 }
@@ -118,6 +119,7 @@ enum pubnub_tribool pubnub_should_retry(enum pubnub_res e)
     case PNR_OBJECTS_API_INVALID_PARAM: return pbccFalse; /* Check and fix the error reported */
     case PNR_OBJECTS_API_OK: return pbccFalse;
     case PNR_OBJECTS_API_ERROR: return pbccFalse; /* Check the error reported */
+    case PNR_QUEUE_FULL: return pbccTrue; /* Once some requests are done */
     }
     return pbccFalse;
 }
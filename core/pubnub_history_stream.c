@@ -0,0 +1,450 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_HISTORY_STREAM
+#include "pubnub_history_stream.h"
+#include "pubnub_ccore.h"
+#include "pubnub_netcore.h"
+
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+struct pubnub_history_stream_options pubnub_history_stream_defopts(void)
+{
+    struct pubnub_history_stream_options rslt;
+
+    rslt.count           = 100;
+    rslt.reverse         = false;
+    rslt.start           = NULL;
+    rslt.end             = NULL;
+    rslt.include_token   = false;
+    rslt.paginate        = true;
+    rslt.max_message_len = PUBNUB_HISTORY_STREAM_MESSAGE_MAXLEN;
+
+    return rslt;
+}
+
+
+/** Copies the timetoken @p s to @p dst (of @p size), an empty string
+    if @p s is NULL.
+    @retval 0 copied
+    @retval -1 too long
+ */
+static int copy_timetoken(char* dst, size_t size, char const* s)
+{
+    size_t len = (NULL == s) ? 0 : strlen(s);
+    if (len >= size) {
+        return -1;
+    }
+    memcpy(dst, s, len);
+    dst[len] = '\0';
+    return 0;
+}
+
+
+static enum pubnub_res prep_page(pubnub_t* pb)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+    enum pubnub_res     rslt;
+
+    rslt = pbcc_history_prep(&pb->core,
+                             p->channel,
+                             p->count,
+                             p->include_token,
+                             pbccNotSet,
+                             p->reverse ? pbccTrue : pbccNotSet,
+                             p->next_start[0] ? p->next_start : NULL,
+                             p->end[0] ? p->end : NULL);
+    p->next_start[0] = '\0';
+#if PUBNUB_PROXY_API
+    /* The path to (re)use is the one we just prepared */
+    pb->proxy_saved_path_len = 0;
+#endif
+
+    return rslt;
+}
+
+
+static enum pubnub_res start_page(pubnub_t* pb)
+{
+    enum pubnub_res rslt = prep_page(pb);
+
+    if (PNR_STARTED == rslt) {
+        pb->hist_stream.running = 1;
+        pb->trans               = PBTT_HISTORY;
+        pb->core.last_result    = PNR_STARTED;
+        pbnc_fsm(pb);
+        rslt = pb->core.last_result;
+    }
+
+    return rslt;
+}
+
+
+enum pubnub_res pubnub_history_stream(pubnub_t*                            pb,
+                                      char const*                          channel,
+                                      struct pubnub_history_stream_options opt,
+                                      pubnub_history_stream_callback_t     cb,
+                                      void*                                user_data)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+    size_t              channel_len;
+    enum pubnub_res     rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(channel != NULL);
+    PUBNUB_ASSERT_OPT(cb != NULL);
+
+    channel_len = strlen(channel);
+    if ((0 == channel_len) || (channel_len > PUBNUB_HISTORY_STREAM_CHANNEL_MAXLEN)) {
+        return PNR_INVALID_CHANNEL;
+    }
+    if ((opt.count < 1) || (opt.count > 100) || (0 == opt.max_message_len)) {
+        return PNR_INVALID_PARAMETERS;
+    }
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    if ((0 != copy_timetoken(p->next_start, sizeof p->next_start, opt.start))
+        || (0 != copy_timetoken(p->end, sizeof p->end, opt.end))) {
+        p->next_start[0] = '\0';
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_INVALID_PARAMETERS;
+    }
+    if (opt.max_message_len + 1 > p->msg_max) {
+        char* msg = (char*)realloc(p->msg, opt.max_message_len + 1);
+        if (NULL == msg) {
+            p->next_start[0] = '\0';
+            pubnub_mutex_unlock(pb->monitor);
+            return PNR_REPLY_TOO_BIG;
+        }
+        p->msg = msg;
+    }
+    p->msg_max = opt.max_message_len + 1;
+    memcpy(p->channel, channel, channel_len + 1);
+    p->count         = opt.count;
+    p->reverse       = opt.reverse;
+    p->include_token = opt.include_token;
+    p->paginate      = opt.paginate;
+    p->cb            = cb;
+    p->user_data     = user_data;
+    p->stopped       = false;
+    p->message_count = 0;
+
+    rslt = start_page(pb);
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+enum pubnub_res pubnub_history_stream_next_page(pubnub_t* pb)
+{
+    enum pubnub_res rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    if ('\0' == pb->hist_stream.next_start[0]) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_INVALID_PARAMETERS;
+    }
+    rslt = start_page(pb);
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+bool pubnub_history_stream_has_more(pubnub_t* pb)
+{
+    bool rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    rslt = !pb->hist_stream.running && (pb->hist_stream.next_start[0] != '\0');
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+unsigned long pubnub_history_stream_message_count(pubnub_t* pb)
+{
+    unsigned long rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    rslt = pb->hist_stream.message_count;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+void pbhs_response_start(pubnub_t* pb)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+
+    p->streaming = p->running && (PBTT_HISTORY == pb->trans) && (200 == pb->http_code);
+#if PUBNUB_PROXY_API
+    /* The response of the proxy to establishing the tunnel */
+    if ((pbproxyHTTP_CONNECT == pb->proxy_type) && !pb->proxy_tunnel_established) {
+        p->streaming = 0;
+    }
+#endif
+    p->depth         = 0;
+    p->in_string     = false;
+    p->escape        = false;
+    p->top_index     = 0;
+    p->collecting    = false;
+    p->done          = false;
+    p->error         = PNR_OK;
+    p->page_messages = 0;
+    p->page_start[0] = '\0';
+    p->page_end[0]   = '\0';
+    p->msg_len       = 0;
+}
+
+
+static void message_read(pubnub_t* pb)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+    pubnub_chamebl_t    message;
+
+    while ((p->msg_len > 0) && ((unsigned char)p->msg[p->msg_len - 1] <= ' ')) {
+        --p->msg_len;
+    }
+    p->msg[p->msg_len] = '\0';
+    ++p->page_messages;
+    if (!p->stopped) {
+        message.ptr  = p->msg;
+        message.size = p->msg_len;
+        ++p->message_count;
+        if (p->cb(pb, message, p->user_data) != 0) {
+            PUBNUB_LOG_TRACE("pb=%p history stream stopped by the callback\n", pb);
+            p->stopped = true;
+        }
+    }
+    p->collecting = false;
+    p->msg_len    = 0;
+}
+
+
+/** Appends @p c to the timetoken of the page being read, if it is
+    one of them.
+ */
+static void timetoken_char(struct pbhs_stream* p, char c)
+{
+    char*  tt;
+    size_t len;
+
+    switch (p->top_index) {
+    case 1:
+        tt = p->page_start;
+        break;
+    case 2:
+        tt = p->page_end;
+        break;
+    default:
+        return;
+    }
+    if (('"' == c) || ((unsigned char)c <= ' ')) {
+        return;
+    }
+    len = strlen(tt);
+    if (len + 1 >= sizeof p->page_start) {
+        p->error = PNR_FORMAT_ERROR;
+        return;
+    }
+    tt[len]     = c;
+    tt[len + 1] = '\0';
+}
+
+
+/** Appends @p c to the message or timetoken being read, if any */
+static void element_char(pubnub_t* pb, char c)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+
+    if (p->collecting) {
+        if (p->msg_len + 1 >= p->msg_max) {
+            PUBNUB_LOG_ERROR("pb=%p history stream: message longer than %lu\n",
+                             pb,
+                             (unsigned long)(p->msg_max - 1));
+            p->error = PNR_REPLY_TOO_BIG;
+            return;
+        }
+        p->msg[p->msg_len++] = c;
+    }
+    else if (1 == p->depth) {
+        timetoken_char(p, c);
+    }
+}
+
+
+void pbhs_feed(pubnub_t* pb, char const* data, size_t len)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+    size_t              i;
+
+    for (i = 0; (i < len) && (PNR_OK == p->error); ++i) {
+        char const c     = data[i];
+        bool const space = (unsigned char)c <= ' ';
+
+        if (p->done) {
+            if (!space) {
+                p->error = PNR_FORMAT_ERROR;
+            }
+            continue;
+        }
+        if (p->in_string) {
+            if (p->escape) {
+                p->escape = false;
+            }
+            else if ('\\' == c) {
+                p->escape = true;
+            }
+            else if ('"' == c) {
+                p->in_string = false;
+            }
+            element_char(pb, c);
+            continue;
+        }
+        if (2 == p->depth) {
+            if ((',' == c) || (']' == c)) {
+                if (p->collecting) {
+                    message_read(pb);
+                }
+                else if (',' == c) {
+                    p->error = PNR_FORMAT_ERROR;
+                }
+                if (',' == c) {
+                    continue;
+                }
+            }
+            else if (!p->collecting && !space) {
+                p->collecting = true;
+            }
+        }
+        else if (1 == p->depth) {
+            if (',' == c) {
+                ++p->top_index;
+                continue;
+            }
+            if ((0 == p->top_index) && !space && (c != '[')) {
+                /* The messages should be an array */
+                p->error = PNR_FORMAT_ERROR;
+                continue;
+            }
+        }
+        else if ((0 == p->depth) && !space && (c != '[')) {
+            p->error = PNR_FORMAT_ERROR;
+            continue;
+        }
+
+        element_char(pb, c);
+        switch (c) {
+        case '"':
+            p->in_string = true;
+            break;
+        case '[':
+        case '{':
+            ++p->depth;
+            break;
+        case ']':
+        case '}':
+            if (0 == --p->depth) {
+                p->done = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+
+enum pubnub_res pbhs_page_result(pubnub_t* pb)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+
+    p->streaming = 0;
+    if (PNR_OK != p->error) {
+        return p->error;
+    }
+    if (!p->done || (p->top_index != 2)) {
+        return PNR_FORMAT_ERROR;
+    }
+    PUBNUB_LOG_TRACE("pb=%p history stream page: %d messages, %s - %s\n",
+                     pb,
+                     p->page_messages,
+                     p->page_start,
+                     p->page_end);
+    if (!p->stopped && (p->page_messages >= p->count)) {
+        char const* next = p->reverse ? p->page_end : p->page_start;
+        if ((next[0] != '\0') && (strcmp(next, "0") != 0)) {
+            strcpy(p->next_start, next);
+        }
+    }
+
+    return PNR_OK;
+}
+
+
+enum pbhs_next pbhs_response(pubnub_t* pb, enum pubnub_res pbres)
+{
+    struct pbhs_stream* p = &pb->hist_stream;
+
+    if (!p->running) {
+        return pbhsNotStreaming;
+    }
+    if ((PNR_OK != pbres) || (p->stopped)) {
+        p->next_start[0] = '\0';
+        return pbhsDone;
+    }
+    if (!p->paginate || ('\0' == p->next_start[0])) {
+        return pbhsDone;
+    }
+#if PUBNUB_NEED_RETRY_AFTER_CLOSE
+    if (pb->flags.should_close) {
+        return (PNR_STARTED == prep_page(pb)) ? pbhsRetry : pbhsDone;
+    }
+#else
+    if (pb->flags.should_close) {
+        /* The user can go on with pubnub_history_stream_next_page() */
+        return pbhsDone;
+    }
+#endif
+    return (PNR_STARTED == prep_page(pb)) ? pbhsSendNext : pbhsDone;
+}
+
+
+void pbhs_trans_outcome(pubnub_t* pb)
+{
+    pb->hist_stream.running   = 0;
+    pb->hist_stream.streaming = 0;
+}
+
+
+void pbhs_free(pubnub_t* pb)
+{
+    free(pb->hist_stream.msg);
+    pb->hist_stream.msg     = NULL;
+    pb->hist_stream.msg_max = 0;
+}
+
+#endif /* PUBNUB_USE_HISTORY_STREAM */
@@ -0,0 +1,167 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_HISTORY_STREAM
+#define INC_PUBNUB_HISTORY_STREAM
+
+
+#include "pubnub_api_types.h"
+#include "pubnub_memory_block.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/** @file pubnub_history_stream.h
+
+    This is the API for reading the history of a channel as a stream
+    of messages. The response is parsed as it is received and each
+    message is given to the user's callback as soon as it was read,
+    instead of putting the whole response in the reply buffer of the
+    context. So, the size of a page of history is not limited by the
+    reply buffer (nor does it make it grow), only the size of a
+    message is limited.
+
+    Pages are requested one after the other, by timetoken, until all
+    the messages (between the `start` and `end` timetokens, if given)
+    were read, in one transaction. So, the whole history of a channel
+    can be read with memory bounded by the size of a message.
+    Alternatively, a transaction can read just one page, and the next
+    one is read with pubnub_history_stream_next_page(), like with an
+    iterator.
+
+    Basic usage:
+
+        static int on_message(pubnub_t* pb, pubnub_chamebl_t message, void* user_data)
+        {
+            fwrite(message.ptr, 1, message.size, (FILE*)user_data);
+            fputc('\n', (FILE*)user_data);
+            return 0;
+        }
+
+        struct pubnub_history_stream_options opt = pubnub_history_stream_defopts();
+        pbresult = pubnub_history_stream(pb, "my_channel", opt, on_message, file);
+        if (PNR_STARTED == pbresult) {
+            pbresult = pubnub_await(pb);
+        }
+*/
+
+
+/** Default maximum length of a message in the history stream, that
+    is, of its JSON. Messages of up to 32KB can be published, and
+    JSON escaping adds a few bytes.
+ */
+#if !defined PUBNUB_HISTORY_STREAM_MESSAGE_MAXLEN
+#define PUBNUB_HISTORY_STREAM_MESSAGE_MAXLEN 40000
+#endif
+
+/** Maximum length of the name of the channel of a history stream */
+#define PUBNUB_HISTORY_STREAM_CHANNEL_MAXLEN 92
+
+
+/** Prototype of the function which is given the messages of the
+    history stream, one by one, as they are read.
+
+    @param pb The context of the history stream
+    @param message The JSON of the message. With `include_token`, it
+    is an object with the message and its timetoken. It is NUL
+    terminated, but it is valid only during the call.
+    @param user_data The data given to pubnub_history_stream()
+    @retval 0 continue the stream
+    @retval other stop the stream: no more messages are given to the
+    callback and no more pages are requested
+
+    @note Called with the context locked, so, don't call Pubnub
+    functions on @p pb from it, nor do anything "long" in it.
+*/
+typedef int (*pubnub_history_stream_callback_t)(pubnub_t*        pb,
+                                                pubnub_chamebl_t message,
+                                                void*            user_data);
+
+
+/** Options for the history stream */
+struct pubnub_history_stream_options {
+    /** The maximum number of messages per page (response). Has to
+        be between 1 and 100. Default is 100.
+     */
+    int count;
+    /** Direction of time traversal. If false (default), pages are
+        read from the newest to the oldest. In any case, messages in
+        a page are from the oldest to the newest.
+     */
+    bool reverse;
+    /** If not NULL, the timetoken to start from (exclusive). Default
+        is NULL, which means now (or the beginning, if @c reverse).
+     */
+    char const* start;
+    /** If not NULL, the timetoken to end at (inclusive). Default is
+        NULL, no end.
+     */
+    char const* end;
+    /** If true, each message is given with its timetoken. Default is
+        false.
+     */
+    bool include_token;
+    /** If true (default), pages are requested one after the other
+        until all the messages were read. If false, a transaction
+        reads only one page, call pubnub_history_stream_next_page()
+        to read the next one.
+     */
+    bool paginate;
+    /** Maximum length of a message (its JSON). A longer one ends the
+        transaction with #PNR_REPLY_TOO_BIG. Default is
+        #PUBNUB_HISTORY_STREAM_MESSAGE_MAXLEN.
+     */
+    size_t max_message_len;
+};
+
+
+/** This returns the default options for the history stream. It's
+    best to always call it to initialize the
+    #pubnub_history_stream_options, since it has several parameters.
+ */
+struct pubnub_history_stream_options pubnub_history_stream_defopts(void);
+
+/** Starts reading the history of the @p channel as a stream, giving
+    the messages, as they are read, to the callback @p cb (with @p
+    user_data). The outcome of the transaction is #PNR_OK when all
+    the pages (or the one page, if not paginating) were read.
+
+    The message buffer of the stream (of @p opt.max_message_len) is
+    allocated the first time it is needed, and is kept (and reused)
+    until the context is freed.
+
+    @param pb The Pubnub context. Can't be NULL.
+    @param channel The channel to read the history of. Can't be NULL.
+    @param opt Options of the history stream
+    @param cb The function to give the messages to. Can't be NULL.
+    @param user_data Data to give to @p cb
+    @return #PNR_STARTED on success, an error otherwise
+*/
+enum pubnub_res pubnub_history_stream(pubnub_t*                            pb,
+                                      char const*                          channel,
+                                      struct pubnub_history_stream_options opt,
+                                      pubnub_history_stream_callback_t     cb,
+                                      void*                                user_data);
+
+/** Starts reading the next page of the history stream on @p pb, if
+    there is one (the stream was not paginating, or the connection
+    was closed and couldn't be re-established).
+
+    @retval PNR_STARTED reading of the next page started
+    @retval PNR_INVALID_PARAMETERS there is no next page
+    @retval PNR_IN_PROGRESS a transaction is in progress on @p pb
+ */
+enum pubnub_res pubnub_history_stream_next_page(pubnub_t* pb);
+
+/** Returns if there are more pages of the history stream on @p pb to
+    read, with pubnub_history_stream_next_page().
+ */
+bool pubnub_history_stream_has_more(pubnub_t* pb);
+
+/** Returns the number of messages given to the callback by the
+    history stream on @p pb, since it was started with
+    pubnub_history_stream().
+ */
+unsigned long pubnub_history_stream_message_count(pubnub_t* pb);
+
+
+#endif /* !defined INC_PUBNUB_HISTORY_STREAM */
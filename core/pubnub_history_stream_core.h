@@ -0,0 +1,130 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_HISTORY_STREAM_CORE
+#define INC_PUBNUB_HISTORY_STREAM_CORE
+
+
+/** @file pubnub_history_stream_core.h
+
+    This is the internal part of the history stream module - the data
+    kept in the context and the functions the Pubnub "net-core" FSM
+    uses to feed the response to the stream parser and to request the
+    next page.
+ */
+
+#if PUBNUB_USE_HISTORY_STREAM
+
+#include "pubnub_history_stream.h"
+
+#include <stdbool.h>
+
+
+/** The history stream data of a context.
+
+    The response is `[[msg1,msg2,...],start,end]`. The parser tracks
+    the nesting @c depth (outside of JSON strings) and collects the
+    elements at depth 2 (the messages) in @c msg, and the ones at
+    depth 1 after the first (the timetokens) in @c page_start and @c
+    page_end.
+*/
+struct pbhs_stream {
+    /** Non-zero while a history stream transaction is going on */
+    int running;
+    /** Non-zero while the response being read is given to the
+        parser, instead of being put in the reply buffer.
+     */
+    int streaming;
+    pubnub_history_stream_callback_t cb;
+    void*                            user_data;
+    char channel[PUBNUB_HISTORY_STREAM_CHANNEL_MAXLEN + 1];
+    char end[20];
+    int  count;
+    bool reverse;
+    bool include_token;
+    bool paginate;
+    /** Timetoken to start the next page from, empty if none */
+    char next_start[20];
+    /** The user's callback asked to stop */
+    bool stopped;
+    /** Number of messages given to the callback since the stream
+        was started */
+    unsigned long message_count;
+
+    /* The parser of the current page */
+    unsigned depth;
+    bool     in_string;
+    bool     escape;
+    /** Index of the current element of the outer array */
+    unsigned top_index;
+    /** Collecting a message in @c msg */
+    bool collecting;
+    /** The outer array was closed */
+    bool done;
+    /** Outcome of the parsing, if it failed */
+    enum pubnub_res error;
+    /** Number of messages in the current page */
+    int  page_messages;
+    char page_start[20];
+    char page_end[20];
+
+    /** The message being collected, allocated */
+    char*  msg;
+    size_t msg_len;
+    size_t msg_max;
+};
+
+
+/** What should the "net-core" FSM do after a response was read */
+enum pbhs_next {
+    /** There is no history stream, finish the transaction as usual */
+    pbhsNotStreaming,
+    /** Send the request (for the next page) which was prepared in
+        the HTTP buffer */
+    pbhsSendNext,
+    /** The request prepared in the HTTP buffer should be sent on a
+        new connection (as this one is getting closed).
+     */
+    pbhsRetry,
+    /** Stream is done, finish the transaction as usual */
+    pbhsDone
+};
+
+/** Called when the status line of a response was read on the context
+    @p pb, to start (or not) streaming its body to the parser.
+ */
+void pbhs_response_start(pubnub_t* pb);
+
+/** Gives the @p len bytes of the body of the response at @p data to
+    the parser of the history stream on the context @p pb.
+ */
+void pbhs_feed(pubnub_t* pb, char const* data, size_t len);
+
+/** Called when the body of the response was read, returns the
+    outcome of parsing it.
+ */
+enum pubnub_res pbhs_page_result(pubnub_t* pb);
+
+/** Called when a response was read (with the outcome @p pbres) on
+    the context @p pb. If there is a next page to read, prepares its
+    request.
+ */
+enum pbhs_next pbhs_response(pubnub_t* pb, enum pubnub_res pbres);
+
+/** Called on the outcome of the transaction on context @p pb */
+void pbhs_trans_outcome(pubnub_t* pb);
+
+/** Frees the message buffer of the history stream of the context @p pb */
+void pbhs_free(pubnub_t* pb);
+
+#define PBHS_STREAMING(pb) ((pb)->hist_stream.streaming)
+#define PBHS_TRANS_OUTCOME(pb) pbhs_trans_outcome(pb)
+#define PBHS_FREE(pb) pbhs_free(pb)
+
+#else
+
+#define PBHS_STREAMING(pb) 0
+#define PBHS_TRANS_OUTCOME(pb)
+#define PBHS_FREE(pb)
+
+#endif /* PUBNUB_USE_HISTORY_STREAM */
+
+#endif /* !defined INC_PUBNUB_HISTORY_STREAM_CORE */
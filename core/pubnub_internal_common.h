@@ -47,6 +47,42 @@
 #define PUBNUB_USE_OBJECTS_API 0
 #endif
 
+#if !defined(PUBNUB_USE_PUBLISH_PIPELINE)
+#define PUBNUB_USE_PUBLISH_PIPELINE 0
+#endif
+
+#if !defined(PUBNUB_USE_REPLY_INDEX)
+#define PUBNUB_USE_REPLY_INDEX 0
+#endif
+
+#if !defined(PUBNUB_USE_URL_CACHE)
+#define PUBNUB_USE_URL_CACHE 0
+#endif
+
+#if !defined(PUBNUB_USE_REQUEST_BODY)
+#define PUBNUB_USE_REQUEST_BODY 0
+#endif
+
+#if !defined(PUBNUB_USE_JSON_WRITER)
+#define PUBNUB_USE_JSON_WRITER 0
+#endif
+
+#if !defined(PUBNUB_USE_HISTORY_STREAM)
+#define PUBNUB_USE_HISTORY_STREAM 0
+#endif
+
+#if !defined(PUBNUB_USE_OBJECTS_CACHE)
+#define PUBNUB_USE_OBJECTS_CACHE 0
+#endif
+
+#if !defined(PUBNUB_USE_SYNC_POLL)
+#define PUBNUB_USE_SYNC_POLL 0
+#endif
+
+#if !defined(PUBNUB_USE_FREE_NOTIFY)
+#define PUBNUB_USE_FREE_NOTIFY 0
+#endif
+
 #if !defined(PUBNUB_PROXY_API)
 #define PUBNUB_PROXY_API 0
 #elif PUBNUB_PROXY_API
@@ -70,6 +106,12 @@
 #include "core/pbgzip_decompress.h"
 #endif
 
+#include "core/pubnub_publish_pipeline_core.h"
+#include "core/pubnub_history_stream_core.h"
+#include "core/pubnub_objects_cache_core.h"
+#include "core/pubnub_free_notify.h"
+#include "core/pbscratch_pool.h"
+
 #include <stdint.h>
 #if PUBNUB_ADVANCED_KEEP_ALIVE
 #include <time.h>
@@ -209,6 +251,12 @@ struct pubnub_flags {
         renewed without losing transaction at hand.
      */
     bool started_while_kept_alive : 1;
+#if PUBNUB_USE_SYNC_POLL && !defined(PUBNUB_CALLBACK_API)
+    /** Indicates whether pubnub_await() is waiting for I/O on the
+        socket, with the context unlocked (true:yes, false:no).
+     */
+    bool waiting_io : 1;
+#endif
 };
 
 #if PUBNUB_CHANGE_DNS_SERVERS
@@ -249,6 +297,16 @@ struct pubnub_multi_addresses {
 #endif /* PUBNUB_USE_MULTIPLE_ADDRESSES */
 
 
+#if defined(PUBNUB_CALLBACK_API)
+/** A link in the (intrusive) queue of contexts to be processed by the
+    callback notifier, see pbpal_ntf_callback_queue.h
+ */
+struct pbntf_queue_node {
+    struct pbntf_queue_node* next;
+};
+#endif /* defined(PUBNUB_CALLBACK_API) */
+
+
 /** The Pubnub context
 
     @note Don't declare any members as `bool`, as there may be
@@ -360,6 +418,13 @@ struct pubnub_ {
     pubnub_callback_t cb;
     void*             user_data;
 
+    /** Link of this context in the queue of contexts to process */
+    struct pbntf_queue_node ntf_node;
+    /** If this context is in the queue of contexts to process, one
+        of `PBNTF_QUEUE_xxx` values. Accessed atomically.
+     */
+    long ntf_queued;
+
 #if PUBNUB_CHANGE_DNS_SERVERS
     struct pbdns_servers_check dns_check;
 #endif    
@@ -367,6 +432,21 @@ struct pubnub_ {
     struct pubnub_multi_addresses spare_addresses;
 #endif
 #endif /* defined(PUBNUB_CALLBACK_API) */
+
+#if PUBNUB_USE_PUBLISH_PIPELINE
+    /** The publish pipeline (queue) of this context */
+    struct pbpipe_publish pipeline;
+#endif
+
+#if PUBNUB_USE_HISTORY_STREAM
+    /** The history stream of this context */
+    struct pbhs_stream hist_stream;
+#endif
+
+#if PUBNUB_USE_OBJECTS_CACHE
+    /** The Objects API response cache data of this context */
+    struct pbobjc_context objc;
+#endif
     
 #if PUBNUB_PROXY_API
 
@@ -404,7 +484,11 @@ struct pubnub_ {
 
     /** The saved path part of the URL for the Pubnub transaction.
      */
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    char* proxy_saved_path;
+#else
     char proxy_saved_path[PUBNUB_BUF_MAXLEN];
+#endif
 
     /** The length, in characters, of the saved proxy path */
     unsigned proxy_saved_path_len;
@@ -477,6 +561,28 @@ int pbntf_requeue_for_processing(pubnub_t* pb);
 int pbntf_watch_in_events(pubnub_t* pb);
 int pbntf_watch_out_events(pubnub_t* pb);
 
+#if defined(PUBNUB_CALLBACK_API)
+/** A function called periodically from the callback thread, with
+    the @p data given when it was added and the number of
+    milliseconds @p elapsed since the previous call.
+*/
+typedef void (*pbntf_ticker_t)(void* data, int elapsed);
+
+/** Internal function. Starts calling @p tick (with @p data) from the
+    callback thread, about as often as the transaction timers are
+    checked. Not available on all platforms.
+    @retval 0 OK
+    @retval -1 too many tickers
+*/
+int pbntf_add_ticker(pbntf_ticker_t tick, void* data);
+
+/** Internal function. Stops calling @p tick with @p data. When it
+    returns, @p tick is not being called (nor will it be) with @p
+    data, so, it must not be called from the @p tick itself.
+*/
+void pbntf_remove_ticker(pbntf_ticker_t tick, void* data);
+#endif /* defined(PUBNUB_CALLBACK_API) */
+
 
 /** Internal function. Checks if the given pubnub context pointer
     is valid.
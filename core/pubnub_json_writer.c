@@ -0,0 +1,370 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_JSON_WRITER
+#include "pubnub_json_writer.h"
+#include "pbpublish_adaptive.h"
+
+#include "pubnub_netcore.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+
+#define LEVEL_BIT(w) ((uint32_t)1 << ((w)->depth - 1))
+
+
+static bool url_safe(unsigned char c)
+{
+    return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'))
+           || ((c >= '0') && (c <= '9'))
+           || ((c != '\0') && (strchr("-_.~,=:;@[]", c) != NULL));
+}
+
+
+static void put(struct pubnub_json_writer* w, char const* s, size_t n)
+{
+    size_t i;
+
+    if (w->result != PNR_OK) {
+        return;
+    }
+    if (n >= w->size - w->len) {
+        w->result = PNR_TX_BUFF_TOO_SMALL;
+        return;
+    }
+    for (i = 0; i < n; ++i) {
+        char c = s[i];
+        if (!url_safe((unsigned char)c)) {
+            ++w->url_unsafe;
+        }
+        w->buf[w->len + i] = c;
+    }
+    w->len += n;
+    w->buf[w->len] = '\0';
+}
+
+
+static void put_escaped(struct pubnub_json_writer* w, char const* s, size_t n)
+{
+    size_t i = 0;
+
+    put(w, "\"", 1);
+    while ((i < n) && (PNR_OK == w->result)) {
+        size_t run = 0;
+        char   esc[7];
+
+        while ((i + run < n) && ((unsigned char)s[i + run] >= 0x20) && (s[i + run] != '"')
+               && (s[i + run] != '\\')) {
+            ++run;
+        }
+        put(w, s + i, run);
+        i += run;
+        if (i == n) {
+            break;
+        }
+        switch (s[i]) {
+        case '"':
+        case '\\':
+            esc[0] = '\\';
+            esc[1] = s[i];
+            put(w, esc, 2);
+            break;
+        case '\b':
+            put(w, "\\b", 2);
+            break;
+        case '\f':
+            put(w, "\\f", 2);
+            break;
+        case '\n':
+            put(w, "\\n", 2);
+            break;
+        case '\r':
+            put(w, "\\r", 2);
+            break;
+        case '\t':
+            put(w, "\\t", 2);
+            break;
+        default:
+            snprintf(esc, sizeof esc, "\\u%04x", (unsigned char)s[i]);
+            put(w, esc, 6);
+            break;
+        }
+        ++i;
+    }
+    put(w, "\"", 1);
+}
+
+
+/** Prepares for writing a value: checks that a value may be written
+    and puts the comma before it, if needed.
+ */
+static bool before_value(struct pubnub_json_writer* w)
+{
+    if (w->result != PNR_OK) {
+        return false;
+    }
+    if (0 == w->depth) {
+        if (w->len > 0) {
+            w->result = PNR_INVALID_PARAMETERS;
+            return false;
+        }
+        return true;
+    }
+    if (w->is_object & LEVEL_BIT(w)) {
+        if (!w->after_key) {
+            w->result = PNR_INVALID_PARAMETERS;
+            return false;
+        }
+        w->after_key = false;
+        return true;
+    }
+    if (w->has_element & LEVEL_BIT(w)) {
+        put(w, ",", 1);
+    }
+    w->has_element |= LEVEL_BIT(w);
+
+    return PNR_OK == w->result;
+}
+
+
+static void begin(struct pubnub_json_writer* w, char const* open, bool object)
+{
+    if (!before_value(w)) {
+        return;
+    }
+    if (w->depth >= PUBNUB_JSON_WRITER_MAX_DEPTH) {
+        w->result = PNR_INVALID_PARAMETERS;
+        return;
+    }
+    put(w, open, 1);
+    ++w->depth;
+    if (object) {
+        w->is_object |= LEVEL_BIT(w);
+    }
+    else {
+        w->is_object &= ~LEVEL_BIT(w);
+    }
+    w->has_element &= ~LEVEL_BIT(w);
+}
+
+
+static void end(struct pubnub_json_writer* w, char const* close, bool object)
+{
+    if (w->result != PNR_OK) {
+        return;
+    }
+    if ((0 == w->depth) || (((w->is_object & LEVEL_BIT(w)) != 0) != object) || w->after_key) {
+        w->result = PNR_INVALID_PARAMETERS;
+        return;
+    }
+    put(w, close, 1);
+    --w->depth;
+}
+
+
+void pubnub_jw_init(struct pubnub_json_writer* w, char* buf, size_t size)
+{
+    PUBNUB_ASSERT_OPT(w != NULL);
+    PUBNUB_ASSERT_OPT(buf != NULL);
+    PUBNUB_ASSERT_OPT(size > 0);
+
+    w->buf         = buf;
+    w->size        = size;
+    w->len         = 0;
+    w->url_unsafe  = 0;
+    w->is_object   = 0;
+    w->has_element = 0;
+    w->depth       = 0;
+    w->after_key   = false;
+    w->result      = PNR_OK;
+    buf[0]         = '\0';
+}
+
+
+void pubnub_jw_begin_object(struct pubnub_json_writer* w)
+{
+    begin(w, "{", true);
+}
+
+
+void pubnub_jw_end_object(struct pubnub_json_writer* w)
+{
+    end(w, "}", true);
+}
+
+
+void pubnub_jw_begin_array(struct pubnub_json_writer* w)
+{
+    begin(w, "[", false);
+}
+
+
+void pubnub_jw_end_array(struct pubnub_json_writer* w)
+{
+    end(w, "]", false);
+}
+
+
+void pubnub_jw_key(struct pubnub_json_writer* w, char const* key)
+{
+    PUBNUB_ASSERT_OPT(key != NULL);
+
+    if (w->result != PNR_OK) {
+        return;
+    }
+    if ((0 == w->depth) || !(w->is_object & LEVEL_BIT(w)) || w->after_key) {
+        w->result = PNR_INVALID_PARAMETERS;
+        return;
+    }
+    if (w->has_element & LEVEL_BIT(w)) {
+        put(w, ",", 1);
+    }
+    w->has_element |= LEVEL_BIT(w);
+    put_escaped(w, key, strlen(key));
+    put(w, ":", 1);
+    w->after_key = true;
+}
+
+
+void pubnub_jw_string(struct pubnub_json_writer* w, char const* s)
+{
+    PUBNUB_ASSERT_OPT(s != NULL);
+    pubnub_jw_string_n(w, s, strlen(s));
+}
+
+
+void pubnub_jw_string_n(struct pubnub_json_writer* w, char const* s, size_t len)
+{
+    PUBNUB_ASSERT_OPT((s != NULL) || (0 == len));
+    if (before_value(w)) {
+        put_escaped(w, s, len);
+    }
+}
+
+
+void pubnub_jw_int(struct pubnub_json_writer* w, long i)
+{
+    char num[24];
+    int  n = snprintf(num, sizeof num, "%ld", i);
+    if (before_value(w)) {
+        put(w, num, n);
+    }
+}
+
+
+void pubnub_jw_double(struct pubnub_json_writer* w, double d)
+{
+    char num[32];
+    int  n;
+
+    if (!isfinite(d)) {
+        pubnub_jw_null(w);
+        return;
+    }
+    n = snprintf(num, sizeof num, "%.17g", d);
+    if (before_value(w)) {
+        put(w, num, n);
+    }
+}
+
+
+void pubnub_jw_bool(struct pubnub_json_writer* w, bool b)
+{
+    if (before_value(w)) {
+        if (b) {
+            put(w, "true", 4);
+        }
+        else {
+            put(w, "false", 5);
+        }
+    }
+}
+
+
+void pubnub_jw_null(struct pubnub_json_writer* w)
+{
+    if (before_value(w)) {
+        put(w, "null", 4);
+    }
+}
+
+
+void pubnub_jw_raw(struct pubnub_json_writer* w, char const* json)
+{
+    PUBNUB_ASSERT_OPT(json != NULL);
+    if (before_value(w)) {
+        put(w, json, strlen(json));
+    }
+}
+
+
+enum pubnub_res pubnub_jw_result(struct pubnub_json_writer const* w)
+{
+    PUBNUB_ASSERT_OPT(w != NULL);
+
+    if (w->result != PNR_OK) {
+        return w->result;
+    }
+    if ((w->depth != 0) || w->after_key || (0 == w->len)) {
+        return PNR_INVALID_PARAMETERS;
+    }
+    return PNR_OK;
+}
+
+
+char const* pubnub_jw_str(struct pubnub_json_writer const* w)
+{
+    PUBNUB_ASSERT_OPT(w != NULL);
+    return w->buf;
+}
+
+
+size_t pubnub_jw_len(struct pubnub_json_writer const* w)
+{
+    PUBNUB_ASSERT_OPT(w != NULL);
+    return w->len;
+}
+
+
+enum pubnub_res pubnub_publish_json(pubnub_t*                        pb,
+                                    char const*                      channel,
+                                    struct pubnub_json_writer const* message,
+                                    struct pubnub_publish_options    opts)
+{
+    enum pubnub_res rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(message != NULL);
+
+    rslt = pubnub_jw_result(message);
+    if (rslt != PNR_OK) {
+        PUBNUB_LOG_ERROR("pubnub_publish_json(pb=%p): the message is not valid: %d\n",
+                         pb,
+                         rslt);
+        return rslt;
+    }
+    if (opts.cipher_key != NULL) {
+        /* The message is encrypted to the context anyway, and the
+           method (if adaptive) is chosen for the encrypted message */
+        return pubnub_publish_ex(pb, channel, message->buf, opts);
+    }
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    /* The writer knows the length and the URL unsafe characters, so
+       the message doesn't have to be scanned to choose the method */
+    rslt = pbpublish_start(
+        pb, channel, message->buf, message->len, message->url_unsafe, opts, true);
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+#endif /* PUBNUB_USE_JSON_WRITER */
@@ -0,0 +1,174 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_JSON_WRITER
+#define INC_PUBNUB_JSON_WRITER
+
+
+#include "pubnub_api_types.h"
+#include "pubnub_coreapi_ex.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/** @file pubnub_json_writer.h
+
+    A small streaming JSON writer, to build a message (or `meta`) to
+    publish without formatting it into a temporary buffer with
+    `snprintf()`. The JSON is written directly into a buffer given
+    by the user (which may be static, or on the stack), escaping the
+    strings as needed and putting the commas and colons between the
+    elements. It never allocates.
+
+    The writer keeps the length of the JSON and the number of
+    characters in it that would have to be URL encoded. So, the
+    message can be published with pubnub_publish_json() without
+    measuring it again, and via POST, it is sent directly from the
+    buffer of the writer, without copying it to the context.
+
+    Errors are "sticky": if the buffer is too small, or the elements
+    are not well nested, the rest of the writes are ignored and the
+    error is reported by pubnub_jw_result() (and
+    pubnub_publish_json()). So, there is no need to check each write.
+    After an error, the buffer has (the start of) the JSON written
+    before it, still NUL terminated.
+
+        char                      buf[200];
+        struct pubnub_json_writer w;
+        pubnub_jw_init(&w, buf, sizeof buf);
+        pubnub_jw_begin_object(&w);
+        pubnub_jw_key(&w, "text");
+        pubnub_jw_string(&w, text);
+        pubnub_jw_key(&w, "count");
+        pubnub_jw_int(&w, count);
+        pubnub_jw_end_object(&w);
+        pbresult = pubnub_publish_json(pn, "my_channel", &w, pubnub_publish_defopts());
+*/
+
+
+#if !defined PUBNUB_JSON_WRITER_MAX_DEPTH
+/** Maximum nesting of objects and arrays in a writer. Can't be more
+    than 32. */
+#define PUBNUB_JSON_WRITER_MAX_DEPTH 32
+#endif
+
+
+/** A JSON writer. Treat as opaque, use the functions to get its
+    contents. */
+struct pubnub_json_writer {
+    /** The buffer written to */
+    char* buf;
+    /** The size of @p buf, including the NUL terminator */
+    size_t size;
+    /** The length of the JSON written so far */
+    size_t len;
+    /** Number of characters in the JSON which are URL encoded */
+    size_t url_unsafe;
+    /** Bit per nesting level: set if the object (array) is an
+        object, not an array */
+    uint32_t is_object;
+    /** Bit per nesting level: set if the object (array) has an
+        element, so the next one has to be preceded by a comma */
+    uint32_t has_element;
+    /** Current nesting level, 0 for the top level */
+    unsigned depth;
+    /** In an object, a key was written, now its value is expected */
+    bool after_key;
+    /** The outcome of the writes so far */
+    enum pubnub_res result;
+};
+
+
+/** Initializes the writer @p w to write to the @p size bytes at @p
+    buf. The JSON is kept NUL terminated, so @p size has to be at least
+    1.
+ */
+void pubnub_jw_init(struct pubnub_json_writer* w, char* buf, size_t size);
+
+/** Starts an object (`{`) */
+void pubnub_jw_begin_object(struct pubnub_json_writer* w);
+
+/** Ends the current object (`}`) */
+void pubnub_jw_end_object(struct pubnub_json_writer* w);
+
+/** Starts an array (`[`) */
+void pubnub_jw_begin_array(struct pubnub_json_writer* w);
+
+/** Ends the current array (`]`) */
+void pubnub_jw_end_array(struct pubnub_json_writer* w);
+
+/** Writes the (NUL terminated) @p key of the next element of the
+    current object, escaped as needed.
+ */
+void pubnub_jw_key(struct pubnub_json_writer* w, char const* key);
+
+/** Writes the NUL terminated (UTF-8) string @p s, escaped as needed */
+void pubnub_jw_string(struct pubnub_json_writer* w, char const* s);
+
+/** Writes the @p len bytes at @p s as a string, escaped as needed.
+    @p s doesn't have to be NUL terminated.
+ */
+void pubnub_jw_string_n(struct pubnub_json_writer* w, char const* s, size_t len);
+
+/** Writes the integer @p i */
+void pubnub_jw_int(struct pubnub_json_writer* w, long i);
+
+/** Writes the number @p d. As JSON has no infinities or NaNs, they
+    are written as `null`.
+ */
+void pubnub_jw_double(struct pubnub_json_writer* w, double d);
+
+/** Writes `true` or `false` */
+void pubnub_jw_bool(struct pubnub_json_writer* w, bool b);
+
+/** Writes `null` */
+void pubnub_jw_null(struct pubnub_json_writer* w);
+
+/** Writes the (NUL terminated) @p json as is, as a value. It has to
+    be valid JSON, it is not checked.
+ */
+void pubnub_jw_raw(struct pubnub_json_writer* w, char const* json);
+
+/** Returns the outcome of the writes to @p w:
+    @retval PNR_OK the JSON is complete (all objects and arrays
+    ended) and fits in the buffer
+    @retval PNR_TX_BUFF_TOO_SMALL the buffer is too small
+    @retval PNR_INVALID_PARAMETERS the JSON is not complete, or an
+    element was written where it is not allowed (a value where a key
+    is expected, or vice versa, end of an array in an object...)
+ */
+enum pubnub_res pubnub_jw_result(struct pubnub_json_writer const* w);
+
+/** Returns the JSON written to @p w (so far), NUL terminated. To use
+    it as `meta`, for example.
+ */
+char const* pubnub_jw_str(struct pubnub_json_writer const* w);
+
+/** Returns the length of the JSON written to @p w (so far) */
+size_t pubnub_jw_len(struct pubnub_json_writer const* w);
+
+
+/** Publishes the JSON written to @p message (which has to be
+    complete). The same as pubnub_publish_ex(), but:
+
+    - with #pubnubSendAdaptive, the method is chosen without scanning
+    the message, as the writer knows how long it is and how much URL
+    encoding would add to it
+    - via POST, without encryption and compression, the message is
+    sent directly from the buffer of the writer (if the build
+    supports sending the body from the user's buffer - see
+    pubnub_request_body.h), so it is not copied to the context, nor is
+    its length limited by #PUBNUB_BUF_MAXLEN. It has to remain valid
+    (unchanged) until the transaction ends.
+
+    @retval PNR_STARTED on success
+    @return pubnub_jw_result() of @p message if it is not #PNR_OK,
+    otherwise an error, as for pubnub_publish_ex()
+ */
+enum pubnub_res pubnub_publish_json(pubnub_t*                        p,
+                                    char const*                      channel,
+                                    struct pubnub_json_writer const* message,
+                                    struct pubnub_publish_options    opts);
+
+
+#endif /* !defined INC_PUBNUB_JSON_WRITER */
@@ -95,12 +95,33 @@ static char const* get_method_verb_string(uint8_t method)
 
 static int send_fin_head(struct pubnub_* pb)
 {
-    char s[200];
+    char        s[300];
+    char const* accept_encoding = ACCEPT_ENCODING;
+#if PUBNUB_USE_HISTORY_STREAM
+    /* The history stream parses the response as it is received */
+    if (pb->hist_stream.running) {
+        accept_encoding = "";
+    }
+#endif
+#if PUBNUB_USE_OBJECTS_CACHE
+    {
+        char const* etag = pbobjc_if_none_match(pb);
+        if (etag != NULL) {
+            snprintf(s,
+                     sizeof s,
+                     "\r\nUser-Agent: %s\r\nIf-None-Match: %s\r\n%s\r\n",
+                     pubnub_uagent(),
+                     etag,
+                     accept_encoding);
+            return pbpal_send_str(pb, s);
+        }
+    }
+#endif
     snprintf(s,
              sizeof s,
-             "\r\nUser-Agent: %s%s",
+             "\r\nUser-Agent: %s\r\n%s\r\n",
              pubnub_uagent(),
-             "\r\n" ACCEPT_ENCODING "\r\n");
+             accept_encoding);
     return pbpal_send_str(pb, s);
 }
 
@@ -112,6 +133,73 @@ static int send_fin_head(struct pubnub_* pb)
     }
 
 
+/** Returns if the request in @p pb has a body to send (now): not
+    while establishing a tunnel through a proxy.
+ */
+static bool should_send_body(struct pubnub_* pb)
+{
+    if (!HTTP_request_has_body(pb->method)) {
+        return false;
+    }
+#if PUBNUB_PROXY_API
+    if ((pbproxyHTTP_CONNECT == pb->proxy_type) && !pb->proxy_tunnel_established) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+
+#if PUBNUB_USE_REQUEST_BODY
+/** Starts sending the next part of a chunked request body: the data
+    of the chunk whose header was sent, or the header of the next
+    chunk, which is taken from the producer.
+
+    @retval 0 the whole body was sent
+    @retval +1 sending started
+    @retval -1 failed
+ */
+static int send_next_chunk(struct pubnub_* pb)
+{
+    struct pbcc_chunked_body* chunked = &pb->core.chunked;
+    void const*               chunk   = NULL;
+    size_t                    len     = 0;
+
+    if (chunked->chunk_len > 0) {
+        len                = chunked->chunk_len;
+        chunked->chunk_len = 0;
+        return (pbpal_send(pb, chunked->chunk, len) < 0) ? -1 : +1;
+    }
+    if (chunked->finished) {
+        return 0;
+    }
+    if (chunked->producer(chunked->producer_data, &chunk, &len) != 0) {
+        PUBNUB_LOG_ERROR("pb=%p: the request body producer failed\n", pb);
+        return -1;
+    }
+    if (0 == len) {
+        snprintf(chunked->header,
+                 sizeof chunked->header,
+                 "%s0\r\n\r\n",
+                 chunked->started ? "\r\n" : "");
+        chunked->finished = true;
+    }
+    else {
+        snprintf(chunked->header,
+                 sizeof chunked->header,
+                 "%s%lx\r\n",
+                 chunked->started ? "\r\n" : "",
+                 (unsigned long)len);
+        chunked->chunk     = chunk;
+        chunked->chunk_len = len;
+    }
+    chunked->started = true;
+
+    return (pbpal_send_str(pb, chunked->header) < 0) ? -1 : +1;
+}
+#endif /* PUBNUB_USE_REQUEST_BODY */
+
+
 static bool should_keep_alive(struct pubnub_* pb, enum pubnub_res rslt)
 {
     if (!pb->flags.should_close) {
@@ -283,7 +371,11 @@ PUBNUB_STATIC_ASSERT((sizeof m_aParseResponse / sizeof m_aParseResponse[0]) == P
 
 static enum pubnub_res parse_pubnub_result(struct pubnub_* pb)
 {
-    enum pubnub_res pbres = m_aParseResponse[pb->trans](&pb->core);
+    enum pubnub_res pbres;
+#if PUBNUB_USE_REPLY_INDEX
+    pbcc_reply_index_reset(&pb->core);
+#endif
+    pbres = m_aParseResponse[pb->trans](&pb->core);
     if (pbres != PNR_OK) {
         PUBNUB_LOG_WARNING("pb=%p parsing response for transaction type #%d "
                            "returned error %d\nResponse was: %s\n",
@@ -297,6 +389,98 @@ static enum pubnub_res parse_pubnub_result(struct pubnub_* pb)
 }
 
 
+#if PUBNUB_USE_PUBLISH_PIPELINE || PUBNUB_USE_HISTORY_STREAM
+/** Sends the HTTP verb of the next pipelined request (or of the next
+    page of the history stream), which is already prepared in the HTTP
+    buffer.
+*/
+static int send_pipelined_request(struct pubnub_* pb)
+{
+    pb->state = PBS_TX_GET;
+    pbntf_watch_out_events(pb);
+    if (0 > pbpal_send_str(pb, get_method_verb_string(pb->method))) {
+        outcome_detected(pb, PNR_IO_ERROR);
+        return -1;
+    }
+    return 0;
+}
+#endif
+
+
+#if PUBNUB_USE_PUBLISH_PIPELINE
+/** Lets the publish pipeline handle the response with outcome @p
+    pbres.
+    @retval PNR_STARTED pipeline goes on, proceed to the next state
+    @retval PNR_OK not pipelined, or pipeline is done
+    @retval PNR_IO_ERROR failed to send the next request
+*/
+static enum pubnub_res pipeline_response(struct pubnub_* pb, enum pubnub_res pbres)
+{
+    switch (pbpipe_response(pb, pbres)) {
+    case pbpipeReadNext:
+        pbpal_start_read_line(pb);
+        pb->state = PBS_RX_HTTP_VER;
+        return PNR_STARTED;
+    case pbpipeSendNext:
+        return (0 == send_pipelined_request(pb)) ? PNR_STARTED : PNR_IO_ERROR;
+#if PUBNUB_NEED_RETRY_AFTER_CLOSE
+    case pbpipeRetry:
+        pb->flags.should_close      = true;
+        pb->flags.retry_after_close = true;
+        outcome_detected(pb, pbres);
+        return PNR_STARTED;
+#endif
+    default:
+        return PNR_OK;
+    }
+}
+#endif /* PUBNUB_USE_PUBLISH_PIPELINE */
+
+
+#if PUBNUB_USE_HISTORY_STREAM
+/** Lets the history stream handle the response with outcome @p
+    pbres.
+    @retval PNR_STARTED next page requested, proceed to the next state
+    @retval PNR_OK not streaming, or the stream is done
+    @retval PNR_IO_ERROR failed to send the next request
+*/
+static enum pubnub_res history_stream_response(struct pubnub_* pb,
+                                               enum pubnub_res pbres)
+{
+    switch (pbhs_response(pb, pbres)) {
+    case pbhsSendNext:
+        return (0 == send_pipelined_request(pb)) ? PNR_STARTED : PNR_IO_ERROR;
+#if PUBNUB_NEED_RETRY_AFTER_CLOSE
+    case pbhsRetry:
+        pb->flags.retry_after_close = true;
+        outcome_detected(pb, pbres);
+        return PNR_STARTED;
+#endif
+    default:
+        return PNR_OK;
+    }
+}
+#endif /* PUBNUB_USE_HISTORY_STREAM */
+
+
+/** Stores the @p len bytes of the response body which were just read
+    to the reply buffer, or gives them to the history stream, if it is
+    streaming this response.
+*/
+static void body_received(struct pubnub_* pb, unsigned len)
+{
+#if PUBNUB_USE_HISTORY_STREAM
+    if (PBHS_STREAMING(pb)) {
+        pbhs_feed(pb, pb->core.http_buf, len);
+        pb->core.http_buf_len += len;
+        return;
+    }
+#endif
+    memcpy(pb->core.http_reply + pb->core.http_buf_len, pb->core.http_buf, len);
+    pb->core.http_buf_len += len;
+}
+
+
 static enum pubnub_res finish(struct pubnub_* pb)
 {
     enum pubnub_res pbres;
@@ -321,21 +505,62 @@ static enum pubnub_res finish(struct pubnub_* pb)
         break;
     }
 #endif
-    /* Ensures existence of the reply buffer in case no:
-       'Content-Length:', nor 'Transfer-Encoding: chunked'
-       header line has been received
-    */
-    if (!pbcc_ensure_reply_buffer(&pb->core)) {
-        outcome_detected(pb, PNR_REPLY_TOO_BIG);
-        return PNR_REPLY_TOO_BIG;
+#if PUBNUB_USE_HISTORY_STREAM
+    if (PBHS_STREAMING(pb)) {
+        /* The body was given to the history stream, not stored */
+        pb->core.http_buf_len = 0;
+        pbres                 = pbhs_page_result(pb);
+    }
+    else
+#endif
+    {
+#if PUBNUB_USE_OBJECTS_CACHE
+        /* On `304 Not Modified`, use the cached response */
+        if (pbobjc_response_body(pb) != 0) {
+            pbobjc_release(pb);
+            outcome_detected(pb, PNR_REPLY_TOO_BIG);
+            return PNR_REPLY_TOO_BIG;
+        }
+#endif
+        /* Ensures existence of the reply buffer in case no:
+           'Content-Length:', nor 'Transfer-Encoding: chunked'
+           header line has been received
+        */
+        if (!pbcc_ensure_reply_buffer(&pb->core)) {
+            outcome_detected(pb, PNR_REPLY_TOO_BIG);
+            return PNR_REPLY_TOO_BIG;
+        }
+        possible_gzip_response(pb);
+        pb->core.http_reply[pb->core.http_buf_len] = '\0';
+        PUBNUB_LOG_TRACE("finish(pb=%p, '%s')\n", pb, pb->core.http_reply);
+        pbres = parse_pubnub_result(pb);
     }
-    possible_gzip_response(pb);
-    pb->core.http_reply[pb->core.http_buf_len] = '\0';
-    PUBNUB_LOG_TRACE("finish(pb=%p, '%s')\n", pb, pb->core.http_reply);
-    pbres = parse_pubnub_result(pb);
     if ((PNR_OK == pbres) && ((pb->http_code / 100) != 2)) {
         pbres = PNR_HTTP_ERROR;
     }
+#if PUBNUB_USE_OBJECTS_CACHE
+    pbobjc_response(pb, pbres);
+#endif
+#if PUBNUB_USE_PUBLISH_PIPELINE
+    switch (pipeline_response(pb, pbres)) {
+    case PNR_STARTED:
+        return PNR_STARTED;
+    case PNR_IO_ERROR:
+        return PNR_IO_ERROR;
+    default:
+        break;
+    }
+#endif
+#if PUBNUB_USE_HISTORY_STREAM
+    switch (history_stream_response(pb, pbres)) {
+    case PNR_STARTED:
+        return PNR_STARTED;
+    case PNR_IO_ERROR:
+        return PNR_IO_ERROR;
+    default:
+        break;
+    }
+#endif
 
     outcome_detected(pb, pbres);
     return pbres;
@@ -422,6 +647,22 @@ static char const* pbnc_state2str(enum pubnub_state e)
     }
 }
 
+#if PUBNUB_PROXY_API
+/** Makes sure there is a buffer to save the path (of the URL) to, as
+    it may be taken from the scratch pool.
+ */
+static bool ensure_proxy_saved_path(struct pubnub_* pb)
+{
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    return pbscratch_ensure(&pb->proxy_saved_path) != NULL;
+#else
+    PUBNUB_UNUSED(pb);
+    return true;
+#endif
+}
+#endif /* PUBNUB_PROXY_API */
+
+
 static void initialize_fields_in_state_IDLE(struct pubnub_* pb)
 {
 #if PUBNUB_CHANGE_DNS_SERVERS
@@ -720,6 +961,10 @@ next_state:
                 }
                 PUBNUB_ASSERT_OPT(pb->core.http_buf_len < PUBNUB_BUF_MAXLEN);
                 if (0 == pb->proxy_saved_path_len) {
+                    if (!ensure_proxy_saved_path(pb)) {
+                        outcome_detected(pb, PNR_INTERNAL_ERROR);
+                        break;
+                    }
                     memcpy(pb->proxy_saved_path,
                            pb->core.http_buf,
                            pb->core.http_buf_len + 1);
@@ -752,6 +997,10 @@ next_state:
                 if (!pb->proxy_tunnel_established) {
                     PUBNUB_ASSERT_OPT(pb->core.http_buf_len < PUBNUB_BUF_MAXLEN);
                     if (0 == pb->proxy_saved_path_len) {
+                        if (!ensure_proxy_saved_path(pb)) {
+                            outcome_detected(pb, PNR_INTERNAL_ERROR);
+                            break;
+                        }
                         memcpy(pb->proxy_saved_path,
                                pb->core.http_buf,
                                pb->core.http_buf_len + 1);
@@ -885,11 +1134,7 @@ next_state:
                 }
             }
 #endif
-            if (HTTP_request_has_body(pb->method)
-#if PUBNUB_PROXY_API
-                && (pb->proxy_tunnel_established || (pbproxyNONE == pb->proxy_type))
-#endif
-            ) {
+            if (should_send_body(pb)) {
                 char hedr[128] = "\r\n";
                 pbcc_via_post_headers(
                     &(pb->core), hedr + 2, sizeof hedr - 2);
@@ -924,25 +1169,32 @@ next_state:
             outcome_detected(pb, PNR_IO_ERROR);
         }
         else if (0 == i) {
-            if (HTTP_request_has_body(pb->method)
-#if PUBNUB_PROXY_API
-                && (pb->proxy_tunnel_established || (pbproxyNONE == pb->proxy_type))
-#endif
-            ) {
-                const char* message = pb->core.message_to_send;
-#if PUBNUB_USE_GZIP_COMPRESSION
-                size_t len = (pb->core.gzip_msg_len != 0) ? pb->core.gzip_msg_len
-                                                          : strlen(message);
-#else
-                size_t len = strlen(message);
-#endif
+            if (should_send_body(pb)) {
                 pb->state = PBS_TX_BODY;
-                if (-1 == pbpal_send(pb, message, len)) {
+#if PUBNUB_USE_REQUEST_BODY
+                if (pb->core.chunked.producer != NULL) {
+                    /* The producer can't be rewound to send the body again */
+                    if (pb->core.chunked.started || (send_next_chunk(pb) < 0)) {
+                        outcome_detected(pb, PNR_IO_ERROR);
+                        break;
+                    }
+                    goto next_state;
+                }
+#endif
+                if (-1 == pbpal_send(pb, pb->core.message_to_send, pb->core.message_len)) {
                     outcome_detected(pb, PNR_IO_ERROR);
                     break;
                 }
             }
             else {
+#if PUBNUB_USE_PUBLISH_PIPELINE
+                if (pbpipe_prep_next(pb)) {
+                    if (0 != send_pipelined_request(pb)) {
+                        break;
+                    }
+                    goto next_state;
+                }
+#endif
                 pbpal_start_read_line(pb);
                 pb->state = PBS_RX_HTTP_VER;
                 pbntf_watch_in_events(pb);
@@ -956,6 +1208,18 @@ next_state:
             outcome_detected(pb, PNR_IO_ERROR);
         }
         else if (0 == i) {
+#if PUBNUB_USE_REQUEST_BODY
+            if (pb->core.chunked.producer != NULL) {
+                i = send_next_chunk(pb);
+                if (i < 0) {
+                    outcome_detected(pb, PNR_IO_ERROR);
+                    break;
+                }
+                if (i > 0) {
+                    goto next_state;
+                }
+            }
+#endif
             pbpal_start_read_line(pb);
             pb->state = PBS_RX_HTTP_VER;
             pbntf_watch_in_events(pb);
@@ -982,11 +1246,17 @@ next_state:
             pb->core.http_content_len = 0;
             pb->http_chunked          = false;
             pb->state                 = PBS_RX_HEADERS;
+#if PUBNUB_USE_HISTORY_STREAM
+            pbhs_response_start(pb);
+#endif
             goto next_state;
         case PNR_CONNECTION_TIMEOUT:
         case PNR_TIMEOUT:
         case PNR_IO_ERROR:
             if (pb->flags.started_while_kept_alive) {
+#if PUBNUB_USE_PUBLISH_PIPELINE
+                pbpipe_rewind(pb);
+#endif
                 pb->state = close_kept_alive_connection(pb);
                 goto next_state;
             }
@@ -1031,6 +1301,13 @@ next_state:
                 pb->core.http_buf_len = 0;
                 if (!pb->http_chunked) {
                     if (0 == pb->core.http_content_len) {
+#if PUBNUB_USE_OBJECTS_CACHE
+                        if (304 == pb->http_code) {
+                            /* No body, the cached response is used */
+                            pb->state = PBS_RX_BODY;
+                            goto next_state;
+                        }
+#endif
 #if PUBNUB_PROXY_API
                         WATCH_ENUM(pb->proxy_type);
                         WATCH_INT(pb->proxy_tunnel_established);
@@ -1052,12 +1329,16 @@ next_state:
                 }
                 goto next_state;
             }
+#if PUBNUB_USE_OBJECTS_CACHE
+            pbobjc_header(pb, pb->core.http_buf, read_len);
+#endif
             if (strncmp(pb->core.http_buf, h_chunked, sizeof h_chunked - 1) == 0) {
                 pb->http_chunked = true;
             }
             else if (strncmp(pb->core.http_buf, h_length, sizeof h_length - 1) == 0) {
                 size_t len = atoi(pb->core.http_buf + sizeof h_length - 1);
-                if (0 != pbcc_realloc_reply_buffer(&pb->core, len)) {
+                if (!PBHS_STREAMING(pb)
+                    && (0 != pbcc_realloc_reply_buffer(&pb->core, len))) {
                     outcome_detected(pb, PNR_REPLY_TOO_BIG);
                     break;
                 }
@@ -1100,7 +1381,9 @@ next_state:
             goto next_state;
         }
         else {
-            finish(pb);
+            if (PNR_STARTED == finish(pb)) {
+                goto next_state;
+            }
 #if PUBNUB_PROXY_API
             if (pb->flags.retry_after_close) {
                 goto next_state;
@@ -1120,8 +1403,7 @@ next_state:
             WATCH_SIZE_T(pb->core.http_buf_len);
             PUBNUB_ASSERT_OPT(pb->core.http_buf_len + len
                               <= pb->core.http_content_len);
-            memcpy(pb->core.http_reply + pb->core.http_buf_len, pb->core.http_buf, len);
-            pb->core.http_buf_len += len;
+            body_received(pb, len);
             pb->state = PBS_RX_BODY;
             goto next_state;
         }
@@ -1145,16 +1427,19 @@ next_state:
 
             PUBNUB_LOG_TRACE("About to read a chunk w/length: %u\n", chunk_length);
             if (chunk_length == 0) {
-                finish(pb);
+                if (PNR_STARTED == finish(pb)) {
+                    goto next_state;
+                }
 #if PUBNUB_PROXY_API
                 if (pb->flags.retry_after_close) {
                     goto next_state;
                 }
 #endif
             }
-            else if (0
-                     != pbcc_realloc_reply_buffer(
-                            &pb->core, pb->core.http_buf_len + chunk_length)) {
+            else if (!PBHS_STREAMING(pb)
+                     && (0
+                         != pbcc_realloc_reply_buffer(
+                             &pb->core, pb->core.http_buf_len + chunk_length))) {
                 outcome_detected(pb, PNR_REPLY_TOO_BIG);
             }
             else {
@@ -1195,10 +1480,7 @@ next_state:
                 if (len < to_copy) {
                     to_copy = len;
                 }
-                memcpy(pb->core.http_reply + pb->core.http_buf_len,
-                       pb->core.http_buf,
-                       to_copy);
-                pb->core.http_buf_len += to_copy;
+                body_received(pb, to_copy);
             }
             pb->core.http_content_len -= len;
             pb->state = PBS_RX_BODY_CHUNK;
@@ -1328,6 +1610,9 @@ void pbnc_stop(struct pubnub_* pbp, enum pubnub_res outcome_to_report)
                intention to reestablish it anew and don't lose current
                transaction.
             */
+#if PUBNUB_USE_PUBLISH_PIPELINE
+            pbpipe_rewind(pbp);
+#endif
             pbp->state = close_kept_alive_connection(pbp);
             pbntf_requeue_for_processing(pbp);
             break;
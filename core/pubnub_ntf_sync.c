@@ -11,6 +11,77 @@
 #include "lib/msstopwatch/msstopwatch.h"
 
 
+#if PUBNUB_USE_SYNC_POLL
+/** The longest time (in milliseconds) pubnub_await() sleeps waiting
+    for I/O before running the FSM again. Waking up now and then is
+    a safety net for the (rare) cases where we don't know what the
+    PAL is waiting for, like a TLS handshake that wants to write.
+ */
+#if !defined PUBNUB_SYNC_POLL_MAX_WAIT_MS
+#define PUBNUB_SYNC_POLL_MAX_WAIT_MS 1000
+#endif
+
+/** Returns the I/O the FSM of @p pb waits for, in its current state */
+static enum pbpal_io_wait io_wait_for(pubnub_t* pb)
+{
+#if PUBNUB_BLOCKING_IO_SETTABLE
+    if (pb->options.use_blocking_io) {
+        return pbpalWaitNone;
+    }
+#endif
+    switch (pb->state) {
+    case PBS_WAIT_DNS_SEND:
+    case PBS_WAIT_CONNECT:
+    case PBS_TX_GET:
+    case PBS_TX_PATH:
+    case PBS_TX_SCHEME:
+    case PBS_TX_HOST:
+    case PBS_TX_PORT_NUM:
+    case PBS_TX_VER:
+    case PBS_TX_EXTRA_HEADERS:
+    case PBS_TX_ORIGIN:
+    case PBS_TX_FIN_HEAD:
+    case PBS_TX_BODY:
+        return pbpalWaitOut;
+    case PBS_WAIT_DNS_RCV:
+    case PBS_RX_HTTP_VER:
+    case PBS_RX_HEADER_LINE:
+    case PBS_RX_BODY_WAIT:
+    case PBS_RX_CHUNK_LEN_LINE:
+    case PBS_RX_BODY_CHUNK_WAIT:
+    case PBS_WAIT_CLOSE:
+    case PBS_WAIT_CANCEL_CLOSE:
+    case PBS_KEEP_ALIVE_WAIT_CLOSE:
+#if PUBNUB_USE_SSL
+    case PBS_WAIT_TLS_CONNECT:
+#endif
+        return pbpalWaitIn;
+    default:
+        return pbpalWaitNone;
+    }
+}
+
+
+/** Sleeps until the socket of @p pb is ready for the I/O the FSM is
+    waiting for, but no longer than @p remaining_ms.
+ */
+static void wait_for_io(pubnub_t* pb, pbms_t remaining_ms)
+{
+    enum pbpal_io_wait wait = io_wait_for(pb);
+
+    if ((pbpalWaitNone == wait) || (remaining_ms <= 0)) {
+        return;
+    }
+    if (remaining_ms > PUBNUB_SYNC_POLL_MAX_WAIT_MS) {
+        remaining_ms = PUBNUB_SYNC_POLL_MAX_WAIT_MS;
+    }
+    pb->flags.waiting_io = true;
+    pbpal_wait_io(pb, pbpalWaitOut == wait, (int)remaining_ms);
+    pb->flags.waiting_io = false;
+}
+#endif /* PUBNUB_USE_SYNC_POLL */
+
+
 int pbntf_init(void)
 {
     return 0;
@@ -34,7 +105,13 @@ void pbntf_update_socket(pubnub_t* pb)
 
 void pbntf_lost_socket(pubnub_t* pb)
 {
+#if PUBNUB_USE_SYNC_POLL
+    if (pb->flags.waiting_io) {
+        pbpal_interrupt_wait_io(pb);
+    }
+#else
     PUBNUB_UNUSED(pb);
+#endif
 }
 
 
@@ -116,9 +193,163 @@ enum pubnub_res pubnub_await(pubnub_t* pb)
                 break;
             }
         }
+#if PUBNUB_USE_SYNC_POLL
+        else if (!pbnc_can_start_transaction(pb)) {
+            wait_for_io(pb, pb->transaction_timeout_ms - delta + 1);
+        }
+#endif
     }
     result = pb->core.last_result;
     pubnub_mutex_unlock(pb->monitor);
 
     return result;
 }
+
+
+#if PUBNUB_USE_SYNC_POLL
+/** State of the wait on one of the contexts of pubnub_await_any()
+    and pubnub_await_all()
+ */
+struct await_multi_ctx {
+    /** Start of the (current phase of the) wait on the transaction */
+    pbmsref_t t0;
+    /** The transaction timed out and was stopped */
+    bool stopped;
+    /** The transaction is done (or we gave up on it) */
+    bool done;
+    /** The socket is ready for the I/O the FSM waits for (or the FSM
+        waits for no I/O), so run the FSM */
+    bool ready;
+};
+
+
+/** Waits on the @p n contexts @p pbs for any (or, if @p all, every)
+    transaction on them to finish. Returns the bitmap of the contexts
+    on which the transaction is done.
+ */
+static uint32_t await_multi(pubnub_t* const* pbs, unsigned n, bool all)
+{
+    struct await_multi_ctx ctx[PUBNUB_AWAIT_MAX_CONTEXTS];
+    enum pbpal_io_wait     waits[PUBNUB_AWAIT_MAX_CONTEXTS];
+    bool                   ready[PUBNUB_AWAIT_MAX_CONTEXTS];
+    uint32_t               done = 0;
+    uint32_t               all_bits;
+    unsigned               i;
+
+    all_bits = (n < 32) ? ((uint32_t)1 << n) - 1 : ~(uint32_t)0;
+    for (i = 0; i < n; ++i) {
+        PUBNUB_ASSERT(pb_valid_ctx_ptr(pbs[i]));
+        ctx[i].t0      = pbms_start();
+        ctx[i].stopped = false;
+        ctx[i].done    = false;
+        ctx[i].ready   = true;
+    }
+    for (;;) {
+        pbms_t wait_ms = PUBNUB_SYNC_POLL_MAX_WAIT_MS;
+
+        for (i = 0; i < n; ++i) {
+            pubnub_t* pb = pbs[i];
+
+            waits[i] = pbpalWaitNone;
+            if (ctx[i].done) {
+                continue;
+            }
+            pubnub_mutex_lock(pb->monitor);
+            pb->flags.waiting_io = false;
+            if (ctx[i].ready && !pbnc_can_start_transaction(pb)) {
+                pbnc_fsm(pb);
+            }
+            if (!pbnc_can_start_transaction(pb)) {
+                pbms_t delta = pbms_elapsed(ctx[i].t0);
+                if (delta > pb->transaction_timeout_ms) {
+                    if (!ctx[i].stopped) {
+                        pbnc_stop(pb, PNR_TIMEOUT);
+                        ctx[i].t0      = pbms_start();
+                        ctx[i].stopped = true;
+                        delta          = 0;
+                    }
+                    else {
+                        ctx[i].done = true;
+                    }
+                }
+                if (!ctx[i].done && !pbnc_can_start_transaction(pb)) {
+                    pbms_t remaining = pb->transaction_timeout_ms - delta + 1;
+                    waits[i]         = io_wait_for(pb);
+                    if (pbpalWaitNone == waits[i]) {
+                        remaining = 0;
+                    }
+                    else {
+                        pb->flags.waiting_io = true;
+                    }
+                    if (remaining < wait_ms) {
+                        wait_ms = remaining;
+                    }
+                }
+            }
+            if (pbnc_can_start_transaction(pb)) {
+                ctx[i].done = true;
+            }
+            pubnub_mutex_unlock(pb->monitor);
+            if (ctx[i].done) {
+                done |= (uint32_t)1 << i;
+            }
+        }
+        if (all ? (done == all_bits) : (done != 0)) {
+            break;
+        }
+
+        if (pbpal_wait_io_any(pbs, waits, ready, n, (int)wait_ms) < 0) {
+            /* Don't know who is ready, so try everybody */
+            for (i = 0; i < n; ++i) {
+                ready[i] = true;
+            }
+        }
+        for (i = 0; i < n; ++i) {
+            ctx[i].ready = (pbpalWaitNone == waits[i]) || ready[i];
+        }
+    }
+
+    return done;
+}
+
+
+int pubnub_await_any(pubnub_t* const* pbs, unsigned n)
+{
+    uint32_t done;
+    int      i;
+
+    PUBNUB_ASSERT_OPT(pbs != NULL);
+    if ((0 == n) || (n > PUBNUB_AWAIT_MAX_CONTEXTS)) {
+        return -1;
+    }
+    done = await_multi(pbs, n, false);
+    for (i = 0; 0 == (done & ((uint32_t)1 << i)); ++i) {
+        continue;
+    }
+
+    return i;
+}
+
+
+uint32_t pubnub_await_all(pubnub_t* const* pbs, unsigned n)
+{
+    uint32_t ok = 0;
+    unsigned i;
+
+    PUBNUB_ASSERT_OPT(pbs != NULL);
+    if ((0 == n) || (n > PUBNUB_AWAIT_MAX_CONTEXTS)) {
+        return 0;
+    }
+    await_multi(pbs, n, true);
+    for (i = 0; i < n; ++i) {
+        pubnub_t* pb = pbs[i];
+        pubnub_mutex_lock(pb->monitor);
+        if (PNR_OK == pb->core.last_result) {
+            ok |= (uint32_t)1 << i;
+        }
+        pubnub_mutex_unlock(pb->monitor);
+    }
+
+    return ok;
+}
+#endif /* PUBNUB_USE_SYNC_POLL */
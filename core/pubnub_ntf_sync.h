@@ -5,6 +5,8 @@
 
 #include "pubnub_api_types.h"
 
+#include <stdint.h>
+
 
 /** @file pubnub_ntf_sync.h 
     This is the "sync" notification interface.
@@ -40,4 +42,46 @@
 enum pubnub_res pubnub_await(pubnub_t *p);
 
 
+/** The maximum number of contexts pubnub_await_any() and
+    pubnub_await_all() can wait on, as many as there are bits in the
+    bitmap pubnub_await_all() returns.
+ */
+#define PUBNUB_AWAIT_MAX_CONTEXTS 32
+
+/** Waits for the transaction on any of the @p n contexts @p pbs to
+    finish. Instead of looping on each context, it sleeps until the
+    socket of any of them is ready for the I/O its transaction waits
+    for (with one poll() over all the sockets), and then advances
+    only the transactions on the contexts that are ready. The
+    transaction timeout of each context is observed, like in
+    pubnub_await().
+
+    Contexts which have no transaction in progress are considered
+    finished. Get the outcome of the finished transaction with
+    pubnub_last_result().
+
+    @note Available only if the sync interface was built with
+    PUBNUB_USE_SYNC_POLL. Contexts with blocking I/O are supported,
+    but, waiting on one, blocks the others.
+
+    @param pbs The array of contexts to wait on
+    @param n The number of contexts in @p pbs, up to
+    #PUBNUB_AWAIT_MAX_CONTEXTS
+    @return The index (in @p pbs) of the context on which the
+    transaction finished (if there are several, the lowest one), or
+    -1 if @p n is invalid
+*/
+int pubnub_await_any(pubnub_t *const *pbs, unsigned n);
+
+/** Waits for the transactions on all the @p n contexts @p pbs to
+    finish, like pubnub_await_any(), but returns only when all of
+    them finished.
+
+    @return The bitmap of the contexts on which the outcome of the
+    transaction is #PNR_OK: bit `i` is for `pbs[i]`. 0 if @p n is
+    invalid.
+*/
+uint32_t pubnub_await_all(pubnub_t *const *pbs, unsigned n);
+
+
 #endif        /* defined INC_PUBNUB_NTF_CONTIKI */
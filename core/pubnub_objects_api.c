@@ -62,6 +62,7 @@ enum pubnub_res pubnub_fetch_all_users(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_FETCH_ALL_USERS;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_REQUEST_START(pb);
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
     }
@@ -96,6 +97,7 @@ enum pubnub_res pubnub_create_user(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_CREATE_USER;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "users", NULL);
         pb->method           = pubnubSendViaPOST;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -125,6 +127,7 @@ enum pubnub_res pubnub_fetch_user(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_FETCH_USER;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_REQUEST_START(pb);
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
     }
@@ -159,6 +162,7 @@ enum pubnub_res pubnub_update_user(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_UPDATE_USER;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "users", NULL);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -185,6 +189,7 @@ enum pubnub_res pubnub_delete_user(pubnub_t* pb, char const* user_id)
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_DELETE_USER;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "users", user_id);
         pb->method           = pubnubUseDELETE;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -223,6 +228,7 @@ enum pubnub_res pubnub_fetch_all_spaces(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_FETCH_ALL_SPACES;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_REQUEST_START(pb);
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
     }
@@ -257,6 +263,7 @@ enum pubnub_res pubnub_create_space(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_CREATE_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "spaces", NULL);
         pb->method           = pubnubSendViaPOST;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -286,6 +293,7 @@ enum pubnub_res pubnub_fetch_space(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_FETCH_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_REQUEST_START(pb);
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
     }
@@ -320,6 +328,7 @@ enum pubnub_res pubnub_update_space(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_UPDATE_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "spaces", NULL);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -346,6 +355,7 @@ enum pubnub_res pubnub_delete_space(pubnub_t* pb, char const* space_id)
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_DELETE_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "spaces", space_id);
         pb->method           = pubnubUseDELETE;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -431,6 +441,7 @@ enum pubnub_res pubnub_add_users_space_memberships(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_ADD_USERS_SPACE_MEMBERSHIPS;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "users", user_id);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -477,6 +488,7 @@ enum pubnub_res pubnub_update_users_space_memberships(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_UPDATE_USERS_SPACE_MEMBERSHIPS;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "users", user_id);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -523,6 +535,7 @@ enum pubnub_res pubnub_remove_users_space_memberships(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_REMOVE_USERS_SPACE_MEMBERSHIPS;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "users", user_id);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -608,6 +621,7 @@ enum pubnub_res pubnub_add_members_in_space(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_ADD_MEMBERS_IN_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "spaces", space_id);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -654,6 +668,7 @@ enum pubnub_res pubnub_update_members_in_space(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_UPDATE_MEMBERS_IN_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "spaces", space_id);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
@@ -700,6 +715,7 @@ enum pubnub_res pubnub_remove_members_in_space(pubnub_t* pb,
     if (PNR_STARTED == rslt) {
         pb->trans            = PBTT_REMOVE_MEMBERS_IN_SPACE;
         pb->core.last_result = PNR_STARTED;
+        PBOBJC_INVALIDATE(pb, "spaces", space_id);
         pb->method           = pubnubUsePATCH;
         pbnc_fsm(pb);
         rslt = pb->core.last_result;
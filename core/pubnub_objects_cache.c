@@ -0,0 +1,554 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "pubnub_objects_cache.h"
+
+#include "pubnub_ccore_pubsub.h"
+#include "pubnub_url_encode.h"
+#include "pubnub_mutex.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Initial number of buckets of the hash table. Must be a power of 2. */
+#define PBOBJC_INITIAL_BUCKETS 64
+
+
+/** A cached response */
+struct pbobjc_entry {
+    /** Next entry in the same bucket of the hash table */
+    struct pbobjc_entry* next;
+    /** Previous (more recently used) entry in the LRU list */
+    struct pbobjc_entry* lru_prev;
+    /** Next (less recently used) entry in the LRU list */
+    struct pbobjc_entry* lru_next;
+    /** Hash of the key */
+    unsigned hash;
+    /** Number of contexts which pinned this entry */
+    unsigned refs;
+    /** Set while the entry is in the cache (not evicted nor
+        invalidated) */
+    bool linked;
+    /** Length of the key */
+    size_t key_len;
+    /** Length of the body */
+    size_t body_len;
+    /** The body, it's after the key, in the same allocation */
+    char* body;
+    /** The `ETag` of the response */
+    char etag[PUBNUB_OBJECTS_CACHE_ETAG_MAXLEN + 1];
+    /** The key, followed by the body */
+    char key[1];
+};
+
+/** Objects API response cache descriptor */
+struct pbobjc_cache {
+    /** Maximum number of bytes the entries may take */
+    size_t max_bytes;
+    /** The hash table of the entries */
+    pubnub_guarded_by(monitor) struct pbobjc_entry** buckets;
+    /** Number of buckets in the hash table, a power of 2 */
+    pubnub_guarded_by(monitor) unsigned bucket_count;
+    /** Most recently used entry */
+    pubnub_guarded_by(monitor) struct pbobjc_entry* lru_head;
+    /** Least recently used entry */
+    pubnub_guarded_by(monitor) struct pbobjc_entry* lru_tail;
+    /** Metrics of the cache, including the number of entries and
+        bytes they take */
+    pubnub_guarded_by(monitor) struct pubnub_objects_cache_metrics metrics;
+
+#if PUBNUB_THREADSAFE
+    pubnub_mutex_t monitor;
+#endif
+};
+
+
+static size_t entry_bytes(struct pbobjc_entry const* entry)
+{
+    return sizeof *entry + entry->key_len + entry->body_len;
+}
+
+
+static bool is_cacheable(enum pubnub_trans trans)
+{
+    switch (trans) {
+    case PBTT_FETCH_USER:
+    case PBTT_FETCH_SPACE:
+    case PBTT_FETCH_ALL_USERS:
+    case PBTT_FETCH_ALL_SPACES:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+static struct pbobjc_entry* find(pubnub_objects_cache_t* cache, char const* key, size_t len)
+{
+    unsigned             h = pbhash_fnv1a(PBHASH_FNV1A_INIT, key, len);
+    struct pbobjc_entry* e;
+
+    for (e = cache->buckets[h & (cache->bucket_count - 1)]; e != NULL; e = e->next) {
+        if ((e->hash == h) && (e->key_len == len) && (0 == memcmp(e->key, key, len))) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+
+/** Doubles the number of buckets of the hash table. If it fails, the
+    table is left as it was (just with longer chains).
+ */
+static void grow_table(pubnub_objects_cache_t* cache)
+{
+    unsigned              n = cache->bucket_count * 2;
+    struct pbobjc_entry** buckets;
+    unsigned              i;
+
+    buckets = (struct pbobjc_entry**)calloc(n, sizeof buckets[0]);
+    if (NULL == buckets) {
+        return;
+    }
+    for (i = 0; i < cache->bucket_count; ++i) {
+        struct pbobjc_entry* e = cache->buckets[i];
+        while (e != NULL) {
+            struct pbobjc_entry* next  = e->next;
+            e->next                    = buckets[e->hash & (n - 1)];
+            buckets[e->hash & (n - 1)] = e;
+            e                          = next;
+        }
+    }
+    free(cache->buckets);
+    cache->buckets      = buckets;
+    cache->bucket_count = n;
+}
+
+
+static void lru_unlink(pubnub_objects_cache_t* cache, struct pbobjc_entry* entry)
+{
+    if (entry->lru_prev != NULL) {
+        entry->lru_prev->lru_next = entry->lru_next;
+    }
+    else {
+        cache->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != NULL) {
+        entry->lru_next->lru_prev = entry->lru_prev;
+    }
+    else {
+        cache->lru_tail = entry->lru_prev;
+    }
+}
+
+
+static void lru_push_front(pubnub_objects_cache_t* cache, struct pbobjc_entry* entry)
+{
+    entry->lru_prev = NULL;
+    entry->lru_next = cache->lru_head;
+    if (cache->lru_head != NULL) {
+        cache->lru_head->lru_prev = entry;
+    }
+    else {
+        cache->lru_tail = entry;
+    }
+    cache->lru_head = entry;
+}
+
+
+/** Takes the @p entry out of the cache. It's freed now, or, if it's
+    pinned by some context(s), when the last one releases it.
+ */
+static void remove_entry(pubnub_objects_cache_t* cache, struct pbobjc_entry* entry)
+{
+    struct pbobjc_entry** pp = &cache->buckets[entry->hash & (cache->bucket_count - 1)];
+
+    while (*pp != entry) {
+        PUBNUB_ASSERT_OPT(*pp != NULL);
+        pp = &(*pp)->next;
+    }
+    *pp = entry->next;
+    lru_unlink(cache, entry);
+    entry->linked = false;
+    --cache->metrics.entries;
+    cache->metrics.bytes -= entry_bytes(entry);
+    if (0 == entry->refs) {
+        free(entry);
+    }
+}
+
+
+/** Makes the key of the request prepared in the HTTP buffer of @p
+    pb: its path and parameters, except the ones that don't change
+    the response (`pnsdk`, `uuid` and `auth`).
+    @retval 0 OK
+    @retval -1 key too long
+ */
+static int make_key(pubnub_t* pb)
+{
+    char const* url = pb->core.http_buf;
+    char const* end = url + pb->core.http_buf_len;
+    char const* q   = (char const*)memchr(url, '?', end - url);
+    char*       key = pb->objc.key;
+    size_t      len;
+    char        sep = '?';
+
+    len = (NULL == q) ? (size_t)(end - url) : (size_t)(q - url);
+    if (len >= sizeof pb->objc.key) {
+        return -1;
+    }
+    memcpy(key, url, len);
+    while ((q != NULL) && (q < end)) {
+        char const* param = q + 1;
+        char const* amp   = (char const*)memchr(param, '&', end - param);
+        size_t      n     = (NULL == amp) ? (size_t)(end - param) : (size_t)(amp - param);
+        q                 = amp;
+        if ((0 == strncmp(param, "pnsdk=", 6)) || (0 == strncmp(param, "uuid=", 5))
+            || (0 == strncmp(param, "auth=", 5)) || (0 == n)) {
+            continue;
+        }
+        if (len + 1 + n >= sizeof pb->objc.key) {
+            return -1;
+        }
+        key[len++] = sep;
+        memcpy(key + len, param, n);
+        len += n;
+        sep = '&';
+    }
+    key[len] = '\0';
+
+    return 0;
+}
+
+
+static size_t path_len(char const* key, size_t key_len)
+{
+    char const* q = (char const*)memchr(key, '?', key_len);
+    return (NULL == q) ? key_len : (size_t)(q - key);
+}
+
+
+/** Returns whether the path of the @p key ends with @p suffix of
+    length @p len */
+static bool path_ends_with(char const* key, size_t key_len, char const* suffix, size_t len)
+{
+    size_t plen = path_len(key, key_len);
+    return (plen >= len) && (0 == memcmp(key + plen - len, suffix, len));
+}
+
+
+/** Returns whether the path of the @p key has the (`/`-terminated)
+    @p prefix of length @p len somewhere in it */
+static bool path_has(char const* key, size_t key_len, char const* prefix, size_t len)
+{
+    size_t plen = path_len(key, key_len);
+    size_t i;
+
+    for (i = 0; i + len <= plen; ++i) {
+        if (0 == memcmp(key + i, prefix, len)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void pbobjc_release(pubnub_t* pb)
+{
+    struct pbobjc_entry*    entry = pb->objc.entry;
+    pubnub_objects_cache_t* cache = pb->objc.cache;
+
+    if (NULL == entry) {
+        return;
+    }
+    PUBNUB_ASSERT_OPT(cache != NULL);
+    pb->objc.entry = NULL;
+    pubnub_mutex_lock(cache->monitor);
+    PUBNUB_ASSERT_OPT(entry->refs > 0);
+    if ((0 == --entry->refs) && !entry->linked) {
+        free(entry);
+    }
+    pubnub_mutex_unlock(cache->monitor);
+}
+
+
+void pbobjc_request_start(pubnub_t* pb)
+{
+    pubnub_objects_cache_t* cache = pb->objc.cache;
+    struct pbobjc_entry*    entry;
+
+    pbobjc_release(pb);
+    pb->objc.hit     = false;
+    pb->objc.etag[0] = '\0';
+    pb->objc.key[0]  = '\0';
+    if ((NULL == cache) || !is_cacheable(pb->trans)) {
+        return;
+    }
+    if (make_key(pb) != 0) {
+        PUBNUB_LOG_DEBUG("pb=%p Objects API request too long to cache\n", pb);
+        pb->objc.key[0] = '\0';
+        return;
+    }
+
+    pubnub_mutex_lock(cache->monitor);
+    ++cache->metrics.lookups;
+    entry = find(cache, pb->objc.key, strlen(pb->objc.key));
+    if (entry != NULL) {
+        ++entry->refs;
+        lru_unlink(cache, entry);
+        lru_push_front(cache, entry);
+        pb->objc.entry = entry;
+    }
+    pubnub_mutex_unlock(cache->monitor);
+}
+
+
+void pbobjc_invalidate(pubnub_t* pb, char const* kind, char const* id)
+{
+    pubnub_objects_cache_t* cache = pb->objc.cache;
+    char                    item[PUBNUB_OBJECTS_CACHE_KEY_MAXLEN + 1];
+    size_t                  list_len;
+    size_t                  item_len;
+    bool                    any_item;
+    struct pbobjc_entry*    e;
+    int                     n;
+
+    if (NULL == cache) {
+        return;
+    }
+    /* "/kind/id", or, if no (or too long) id, "/kind/" for all items */
+    n = snprintf(item, sizeof item, "/%s/%s", kind, (NULL == id) ? "" : id);
+    any_item = (NULL == id) || (n < 0) || ((size_t)n >= sizeof item);
+    list_len = strlen(kind) + 1;
+    item_len = any_item ? list_len + 1 : (size_t)n;
+
+    pubnub_mutex_lock(cache->monitor);
+    e = cache->lru_head;
+    while (e != NULL) {
+        struct pbobjc_entry* next = e->lru_next;
+        if (path_ends_with(e->key, e->key_len, item, list_len)
+            || (any_item ? path_has(e->key, e->key_len, item, item_len)
+                         : path_ends_with(e->key, e->key_len, item, item_len))) {
+            PUBNUB_LOG_TRACE("pb=%p Objects API cache: invalidating '%s'\n", pb, e->key);
+            remove_entry(cache, e);
+            ++cache->metrics.invalidations;
+        }
+        e = next;
+    }
+    pubnub_mutex_unlock(cache->monitor);
+}
+
+
+char const* pbobjc_if_none_match(pubnub_t* pb)
+{
+    if ((NULL == pb->objc.entry) || !is_cacheable(pb->trans)) {
+        return NULL;
+    }
+    return pb->objc.entry->etag;
+}
+
+
+void pbobjc_header(pubnub_t* pb, char const* line, size_t len)
+{
+    static char const h_etag[] = "etag:";
+    size_t            i;
+
+    if (('\0' == pb->objc.key[0]) || !is_cacheable(pb->trans) || (len < sizeof h_etag)) {
+        return;
+    }
+    for (i = 0; i < sizeof h_etag - 1; ++i) {
+        if (tolower((unsigned char)line[i]) != h_etag[i]) {
+            return;
+        }
+    }
+    while ((i < len) && (' ' == line[i])) {
+        ++i;
+    }
+    while ((len > i) && (('\r' == line[len - 1]) || ('\n' == line[len - 1]))) {
+        --len;
+    }
+    if (len - i > PUBNUB_OBJECTS_CACHE_ETAG_MAXLEN) {
+        PUBNUB_LOG_DEBUG("pb=%p Objects API response ETag too long to cache\n", pb);
+        return;
+    }
+    memcpy(pb->objc.etag, line + i, len - i);
+    pb->objc.etag[len - i] = '\0';
+}
+
+
+int pbobjc_response_body(pubnub_t* pb)
+{
+    struct pbobjc_entry* entry = pb->objc.entry;
+
+    if ((pb->http_code != 304) || (NULL == entry) || !is_cacheable(pb->trans)) {
+        return 0;
+    }
+    /* The entry is pinned, so its body can be read without locking */
+    if (pbcc_realloc_reply_buffer(&pb->core, (unsigned)entry->body_len) != 0) {
+        return -1;
+    }
+    memcpy(pb->core.http_reply, entry->body, entry->body_len);
+    pb->core.http_buf_len = entry->body_len;
+    pb->objc.hit          = true;
+
+    return 0;
+}
+
+
+/** Stores the response in the reply buffer of @p pb in its cache,
+    replacing the old response for the same key, if any. Evicts the
+    least recently used responses, to stay within the size limit.
+    Has to be called with the cache locked.
+ */
+static void store(pubnub_objects_cache_t* cache, pubnub_t* pb)
+{
+    size_t               key_len  = strlen(pb->objc.key);
+    size_t               body_len = pb->core.http_buf_len;
+    struct pbobjc_entry* entry;
+
+    entry = find(cache, pb->objc.key, key_len);
+    if (entry != NULL) {
+        remove_entry(cache, entry);
+    }
+    if (sizeof *entry + key_len + body_len > cache->max_bytes) {
+        return;
+    }
+    entry = (struct pbobjc_entry*)malloc(sizeof *entry + key_len + body_len + 1);
+    if (NULL == entry) {
+        return;
+    }
+    entry->hash     = pbhash_fnv1a(PBHASH_FNV1A_INIT, pb->objc.key, key_len);
+    entry->refs     = 0;
+    entry->linked   = true;
+    entry->key_len  = key_len;
+    entry->body_len = body_len;
+    memcpy(entry->key, pb->objc.key, key_len + 1);
+    entry->body = entry->key + key_len + 1;
+    memcpy(entry->body, pb->core.http_reply, body_len);
+    strcpy(entry->etag, pb->objc.etag);
+
+    while ((cache->lru_tail != NULL)
+           && (cache->metrics.bytes + entry_bytes(entry) > cache->max_bytes)) {
+        remove_entry(cache, cache->lru_tail);
+        ++cache->metrics.evictions;
+    }
+    if (cache->metrics.entries >= cache->bucket_count) {
+        grow_table(cache);
+    }
+    entry->next = cache->buckets[entry->hash & (cache->bucket_count - 1)];
+    cache->buckets[entry->hash & (cache->bucket_count - 1)] = entry;
+    lru_push_front(cache, entry);
+    ++cache->metrics.entries;
+    cache->metrics.bytes += entry_bytes(entry);
+}
+
+
+void pbobjc_response(pubnub_t* pb, enum pubnub_res pbres)
+{
+    pubnub_objects_cache_t* cache = pb->objc.cache;
+
+    if ((NULL == cache) || ('\0' == pb->objc.key[0]) || !is_cacheable(pb->trans)) {
+        return;
+    }
+    pubnub_mutex_lock(cache->monitor);
+    if (pb->objc.hit) {
+        ++cache->metrics.hits;
+    }
+    else if (PNR_OBJECTS_API_OK == pbres) {
+        ++cache->metrics.misses;
+        if ((200 == pb->http_code) && (pb->objc.etag[0] != '\0')) {
+            store(cache, pb);
+        }
+    }
+    pubnub_mutex_unlock(cache->monitor);
+    pb->objc.key[0] = '\0';
+    pbobjc_release(pb);
+}
+
+
+pubnub_objects_cache_t* pubnub_objects_cache_create(size_t max_bytes)
+{
+    pubnub_objects_cache_t* cache = (pubnub_objects_cache_t*)calloc(1, sizeof *cache);
+
+    if (NULL == cache) {
+        return NULL;
+    }
+    cache->buckets = (struct pbobjc_entry**)calloc(PBOBJC_INITIAL_BUCKETS,
+                                                   sizeof cache->buckets[0]);
+    if (NULL == cache->buckets) {
+        free(cache);
+        return NULL;
+    }
+    cache->bucket_count = PBOBJC_INITIAL_BUCKETS;
+    cache->max_bytes    = max_bytes;
+    pubnub_mutex_init(cache->monitor);
+
+    return cache;
+}
+
+
+void pubnub_set_objects_cache(pubnub_t* pb, pubnub_objects_cache_t* cache)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    pbobjc_release(pb);
+    pb->objc.cache  = cache;
+    pb->objc.key[0] = '\0';
+    pb->objc.hit    = false;
+    pubnub_mutex_unlock(pb->monitor);
+}
+
+
+bool pubnub_objects_cache_hit(pubnub_t* pb)
+{
+    bool rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    rslt = pb->objc.hit;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+void pubnub_objects_cache_clear(pubnub_objects_cache_t* cache)
+{
+    PUBNUB_ASSERT_OPT(cache != NULL);
+
+    pubnub_mutex_lock(cache->monitor);
+    while (cache->lru_head != NULL) {
+        remove_entry(cache, cache->lru_head);
+    }
+    pubnub_mutex_unlock(cache->monitor);
+}
+
+
+void pubnub_objects_cache_get_metrics(pubnub_objects_cache_t*              cache,
+                                      struct pubnub_objects_cache_metrics* metrics)
+{
+    PUBNUB_ASSERT_OPT(cache != NULL);
+    PUBNUB_ASSERT_OPT(metrics != NULL);
+
+    pubnub_mutex_lock(cache->monitor);
+    *metrics = cache->metrics;
+    pubnub_mutex_unlock(cache->monitor);
+}
+
+
+void pubnub_objects_cache_destroy(pubnub_objects_cache_t* cache)
+{
+    PUBNUB_ASSERT_OPT(cache != NULL);
+
+    pubnub_objects_cache_clear(cache);
+    pubnub_mutex_destroy(cache->monitor);
+    free(cache->buckets);
+    free(cache);
+}
@@ -0,0 +1,95 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_OBJECTS_CACHE
+#define INC_PUBNUB_OBJECTS_CACHE
+
+
+#include "pubnub_api_types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+
+/** @file pubnub_objects_cache.h
+
+    This is the response cache of the Objects API. It keeps the
+    responses of pubnub_fetch_user(), pubnub_fetch_space(),
+    pubnub_fetch_all_users() and pubnub_fetch_all_spaces(), with
+    their `ETag`, keyed by the request path and its options (include,
+    limit...), in a least-recently-used (LRU) list, bounded by the
+    number of bytes they take.
+
+    When a response for the same request is in the cache, the request
+    is sent with `If-None-Match: <etag>`. If the server answers `304
+    Not Modified`, the cached response is used, as if the server sent
+    it: the transaction outcome is #PNR_OBJECTS_API_OK and the
+    response is available with pubnub_get(). The server still checks
+    the request (auth key...), so a response is never used without
+    the server "knowing".
+
+    Local pubnub_create/update/delete_user/space() (and membership
+    updates) invalidate the cached responses of the users and spaces
+    they change, and the lists of them.
+
+    A cache may be shared by many contexts (of the same, or different
+    keysets) and used from many threads.
+*/
+
+
+/** An Objects API response cache descriptor. An opaque data structure. */
+typedef struct pbobjc_cache pubnub_objects_cache_t;
+
+/** Objects API response cache metrics, as returned by
+    pubnub_objects_cache_get_metrics() */
+struct pubnub_objects_cache_metrics {
+    /** Number of cacheable requests started */
+    unsigned long lookups;
+    /** Number of responses taken from the cache (`304`) */
+    unsigned long hits;
+    /** Number of new responses received (and, if they had an
+        `ETag`, stored in the cache) */
+    unsigned long misses;
+    /** Number of responses evicted to stay within the size limit */
+    unsigned long evictions;
+    /** Number of responses invalidated by local changes */
+    unsigned long invalidations;
+    /** Number of responses in the cache */
+    unsigned entries;
+    /** Number of bytes the responses in the cache take */
+    size_t bytes;
+};
+
+
+/** Creates an Objects API response cache which keeps at most @p
+    max_bytes of responses (with their keys and bookkeeping).
+
+    @retval NULL Failed to allocate
+    @return The cache created
+*/
+pubnub_objects_cache_t* pubnub_objects_cache_create(size_t max_bytes);
+
+/** Sets the @p cache to use for the Objects API requests on the
+    context @p pb. Use NULL to stop using a cache. Should be called
+    after pubnub_init(), while no transaction is going on.
+*/
+void pubnub_set_objects_cache(pubnub_t* pb, pubnub_objects_cache_t* cache);
+
+/** Returns whether the outcome of the last cacheable Objects API
+    transaction on the context @p pb was taken from its Objects API
+    response cache.
+*/
+bool pubnub_objects_cache_hit(pubnub_t* pb);
+
+/** Removes all responses from the @p cache */
+void pubnub_objects_cache_clear(pubnub_objects_cache_t* cache);
+
+/** Gets the current metrics of the @p cache to @p metrics */
+void pubnub_objects_cache_get_metrics(pubnub_objects_cache_t*              cache,
+                                      struct pubnub_objects_cache_metrics* metrics);
+
+/** Destroys the @p cache. No context may use it any more (set
+    another, or NULL, to the contexts that used it, or free them).
+*/
+void pubnub_objects_cache_destroy(pubnub_objects_cache_t* cache);
+
+
+#endif /* !defined INC_PUBNUB_OBJECTS_CACHE */
@@ -0,0 +1,103 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_OBJECTS_CACHE_CORE
+#define INC_PUBNUB_OBJECTS_CACHE_CORE
+
+
+/** @file pubnub_objects_cache_core.h
+
+    This is the internal part of the Objects API response cache - the
+    data kept in the context and the functions the Objects API and
+    the Pubnub "net-core" FSM use to revalidate and store responses.
+ */
+
+#if PUBNUB_USE_OBJECTS_CACHE
+
+#if !PUBNUB_USE_OBJECTS_API
+#error To use the Objects API cache you must define PUBNUB_USE_OBJECTS_API=1
+#endif
+
+#include "pubnub_objects_cache.h"
+
+
+/** Maximum length of the key (request path and options) of a
+    cacheable request. Longer requests are not cached. */
+#if !defined PUBNUB_OBJECTS_CACHE_KEY_MAXLEN
+#define PUBNUB_OBJECTS_CACHE_KEY_MAXLEN 256
+#endif
+
+/** Maximum length of the `ETag` of a response. Responses with longer
+    ones are not cached. */
+#if !defined PUBNUB_OBJECTS_CACHE_ETAG_MAXLEN
+#define PUBNUB_OBJECTS_CACHE_ETAG_MAXLEN 80
+#endif
+
+struct pbobjc_entry;
+
+/** The Objects API cache data of a context */
+struct pbobjc_context {
+    /** The cache to use, NULL if none */
+    pubnub_objects_cache_t* cache;
+    /** The cached response being revalidated (its `ETag` was sent),
+        pinned, so it's not freed while in use, NULL if none */
+    struct pbobjc_entry* entry;
+    /** The outcome of the last transaction was taken from the cache */
+    bool hit;
+    /** Key of the current request, empty if it's not cacheable */
+    char key[PUBNUB_OBJECTS_CACHE_KEY_MAXLEN + 1];
+    /** The `ETag` of the response, empty if none */
+    char etag[PUBNUB_OBJECTS_CACHE_ETAG_MAXLEN + 1];
+};
+
+
+/** Called when a cacheable request was prepared (in the HTTP buffer)
+    on the context @p pb. Looks for its response in the cache.
+*/
+void pbobjc_request_start(pubnub_t* pb);
+
+/** Called when a request that changes the @p kind ("users" or
+    "spaces") object with @p id was prepared on the context @p
+    pb. Invalidates the cached responses of it, and the lists of @p
+    kind. If @p id is NULL (not known, or a new object), invalidates
+    all the cached responses of @p kind.
+*/
+void pbobjc_invalidate(pubnub_t* pb, char const* kind, char const* id);
+
+/** Returns the `ETag` to send in `If-None-Match` on the context @p
+    pb, or NULL if none.
+ */
+char const* pbobjc_if_none_match(pubnub_t* pb);
+
+/** Called for each response header @p line (of length @p len) read
+    on the context @p pb, to get the `ETag`.
+ */
+void pbobjc_header(pubnub_t* pb, char const* line, size_t len);
+
+/** Called when the body of the response was read on the context @p
+    pb. On `304 Not Modified`, puts the cached response to the reply
+    buffer.
+    @retval 0 OK
+    @retval -1 cached response does not fit in the reply buffer
+ */
+int pbobjc_response_body(pubnub_t* pb);
+
+/** Called with the outcome @p pbres of parsing the response on the
+    context @p pb. Stores a new response in the cache.
+ */
+void pbobjc_response(pubnub_t* pb, enum pubnub_res pbres);
+
+/** Releases the cached response pinned by the context @p pb */
+void pbobjc_release(pubnub_t* pb);
+
+#define PBOBJC_REQUEST_START(pb) pbobjc_request_start(pb)
+#define PBOBJC_INVALIDATE(pb, kind, id) pbobjc_invalidate((pb), (kind), (id))
+#define PBOBJC_FREE(pb) pbobjc_release(pb)
+
+#else
+
+#define PBOBJC_REQUEST_START(pb)
+#define PBOBJC_INVALIDATE(pb, kind, id)
+#define PBOBJC_FREE(pb)
+
+#endif /* PUBNUB_USE_OBJECTS_CACHE */
+
+#endif /* !defined INC_PUBNUB_OBJECTS_CACHE_CORE */
@@ -0,0 +1,297 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "pubnub_objects_pager.h"
+
+#include "pubnub_pubsubapi.h"
+#include "pubnub_ntf_sync.h"
+#include "pubnub_blocking_io.h"
+#include "pubnub_alloc.h"
+#include "pubnub_free_with_timeout.h"
+#include "pubnub_objects_api.h"
+#include "pbcc_objects_api.h"
+#include "pubnub_helper.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/** Objects API pager descriptor */
+struct pubnub_objects_pager {
+    /** The two contexts: one has the page being yielded, the other
+        fetches the next page */
+    pubnub_t* pbs[2];
+    /** Index of the context with the page being yielded */
+    unsigned current;
+    /** The page on the current context was received */
+    bool current_ready;
+    /** The next page is being fetched on the other context */
+    bool prefetching;
+    /** Outcome of starting to fetch the next page, reported when the
+        current page is done */
+    enum pubnub_res prefetch_error;
+
+    /** The list being gone through, and its parameters */
+    enum pubnub_objects_list list;
+    char const*              id;
+    char const**             include;
+    size_t                   include_count;
+    size_t                   limit;
+
+    /** The `next` cursor of the page being fetched */
+    char cursor[PUBNUB_OBJECTS_PAGER_CURSOR_MAXLEN + 1];
+    /** Outcome of going through the list */
+    enum pubnub_res result;
+    /** Number of pages received */
+    unsigned pages;
+};
+
+
+/** Starts fetching the page of the list of @p pg, which starts at @p
+    cursor (NULL for the first page), on the context @p pb.
+ */
+static enum pubnub_res fetch_page(pubnub_objects_pager_t* pg, pubnub_t* pb, char const* cursor)
+{
+    switch (pg->list) {
+    case pbolUsers:
+        return pubnub_fetch_all_users(
+            pb, pg->include, pg->include_count, pg->limit, cursor, NULL, pbccNotSet);
+    case pbolSpaces:
+        return pubnub_fetch_all_spaces(
+            pb, pg->include, pg->include_count, pg->limit, cursor, NULL, pbccNotSet);
+    case pbolUsersSpaceMemberships:
+        return pubnub_fetch_users_space_memberships(
+            pb, pg->id, pg->include, pg->include_count, pg->limit, cursor, NULL, pbccNotSet);
+    case pbolMembersInSpace:
+        return pubnub_fetch_members_in_space(
+            pb, pg->id, pg->include, pg->include_count, pg->limit, cursor, NULL, pbccNotSet);
+    default:
+        PUBNUB_LOG_ERROR("Objects pager %p: unknown list %d\n", pg, pg->list);
+        return PNR_INVALID_PARAMETERS;
+    }
+}
+
+
+/** Returns whether the outcome @p res of starting to fetch a page
+    means that the page is (being) fetched. With non-blocking I/O, the
+    transaction may finish right away (for example, on a fast local
+    network), in which case the page is already received and parsed.
+ */
+static bool fetch_started(enum pubnub_res res)
+{
+    return (PNR_STARTED == res) || (PNR_OBJECTS_API_OK == res);
+}
+
+
+/** Starts fetching the page after the one received on the current
+    context, on the other context, if there is one.
+ */
+static void prefetch(pubnub_objects_pager_t* pg)
+{
+    pubnub_t*        pb = pg->pbs[pg->current];
+    pubnub_chamebl_t next;
+    enum pubnub_res  res;
+
+    pubnub_mutex_lock(pb->monitor);
+    next = pbcc_get_objects_next(&pb->core);
+    if (next.size >= sizeof pg->cursor) {
+        pubnub_mutex_unlock(pb->monitor);
+        PUBNUB_LOG_ERROR("Objects pager %p: next page cursor too long: '%.*s'\n",
+                         pg,
+                         (int)next.size,
+                         next.ptr);
+        pg->prefetch_error = PNR_TX_BUFF_TOO_SMALL;
+        return;
+    }
+    if (next.size > 0) {
+        memcpy(pg->cursor, next.ptr, next.size);
+    }
+    pg->cursor[next.size] = '\0';
+    pubnub_mutex_unlock(pb->monitor);
+
+    if (0 == next.size) {
+        return;
+    }
+    res = fetch_page(pg, pg->pbs[!pg->current], pg->cursor);
+    if (fetch_started(res)) {
+        pg->prefetching = true;
+    }
+    else {
+        pg->prefetch_error = res;
+    }
+}
+
+
+/** Cancels the transaction on @p pb, if there is one */
+static void cancel(pubnub_t* pb)
+{
+    if (PN_CANCEL_STARTED == pubnub_cancel(pb)) {
+        pubnub_await(pb);
+    }
+}
+
+
+pubnub_objects_pager_t* pubnub_objects_pager_create(char const* publish_key,
+                                                    char const* subscribe_key)
+{
+    pubnub_objects_pager_t* pg;
+    unsigned                i;
+
+    PUBNUB_ASSERT_OPT(publish_key != NULL);
+    PUBNUB_ASSERT_OPT(subscribe_key != NULL);
+
+    pg = (pubnub_objects_pager_t*)calloc(1, sizeof *pg);
+    if (NULL == pg) {
+        return NULL;
+    }
+    for (i = 0; i < 2; ++i) {
+        pubnub_t* pb = pubnub_alloc();
+        if (NULL == pb) {
+            PUBNUB_LOG_ERROR("Failed to allocate context %u for the Objects pager\n", i);
+            pubnub_objects_pager_destroy(pg, 0);
+            return NULL;
+        }
+        pubnub_init(pb, publish_key, subscribe_key);
+        pubnub_set_non_blocking_io(pb);
+        pg->pbs[i] = pb;
+    }
+    pg->result = PNR_OBJECTS_API_OK;
+
+    return pg;
+}
+
+
+pubnub_t* pubnub_objects_pager_context(pubnub_objects_pager_t* pg, unsigned i)
+{
+    PUBNUB_ASSERT_OPT(pg != NULL);
+    return (i < 2) ? pg->pbs[i] : NULL;
+}
+
+
+enum pubnub_res pubnub_objects_pager_start(pubnub_objects_pager_t*  pg,
+                                           enum pubnub_objects_list list,
+                                           char const*              id,
+                                           char const**             include,
+                                           size_t                   include_count,
+                                           size_t                   limit)
+{
+    enum pubnub_res res;
+
+    PUBNUB_ASSERT_OPT(pg != NULL);
+
+    cancel(pg->pbs[0]);
+    cancel(pg->pbs[1]);
+    pg->list           = list;
+    pg->id             = id;
+    pg->include        = include;
+    pg->include_count  = include_count;
+    pg->limit          = limit;
+    pg->current        = 0;
+    pg->current_ready  = false;
+    pg->prefetching    = false;
+    pg->prefetch_error = PNR_OK;
+    pg->pages          = 0;
+
+    res = fetch_page(pg, pg->pbs[0], NULL);
+    if (fetch_started(res)) {
+        /* If the first page is already received, pubnub_await()
+           reports it in pubnub_objects_pager_next() */
+        res = PNR_STARTED;
+    }
+    pg->result = res;
+
+    return res;
+}
+
+
+bool pubnub_objects_pager_next(pubnub_objects_pager_t* pg, pubnub_chamebl_t* o_object)
+{
+    PUBNUB_ASSERT_OPT(pg != NULL);
+    PUBNUB_ASSERT_OPT(o_object != NULL);
+
+    while (PNR_STARTED == pg->result) {
+        pubnub_t* pb = pg->pbs[pg->current];
+
+        if (!pg->current_ready) {
+            enum pubnub_res res = pubnub_await(pb);
+            if (res != PNR_OBJECTS_API_OK) {
+                PUBNUB_LOG_ERROR("Objects pager %p: page %u failed: %d('%s')\n",
+                                 pg,
+                                 pg->pages,
+                                 res,
+                                 pubnub_res_2_string(res));
+                pg->result = res;
+                break;
+            }
+            ++pg->pages;
+            pg->current_ready = true;
+            prefetch(pg);
+        }
+
+        pubnub_mutex_lock(pb->monitor);
+        *o_object = pbcc_get_object(&pb->core);
+        pubnub_mutex_unlock(pb->monitor);
+        if (o_object->ptr != NULL) {
+            if (pg->prefetching) {
+                /* Drive the (non-blocking) fetch of the next page */
+                pubnub_last_result(pg->pbs[!pg->current]);
+            }
+            return true;
+        }
+
+        /* This page is done, go to the next one */
+        if (pg->prefetching) {
+            pg->current       = !pg->current;
+            pg->current_ready = false;
+            pg->prefetching   = false;
+        }
+        else {
+            pg->result = (PNR_OK == pg->prefetch_error) ? PNR_OBJECTS_API_OK
+                                                        : pg->prefetch_error;
+        }
+    }
+
+    o_object->ptr  = NULL;
+    o_object->size = 0;
+
+    return false;
+}
+
+
+enum pubnub_res pubnub_objects_pager_result(pubnub_objects_pager_t const* pg)
+{
+    PUBNUB_ASSERT_OPT(pg != NULL);
+    return pg->result;
+}
+
+
+unsigned pubnub_objects_pager_page_count(pubnub_objects_pager_t const* pg)
+{
+    PUBNUB_ASSERT_OPT(pg != NULL);
+    return pg->pages;
+}
+
+
+int pubnub_objects_pager_destroy(pubnub_objects_pager_t* pg, unsigned millisec)
+{
+    pubnub_t* pbs[2];
+    unsigned  n = 0;
+    unsigned  i;
+
+    PUBNUB_ASSERT_OPT(pg != NULL);
+
+    for (i = 0; i < 2; ++i) {
+        if (pg->pbs[i] != NULL) {
+            pbs[n++] = pg->pbs[i];
+        }
+    }
+    if (pubnub_free_all_with_timeout(pbs, n, millisec) != 0) {
+        PUBNUB_LOG_ERROR("Failed to free the contexts of the Objects pager %p\n", pg);
+        return -1;
+    }
+    free(pg);
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_OBJECTS_PAGER
+#define INC_PUBNUB_OBJECTS_PAGER
+
+
+#include "pubnub_api_types.h"
+#include "pubnub_memory_block.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#if defined PUBNUB_CALLBACK_API
+#error The Objects API pager is available only in the sync interface
+#endif
+
+
+/** @file pubnub_objects_pager.h
+
+    This module implements a "pager" for the list transactions of the
+    Objects API, for the sync interface: it goes through all the pages
+    of a list (users, spaces, memberships of a user or members of a
+    space), following the `next` cursor of each page, and yields the
+    objects in the list, one by one.
+
+    It has two Pubnub contexts, owned by the pager, with non-blocking
+    I/O. While the objects of a page are yielded from one of them, the
+    next page is fetched on the other. So, going through a long list
+    takes (about) as long as it takes to process its objects, not as
+    long as the round-trip times of all its pages.
+
+    A pager may be used from one thread at a time.
+*/
+
+
+/** The list to go through */
+enum pubnub_objects_list {
+    /** All the users, pubnub_fetch_all_users() */
+    pbolUsers,
+    /** All the spaces, pubnub_fetch_all_spaces() */
+    pbolSpaces,
+    /** The space memberships of a user,
+        pubnub_fetch_users_space_memberships() */
+    pbolUsersSpaceMemberships,
+    /** The members of a space, pubnub_fetch_members_in_space() */
+    pbolMembersInSpace
+};
+
+/** Maximum length of the `next` page cursor */
+#if !defined PUBNUB_OBJECTS_PAGER_CURSOR_MAXLEN
+#define PUBNUB_OBJECTS_PAGER_CURSOR_MAXLEN 128
+#endif
+
+
+/** An Objects API pager descriptor. An opaque data structure. */
+struct pubnub_objects_pager;
+
+/** A helper typedef of an Objects API pager descriptor */
+typedef struct pubnub_objects_pager pubnub_objects_pager_t;
+
+
+/** Creates an Objects API pager, with its two contexts initialized
+    with the given keys.
+
+    To change other settings of the contexts (UUID, auth, proxy...),
+    use pubnub_objects_pager_context().
+
+    @retval NULL Failed to create a pager
+    @result The pager created
+ */
+pubnub_objects_pager_t* pubnub_objects_pager_create(char const* publish_key,
+                                                    char const* subscribe_key);
+
+/** Returns the context with the index @p i (0 or 1) of the pager, so
+    that its settings may be changed.
+
+    @warning Do not start transactions on the context. Do not free
+    it, it's owned by the pager.
+
+    @retval NULL @p i out of range
+    @result The context
+*/
+pubnub_t* pubnub_objects_pager_context(pubnub_objects_pager_t* pg, unsigned i);
+
+/** Starts going through the @p list, fetching its first page. If the
+    pager was going through another list, it is cancelled.
+
+    @param pg The pager
+    @param list The list to go through
+    @param id The user ID (for #pbolUsersSpaceMemberships) or space
+    ID (for #pbolMembersInSpace), ignored for the other lists
+    @param include Additional attributes to include in each object,
+    as for the list transactions, can be NULL. Must be valid until
+    the list is done.
+    @param include_count Number of elements in @p include
+    @param limit Number of objects in a page, 0 for the server default
+
+    @retval PNR_STARTED started
+    @return Error of the first page transaction, otherwise
+ */
+enum pubnub_res pubnub_objects_pager_start(pubnub_objects_pager_t*  pg,
+                                           enum pubnub_objects_list list,
+                                           char const*              id,
+                                           char const**             include,
+                                           size_t                   include_count,
+                                           size_t                   limit);
+
+/** Gets the next object in the list to @p o_object, as a JSON
+    element (a "slice" of the response, not NUL terminated). Waits
+    for its page, if it was not received yet. It is valid until the
+    next call to this function (or pubnub_objects_pager_start()).
+
+    @retval true got the next object
+    @retval false no more objects: the list is done, or a page
+    transaction failed, see pubnub_objects_pager_result()
+ */
+bool pubnub_objects_pager_next(pubnub_objects_pager_t* pg, pubnub_chamebl_t* o_object);
+
+/** Returns the outcome of going through the list: #PNR_STARTED while
+    in progress, #PNR_OBJECTS_API_OK when all its objects were
+    yielded, or the error of the page transaction that failed.
+ */
+enum pubnub_res pubnub_objects_pager_result(pubnub_objects_pager_t const* pg);
+
+/** Returns the number of pages received of the current list */
+unsigned pubnub_objects_pager_page_count(pubnub_objects_pager_t const* pg);
+
+/** Destroys the pager, freeing its contexts, waiting at most @p
+    millisec for them.
+
+    @retval 0 pager destroyed
+    @retval -1 failed to free some context(s) in due time, pager
+    can't be destroyed (it is "leaked")
+ */
+int pubnub_objects_pager_destroy(pubnub_objects_pager_t* pg, unsigned millisec);
+
+
+#endif /* !defined INC_PUBNUB_OBJECTS_PAGER */
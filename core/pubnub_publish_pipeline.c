@@ -0,0 +1,519 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_PUBLISH_PIPELINE
+#include "pubnub_publish_pipeline.h"
+#include "pubnub_ccore_pubsub.h"
+#include "pubnub_netcore.h"
+#include "pubnub_pubsubapi.h"
+
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+
+#define PIPELINE_INDEX(p, i) (((p)->head + (i)) % PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN)
+
+
+static enum pubnub_res prep_item(pubnub_t* pb, struct pbpipe_item const* item)
+{
+    struct pubnub_publish_options const* opts = item->options;
+    enum pubnub_res                      rslt = pbcc_publish_prep(&pb->core,
+                                             item->channel,
+                                             item->message,
+                                             (NULL == opts) || opts->store,
+                                             (opts != NULL) && !opts->replicate,
+                                             (NULL == opts) ? NULL : opts->meta,
+                                             pubnubSendViaGET);
+#if PUBNUB_PROXY_API
+    /* The path to (re)use is the one we just prepared */
+    pb->proxy_saved_path_len = 0;
+#endif
+    return rslt;
+}
+
+
+/** Finishes the batch (if all of its items are reported), restoring
+    the pipeline settings and calling the completion callback.
+ */
+static void batch_finish(pubnub_t* pb)
+{
+    struct pbpipe_publish* p     = &pb->pipeline;
+    struct pbpipe_batch    batch = p->batch;
+
+    if ((NULL == batch.items) || (batch.reported < batch.count)) {
+        return;
+    }
+    PUBNUB_LOG_TRACE("pb=%p publish pipeline: batch of %lu done, %u failed\n",
+                     pb,
+                     (unsigned long)batch.count,
+                     batch.failed);
+    p->depth       = batch.saved_depth;
+    p->batch.items = NULL;
+    if (batch.done != NULL) {
+        batch.done(pb, batch.items, batch.count, batch.failed, batch.user_data);
+    }
+}
+
+
+/** Puts the items of the batch in the pipeline queue, while there is
+    room for them. Items that can't be pipelined are failed right
+    away.
+ */
+static void batch_fill(pubnub_t* pb)
+{
+    struct pbpipe_publish* p     = &pb->pipeline;
+    struct pbpipe_batch*   batch = &p->batch;
+
+    while ((batch->next < batch->count)
+           && (p->count < PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN)) {
+        struct pubnub_publish_batch_item*    bi   = &batch->items[batch->next++];
+        struct pubnub_publish_options const* opts = bi->options;
+        struct pbpipe_item*                  item;
+
+        if ((opts != NULL)
+            && ((opts->cipher_key != NULL)
+                || ((opts->method != pubnubSendViaGET)
+                    && (opts->method != pubnubSendAdaptive)))) {
+            bi->result         = PNR_INVALID_PARAMETERS;
+            bi->publish_result = PNPUB_UNKNOWN_ERROR;
+            ++batch->reported;
+            ++batch->failed;
+            continue;
+        }
+        bi->result      = PNR_STARTED;
+        item            = &p->items[PIPELINE_INDEX(p, p->count)];
+        item->channel   = bi->channel;
+        item->message   = bi->message;
+        item->options   = opts;
+        item->item_data = bi;
+        item->result    = PNR_STARTED;
+        ++p->count;
+    }
+}
+
+
+/** Accounts the outcome of a batch item and puts more items of the
+    batch in the (now not full) pipeline queue.
+ */
+static void batch_account(pubnub_t* pb, enum pubnub_res result)
+{
+    struct pbpipe_batch* batch = &pb->pipeline.batch;
+
+    ++batch->reported;
+    if (result != PNR_OK) {
+        ++batch->failed;
+    }
+    batch_fill(pb);
+    batch_finish(pb);
+}
+
+
+static void report_item(pubnub_t*                 pb,
+                        struct pbpipe_item const* item,
+                        enum pubnub_res           result)
+{
+    struct pbpipe_publish*  p = &pb->pipeline;
+    enum pubnub_publish_res publish_result;
+
+    switch (result) {
+    case PNR_OK:
+        publish_result = PNPUB_SENT;
+        break;
+    case PNR_PUBLISH_FAILED:
+        publish_result = pubnub_parse_publish_result(pubnub_last_publish_result(pb));
+        break;
+    default:
+        publish_result = PNPUB_UNKNOWN_ERROR;
+        break;
+    }
+    PUBNUB_LOG_TRACE("pb=%p publish pipeline: reporting item_data=%p "
+                     "result=%d publish_result=%d\n",
+                     pb,
+                     item->item_data,
+                     result,
+                     publish_result);
+    if (p->batch.items != NULL) {
+        struct pubnub_publish_batch_item* bi =
+            (struct pubnub_publish_batch_item*)item->item_data;
+        bi->result         = result;
+        bi->publish_result = publish_result;
+        batch_account(pb, result);
+        return;
+    }
+    p->cb(pb, result, publish_result, item->item_data, p->user_data);
+}
+
+
+/** Removes the head item from the queue and reports it with @p result */
+static void pop_and_report(pubnub_t* pb, enum pubnub_res result)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+    struct pbpipe_item     item;
+
+    PUBNUB_ASSERT_OPT(p->count > 0);
+    item    = p->items[p->head];
+    p->head = PIPELINE_INDEX(p, 1);
+    --p->count;
+    if (p->sent > 0) {
+        --p->sent;
+    }
+    /* Reported after removal, so that the callback may enqueue */
+    report_item(pb, &item, result);
+}
+
+
+/** Reports the items at the head of the queue for which preparing
+    the request failed - they don't have a response to wait for.
+ */
+static void pop_failed(pubnub_t* pb)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    while ((p->sent > 0) && (p->items[p->head].result != PNR_STARTED)) {
+        pop_and_report(pb, p->items[p->head].result);
+    }
+}
+
+
+/** Prepares the first item waiting to be sent which can be prepared.
+    Items which fail are marked as such. If there is nothing on the
+    wire, they are reported right away, as there's nothing before
+    them in the queue to report.
+    @return true: request prepared in the HTTP buffer, false: no
+    (more) items to send
+ */
+static bool prep_waiting(pubnub_t* pb)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    while (p->sent < p->count) {
+        struct pbpipe_item* item = &p->items[PIPELINE_INDEX(p, p->sent)];
+        enum pubnub_res     rslt = prep_item(pb, item);
+        ++p->sent;
+        if (PNR_STARTED == rslt) {
+            item->result = PNR_STARTED;
+            ++p->on_wire;
+            return true;
+        }
+        PUBNUB_LOG_WARNING("pb=%p publish pipeline: failed to prepare "
+                           "request for channel '%s': %d\n",
+                           pb,
+                           item->channel,
+                           rslt);
+        item->result = rslt;
+        if (0 == p->on_wire) {
+            pop_failed(pb);
+        }
+    }
+    return false;
+}
+
+
+bool pbpipe_prep_next(pubnub_t* pb)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    if (!p->running || (p->on_wire >= p->depth)) {
+        return false;
+    }
+    return prep_waiting(pb);
+}
+
+
+static bool should_keep_connection(pubnub_t* pb, enum pubnub_res pbres)
+{
+    if (pb->flags.should_close) {
+        return false;
+    }
+    switch (pbres) {
+    case PNR_OK:
+    case PNR_PUBLISH_FAILED:
+    case PNR_HTTP_ERROR:
+    case PNR_FORMAT_ERROR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+/** Puts the requests which were sent, but not answered, back in the
+    queue, to be sent again.
+ */
+static void put_back_on_wire(struct pbpipe_publish* p)
+{
+    unsigned i;
+    for (i = 0; i < p->sent; ++i) {
+        p->items[PIPELINE_INDEX(p, i)].result = PNR_STARTED;
+    }
+    p->sent    = 0;
+    p->on_wire = 0;
+}
+
+
+enum pbpipe_next pbpipe_response(pubnub_t* pb, enum pubnub_res pbres)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    if (!p->running) {
+        return pbpipeNotPipelined;
+    }
+    PUBNUB_ASSERT_OPT(p->on_wire > 0);
+
+    pop_failed(pb);
+    --p->on_wire;
+    pop_and_report(pb, pbres);
+    pop_failed(pb);
+
+    if (!should_keep_connection(pb, pbres)) {
+        if (0 == p->count) {
+            p->running = 0;
+            return pbpipeDone;
+        }
+        put_back_on_wire(p);
+#if PUBNUB_NEED_RETRY_AFTER_CLOSE
+        if (prep_waiting(pb)) {
+            return pbpipeRetry;
+        }
+        p->running = 0;
+        return pbpipeDone;
+#else
+        {
+            unsigned i;
+            for (i = 0; i < p->count; ++i) {
+                p->items[PIPELINE_INDEX(p, i)].result = PNR_ABORTED;
+            }
+        }
+        return pbpipeDone;
+#endif
+    }
+    if (p->on_wire > 0) {
+        return pbpipeReadNext;
+    }
+    if (prep_waiting(pb)) {
+        return pbpipeSendNext;
+    }
+    p->running = 0;
+
+    return pbpipeDone;
+}
+
+
+void pbpipe_rewind(pubnub_t* pb)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    if (p->running && (p->on_wire > 0)) {
+        PUBNUB_LOG_TRACE("pb=%p publish pipeline: rewinding %u requests\n",
+                         pb,
+                         p->on_wire);
+        put_back_on_wire(p);
+        prep_waiting(pb);
+    }
+}
+
+
+void pbpipe_trans_outcome(pubnub_t* pb)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    if (p->running) {
+        p->running = 0;
+        p->on_wire = 0;
+        while (p->count > 0) {
+            enum pubnub_res rslt = p->items[p->head].result;
+            if (PNR_STARTED == rslt) {
+                rslt = pb->core.last_result;
+            }
+            pop_and_report(pb, rslt);
+        }
+    }
+}
+
+
+/** Starts the pipeline transaction, with the context locked.
+    @retval PNR_OK nothing to send
+    @retval otherwise as pubnub_publish_pipeline_start()
+ */
+static enum pubnub_res start_transaction(pubnub_t* pb)
+{
+    struct pbpipe_publish* p = &pb->pipeline;
+
+    p->sent = p->on_wire = 0;
+    if (!prep_waiting(pb)) {
+        return PNR_OK;
+    }
+    p->running           = 1;
+    pb->trans            = PBTT_PUBLISH;
+    pb->method           = pubnubSendViaGET;
+    pb->core.last_result = PNR_STARTED;
+    pbnc_fsm(pb);
+
+    return pb->core.last_result;
+}
+
+
+enum pubnub_res pubnub_publish_pipeline_enable(
+    pubnub_t*                          pb,
+    unsigned                           depth,
+    pubnub_publish_pipeline_callback_t cb,
+    void*                              user_data)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    if ((0 == depth) || (depth > PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN)
+        || (NULL == cb)) {
+        return PNR_INVALID_PARAMETERS;
+    }
+    pubnub_mutex_lock(pb->monitor);
+    if (pb->pipeline.running) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    pb->pipeline.depth     = depth;
+    pb->pipeline.cb        = cb;
+    pb->pipeline.user_data = user_data;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pubnub_publish_pipeline_disable(pubnub_t* pb)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    if (pb->pipeline.running) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    pb->pipeline.depth = 0;
+    pb->pipeline.count = pb->pipeline.sent = pb->pipeline.on_wire = 0;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pubnub_publish_pipeline_enqueue(pubnub_t*   pb,
+                                                char const* channel,
+                                                char const* message,
+                                                void*       item_data)
+{
+    struct pbpipe_publish* p;
+    struct pbpipe_item*    item;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(channel != NULL);
+    PUBNUB_ASSERT_OPT(message != NULL);
+
+    pubnub_mutex_lock(pb->monitor);
+    p = &pb->pipeline;
+    if (0 == p->depth) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_INVALID_PARAMETERS;
+    }
+    if (p->count >= PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_QUEUE_FULL;
+    }
+    item            = &p->items[PIPELINE_INDEX(p, p->count)];
+    item->channel   = channel;
+    item->message   = message;
+    item->options   = NULL;
+    item->item_data = item_data;
+    item->result    = PNR_STARTED;
+    ++p->count;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pubnub_publish_pipeline_start(pubnub_t* pb)
+{
+    struct pbpipe_publish* p;
+    enum pubnub_res        rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    p = &pb->pipeline;
+    if (0 == p->depth) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_INVALID_PARAMETERS;
+    }
+    if (p->running) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_STARTED;
+    }
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    rslt = start_transaction(pb);
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+enum pubnub_res pubnub_publish_batch(pubnub_t*                         pb,
+                                     struct pubnub_publish_batch_item* items,
+                                     size_t                            count,
+                                     unsigned                          depth,
+                                     pubnub_publish_batch_callback_t   done,
+                                     void*                             user_data)
+{
+    struct pbpipe_publish* p;
+    enum pubnub_res        rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    if ((0 == depth) || (depth > PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN)
+        || (NULL == items) || (0 == count)) {
+        return PNR_INVALID_PARAMETERS;
+    }
+    pubnub_mutex_lock(pb->monitor);
+    p = &pb->pipeline;
+    if (p->running || (p->count > 0) || !pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    p->batch.items       = items;
+    p->batch.count       = count;
+    p->batch.next        = 0;
+    p->batch.reported    = 0;
+    p->batch.failed      = 0;
+    p->batch.done        = done;
+    p->batch.user_data   = user_data;
+    p->batch.saved_depth = p->depth;
+    p->depth             = depth;
+    batch_fill(pb);
+    rslt = start_transaction(pb);
+    if (PNR_OK == rslt) {
+        /* Nothing was sent, so, this is the end of the batch */
+        batch_finish(pb);
+    }
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+unsigned pubnub_publish_pipeline_pending(pubnub_t* pb)
+{
+    unsigned rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    rslt = pb->pipeline.count;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+#endif /* PUBNUB_USE_PUBLISH_PIPELINE */
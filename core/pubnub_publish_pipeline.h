@@ -0,0 +1,214 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_PUBLISH_PIPELINE
+#define INC_PUBNUB_PUBLISH_PIPELINE
+
+
+#include "pubnub_api_types.h"
+#include "pubnub_helper.h"
+#include "pubnub_coreapi_ex.h"
+
+#include <stddef.h>
+
+
+/** @file pubnub_publish_pipeline.h
+
+    This is the "publish pipeline" API of the Pubnub client library.
+    It is an opt-in publish queue on a context, which uses HTTP/1.1
+    request pipelining: up to a given number of publish requests are
+    sent, one after the other, on the same (kept alive) connection,
+    before their responses are read.
+
+    Responses are matched to requests in order and each is reported,
+    through the pipeline callback, with its own result. The whole
+    "pipeline run" is a single (publish) transaction on the context,
+    and the outcome of it is reported as for any other transaction
+    (callback, or pubnub_await()), after all of the items have been
+    reported.
+
+    Only "plain" publish is supported, that is, the same as
+    pubnub_publish() - GET method, stored in history, no meta.
+    Items with #pubnubSendAdaptive are sent via GET, as requests with
+    a body would stall the pipeline.
+
+    @note Pipelining requires HTTP keep-alive, which is the default.
+    If the server closes the connection, requests that were sent but
+    not answered are re-sent on a new connection (if supported by the
+    build), or reported as PNR_ABORTED.
+*/
+
+
+#if !defined PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN
+/** Maximum number of publish requests that can wait in the pipeline
+    queue of a context (including the ones that were sent but whose
+    responses were not yet read). This is also the maximum depth of
+    the pipeline.
+*/
+#define PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN 32
+#endif
+
+
+/** Type of the pipeline callback. Called once for every item in the
+    pipeline, in the order they were enqueued.
+
+    @param pb The context on which the item was published
+    @param result The outcome of the publish of the item
+    @param publish_result The parsed publish result (PNPUB_SENT on
+    success)
+    @param item_data The data given when the item was enqueued
+    @param user_data The data given when the pipeline was enabled
+
+    @note Called with the context locked, so, don't do anything
+    "long" in it. You may enqueue new items from it.
+*/
+typedef void (*pubnub_publish_pipeline_callback_t)(
+    pubnub_t*               pb,
+    enum pubnub_res         result,
+    enum pubnub_publish_res publish_result,
+    void*                   item_data,
+    void*                   user_data);
+
+
+/** Enables the publish pipeline on the context @p pb, with the
+    pipeline @p depth - the maximum number of requests "on the wire"
+    (sent, but their response not yet read).
+
+    @param pb The Pubnub context
+    @param depth Pipeline depth, 1 to #PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN
+    @param cb The callback to report the outcome of each item
+    @param user_data Passed to @p cb
+    @retval PNR_OK pipeline enabled
+    @retval PNR_INVALID_PARAMETERS @p depth out of range or no @p cb
+    @retval PNR_IN_PROGRESS pipeline is currently running
+ */
+enum pubnub_res pubnub_publish_pipeline_enable(
+    pubnub_t*                          pb,
+    unsigned                           depth,
+    pubnub_publish_pipeline_callback_t cb,
+    void*                              user_data);
+
+/** Disables the publish pipeline on the context @p pb. Can't be
+    done while the pipeline is running. Items still in the queue are
+    discarded without being reported.
+
+    @retval PNR_OK pipeline disabled
+    @retval PNR_IN_PROGRESS pipeline is currently running
+ */
+enum pubnub_res pubnub_publish_pipeline_disable(pubnub_t* pb);
+
+/** Puts the publish of @p message on @p channel in the pipeline queue
+    of the context @p pb. Nothing is sent until the pipeline is
+    started with pubnub_publish_pipeline_start(). If the pipeline is
+    already running, the item will be picked up by it.
+
+    Both @p channel and @p message have to remain valid until the
+    item is reported via the pipeline callback.
+
+    @param item_data Passed to the pipeline callback for this item
+    @retval PNR_OK item enqueued
+    @retval PNR_INVALID_PARAMETERS pipeline not enabled
+    @retval PNR_QUEUE_FULL there are #PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN
+    items in the queue already
+ */
+enum pubnub_res pubnub_publish_pipeline_enqueue(pubnub_t*   pb,
+                                                char const* channel,
+                                                char const* message,
+                                                void*       item_data);
+
+/** Starts the pipeline transaction on the context @p pb, which will
+    last until the pipeline queue is empty (or an error that breaks
+    the connection happens).
+
+    @retval PNR_STARTED pipeline transaction started (or already running)
+    @retval PNR_IN_PROGRESS some other transaction is in progress
+    @retval PNR_INVALID_PARAMETERS pipeline not enabled
+    @retval PNR_OK nothing to send, queue is empty
+    @retval otherwise the outcome of the transaction, if it finished
+    (as may be the case in the sync interface with blocking I/O)
+ */
+enum pubnub_res pubnub_publish_pipeline_start(pubnub_t* pb);
+
+/** Returns the number of items in the pipeline queue of the context
+    @p pb which were not yet reported via the pipeline callback.
+ */
+unsigned pubnub_publish_pipeline_pending(pubnub_t* pb);
+
+
+/** One message of a batch publish, see pubnub_publish_batch() */
+struct pubnub_publish_batch_item {
+    /** The channel to publish to */
+    char const* channel;
+    /** The message to publish (JSON) */
+    char const* message;
+    /** Publish options of this message, NULL for the defaults. The
+        `store`, `replicate` and `meta` are supported. Encryption
+        (`cipher_key`) and publish via POST are not (such items fail
+        with #PNR_INVALID_PARAMETERS), use pubnub_publish_ex() for
+        them. Items with #pubnubSendAdaptive are sent via GET.
+     */
+    struct pubnub_publish_options const* options;
+    /** Set by the batch: the outcome of the publish of this message */
+    enum pubnub_res result;
+    /** Set by the batch: the parsed publish result (PNPUB_SENT on
+        success) */
+    enum pubnub_publish_res publish_result;
+};
+
+/** Type of the batch publish completion callback. Called once, when
+    the outcomes of all the items of the batch are known.
+
+    @param pb The context on which the batch was published
+    @param items The items of the batch, with their outcomes
+    @param count The number of @p items
+    @param failed The number of items that were not published
+    @param user_data The data given to pubnub_publish_batch()
+
+    @note Called with the context locked, before the outcome of the
+    batch (pipeline) transaction is reported as usual.
+*/
+typedef void (*pubnub_publish_batch_callback_t)(pubnub_t*                         pb,
+                                                struct pubnub_publish_batch_item* items,
+                                                size_t                            count,
+                                                unsigned                          failed,
+                                                void*                             user_data);
+
+/** Publishes all the @p items in one (pipeline) transaction on the
+    context @p pb, on the same (kept alive) connection. Up to @p depth
+    requests are sent before their responses are read - with @p depth
+    of 1, there is no pipelining, just one request after the other.
+
+    The outcome of each item is set in the item itself. When they are
+    all known, @p done is called. After that, the outcome of the
+    transaction is reported as for any other transaction (callback,
+    or pubnub_await()) - but, it's the outcome of the last publish, so
+    check the items (or the number of failed ones).
+
+    This uses the publish pipeline of the context: any pipeline
+    settings are kept, but there must not be any items in its queue.
+    The batch may have any number of items. Keep in mind that the
+    transaction timeout applies to the whole batch.
+
+    @param pb The Pubnub context
+    @param items The messages to publish. Has to remain valid until
+    the batch is done.
+    @param count The number of @p items
+    @param depth Pipeline depth, 1 to #PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN
+    @param done Function to call when the batch is done, can be NULL
+    @param user_data Passed to @p done
+
+    @retval PNR_STARTED batch transaction started
+    @retval PNR_OK nothing to send (all items failed, @p done was
+    already called)
+    @retval PNR_INVALID_PARAMETERS @p depth out of range or no @p items
+    @retval PNR_IN_PROGRESS some transaction is in progress, or the
+    pipeline queue is not empty
+    @retval otherwise the outcome of the transaction, if it finished
+ */
+enum pubnub_res pubnub_publish_batch(pubnub_t*                         pb,
+                                     struct pubnub_publish_batch_item* items,
+                                     size_t                            count,
+                                     unsigned                          depth,
+                                     pubnub_publish_batch_callback_t   done,
+                                     void*                             user_data);
+
+
+#endif /* !defined INC_PUBNUB_PUBLISH_PIPELINE */
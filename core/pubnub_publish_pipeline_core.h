@@ -0,0 +1,132 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_PUBLISH_PIPELINE_CORE
+#define INC_PUBNUB_PUBLISH_PIPELINE_CORE
+
+
+/** @file pubnub_publish_pipeline_core.h
+
+    This is the internal part of the publish pipeline module - the
+    data kept in the context and the functions the Pubnub "net-core"
+    FSM uses to drive the pipeline.
+ */
+
+#if PUBNUB_USE_PUBLISH_PIPELINE
+
+#include "pubnub_publish_pipeline.h"
+
+#include <stdbool.h>
+
+
+/** One publish request in the pipeline queue */
+struct pbpipe_item {
+    char const* channel;
+    char const* message;
+    /** Options of the publish, NULL for the defaults */
+    struct pubnub_publish_options const* options;
+    void*                                item_data;
+    /** PNR_STARTED while waiting to be sent, or on the wire, otherwise
+        the (failed) outcome of preparing the request.
+     */
+    enum pubnub_res result;
+};
+
+/** A batch publish, which feeds its items to the pipeline queue */
+struct pbpipe_batch {
+    /** The items of the batch, NULL if there is no batch */
+    struct pubnub_publish_batch_item* items;
+    /** Number of #items */
+    size_t count;
+    /** Index of the first item not yet put in the pipeline queue */
+    size_t next;
+    /** Number of items whose outcome is known */
+    size_t reported;
+    /** Number of items that failed */
+    unsigned                        failed;
+    pubnub_publish_batch_callback_t done;
+    void*                           user_data;
+    /** Pipeline depth to restore when the batch is done */
+    unsigned saved_depth;
+};
+
+/** The publish pipeline data of a context.
+
+    Items in the queue, starting from @c head:
+
+        | sent (on the wire or failed) | waiting to be sent |
+        |<---------------------------->|<------------------>|
+        |<------------------ count ------------------------>|
+*/
+struct pbpipe_publish {
+    /** Maximum number of requests on the wire, 0 if not enabled */
+    unsigned depth;
+    /** Non-zero while the pipeline transaction is going on */
+    int running;
+    /** Index of the oldest item not yet reported */
+    unsigned head;
+    /** Number of items not yet reported */
+    unsigned count;
+    /** Number of items (from head) which were sent, or failed */
+    unsigned sent;
+    /** Number of requests which were sent, but whose response was
+        not yet read.
+     */
+    unsigned on_wire;
+    pubnub_publish_pipeline_callback_t cb;
+    void*                              user_data;
+    struct pbpipe_item items[PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN];
+    /** The batch publish in progress, if any */
+    struct pbpipe_batch batch;
+};
+
+
+/** What should the "net-core" FSM do after a response was read */
+enum pbpipe_next {
+    /** There is no pipeline, finish the transaction as usual */
+    pbpipeNotPipelined,
+    /** Read the next response on the connection */
+    pbpipeReadNext,
+    /** Send the request which was prepared in the HTTP buffer */
+    pbpipeSendNext,
+    /** The request prepared in the HTTP buffer should be sent on a
+        new connection (as this one is getting closed).
+     */
+    pbpipeRetry,
+    /** Pipeline is done, finish the transaction as usual */
+    pbpipeDone
+};
+
+/** Called when a request was sent on the context @p pb, to prepare the
+    next one in the pipeline, if there is one and the pipeline is not
+    "full".
+    @return true: next request is prepared in the HTTP buffer, send it,
+    false: nothing (more) to send, read the response(s)
+ */
+bool pbpipe_prep_next(pubnub_t* pb);
+
+/** Called when a response was read (and parsed, with the outcome @p
+    pbres) on the context @p pb. Reports the item the response is for
+    and, if needed, prepares the next one.
+ */
+enum pbpipe_next pbpipe_response(pubnub_t* pb, enum pubnub_res pbres);
+
+/** Called when the (kept alive) connection is lost and the current
+    request will be re-sent on a new one. Puts all the requests that
+    were sent back in the queue and prepares the first of them in the
+    HTTP buffer.
+ */
+void pbpipe_rewind(pubnub_t* pb);
+
+/** Called on the outcome of the transaction on context @p pb, reports
+    all the items still in the pipeline.
+ */
+void pbpipe_trans_outcome(pubnub_t* pb);
+
+#define PBPIPE_TRANS_OUTCOME(pb) pbpipe_trans_outcome(pb)
+
+#else
+
+#define PBPIPE_TRANS_OUTCOME(pb)
+
+#endif /* PUBNUB_USE_PUBLISH_PIPELINE */
+
+#endif /* !defined INC_PUBNUB_PUBLISH_PIPELINE_CORE */
@@ -0,0 +1,399 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "pubnub_publisher.h"
+
+#include "pubnub_pubsubapi.h"
+#include "pubnub_ntf_callback.h"
+#include "pubnub_alloc.h"
+#include "pubnub_free_with_timeout.h"
+#include "pubnub_mutex.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <stdlib.h>
+
+
+/** A publish request given to the publisher */
+struct pbpub_request {
+    char const*                 channel;
+    char const*                 message;
+    pubnub_publisher_callback_t cb;
+    void*                       request_data;
+};
+
+/** A context of the publisher pool */
+struct pbpub_slot {
+    /** The context itself */
+    pubnub_t* pb;
+    /** The publisher this slot belongs to */
+    pubnub_publisher_t* pbpub;
+    /** The request the context is publishing */
+    struct pbpub_request req;
+    /** Incremented each time a request of this slot is done, so we
+        can tell if a request was already reported.
+     */
+    unsigned generation;
+    /** Set while the slot has a request, that is, it is not idle */
+    bool busy;
+};
+
+/** Publisher descriptor */
+struct pubnub_publisher {
+    /** The pool of contexts */
+    struct pbpub_slot* slots;
+    /** Number of contexts in the pool */
+    unsigned size;
+    /** Stack of indexes of idle slots */
+    pubnub_guarded_by(monitor) unsigned* idle;
+    /** Number of idle slots */
+    pubnub_guarded_by(monitor) unsigned idle_count;
+    /** Ring buffer of requests waiting for an idle context */
+    pubnub_guarded_by(monitor) struct pbpub_request* queue;
+    /** Size of the #queue */
+    unsigned queue_len;
+    /** Index of the first request in the #queue */
+    pubnub_guarded_by(monitor) unsigned head;
+    /** Number of requests in the #queue */
+    pubnub_guarded_by(monitor) unsigned count;
+    /** Set when the publisher is being destroyed */
+    pubnub_guarded_by(monitor) int stopping;
+    /** Metrics of the publisher (`busy` and `queued` are calculated) */
+    pubnub_guarded_by(monitor) struct pubnub_publisher_metrics metrics;
+
+#if PUBNUB_THREADSAFE
+    pubnub_mutex_t monitor;
+#endif
+};
+
+
+static void account(pubnub_publisher_t* pbpub, enum pubnub_res result)
+{
+    if (PNR_OK == result) {
+        ++pbpub->metrics.published;
+    }
+    else {
+        ++pbpub->metrics.failed;
+    }
+}
+
+
+/** Marks the request of the @p slot as done and takes the next one
+    from the queue, if there is one. Otherwise, the slot becomes idle.
+    Has to be called with the publisher locked.
+    @return true: next request taken, start it, false: slot is idle
+ */
+static bool take_next(pubnub_publisher_t* pbpub, struct pbpub_slot* slot)
+{
+    ++slot->generation;
+    if (pbpub->stopping || (0 == pbpub->count)) {
+        PUBNUB_ASSERT_OPT(pbpub->idle_count < pbpub->size);
+        pbpub->idle[pbpub->idle_count++] = (unsigned)(slot - pbpub->slots);
+        slot->busy                       = false;
+        return false;
+    }
+    slot->req   = pbpub->queue[pbpub->head];
+    pbpub->head = (pbpub->head + 1) % pbpub->queue_len;
+    --pbpub->count;
+
+    return true;
+}
+
+
+static void report(pubnub_t* pb, struct pbpub_request const* req, enum pubnub_res result)
+{
+    PUBNUB_LOG_TRACE("pb=%p publisher: reporting request_data=%p result=%d\n",
+                     pb,
+                     req->request_data,
+                     result);
+    if (req->cb != NULL) {
+        req->cb(pb, result, req->request_data);
+    }
+}
+
+
+/** Starts the request of the @p slot (and the next one(s) from the
+    queue, if it fails right away). Has to be called with the
+    publisher unlocked.
+*/
+static void start_publish(struct pbpub_slot* slot)
+{
+    pubnub_publisher_t* pbpub = slot->pbpub;
+
+    for (;;) {
+        struct pbpub_request req;
+        unsigned             generation;
+        enum pubnub_res      rslt;
+        bool                 more;
+
+        pubnub_mutex_lock(pbpub->monitor);
+        req        = slot->req;
+        generation = slot->generation;
+        pubnub_mutex_unlock(pbpub->monitor);
+
+        rslt = pubnub_publish(slot->pb, req.channel, req.message);
+        if (PNR_STARTED == rslt) {
+            return;
+        }
+
+        pubnub_mutex_lock(pbpub->monitor);
+        if (generation != slot->generation) {
+            /* Already reported from the context callback */
+            pubnub_mutex_unlock(pbpub->monitor);
+            return;
+        }
+        account(pbpub, rslt);
+        more = take_next(pbpub, slot);
+        pubnub_mutex_unlock(pbpub->monitor);
+
+        report(slot->pb, &req, rslt);
+        if (!more) {
+            return;
+        }
+    }
+}
+
+
+static void publisher_context_callback(pubnub_t*         pb,
+                                       enum pubnub_trans trans,
+                                       enum pubnub_res   result,
+                                       void*             user_data)
+{
+    struct pbpub_slot*  slot = (struct pbpub_slot*)user_data;
+    pubnub_publisher_t* pbpub;
+    struct pbpub_request req;
+    bool                 more;
+
+    PUBNUB_ASSERT_OPT(slot != NULL);
+    PUBNUB_ASSERT_OPT(slot->pb == pb);
+
+    if (PBTT_NONE == trans) {
+        /* Context being freed, not a request of ours */
+        return;
+    }
+    if (trans != PBTT_PUBLISH) {
+        PUBNUB_LOG_WARNING("pb=%p publisher: unexpected transaction %d "
+                           "outcome %d\n",
+                           pb,
+                           trans,
+                           result);
+        return;
+    }
+    pbpub = slot->pbpub;
+
+    pubnub_mutex_lock(pbpub->monitor);
+    if (!slot->busy) {
+        /* A transaction cancelled again (by another pubnub_free() of
+           the context, when destroying) is reported again */
+        pubnub_mutex_unlock(pbpub->monitor);
+        return;
+    }
+    req = slot->req;
+    account(pbpub, result);
+    more = take_next(pbpub, slot);
+    pubnub_mutex_unlock(pbpub->monitor);
+
+    report(pb, &req, result);
+    if (more) {
+        start_publish(slot);
+    }
+}
+
+
+static void free_contexts(pubnub_publisher_t* pbpub, unsigned n)
+{
+    unsigned i;
+    for (i = 0; i < n; ++i) {
+        pubnub_free(pbpub->slots[i].pb);
+    }
+}
+
+
+static void free_publisher(pubnub_publisher_t* pbpub)
+{
+    pubnub_mutex_destroy(pbpub->monitor);
+    free(pbpub->queue);
+    free(pbpub->idle);
+    free(pbpub->slots);
+    free(pbpub);
+}
+
+
+pubnub_publisher_t* pubnub_publisher_create(char const* publish_key,
+                                            char const* subscribe_key,
+                                            unsigned    size,
+                                            unsigned    queue_len)
+{
+    pubnub_publisher_t* pbpub;
+    unsigned            i;
+
+    PUBNUB_ASSERT_OPT(publish_key != NULL);
+    PUBNUB_ASSERT_OPT(subscribe_key != NULL);
+
+    if (0 == size) {
+        return NULL;
+    }
+    pbpub = (pubnub_publisher_t*)calloc(1, sizeof *pbpub);
+    if (NULL == pbpub) {
+        return NULL;
+    }
+    pbpub->slots = (struct pbpub_slot*)calloc(size, sizeof pbpub->slots[0]);
+    pbpub->idle  = (unsigned*)malloc(size * sizeof pbpub->idle[0]);
+    pbpub->queue = (struct pbpub_request*)malloc(
+        (queue_len > 0 ? queue_len : 1) * sizeof pbpub->queue[0]);
+    if ((NULL == pbpub->slots) || (NULL == pbpub->idle) || (NULL == pbpub->queue)) {
+        free(pbpub->queue);
+        free(pbpub->idle);
+        free(pbpub->slots);
+        free(pbpub);
+        return NULL;
+    }
+    pbpub->size      = size;
+    pbpub->queue_len = queue_len;
+    pubnub_mutex_init(pbpub->monitor);
+
+    for (i = 0; i < size; ++i) {
+        struct pbpub_slot* slot = &pbpub->slots[i];
+        slot->pbpub             = pbpub;
+        slot->pb                = pubnub_alloc();
+        if (NULL == slot->pb) {
+            PUBNUB_LOG_ERROR("Failed to allocate context %u of %u for the "
+                             "publisher\n",
+                             i,
+                             size);
+            free_contexts(pbpub, i);
+            free_publisher(pbpub);
+            return NULL;
+        }
+        pubnub_init(slot->pb, publish_key, subscribe_key);
+        pubnub_register_callback(slot->pb, publisher_context_callback, slot);
+        /* So that the first context is the first one used */
+        pbpub->idle[size - 1 - i] = i;
+    }
+    pbpub->idle_count = size;
+
+    return pbpub;
+}
+
+
+unsigned pubnub_publisher_size(pubnub_publisher_t const* pbpub)
+{
+    PUBNUB_ASSERT_OPT(pbpub != NULL);
+    return pbpub->size;
+}
+
+
+pubnub_t* pubnub_publisher_context(pubnub_publisher_t* pbpub, unsigned i)
+{
+    PUBNUB_ASSERT_OPT(pbpub != NULL);
+    return (i < pbpub->size) ? pbpub->slots[i].pb : NULL;
+}
+
+
+enum pubnub_res pubnub_publisher_publish(pubnub_publisher_t*         pbpub,
+                                         char const*                 channel,
+                                         char const*                 message,
+                                         pubnub_publisher_callback_t cb,
+                                         void*                       request_data)
+{
+    struct pbpub_request req;
+    struct pbpub_slot*   slot;
+
+    PUBNUB_ASSERT_OPT(pbpub != NULL);
+    PUBNUB_ASSERT_OPT(channel != NULL);
+    PUBNUB_ASSERT_OPT(message != NULL);
+
+    req.channel      = channel;
+    req.message      = message;
+    req.cb           = cb;
+    req.request_data = request_data;
+
+    pubnub_mutex_lock(pbpub->monitor);
+    if (pbpub->stopping) {
+        pubnub_mutex_unlock(pbpub->monitor);
+        return PNR_CANCELLED;
+    }
+    if (0 == pbpub->idle_count) {
+        if (pbpub->count >= pbpub->queue_len) {
+            ++pbpub->metrics.rejected;
+            pubnub_mutex_unlock(pbpub->monitor);
+            return PNR_QUEUE_FULL;
+        }
+        pbpub->queue[(pbpub->head + pbpub->count) % pbpub->queue_len] = req;
+        ++pbpub->count;
+        if (pbpub->count > pbpub->metrics.queued_max) {
+            pbpub->metrics.queued_max = pbpub->count;
+        }
+        pubnub_mutex_unlock(pbpub->monitor);
+        return PNR_STARTED;
+    }
+    slot       = &pbpub->slots[pbpub->idle[--pbpub->idle_count]];
+    slot->req  = req;
+    slot->busy = true;
+    pubnub_mutex_unlock(pbpub->monitor);
+
+    /* Not holding the publisher lock while locking the context, as
+       the context callback locks them the other way around.
+    */
+    start_publish(slot);
+
+    return PNR_STARTED;
+}
+
+
+void pubnub_publisher_get_metrics(pubnub_publisher_t*              pbpub,
+                                  struct pubnub_publisher_metrics* metrics)
+{
+    PUBNUB_ASSERT_OPT(pbpub != NULL);
+    PUBNUB_ASSERT_OPT(metrics != NULL);
+
+    pubnub_mutex_lock(pbpub->monitor);
+    *metrics        = pbpub->metrics;
+    metrics->busy   = pbpub->size - pbpub->idle_count;
+    metrics->queued = pbpub->count;
+    pubnub_mutex_unlock(pbpub->monitor);
+}
+
+
+int pubnub_publisher_destroy(pubnub_publisher_t* pbpub, unsigned millisec)
+{
+    unsigned i;
+    int      rslt = 0;
+
+    PUBNUB_ASSERT_OPT(pbpub != NULL);
+
+    pubnub_mutex_lock(pbpub->monitor);
+    pbpub->stopping = 1;
+    while (pbpub->count > 0) {
+        struct pbpub_request req = pbpub->queue[pbpub->head];
+        pbpub->head              = (pbpub->head + 1) % pbpub->queue_len;
+        --pbpub->count;
+        ++pbpub->metrics.failed;
+        pubnub_mutex_unlock(pbpub->monitor);
+        report(NULL, &req, PNR_CANCELLED);
+        pubnub_mutex_lock(pbpub->monitor);
+    }
+    pubnub_mutex_unlock(pbpub->monitor);
+
+    for (i = 0; i < pbpub->size; ++i) {
+        pubnub_t* pb = pbpub->slots[i].pb;
+        if (NULL == pb) {
+            /* Freed by a previous call */
+            continue;
+        }
+        if (pubnub_free_with_timeout(pb, millisec) != 0) {
+            PUBNUB_LOG_ERROR("Failed to free context %p of the publisher %p\n",
+                             pb,
+                             pbpub);
+            rslt = -1;
+        }
+        else {
+            pbpub->slots[i].pb = NULL;
+        }
+    }
+    if (0 == rslt) {
+        free_publisher(pbpub);
+    }
+
+    return rslt;
+}
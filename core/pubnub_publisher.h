@@ -0,0 +1,148 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_PUBLISHER
+#define INC_PUBNUB_PUBLISHER
+
+
+#include "pubnub_api_types.h"
+
+
+/** @file pubnub_publisher.h
+
+    This module implements a "publisher" for the callback interface -
+    a pool of Pubnub contexts, owned by the publisher, used only for
+    publishing.
+
+    Publish requests are given to the publisher, which starts each of
+    them on the first idle context of the pool. If all contexts are
+    busy, requests wait in a bounded queue (of a size given on
+    creation) and are started as contexts become idle. If the queue is
+    full, the request is rejected with #PNR_QUEUE_FULL and should be
+    retried later ("backpressure").
+
+    Requests may be made from any number of threads. The outcome of
+    each request is reported via its own completion callback.
+*/
+
+
+/** A publisher descriptor. An opaque data structure. */
+struct pubnub_publisher;
+
+/** A helper typedef of a publisher descriptor */
+typedef struct pubnub_publisher pubnub_publisher_t;
+
+/** Prototype of a function that will be called back when a publish
+    request given to a publisher is done.
+
+    @param pb The context of the publisher pool that was used for the
+    request, NULL if it was never started (cancelled while waiting in
+    the queue). If @p result is #PNR_OK or #PNR_PUBLISH_FAILED, you
+    can get the publish response with pubnub_last_publish_result().
+    @param result The outcome of the request
+    @param request_data The data given with the request
+
+    @note Called with the context @p pb locked, so, don't do anything
+    "long" in it. You may give new requests to the publisher from it.
+*/
+typedef void (*pubnub_publisher_callback_t)(pubnub_t*       pb,
+                                            enum pubnub_res result,
+                                            void*           request_data);
+
+/** Publisher metrics, as returned by pubnub_publisher_get_metrics() */
+struct pubnub_publisher_metrics {
+    /** Number of requests successfully published */
+    unsigned long published;
+    /** Number of requests that failed (including the ones cancelled) */
+    unsigned long failed;
+    /** Number of requests rejected because the queue was full */
+    unsigned long rejected;
+    /** Number of contexts currently publishing */
+    unsigned busy;
+    /** Number of requests currently waiting in the queue */
+    unsigned queued;
+    /** Maximum number of requests that were waiting in the queue */
+    unsigned queued_max;
+};
+
+
+/** Creates a publisher with a pool of @p size contexts, all
+    initialized with the given keys, and a queue for @p queue_len
+    requests.
+
+    To change other settings of the contexts (UUID, auth, proxy...),
+    use pubnub_publisher_context().
+
+    @param publish_key The string of the key to use when publishing
+    @param subscribe_key The string of the key to use when subscribing
+    @param size Number of contexts in the pool, at least 1
+    @param queue_len Maximum number of requests waiting in the queue
+
+    @retval NULL Failed to create a publisher
+    @result The publisher created
+ */
+pubnub_publisher_t* pubnub_publisher_create(char const* publish_key,
+                                            char const* subscribe_key,
+                                            unsigned    size,
+                                            unsigned    queue_len);
+
+/** Returns the number of contexts in the pool of the publisher */
+unsigned pubnub_publisher_size(pubnub_publisher_t const* pbpub);
+
+/** Returns the context with the index @p i in the pool of the
+    publisher, so that its settings may be changed.
+
+    @warning Do not start transactions on the context or change its
+    callback. Do not free it, it's owned by the publisher.
+
+    @retval NULL @p i out of range
+    @result The context
+*/
+pubnub_t* pubnub_publisher_context(pubnub_publisher_t* pbpub, unsigned i);
+
+/** Publishes the @p message on the @p channel, using the publisher.
+    Same as pubnub_publish(), but on the first idle context of the
+    publisher, or, if there is none, once one becomes idle.
+
+    Both @p channel and @p message have to remain valid until the
+    request is reported via @p cb.
+
+    @param pbpub The publisher
+    @param channel The string with the channel (or comma-delimited
+    list of channels) to publish to
+    @param message The message to publish, expected to be in JSON
+    format
+    @param cb The function to call when the request is done, can be
+    NULL
+    @param request_data Passed to @p cb
+
+    @retval PNR_STARTED request started or queued, its outcome will be
+    reported via @p cb (possibly before this function returns)
+    @retval PNR_QUEUE_FULL all contexts busy and the queue is full
+    @retval PNR_CANCELLED the publisher is being destroyed
+ */
+enum pubnub_res pubnub_publisher_publish(pubnub_publisher_t*         pbpub,
+                                         char const*                 channel,
+                                         char const*                 message,
+                                         pubnub_publisher_callback_t cb,
+                                         void*                       request_data);
+
+/** Gets the current metrics of the publisher @p pbpub to @p metrics */
+void pubnub_publisher_get_metrics(pubnub_publisher_t*              pbpub,
+                                  struct pubnub_publisher_metrics* metrics);
+
+/** Destroys the publisher. Requests waiting in the queue are reported
+    as #PNR_CANCELLED, the ones in progress are cancelled and all the
+    contexts are freed, waiting at most @p millisec for each.
+
+    If some context can't be freed in due time, the others are still
+    freed, but the publisher is not destroyed. It stays stopped (new
+    requests are #PNR_CANCELLED) and you can call this again, to free
+    the contexts left and then destroy it.
+
+    @retval 0 publisher destroyed
+    @retval -1 failed to free some context(s) in due time, publisher
+    not destroyed (yet)
+ */
+int pubnub_publisher_destroy(pubnub_publisher_t* pbpub, unsigned millisec);
+
+
+#endif /* !defined INC_PUBNUB_PUBLISHER */
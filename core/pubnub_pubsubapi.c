@@ -26,8 +26,10 @@ pubnub_t* pubnub_init(pubnub_t* p, const char* publish_key, const char* subscrib
 #endif
     }
 #if defined(PUBNUB_CALLBACK_API)
-    p->cb        = NULL;
-    p->user_data = NULL;
+    p->cb            = NULL;
+    p->user_data     = NULL;
+    p->ntf_node.next = NULL;
+    p->ntf_queued    = 0;
 #endif /* defined(PUBNUB_CALLBACK_API) */
     if (PUBNUB_ORIGIN_SETTABLE) {
         p->origin = PUBNUB_ORIGIN;
@@ -54,6 +56,15 @@ pubnub_t* pubnub_init(pubnub_t* p, const char* publish_key, const char* subscrib
 #if PUBNUB_ADVANCED_KEEP_ALIVE
     p->keep_alive.max     = 1000;
     p->keep_alive.timeout = 50;
+#endif
+#if PUBNUB_USE_PUBLISH_PIPELINE
+    memset(&p->pipeline, 0, sizeof p->pipeline);
+#endif
+#if PUBNUB_USE_HISTORY_STREAM
+    memset(&p->hist_stream, 0, sizeof p->hist_stream);
+#endif
+#if PUBNUB_USE_OBJECTS_CACHE
+    memset(&p->objc, 0, sizeof p->objc);
 #endif
     pbpal_init(p);
     pubnub_mutex_unlock(p->monitor);
@@ -68,6 +79,10 @@ pubnub_t* pubnub_init(pubnub_t* p, const char* publish_key, const char* subscrib
 #endif
 #endif /* defined(PUBNUB_CALLBACK_API) */
     p->proxy_tunnel_established = false;
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    p->proxy_saved_path     = NULL;
+    p->proxy_saved_path_len = 0;
+#endif
     p->proxy_port               = 80;
     p->proxy_auth_scheme        = pbhtauNone;
     p->proxy_auth_username      = NULL;
@@ -0,0 +1,107 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_REPLY_INDEX
+#include "pubnub_reply_index.h"
+
+#include "pubnub_assert.h"
+
+
+static int get_from_index(pubnub_t*                      pb,
+                          struct pbcc_reply_index const* index,
+                          pubnub_chamebl_t const**       o_items)
+{
+    int rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb) || !index->valid) {
+        pubnub_mutex_unlock(pb->monitor);
+        return -1;
+    }
+    /* A failed transaction was not (fully) parsed, the index may be
+       of some previous reply */
+    rslt = (PNR_OK == pb->core.last_result) ? (int)index->count : 0;
+    if (o_items != NULL) {
+        *o_items = index->item;
+    }
+    pubnub_mutex_unlock(pb->monitor);
+
+    return rslt;
+}
+
+
+/** Returns (in @p o_items) the items of the @p index which were not
+    read yet, that is, from the offset @p ofs in the reply, and marks
+    them as read, by moving @p ofs to @p end. If the reply is not
+    indexed, nothing is marked as read.
+ */
+static int consume_from_index(pubnub_t*                      pb,
+                              struct pbcc_reply_index const* index,
+                              unsigned*                      ofs,
+                              unsigned const*                end,
+                              pubnub_chamebl_t const**       o_items)
+{
+    char const* next;
+    unsigned    count;
+    unsigned    lo = 0;
+    unsigned    hi;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(o_items != NULL);
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb) || !index->valid) {
+        pubnub_mutex_unlock(pb->monitor);
+        return -1;
+    }
+    count = hi = (PNR_OK == pb->core.last_result) ? index->count : 0;
+    /* The items are in the order of the reply, so the first one not
+       read yet is found by a binary search */
+    next = pb->core.http_reply + *ofs;
+    while (lo < hi) {
+        unsigned mid = lo + (hi - lo) / 2;
+        if (index->item[mid].ptr < next) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    *o_items = (lo < count) ? index->item + lo : NULL;
+    if ((count > 0) && (*ofs < *end)) {
+        *ofs = *end;
+    }
+    pubnub_mutex_unlock(pb->monitor);
+
+    return (int)(count - lo);
+}
+
+
+int pubnub_get_messages(pubnub_t* pb, pubnub_chamebl_t const** o_msgs)
+{
+    return get_from_index(pb, &pb->core.msg_index, o_msgs);
+}
+
+
+int pubnub_get_channels(pubnub_t* pb, pubnub_chamebl_t const** o_chans)
+{
+    return get_from_index(pb, &pb->core.chan_index, o_chans);
+}
+
+
+int pubnub_consume_messages(pubnub_t* pb, pubnub_chamebl_t const** o_msgs)
+{
+    return consume_from_index(
+        pb, &pb->core.msg_index, &pb->core.msg_ofs, &pb->core.msg_end, o_msgs);
+}
+
+
+int pubnub_consume_channels(pubnub_t* pb, pubnub_chamebl_t const** o_chans)
+{
+    return consume_from_index(
+        pb, &pb->core.chan_index, &pb->core.chan_ofs, &pb->core.chan_end, o_chans);
+}
+
+#endif /* PUBNUB_USE_REPLY_INDEX */
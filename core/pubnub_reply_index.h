@@ -0,0 +1,82 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_REPLY_INDEX
+#define INC_PUBNUB_REPLY_INDEX
+
+#include "pubnub_config.h"
+
+#include "pubnub_api_types.h"
+#include "pubnub_memory_block.h"
+
+#if !PUBNUB_USE_REPLY_INDEX
+#error To use the reply index API you must define PUBNUB_USE_REPLY_INDEX=1
+#endif
+
+
+/** @file pubnub_reply_index.h
+
+    This API gives "random access" to the messages (and channels) in
+    the reply of the last transaction - the same ones you would read
+    one by one with pubnub_get() (and pubnub_get_channel()), but as an
+    array of pointers and lengths. The array is filled while the reply
+    is parsed, so you know how many messages there are and how long
+    each one is without scanning them (again). This is handy to
+    forward messages in batches, with their lengths.
+
+    The messages are not copied, they point into the reply, so they
+    (and the array) are valid until the next transaction is started on
+    the context. Each message is also NUL-terminated. Reading them
+    this way doesn't "consume" them, that is, it doesn't affect what
+    pubnub_get() (pubnub_get_channel()) returns, and vice versa.
+
+    Only the replies that pubnub_get() reads as a list of messages
+    are indexed: subscribe (V1), time and history. For all others, as
+    well as for any transaction that didn't finish with #PNR_OK, the
+    array is empty.
+ */
+
+
+/** Returns the messages in the reply of the last transaction on the
+    context @p pb, in @p o_msgs. You can pass NULL for @p o_msgs if
+    you need just the number of messages.
+
+    @param pb The Pubnub context. Can't be NULL.
+    @param o_msgs Set to point to the array of messages (if not NULL)
+    @return Number of messages (in @p o_msgs), -1 on error
+    (transaction in progress, or failed to allocate the index)
+ */
+int pubnub_get_messages(pubnub_t* pb, pubnub_chamebl_t const** o_msgs);
+
+/** Returns the channels in the reply of the last transaction on the
+    context @p pb, in @p o_chans. Like pubnub_get_messages(), just for
+    channels, that is, what you would read with
+    pubnub_get_channel(). The channels are not always present in a
+    subscribe reply, so this may return 0 even if there are messages.
+
+    @param pb The Pubnub context. Can't be NULL.
+    @param o_chans Set to point to the array of channels (if not NULL)
+    @return Number of channels (in @p o_chans), -1 on error
+ */
+int pubnub_get_channels(pubnub_t* pb, pubnub_chamebl_t const** o_chans);
+
+/** Returns the messages in the reply of the last transaction on the
+    context @p pb which were not read with pubnub_get() yet, in @p
+    o_msgs, and "consumes" them, so pubnub_get() will not return them
+    any more. That is, the same messages you would get by calling
+    pubnub_get() until it returns NULL, with their lengths, without
+    scanning them.
+
+    @param pb The Pubnub context. Can't be NULL.
+    @param o_msgs Set to point to the first of the messages (NULL if
+    there are none). Can't be NULL.
+    @return Number of messages (in @p o_msgs), -1 on error
+    (transaction in progress, or failed to allocate the index)
+ */
+int pubnub_consume_messages(pubnub_t* pb, pubnub_chamebl_t const** o_msgs);
+
+/** Like pubnub_consume_messages(), just for the channels, that is,
+    for what you would read with pubnub_get_channel().
+ */
+int pubnub_consume_channels(pubnub_t* pb, pubnub_chamebl_t const** o_chans);
+
+
+#endif /* !defined INC_PUBNUB_REPLY_INDEX */
@@ -0,0 +1,53 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_REQUEST_BODY
+#include "pubnub_request_body.h"
+#include "pubnub_ccore_pubsub.h"
+#include "pubnub_netcore.h"
+
+#include "pubnub_assert.h"
+
+
+enum pubnub_res pubnub_set_request_body(pubnub_t* pb, void const* body, size_t len)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(body != NULL);
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    pb->core.next_body.ptr           = body;
+    pb->core.next_body.len           = len;
+    pb->core.next_body.producer      = NULL;
+    pb->core.next_body.producer_data = NULL;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pubnub_set_request_body_producer(pubnub_t*              pb,
+                                                 pubnub_body_producer_t producer,
+                                                 void*                  user_data)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    PUBNUB_ASSERT_OPT(producer != NULL);
+
+    pubnub_mutex_lock(pb->monitor);
+    if (!pbnc_can_start_transaction(pb)) {
+        pubnub_mutex_unlock(pb->monitor);
+        return PNR_IN_PROGRESS;
+    }
+    pb->core.next_body.ptr           = NULL;
+    pb->core.next_body.len           = 0;
+    pb->core.next_body.producer      = producer;
+    pb->core.next_body.producer_data = user_data;
+    pubnub_mutex_unlock(pb->monitor);
+
+    return PNR_OK;
+}
+
+#endif /* PUBNUB_USE_REQUEST_BODY */
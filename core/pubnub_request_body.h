@@ -0,0 +1,71 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_REQUEST_BODY
+#define INC_PUBNUB_REQUEST_BODY
+
+
+#include "pubnub_api_types.h"
+
+#include <stddef.h>
+
+
+/** @file pubnub_request_body.h
+
+    This is the API for sending the body of a request (publish via
+    POST, or a create/update transaction of the objects API) directly
+    from the user's buffer(s), instead of copying it to the "scratch"
+    buffer of the context, after the URL. So, the body is not limited
+    by #PUBNUB_BUF_MAXLEN (nor #PUBNUB_MAX_OBJECT_LENGTH) and doesn't
+    have to be a NUL terminated string.
+
+    The body is set on the context and is used by (and cleared by)
+    the next transaction with a body started on it. The message
+    (object) given to the function that starts that transaction is
+    not sent, so give an empty string (`""`). Message encryption and
+    compression (GZIP) don't apply to such a body.
+*/
+
+
+/** Prototype of a function that produces the body of a request in
+    chunks, which are sent with the "chunked" HTTP transfer encoding.
+
+    @param user_data The data given to pubnub_set_request_body_producer()
+    @param chunk Set to the pointer to the next chunk. Has to remain
+    valid until the next call (or the end of the transaction).
+    @param len Set to the length of the next chunk, `0` if there are
+    no more chunks.
+    @retval 0 chunk given (or the end of the body)
+    @retval -1 failed to produce the chunk, the transaction ends with
+    #PNR_IO_ERROR
+
+    @note Called with the context locked, so, don't do anything
+    "long" in it.
+*/
+typedef int (*pubnub_body_producer_t)(void* user_data, void const** chunk, size_t* len);
+
+
+/** Sets the body of the next transaction with a body started on @p
+    pb to the @p len bytes at @p body. They are not copied, so they
+    have to remain valid (unchanged) until that transaction ends.
+
+    @retval PNR_OK body set
+    @retval PNR_IN_PROGRESS a transaction is in progress on @p pb
+ */
+enum pubnub_res pubnub_set_request_body(pubnub_t* pb, void const* body, size_t len);
+
+/** Sets the @p producer of the body of the next transaction with a
+    body started on @p pb. The body is sent in chunks, as they are
+    produced, so it can be of any length.
+
+    The producer is called from the start of the body only once, so,
+    if the request has to be sent again (for example, to authenticate
+    to a proxy), the transaction fails.
+
+    @retval PNR_OK producer set
+    @retval PNR_IN_PROGRESS a transaction is in progress on @p pb
+ */
+enum pubnub_res pubnub_set_request_body_producer(pubnub_t*              pb,
+                                                 pubnub_body_producer_t producer,
+                                                 void*                  user_data);
+
+
+#endif /* !defined INC_PUBNUB_REQUEST_BODY */
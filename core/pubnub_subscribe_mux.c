@@ -0,0 +1,740 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#if PUBNUB_USE_SUBSCRIBE_V2
+
+#include "pubnub_subscribe_mux.h"
+
+#include "pubnub_pubsubapi.h"
+#include "pubnub_ntf_callback.h"
+#include "pubnub_alloc.h"
+#include "pubnub_free_with_timeout.h"
+#include "pubnub_url_encode.h"
+#include "pubnub_mutex.h"
+#include "pubnub_assert.h"
+#include "pubnub_log.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+
+/** How much of the subscribe URL (#PUBNUB_BUF_MAXLEN) to reserve for
+    everything but the channel (group) names: subscribe key, time
+    token, UUID, auth key, etc. The filter expression (if any) is
+    reserved for on top of this.
+ */
+#if !defined PUBNUB_SUBMUX_URL_RESERVE
+#define PUBNUB_SUBMUX_URL_RESERVE 512
+#endif
+
+/** Initial number of buckets of the hash table. Must be a power of 2. */
+#define SUBMUX_INITIAL_BUCKETS 64
+
+
+struct submux_shard;
+
+/** A channel (group) the multiplexer is subscribed to */
+struct submux_entry {
+    /** Next entry in the same bucket of the hash table */
+    struct submux_entry* next;
+    /** Previous entry in the same shard */
+    struct submux_entry* shard_prev;
+    /** Next entry in the same shard */
+    struct submux_entry* shard_next;
+    /** The shard (long-poll) this entry is in */
+    struct submux_shard* shard;
+    /** Hash of the name */
+    unsigned hash;
+    /** Is this a channel group (or a channel)? */
+    bool is_group;
+    /** Handler of the messages of this channel (group) */
+    pubnub_submux_handler_t handler;
+    /** Data to pass to the #handler */
+    void* user_data;
+    /** Length of the name */
+    size_t len;
+    /** Length of the name in the URL (URL encoded) */
+    size_t encoded_len;
+    /** The name itself, the entry is allocated to hold it all */
+    char name[1];
+};
+
+/** One long-poll (subscribe on a context) of the multiplexer */
+struct submux_shard {
+    /** The context to subscribe on */
+    pubnub_t* pb;
+    /** The multiplexer this shard belongs to */
+    pubnub_submux_t* mux;
+    /** First entry (channel or group) in this shard */
+    struct submux_entry* entries;
+    /** Number of entries */
+    unsigned count;
+    /** Length in the URL of all the names of this shard (with the
+        commas between them) */
+    size_t url_len;
+    /** Buffer for the comma-separated list of channels */
+    char* channels;
+    /** Buffer for the comma-separated list of channel groups */
+    char* groups;
+    /** Capacity of the #channels and #groups buffers */
+    size_t names_cap;
+    /** Set while a subscribe is in progress on the context */
+    bool busy;
+    /** Set when the entries changed since the subscribe was started */
+    bool dirty;
+    /** Set when the subscribe in progress is cancelled, to restart it */
+    bool cancelling;
+    /** Incremented each time a subscribe is started */
+    unsigned generation;
+};
+
+/** Subscribe multiplexer descriptor */
+struct pubnub_subscribe_mux {
+    char const* publish_key;
+    char const* subscribe_key;
+    /** Subscribe options to use for all subscribes */
+    struct pubnub_subscribe_v2_options options;
+    /** Maximum length of the names in the URL of one subscribe */
+    size_t url_budget;
+    pubnub_submux_error_t on_error;
+    void*                 error_data;
+    pubnub_guarded_by(monitor) pubnub_submux_context_init_t ctx_init;
+    pubnub_guarded_by(monitor) void* ctx_init_data;
+    pubnub_guarded_by(monitor) pubnub_submux_handler_t default_handler;
+    pubnub_guarded_by(monitor) void* default_data;
+    /** The hash table of the channels and groups */
+    pubnub_guarded_by(monitor) struct submux_entry** buckets;
+    /** Number of buckets in the hash table, a power of 2 */
+    pubnub_guarded_by(monitor) unsigned bucket_count;
+    /** Number of entries in the hash table */
+    pubnub_guarded_by(monitor) unsigned entry_count;
+    /** The shards (long-polls) */
+    pubnub_guarded_by(monitor) struct submux_shard** shards;
+    /** Number of shards */
+    pubnub_guarded_by(monitor) unsigned shard_count;
+    /** Set when the multiplexer is being destroyed */
+    pubnub_guarded_by(monitor) bool stopping;
+
+#if PUBNUB_THREADSAFE
+    pubnub_mutex_t monitor;
+#endif
+};
+
+
+/** Hash of the name @p s of length @p len, of a group or a channel */
+static unsigned hash_name(char const* s, size_t len, bool is_group)
+{
+    return pbhash_fnv1a(is_group ? PBHASH_FNV1A_INIT ^ 0xffu : PBHASH_FNV1A_INIT, s, len);
+}
+
+
+/** Looks up the channel (group) @p s of length @p len. Has to be
+    called with the multiplexer locked.
+ */
+static struct submux_entry* find(pubnub_submux_t* mux,
+                                 char const*      s,
+                                 size_t           len,
+                                 bool             is_group)
+{
+    unsigned             h = hash_name(s, len, is_group);
+    struct submux_entry* e;
+
+    for (e = mux->buckets[h & (mux->bucket_count - 1)]; e != NULL; e = e->next) {
+        if ((e->hash == h) && (e->len == len) && (e->is_group == is_group)
+            && (0 == memcmp(e->name, s, len))) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+
+/** Doubles the number of buckets of the hash table. If it fails, the
+    table is left as it was (just with longer chains).
+ */
+static void grow_table(pubnub_submux_t* mux)
+{
+    unsigned              n = mux->bucket_count * 2;
+    struct submux_entry** buckets;
+    unsigned              i;
+
+    buckets = (struct submux_entry**)calloc(n, sizeof buckets[0]);
+    if (NULL == buckets) {
+        return;
+    }
+    for (i = 0; i < mux->bucket_count; ++i) {
+        struct submux_entry* e = mux->buckets[i];
+        while (e != NULL) {
+            struct submux_entry* next = e->next;
+            e->next                   = buckets[e->hash & (n - 1)];
+            buckets[e->hash & (n - 1)] = e;
+            e                          = next;
+        }
+    }
+    free(mux->buckets);
+    mux->buckets      = buckets;
+    mux->bucket_count = n;
+}
+
+
+static void unlink_from_table(pubnub_submux_t* mux, struct submux_entry* entry)
+{
+    struct submux_entry** pp = &mux->buckets[entry->hash & (mux->bucket_count - 1)];
+    while (*pp != entry) {
+        PUBNUB_ASSERT_OPT(*pp != NULL);
+        pp = &(*pp)->next;
+    }
+    *pp = entry->next;
+    --mux->entry_count;
+}
+
+
+static void add_to_shard(struct submux_shard* shard, struct submux_entry* entry)
+{
+    entry->shard      = shard;
+    entry->shard_prev = NULL;
+    entry->shard_next = shard->entries;
+    if (shard->entries != NULL) {
+        shard->entries->shard_prev = entry;
+    }
+    shard->entries = entry;
+    ++shard->count;
+    shard->url_len += entry->encoded_len + 1;
+    shard->dirty = true;
+}
+
+
+static void remove_from_shard(struct submux_entry* entry)
+{
+    struct submux_shard* shard = entry->shard;
+    if (entry->shard_prev != NULL) {
+        entry->shard_prev->shard_next = entry->shard_next;
+    }
+    else {
+        shard->entries = entry->shard_next;
+    }
+    if (entry->shard_next != NULL) {
+        entry->shard_next->shard_prev = entry->shard_prev;
+    }
+    --shard->count;
+    shard->url_len -= entry->encoded_len + 1;
+    shard->dirty = true;
+}
+
+
+static void submux_context_callback(pubnub_t*         pb,
+                                    enum pubnub_trans trans,
+                                    enum pubnub_res   result,
+                                    void*             user_data);
+
+
+/** Finds a shard with room for @p url_len more characters of names,
+    allocating a new one (and its context) if needed. Has to be
+    called with the multiplexer locked.
+ */
+static struct submux_shard* shard_with_room(pubnub_submux_t* mux, size_t url_len)
+{
+    struct submux_shard*  shard;
+    struct submux_shard** shards;
+    unsigned              i;
+
+    for (i = 0; i < mux->shard_count; ++i) {
+        if (mux->shards[i]->url_len + url_len <= mux->url_budget) {
+            return mux->shards[i];
+        }
+    }
+    shards = (struct submux_shard**)realloc(
+        mux->shards, (mux->shard_count + 1) * sizeof mux->shards[0]);
+    if (NULL == shards) {
+        return NULL;
+    }
+    mux->shards = shards;
+    shard       = (struct submux_shard*)calloc(1, sizeof *shard);
+    if (NULL == shard) {
+        return NULL;
+    }
+    shard->pb = pubnub_alloc();
+    if (NULL == shard->pb) {
+        PUBNUB_LOG_ERROR("Failed to allocate context %u for the subscribe "
+                         "multiplexer %p\n",
+                         mux->shard_count,
+                         mux);
+        free(shard);
+        return NULL;
+    }
+    shard->mux = mux;
+    pubnub_init(shard->pb, mux->publish_key, mux->subscribe_key);
+    if (mux->ctx_init != NULL) {
+        mux->ctx_init(shard->pb, mux->ctx_init_data);
+    }
+    pubnub_register_callback(shard->pb, submux_context_callback, shard);
+    mux->shards[mux->shard_count++] = shard;
+
+    return shard;
+}
+
+
+/** Makes the comma-separated lists of channels and groups of the @p
+    shard. Has to be called with the multiplexer locked.
+    @return 0: OK, -1: failed to allocate memory
+ */
+static int make_name_lists(struct submux_shard* shard)
+{
+    struct submux_entry* e;
+    char*                ch;
+    char*                gr;
+
+    /* Raw names can't be longer than the URL encoded ones */
+    if (shard->names_cap < shard->url_len + 1) {
+        char* channels = (char*)realloc(shard->channels, shard->url_len + 1);
+        char* groups;
+        if (NULL == channels) {
+            return -1;
+        }
+        shard->channels = channels;
+        groups          = (char*)realloc(shard->groups, shard->url_len + 1);
+        if (NULL == groups) {
+            return -1;
+        }
+        shard->groups    = groups;
+        shard->names_cap = shard->url_len + 1;
+    }
+    ch = shard->channels;
+    gr = shard->groups;
+    for (e = shard->entries; e != NULL; e = e->shard_next) {
+        char** pp    = e->is_group ? &gr : &ch;
+        char*  start = e->is_group ? shard->groups : shard->channels;
+        if (*pp != start) {
+            *(*pp)++ = ',';
+        }
+        memcpy(*pp, e->name, e->len);
+        *pp += e->len;
+    }
+    *ch = *gr = '\0';
+
+    return 0;
+}
+
+
+/** Brings the subscribe of the @p shard in line with its entries:
+    starts it if it is not running, restarts it if the entries
+    changed, stops it if there are no entries. Has to be called with
+    the multiplexer unlocked, as it locks the context first.
+ */
+static void kick(struct submux_shard* shard)
+{
+    pubnub_submux_t*                   mux = shard->mux;
+    struct pubnub_subscribe_v2_options opts;
+    char const*                        channels;
+    unsigned                           generation;
+    enum pubnub_res                    rslt;
+
+    pubnub_mutex_lock(shard->pb->monitor);
+    pubnub_mutex_lock(mux->monitor);
+    if (mux->stopping) {
+        pubnub_mutex_unlock(mux->monitor);
+        pubnub_mutex_unlock(shard->pb->monitor);
+        return;
+    }
+    if (shard->busy) {
+        bool cancel = shard->dirty && !shard->cancelling;
+        if (cancel) {
+            shard->cancelling = true;
+        }
+        pubnub_mutex_unlock(mux->monitor);
+        if (cancel) {
+            PUBNUB_LOG_TRACE("pb=%p subscribe multiplexer: restarting the "
+                             "subscribe\n",
+                             shard->pb);
+            pubnub_cancel(shard->pb);
+        }
+        pubnub_mutex_unlock(shard->pb->monitor);
+        return;
+    }
+    if ((0 == shard->count) || (make_name_lists(shard) != 0)) {
+        pubnub_mutex_unlock(mux->monitor);
+        pubnub_mutex_unlock(shard->pb->monitor);
+        return;
+    }
+    opts               = mux->options;
+    opts.channel_group = ('\0' == shard->groups[0]) ? NULL : shard->groups;
+    channels           = ('\0' == shard->channels[0]) ? NULL : shard->channels;
+    shard->busy        = true;
+    shard->dirty       = false;
+    generation         = ++shard->generation;
+    pubnub_mutex_unlock(mux->monitor);
+
+    /* The name lists are changed only here, with the context locked */
+    rslt = pubnub_subscribe_v2(shard->pb, channels, opts);
+    if (rslt != PNR_STARTED) {
+        bool report;
+
+        PUBNUB_LOG_ERROR("pb=%p subscribe multiplexer: failed to start "
+                         "subscribe, error code = %d\n",
+                         shard->pb,
+                         rslt);
+        pubnub_mutex_lock(mux->monitor);
+        /* Unless already reported from the context callback */
+        report = (generation == shard->generation) && shard->busy;
+        if (report) {
+            shard->busy = false;
+        }
+        pubnub_mutex_unlock(mux->monitor);
+        if (report && (mux->on_error != NULL)) {
+            mux->on_error(shard->pb, rslt, mux->error_data);
+        }
+    }
+    pubnub_mutex_unlock(shard->pb->monitor);
+}
+
+
+/** Finds the handler for the message @p msg. A channel group, or a
+    wildcard subscription, that the message matched has precedence
+    over the channel it was published to.
+ */
+static void dispatch(pubnub_submux_t* mux, pubnub_t* pb, struct pubnub_v2_message const* msg)
+{
+    struct submux_entry*    e     = NULL;
+    char const*             match = msg->match_or_group.ptr;
+    size_t                  len   = msg->match_or_group.size;
+    pubnub_submux_handler_t handler;
+    void*                   user_data;
+
+    /* Unlike the channel, the match (group) is given as a JSON string */
+    if ((len >= 2) && ('"' == match[0])) {
+        ++match;
+        len -= 2;
+    }
+    pubnub_mutex_lock(mux->monitor);
+    if (len > 0) {
+        e = find(mux, match, len, true);
+        if (NULL == e) {
+            e = find(mux, match, len, false);
+        }
+    }
+    if (NULL == e) {
+        e = find(mux, msg->channel.ptr, msg->channel.size, false);
+    }
+    if (e != NULL) {
+        handler   = e->handler;
+        user_data = e->user_data;
+    }
+    else {
+        handler   = mux->default_handler;
+        user_data = mux->default_data;
+    }
+    pubnub_mutex_unlock(mux->monitor);
+
+    if (handler != NULL) {
+        handler(pb, msg, user_data);
+    }
+}
+
+
+static void submux_context_callback(pubnub_t*         pb,
+                                    enum pubnub_trans trans,
+                                    enum pubnub_res   result,
+                                    void*             user_data)
+{
+    struct submux_shard* shard = (struct submux_shard*)user_data;
+    pubnub_submux_t*     mux;
+
+    PUBNUB_ASSERT_OPT(shard != NULL);
+    PUBNUB_ASSERT_OPT(shard->pb == pb);
+
+    if (PBTT_NONE == trans) {
+        /* Context being freed, not a request of ours */
+        return;
+    }
+    if (trans != PBTT_SUBSCRIBE_V2) {
+        PUBNUB_LOG_WARNING("pb=%p subscribe multiplexer: unexpected "
+                           "transaction %d outcome %d\n",
+                           pb,
+                           trans,
+                           result);
+        return;
+    }
+    mux = shard->mux;
+
+    pubnub_mutex_lock(mux->monitor);
+    shard->busy       = false;
+    shard->cancelling = false;
+    pubnub_mutex_unlock(mux->monitor);
+
+    if (PNR_OK == result) {
+        struct pubnub_v2_message msg;
+        for (msg = pubnub_get_v2(pb); msg.payload.ptr != NULL; msg = pubnub_get_v2(pb)) {
+            dispatch(mux, pb, &msg);
+        }
+    }
+    else if ((result != PNR_CANCELLED) && (mux->on_error != NULL)) {
+        mux->on_error(pb, result, mux->error_data);
+    }
+
+    kick(shard);
+}
+
+
+pubnub_submux_t* pubnub_submux_create(char const*                        publish_key,
+                                      char const*                        subscribe_key,
+                                      struct pubnub_subscribe_v2_options options,
+                                      pubnub_submux_error_t              on_error,
+                                      void*                              error_data)
+{
+    pubnub_submux_t* mux;
+    size_t           reserve = PUBNUB_SUBMUX_URL_RESERVE;
+
+    PUBNUB_ASSERT_OPT(publish_key != NULL);
+    PUBNUB_ASSERT_OPT(subscribe_key != NULL);
+
+    if (options.filter_expr != NULL) {
+        reserve += pubnub_url_encoded_len(options.filter_expr, strlen(options.filter_expr));
+    }
+    if (reserve >= PUBNUB_BUF_MAXLEN) {
+        PUBNUB_LOG_ERROR("Subscribe multiplexer: no room for channels in "
+                         "the URL of %d characters\n",
+                         PUBNUB_BUF_MAXLEN);
+        return NULL;
+    }
+    mux = (pubnub_submux_t*)calloc(1, sizeof *mux);
+    if (NULL == mux) {
+        return NULL;
+    }
+    mux->buckets = (struct submux_entry**)calloc(SUBMUX_INITIAL_BUCKETS,
+                                                 sizeof mux->buckets[0]);
+    if (NULL == mux->buckets) {
+        free(mux);
+        return NULL;
+    }
+    mux->bucket_count          = SUBMUX_INITIAL_BUCKETS;
+    mux->publish_key           = publish_key;
+    mux->subscribe_key         = subscribe_key;
+    mux->options               = options;
+    mux->options.channel_group = NULL;
+    mux->url_budget            = PUBNUB_BUF_MAXLEN - reserve;
+    mux->on_error              = on_error;
+    mux->error_data            = error_data;
+    pubnub_mutex_init(mux->monitor);
+
+    return mux;
+}
+
+
+void pubnub_submux_set_context_init(pubnub_submux_t*             mux,
+                                    pubnub_submux_context_init_t init,
+                                    void*                        init_data)
+{
+    PUBNUB_ASSERT_OPT(mux != NULL);
+
+    pubnub_mutex_lock(mux->monitor);
+    mux->ctx_init      = init;
+    mux->ctx_init_data = init_data;
+    pubnub_mutex_unlock(mux->monitor);
+}
+
+
+void pubnub_submux_set_default_handler(pubnub_submux_t*        mux,
+                                       pubnub_submux_handler_t handler,
+                                       void*                   user_data)
+{
+    PUBNUB_ASSERT_OPT(mux != NULL);
+
+    pubnub_mutex_lock(mux->monitor);
+    mux->default_handler = handler;
+    mux->default_data    = user_data;
+    pubnub_mutex_unlock(mux->monitor);
+}
+
+
+static enum pubnub_res add_entry(pubnub_submux_t*        mux,
+                                 char const*             name,
+                                 bool                    is_group,
+                                 pubnub_submux_handler_t handler,
+                                 void*                   user_data)
+{
+    struct submux_entry* entry;
+    struct submux_shard* shard;
+    size_t               len;
+    size_t               encoded_len;
+
+    PUBNUB_ASSERT_OPT(mux != NULL);
+    PUBNUB_ASSERT_OPT(name != NULL);
+
+    len         = strlen(name);
+    encoded_len = pubnub_url_encoded_len(name, len);
+    if ((0 == len) || (strchr(name, ',') != NULL)
+        || (encoded_len + 1 > mux->url_budget)) {
+        return PNR_INVALID_CHANNEL;
+    }
+
+    pubnub_mutex_lock(mux->monitor);
+    if (mux->stopping) {
+        pubnub_mutex_unlock(mux->monitor);
+        return PNR_CANCELLED;
+    }
+    entry = find(mux, name, len, is_group);
+    if (entry != NULL) {
+        entry->handler   = handler;
+        entry->user_data = user_data;
+        pubnub_mutex_unlock(mux->monitor);
+        return PNR_OK;
+    }
+    entry = (struct submux_entry*)malloc(sizeof *entry + len);
+    if (NULL == entry) {
+        pubnub_mutex_unlock(mux->monitor);
+        return PNR_INTERNAL_ERROR;
+    }
+    shard = shard_with_room(mux, encoded_len + 1);
+    if (NULL == shard) {
+        pubnub_mutex_unlock(mux->monitor);
+        free(entry);
+        return PNR_INTERNAL_ERROR;
+    }
+    memcpy(entry->name, name, len + 1);
+    entry->len         = len;
+    entry->encoded_len = encoded_len;
+    entry->is_group    = is_group;
+    entry->hash        = hash_name(name, len, is_group);
+    entry->handler     = handler;
+    entry->user_data   = user_data;
+    entry->next        = mux->buckets[entry->hash & (mux->bucket_count - 1)];
+    mux->buckets[entry->hash & (mux->bucket_count - 1)] = entry;
+    if (++mux->entry_count > mux->bucket_count / 4 * 3) {
+        grow_table(mux);
+    }
+    add_to_shard(shard, entry);
+    pubnub_mutex_unlock(mux->monitor);
+
+    /* Not holding the multiplexer lock while locking the context, as
+       the context callback locks them the other way around.
+    */
+    kick(shard);
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pubnub_submux_add_channel(pubnub_submux_t*        mux,
+                                          char const*             channel,
+                                          pubnub_submux_handler_t handler,
+                                          void*                   user_data)
+{
+    return add_entry(mux, channel, false, handler, user_data);
+}
+
+
+enum pubnub_res pubnub_submux_add_channel_group(pubnub_submux_t*        mux,
+                                                char const*             group,
+                                                pubnub_submux_handler_t handler,
+                                                void*                   user_data)
+{
+    return add_entry(mux, group, true, handler, user_data);
+}
+
+
+static enum pubnub_res remove_entry(pubnub_submux_t* mux, char const* name, bool is_group)
+{
+    struct submux_entry* entry;
+    struct submux_shard* shard;
+
+    PUBNUB_ASSERT_OPT(mux != NULL);
+    PUBNUB_ASSERT_OPT(name != NULL);
+
+    pubnub_mutex_lock(mux->monitor);
+    entry = find(mux, name, strlen(name), is_group);
+    if (NULL == entry) {
+        pubnub_mutex_unlock(mux->monitor);
+        return PNR_INVALID_CHANNEL;
+    }
+    shard = entry->shard;
+    unlink_from_table(mux, entry);
+    remove_from_shard(entry);
+    pubnub_mutex_unlock(mux->monitor);
+    free(entry);
+
+    kick(shard);
+
+    return PNR_OK;
+}
+
+
+enum pubnub_res pubnub_submux_remove_channel(pubnub_submux_t* mux, char const* channel)
+{
+    return remove_entry(mux, channel, false);
+}
+
+
+enum pubnub_res pubnub_submux_remove_channel_group(pubnub_submux_t* mux,
+                                                   char const*      group)
+{
+    return remove_entry(mux, group, true);
+}
+
+
+unsigned pubnub_submux_context_count(pubnub_submux_t* mux)
+{
+    unsigned rslt;
+
+    PUBNUB_ASSERT_OPT(mux != NULL);
+
+    pubnub_mutex_lock(mux->monitor);
+    rslt = mux->shard_count;
+    pubnub_mutex_unlock(mux->monitor);
+
+    return rslt;
+}
+
+
+int pubnub_submux_destroy(pubnub_submux_t* mux, unsigned millisec)
+{
+    unsigned i;
+    int      rslt = 0;
+
+    PUBNUB_ASSERT_OPT(mux != NULL);
+
+    pubnub_mutex_lock(mux->monitor);
+    mux->stopping = true;
+    pubnub_mutex_unlock(mux->monitor);
+
+    for (i = 0; i < mux->shard_count; ++i) {
+        struct submux_shard* shard = mux->shards[i];
+        if (NULL == shard->pb) {
+            continue;
+        }
+        if (pubnub_free_with_timeout(shard->pb, millisec) != 0) {
+            PUBNUB_LOG_ERROR("Failed to free context %p of the subscribe "
+                             "multiplexer %p\n",
+                             shard->pb,
+                             mux);
+            rslt = -1;
+        }
+        else {
+            shard->pb = NULL;
+        }
+    }
+    if (rslt != 0) {
+        return rslt;
+    }
+
+    for (i = 0; i < mux->bucket_count; ++i) {
+        struct submux_entry* e = mux->buckets[i];
+        while (e != NULL) {
+            struct submux_entry* next = e->next;
+            free(e);
+            e = next;
+        }
+    }
+    for (i = 0; i < mux->shard_count; ++i) {
+        free(mux->shards[i]->channels);
+        free(mux->shards[i]->groups);
+        free(mux->shards[i]);
+    }
+    free(mux->shards);
+    free(mux->buckets);
+    pubnub_mutex_destroy(mux->monitor);
+    free(mux);
+
+    return 0;
+}
+
+#endif /* PUBNUB_USE_SUBSCRIBE_V2 */
@@ -0,0 +1,183 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_SUBSCRIBE_MUX
+#define INC_PUBNUB_SUBSCRIBE_MUX
+
+
+#include "pubnub_api_types.h"
+
+#if !PUBNUB_USE_SUBSCRIBE_V2
+#error To use the subscribe multiplexer you must define PUBNUB_USE_SUBSCRIBE_V2=1
+#endif
+
+#include "pubnub_subscribe_v2.h"
+
+
+/** @file pubnub_subscribe_mux.h
+
+    This module implements a subscribe multiplexer ("subscription
+    manager") for the callback interface.
+
+    Instead of running a subscribe loop (on its own context) for each
+    channel (or a few of them), you tell the multiplexer which
+    channels and channel groups you are interested in, each with its
+    own handler. The multiplexer puts all of them in as few subscribe
+    V2 long-polls as it can - each long-poll is on a context of its
+    own, owned by the multiplexer, and is limited by the length of the
+    URL (#PUBNUB_BUF_MAXLEN). Each message received is dispatched to
+    the handler of its channel (or channel group).
+
+    When you add or remove a channel (group), only the long-poll it
+    is (to be) in is restarted (keeping its time token, so no messages
+    are lost), the others are not affected. Several changes done in a
+    short time are coalesced into one restart.
+
+    Interest may be changed from any thread, including from the
+    handlers.
+*/
+
+
+/** A subscribe multiplexer descriptor. An opaque data structure. */
+struct pubnub_subscribe_mux;
+
+/** A helper typedef of a subscribe multiplexer descriptor */
+typedef struct pubnub_subscribe_mux pubnub_submux_t;
+
+/** Prototype of a function that will be called back for each message
+    received on a channel (group) it was registered for.
+
+    @param pb The context of the multiplexer that received the message
+    @param msg The message. Its data is valid only during the call.
+    @param user_data The data given when the handler was registered
+
+    @note Called with the context @p pb locked, so, don't do anything
+    "long" in it.
+*/
+typedef void (*pubnub_submux_handler_t)(pubnub_t*                       pb,
+                                        struct pubnub_v2_message const* msg,
+                                        void*                           user_data);
+
+/** Prototype of a function that will be called back when a subscribe
+    of the multiplexer fails. The multiplexer will subscribe again
+    after the call.
+
+    @param pb The context on which the subscribe failed
+    @param result The outcome of the subscribe
+    @param user_data The data given to pubnub_submux_create()
+*/
+typedef void (*pubnub_submux_error_t)(pubnub_t* pb, enum pubnub_res result, void* user_data);
+
+/** Prototype of a function that is called for each context the
+    multiplexer allocates, to change its settings (UUID, auth,
+    proxy...), before it is used.
+*/
+typedef void (*pubnub_submux_context_init_t)(pubnub_t* pb, void* user_data);
+
+
+/** Creates a subscribe multiplexer. It doesn't allocate any contexts
+    until there is some interest (channel or channel group) to
+    subscribe to.
+
+    @param publish_key The string of the key to use when publishing.
+    Has to remain valid while the multiplexer exists.
+    @param subscribe_key The string of the key to use when
+    subscribing. Has to remain valid while the multiplexer exists.
+    @param options Subscribe V2 options to use for all the
+    subscribes. The `channel_group` is ignored, channel groups are
+    added with pubnub_submux_add_channel_group().
+    @param on_error Function to call when a subscribe fails, can be
+    NULL
+    @param error_data Passed to @p on_error
+
+    @retval NULL Failed to create a multiplexer
+    @result The multiplexer created
+ */
+pubnub_submux_t* pubnub_submux_create(char const*                        publish_key,
+                                      char const*                        subscribe_key,
+                                      struct pubnub_subscribe_v2_options options,
+                                      pubnub_submux_error_t              on_error,
+                                      void*                              error_data);
+
+/** Sets the function to call for each context the multiplexer @p
+    mux allocates from now on, so that you can change its settings.
+ */
+void pubnub_submux_set_context_init(pubnub_submux_t*             mux,
+                                    pubnub_submux_context_init_t init,
+                                    void*                        init_data);
+
+/** Sets the handler for the messages that don't match any channel
+    (group) of the multiplexer @p mux. This should not happen, except
+    for wildcard subscriptions, or races with removing a channel. If
+    not set, such messages are ignored.
+ */
+void pubnub_submux_set_default_handler(pubnub_submux_t*        mux,
+                                       pubnub_submux_handler_t handler,
+                                       void*                   user_data);
+
+/** Adds interest in the @p channel to the multiplexer @p mux: its
+    messages will be given to @p handler. If there already is such a
+    channel in the multiplexer, its handler is replaced.
+
+    A wildcard subscription (`channel.*`) is a channel, too. Messages
+    that match it are given to its handler.
+
+    @param mux The multiplexer
+    @param channel The name of one channel (no commas). Is copied.
+    @param handler The function to call for each message of @p channel
+    @param user_data Passed to @p handler
+
+    @retval PNR_OK channel added, it will be subscribed to shortly
+    @retval PNR_INVALID_CHANNEL bad channel name (empty, or has a
+    comma, or too long to fit in a subscribe URL)
+    @retval PNR_INTERNAL_ERROR failed to allocate memory or context
+    @retval PNR_CANCELLED the multiplexer is being destroyed
+ */
+enum pubnub_res pubnub_submux_add_channel(pubnub_submux_t*        mux,
+                                          char const*             channel,
+                                          pubnub_submux_handler_t handler,
+                                          void*                   user_data);
+
+/** Adds interest in the channel @p group to the multiplexer @p mux.
+    Same as pubnub_submux_add_channel(), but for a channel group: the
+    messages received on any channel of the @p group are given to @p
+    handler.
+ */
+enum pubnub_res pubnub_submux_add_channel_group(pubnub_submux_t*        mux,
+                                                char const*             group,
+                                                pubnub_submux_handler_t handler,
+                                                void*                   user_data);
+
+/** Removes interest in the @p channel from the multiplexer @p mux.
+
+    @note A message received just before this call may still be given
+    to the handler of the @p channel, during or (shortly) after it.
+
+    @retval PNR_OK channel removed
+    @retval PNR_INVALID_CHANNEL no such channel in the multiplexer
+ */
+enum pubnub_res pubnub_submux_remove_channel(pubnub_submux_t* mux, char const* channel);
+
+/** Removes interest in the channel @p group from the multiplexer @p
+    mux. Same as pubnub_submux_remove_channel(), but for a channel
+    group.
+ */
+enum pubnub_res pubnub_submux_remove_channel_group(pubnub_submux_t* mux,
+                                                   char const*      group);
+
+/** Returns the number of contexts (long-polls) the multiplexer @p mux
+    has allocated. Contexts are not freed when they have nothing to
+    subscribe to (they are reused when interest is added), but they
+    stop subscribing.
+ */
+unsigned pubnub_submux_context_count(pubnub_submux_t* mux);
+
+/** Destroys the multiplexer. All the subscribes are cancelled and
+    all the contexts are freed, waiting at most @p millisec for each.
+
+    @retval 0 multiplexer destroyed
+    @retval -1 failed to free some context(s) in due time, multiplexer
+    can't be destroyed (it is "leaked")
+ */
+int pubnub_submux_destroy(pubnub_submux_t* mux, unsigned millisec);
+
+
+#endif /* !defined INC_PUBNUB_SUBSCRIBE_MUX */
@@ -67,3 +67,25 @@ int pubnub_url_encode(char* buffer, char const* what, size_t buffer_size)
 
     return i;
 }
+
+
+size_t pubnub_url_encoded_len(char const* s, size_t len)
+{
+    size_t rslt = 0;
+    size_t i;
+    for (i = 0; i < len; ++i) {
+        rslt += (strchr(OK_SPAN_CHARACTERS, s[i]) != NULL) ? 1 : 3;
+    }
+    return rslt;
+}
+
+
+unsigned pbhash_fnv1a(unsigned h, char const* s, size_t len)
+{
+    size_t i;
+    for (i = 0; i < len; ++i) {
+        h ^= (unsigned char)s[i];
+        h *= 0x01000193u;
+    }
+    return h;
+}
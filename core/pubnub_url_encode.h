@@ -2,6 +2,8 @@
 #if !defined INC_PUBNUB_URL_ENCODE
 #define INC_PUBNUB_URL_ENCODE
 
+#include <stddef.h>
+
 /* RFC 3986 Unreserved characters plus few
  * safe reserved ones. */
 #define OK_SPAN_CHARACTERS "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~,=:;@[]"
@@ -12,5 +14,19 @@
  */
 int pubnub_url_encode(char* buffer, char const* what, size_t buffer_size);
 
+/** Returns the length of the @p len characters at @p s when
+    url-encoded, without encoding them.
+ */
+size_t pubnub_url_encoded_len(char const* s, size_t len);
+
+/** Initial value of an FNV-1a hash, for pbhash_fnv1a() */
+#define PBHASH_FNV1A_INIT 0x811c9dc5u
+
+/** Returns the FNV-1a hash @p h updated with the @p len characters at
+    @p s. Used to hash the names (of channels, UUIDs...) which go into
+    the URLs, to look them up in hash tables.
+ */
+unsigned pbhash_fnv1a(unsigned h, char const* s, size_t len);
+
 #endif /* !defined INC_PUBNUB_URL_ENCODE */
 
@@ -124,5 +124,17 @@
 #define PUBNUB_USE_ADVANCED_HISTORY 1
 #endif
 
+#if !defined(PUBNUB_USE_REPLY_INDEX)
+/** If true (!=0) will enable the API to get the messages (and
+    channels) of a reply as an array, with their lengths. */
+#define PUBNUB_USE_REPLY_INDEX 1
+#endif
+
+#if !defined(PUBNUB_USE_URL_CACHE)
+/** If true (!=0) will enable caching the static fragments (keys,
+    `pnsdk`, `uuid` and `auth`) of the request URLs in the context. */
+#define PUBNUB_USE_URL_CACHE 1
+#endif
+
 
 #endif /* !defined INC_PUBNUB_CONFIG */
@@ -0,0 +1,155 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub.hpp"
+
+#include "pubnub_mock_http_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <cstdlib>
+
+
+/** @file pubnub_executor_benchmark.cpp
+
+    Compares the executors of the `futres::then()` continuations, set
+    for the contexts with `context::set_executor()`: the time from the
+    start of a transaction to the start of its continuation (latency),
+    and how many transactions with continuations per second get done
+    (throughput). "thread per call" is how `then()` ran the
+    continuations before there were executors.
+
+    A number of contexts publish at the same time, in rounds, so
+    there are as many continuations in flight as there are contexts.
+    The transactions go to the mock HTTP server, which is used as a
+    proxy, with no simulated round-trip time, so the numbers don't
+    depend on the network and the differences are due to the
+    executors.
+
+    Usage: executor_benchmark [rounds [contexts]]
+ */
+
+
+typedef std::chrono::steady_clock clk;
+
+static int run(char const*                                    name,
+               std::vector<std::unique_ptr<pubnub::context>>& contexts,
+               std::shared_ptr<pubnub::executor>              exec,
+               unsigned                                       rounds)
+{
+    std::vector<double>     latency_us;
+    std::mutex              m;
+    std::condition_variable cond;
+    unsigned                done   = 0;
+    bool                    failed = false;
+
+    for (auto& ctx : contexts) {
+        ctx->set_executor(exec);
+    }
+    latency_us.reserve(rounds * contexts.size());
+
+    auto start = clk::now();
+    for (unsigned r = 0; r < rounds; ++r) {
+        std::vector<pubnub::futres> pending;
+        pending.reserve(contexts.size());
+        {
+            std::lock_guard<std::mutex> lk(m);
+            done = 0;
+        }
+        for (auto& ctx : contexts) {
+            auto started = clk::now();
+            pending.emplace_back(ctx->publish("executor_bench", "\"benchmark\""));
+            pending.back().then([&, started](pubnub::context&, pubnub_res res) {
+                double l = std::chrono::duration<double, std::micro>(clk::now() - started)
+                               .count();
+                std::lock_guard<std::mutex> lk(m);
+                latency_us.push_back(l);
+                if (res != PNR_OK) {
+                    failed = true;
+                }
+                if (++done == contexts.size()) {
+                    cond.notify_all();
+                }
+            });
+        }
+        std::unique_lock<std::mutex> lk(m);
+        cond.wait(lk, [&] { return done == contexts.size(); });
+    }
+    double elapsed_ms =
+        std::chrono::duration<double, std::milli>(clk::now() - start).count();
+    if (failed) {
+        std::cout << name << ": a publish failed" << std::endl;
+        return -1;
+    }
+
+    std::sort(latency_us.begin(), latency_us.end());
+    double sum = 0;
+    for (double l : latency_us) {
+        sum += l;
+    }
+    std::size_t const n = latency_us.size();
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << n / elapsed_ms * 1000
+              << " /s, latency avg " << std::setw(8) << sum / n << " us, p99 "
+              << std::setw(8) << latency_us[n * 99 / 100] << " us" << std::endl;
+
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned rounds   = 1000;
+    unsigned contexts = 8;
+    uint16_t port;
+
+    if (argc > 1) {
+        rounds = std::strtoul(argv[1], nullptr, 10);
+    }
+    if (argc > 2) {
+        contexts = std::strtoul(argv[2], nullptr, 10);
+    }
+    if (0 == rounds) {
+        rounds = 1;
+    }
+    if (0 == contexts) {
+        contexts = 1;
+    }
+
+    if (mock_http_server_start(&port) != 0) {
+        std::cout << "Failed to start the mock HTTP server" << std::endl;
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    try {
+        std::vector<std::unique_ptr<pubnub::context>> ctxs;
+        for (unsigned i = 0; i < contexts; ++i) {
+            ctxs.emplace_back(new pubnub::context("demo", "demo"));
+            ctxs.back()->set_proxy_manual(pubnub::http_get_proxy, "127.0.0.1", port);
+        }
+
+        std::cout << rounds << " rounds of " << contexts << " publishes, "
+                  << std::thread::hardware_concurrency() << " CPU(s)" << std::endl;
+        if ((run("thread per call", ctxs, pubnub::thread_per_call_executor(), rounds) != 0)
+            || (run("thread pool (1)", ctxs, pubnub::make_thread_pool_executor(1), rounds)
+                != 0)
+            || (run("thread pool (4)", ctxs, pubnub::make_thread_pool_executor(4), rounds)
+                != 0)
+            || (run("inline", ctxs, pubnub::inline_executor(), rounds) != 0)) {
+            return -1;
+        }
+    }
+    catch (std::exception& exc) {
+        std::cout << "Caught exception: " << exc.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,168 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub.hpp"
+
+#include "pubnub_mock_http_server.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+
+
+/** @file pubnub_get_all_benchmark.cpp
+
+    Compares the ways to read the messages from a subscribe response:
+    by copying them to a new vector of strings (`get_all()`), to a
+    vector of strings which is reused for all the responses
+    (`get_all(std::vector<std::string>&)`) and through views of them
+    (`messages()`). For each it shows the number of (heap) allocations
+    and the time per subscribe response.
+
+    The responses come from the mock HTTP server, which is used as a
+    proxy, so the numbers don't depend on the network.
+
+    Usage: get_all_benchmark [messages_per_response [responses]]
+ */
+
+
+static unsigned long        m_allocations;
+static volatile std::size_t m_bytes_read;
+
+void* operator new(std::size_t size)
+{
+    void* rslt = std::malloc(size ? size : 1);
+    if (NULL == rslt) {
+        throw std::bad_alloc();
+    }
+    ++m_allocations;
+    return rslt;
+}
+
+void operator delete(void* p) throw()
+{
+    std::free(p);
+}
+
+
+typedef std::chrono::steady_clock clk;
+
+enum method { copy_all, reuse_all, views };
+
+
+static int run(char const*      name,
+               pubnub::context& pb,
+               method           how,
+               unsigned         messages,
+               unsigned         responses)
+{
+    std::vector<std::string> reused;
+    unsigned long            allocations = 0;
+    double                   elapsed_us  = 0;
+    std::size_t              bytes       = 0;
+
+    for (unsigned i = 0; i < responses; ++i) {
+        pubnub_res res = pb.subscribe("bench").await();
+        if (res != PNR_OK) {
+            std::cout << name << ": subscribe failed: " << pubnub_res_2_string(res)
+                      << std::endl;
+            return -1;
+        }
+
+        unsigned long allocated = m_allocations;
+        auto          start     = clk::now();
+        std::size_t   n         = 0;
+        switch (how) {
+        case copy_all: {
+            std::vector<std::string> all = pb.get_all();
+            n                            = all.size();
+            bytes += all.empty() ? 0 : all.back().size();
+            break;
+        }
+        case reuse_all:
+            n = pb.get_all(reused);
+            bytes += reused.empty() ? 0 : reused.back().size();
+            break;
+        case views:
+            for (auto msg : pb.messages()) {
+                bytes += msg.size();
+                ++n;
+            }
+            break;
+        }
+        elapsed_us += std::chrono::duration<double, std::micro>(clk::now() - start).count();
+        allocations += m_allocations - allocated;
+
+        if (n != messages) {
+            std::cout << name << ": got " << n << " messages instead of " << messages
+                      << std::endl;
+            return -1;
+        }
+    }
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(10)
+              << double(allocations) / responses << " allocations, "
+              << std::setw(8) << elapsed_us / responses << " us per response"
+              << std::endl;
+    /* So that reading the messages is not optimized away */
+    m_bytes_read = bytes;
+
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned messages  = 100;
+    unsigned responses = 1000;
+    uint16_t port;
+
+    if (argc > 1) {
+        messages = std::strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        responses = std::strtoul(argv[2], NULL, 10);
+    }
+    if (0 == responses) {
+        responses = 1;
+    }
+
+    std::string body = "[[";
+    for (unsigned i = 0; i < messages; ++i) {
+        if (i > 0) {
+            body += ',';
+        }
+        body += "{\"text\":\"Hello from the get_all benchmark, message #"
+                + std::to_string(i) + "\"}";
+    }
+    body += "],\"15700000000000001\"]";
+
+    if ((mock_http_server_set_reply(body.c_str()) != 0)
+        || (mock_http_server_start(&port) != 0)) {
+        std::cout << "Failed to start the mock HTTP server" << std::endl;
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    try {
+        pubnub::context pb("demo", "demo");
+        pb.set_proxy_manual(pubnub::http_get_proxy, "127.0.0.1", port);
+
+        std::cout << messages << " messages per response, " << responses
+                  << " responses" << std::endl;
+        if ((run("get_all()", pb, copy_all, messages, responses) != 0)
+            || (run("get_all(reused)", pb, reuse_all, messages, responses) != 0)
+            || (run("messages() views", pb, views, messages, responses) != 0)) {
+            return -1;
+        }
+    }
+    catch (std::exception& exc) {
+        std::cout << "Caught exception: " << exc.what() << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
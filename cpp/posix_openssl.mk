@@ -28,6 +28,14 @@ ifndef USE_OBJECTS_API
 USE_OBJECTS_API = 1
 endif
 
+ifndef USE_REPLY_INDEX
+USE_REPLY_INDEX = 1
+endif
+
+ifndef USE_URL_CACHE
+USE_URL_CACHE = 1
+endif
+
 ifeq ($(USE_PROXY), 1)
 SOURCEFILES += ../core/pubnub_proxy.c ../core/pubnub_proxy_core.c ../core/pbhttp_digest.c ../core/pbntlm_core.c ../core/pbntlm_packer_std.c
 endif
@@ -57,7 +65,11 @@ SOURCEFILES += ../core/pbcc_objects_api.c ../core/pubnub_objects_api.c
 OBJFILES += pbcc_objects_api.o pubnub_objects_api.o
 endif
 
-CFLAGS =-g -I .. -I . -I ../openssl -Wall -D PUBNUB_THREADSAFE -D PUBNUB_LOG_LEVEL=PUBNUB_LOG_LEVEL_WARNING -D PUBNUB_ONLY_PUBSUB_API=$(ONLY_PUBSUB_API) -D PUBNUB_PROXY_API=$(USE_PROXY) -D PUBNUB_USE_GZIP_COMPRESSION=$(USE_GZIP_COMPRESSION) -D PUBNUB_RECEIVE_GZIP_RESPONSE=$(RECEIVE_GZIP_RESPONSE) -D PUBNUB_USE_SUBSCRIBE_V2=$(USE_SUBSCRIBE_V2) -D PUBNUB_USE_OBJECTS_API=$(USE_OBJECTS_API)
+ifeq ($(USE_REPLY_INDEX), 1)
+SOURCEFILES += ../core/pubnub_reply_index.c
+endif
+
+CFLAGS =-g -I .. -I . -I ../openssl -Wall -D PUBNUB_THREADSAFE -D PUBNUB_LOG_LEVEL=PUBNUB_LOG_LEVEL_WARNING -D PUBNUB_ONLY_PUBSUB_API=$(ONLY_PUBSUB_API) -D PUBNUB_PROXY_API=$(USE_PROXY) -D PUBNUB_USE_GZIP_COMPRESSION=$(USE_GZIP_COMPRESSION) -D PUBNUB_RECEIVE_GZIP_RESPONSE=$(RECEIVE_GZIP_RESPONSE) -D PUBNUB_USE_SUBSCRIBE_V2=$(USE_SUBSCRIBE_V2) -D PUBNUB_USE_OBJECTS_API=$(USE_OBJECTS_API) -D PUBNUB_USE_REPLY_INDEX=$(USE_REPLY_INDEX) -D PUBNUB_USE_URL_CACHE=$(USE_URL_CACHE)
 # -g enables debugging, remove to get a smaller executable
 
 OS := $(shell uname)
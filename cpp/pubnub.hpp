@@ -12,6 +12,12 @@
 
 #include <functional>
 #include <string>
+#if defined(PUBNUB_CALLBACK_API) && ((__cplusplus >= 201103L) || (_MSC_VER >= 1600))
+#include <memory>
+#endif
+#if defined(PUBNUB_CALLBACK_API) && defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
 
 #if PUBNUB_USE_EXTERN_C
 extern "C" {
@@ -157,6 +163,45 @@ public:
 #endif
 
 
+#if defined(PUBNUB_CALLBACK_API) && ((__cplusplus >= 201103L) || (_MSC_VER >= 1600))
+/** Runs the continuations passed to futres::then(). Set one for a
+ * context with context::set_executor(), or pass it to
+ * futres::then(). If none is set, each continuation is run in a
+ * thread of its own (see thread_per_call_executor()).
+ *
+ * You may provide your own, by deriving from this class, for
+ * example, to run continuations in your event loop.
+ */
+class executor {
+public:
+    virtual ~executor() {}
+    /// Runs @p f - now or later, in this or some other thread.
+    virtual void execute(std::function<void()> f) = 0;
+};
+
+/** Returns the executor that starts a new thread for each
+    continuation. This is the default.
+ */
+std::shared_ptr<executor> thread_per_call_executor();
+
+/** Returns the executor that runs a continuation right away, in the
+    thread which got the outcome of the transaction (the Pubnub
+    callback thread). This is the fastest, but the continuation
+    must not block - in particular, it must not await the outcome of
+    another transaction, including destroying a `futres` whose
+    transaction is in progress.
+ */
+std::shared_ptr<executor> inline_executor();
+
+/** Makes an executor with a fixed pool of @p threads worker threads,
+    which run the continuations in the order they were given. A
+    continuation that awaits another transaction blocks a worker
+    thread while it waits.
+ */
+std::shared_ptr<executor> make_thread_pool_executor(unsigned threads);
+#endif
+
+
 /** A future (pending) result of a Pubnub
  * transaction/operation/request.  It is somewhat similar to the
  * std::future<> from C++11.
@@ -211,6 +256,12 @@ public:
         /// be called when the transaction ends.
 #if (__cplusplus >= 201103L) || (_MSC_VER >= 1600)
     void then(std::function<void(pubnub::context&, pubnub_res)> f);
+#if defined(PUBNUB_CALLBACK_API)
+    /// Same as then(f), but @p f will be run by the executor
+    /// @p exec, instead of the one set for the context.
+    void then(std::function<void(pubnub::context&, pubnub_res)> f,
+              std::shared_ptr<executor> exec);
+#endif
 #else
     template <class T> void then(T f)
     {
@@ -229,6 +280,44 @@ public:
     /// Returns true if the transaction is over, else otherwise
     bool is_ready() const;
 
+#if defined(PUBNUB_CALLBACK_API) && defined(__cpp_impl_coroutine)
+    /** Makes a futres `co_await`-able (C++20): the awaiting coroutine
+        is resumed when the transaction is over, and `co_await`
+        yields its final result (outcome). The coroutine is resumed
+        on the executor @p exec, or, if it's empty, the one set for
+        the context (see context::set_executor()).
+
+        The futres has to live while it is awaited, which it does
+        if you `co_await` the temporary returned from a transaction
+        start, as in: `pubnub_res res = co_await ctx.time();`.
+     */
+    class awaiter {
+    public:
+        awaiter(futres& f, std::shared_ptr<executor> exec)
+            : d_f(f)
+            , d_exec(exec)
+        {
+        }
+        bool       await_ready() const;
+        bool       await_suspend(std::coroutine_handle<> h);
+        pubnub_res await_resume();
+
+    private:
+        futres&                   d_f;
+        std::shared_ptr<executor> d_exec;
+    };
+
+    /// Awaits the outcome, resuming on the context's executor
+    awaiter operator co_await() { return awaiter(*this, nullptr); }
+
+    /// Awaits the outcome, resuming on @p exec:
+    /// `co_await ctx.time().resume_on(exec)`
+    awaiter resume_on(std::shared_ptr<executor> exec)
+    {
+        return awaiter(*this, exec);
+    }
+#endif
+
     /// Parses the last (or latest) result of the transaction 'publish'.
     pubnub_publish_res parse_last_publish_result();
 
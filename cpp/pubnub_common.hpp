@@ -36,12 +36,16 @@ extern "C" {
 #define MAX_INCLUDE_DIMENSION 100
 #define MAX_ELEM_LENGTH 30
 #endif
+#if PUBNUB_USE_REPLY_INDEX
+#include "core/pubnub_reply_index.h"
+#endif
 #if PUBNUB_USE_EXTERN_C
 }
 #endif
 
 #include "pubnub_mutex.hpp"
 #include "tribool.hpp"
+#include "pubnub_message_range.hpp"
 #if PUBNUB_USE_SUBSCRIBE_V2
 #include "pubnub_v2_message.hpp"
 #endif
@@ -448,13 +452,10 @@ public:
     }
     pubnub_tribool count()
     {
-        if (false == d_count) {
-            return pbccFalse;
-        }
-        else if (true == d_count) {
-            return pbccTrue;
+        if (!d_count.is_set()) {
+            return pbccNotSet;
         }
-        return pbccNotSet;
+        return d_count ? pbccTrue : pbccFalse;
     }
 };
 #endif /* PUBNUB_USE_OBJECTS_API */    
@@ -586,14 +587,37 @@ public:
     std::vector<std::string> get_all() const
     {
         std::vector<std::string> all;
-        while (char const* msg = pubnub_get(d_pb)) {
-            if (NULL == msg) {
-                break;
-            }
-            all.push_back(msg);
+#if PUBNUB_USE_REPLY_INDEX
+        int count = pubnub_get_messages(d_pb, NULL);
+        if (count > 0) {
+            all.reserve(count);
         }
+#endif
+        get_all(all);
         return all;
     }
+    /// Puts all messages from the context in @p all, replacing its
+    /// contents. Reuses the capacity of @p all and of the strings
+    /// already in it, so, if you keep (and reuse) the same vector for
+    /// all the responses, there are (almost) no allocations once it
+    /// "grew" to the size of a typical response.
+    /// @return The number of messages
+    std::size_t get_all(std::vector<std::string>& all) const
+    {
+        return fill_all(messages(), all);
+    }
+    /// Returns a range of views of the messages from the context,
+    /// which doesn't copy the messages. The views are valid until
+    /// the next transaction is started on the context.
+    /// @see message_range
+    message_range messages() const
+    {
+#if PUBNUB_USE_REPLY_INDEX
+        return message_range(d_pb, pubnub_get, pubnub_consume_messages);
+#else
+        return message_range(d_pb, pubnub_get);
+#endif
+    }
 
 #if PUBNUB_USE_SUBSCRIBE_V2
     /// Returns the next v2 message from the context. If there are
@@ -667,14 +691,34 @@ public:
     std::vector<std::string> get_all_channels() const
     {
         std::vector<std::string> all;
-        while (char const* msg = pubnub_get_channel(d_pb)) {
-            if (NULL == msg) {
-                break;
-            }
-            all.push_back(msg);
+#if PUBNUB_USE_REPLY_INDEX
+        int count = pubnub_get_channels(d_pb, NULL);
+        if (count > 0) {
+            all.reserve(count);
         }
+#endif
+        get_all_channels(all);
         return all;
     }
+    /// Puts all channel strings from the context in @p all,
+    /// reusing its capacity, like `get_all(std::vector<std::string>&)`.
+    /// @return The number of channels
+    std::size_t get_all_channels(std::vector<std::string>& all) const
+    {
+        return fill_all(channels(), all);
+    }
+    /// Returns a range of views of the channel strings from the
+    /// context, which doesn't copy them. The views are valid until
+    /// the next transaction is started on the context.
+    /// @see message_range
+    message_range channels() const
+    {
+#if PUBNUB_USE_REPLY_INDEX
+        return message_range(d_pb, pubnub_get_channel, pubnub_consume_channels);
+#else
+        return message_range(d_pb, pubnub_get_channel);
+#endif
+    }
 
     /// Cancels the transaction, if any is ongoing, or connection is 'kept alive'. 
     /// If none is ongoing, it is ignored.
@@ -1509,13 +1553,50 @@ public:
         pubnub_mutex_destroy(d_mutex);
     }
 
+#if defined(PUBNUB_CALLBACK_API) && ((__cplusplus >= 201103L) || (_MSC_VER >= 1600))
+    /** Sets the executor which will run the continuations passed to
+        futres::then() of transactions started on this context. Pass
+        an empty pointer to use the default (a thread per
+        continuation).
+     */
+    void set_executor(std::shared_ptr<executor> exec)
+    {
+        lock_guard lck(d_mutex);
+        d_executor = exec;
+    }
+    /// Returns the executor set for this context (empty if none was)
+    std::shared_ptr<executor> get_executor() const
+    {
+        lock_guard lck(d_mutex);
+        return d_executor;
+    }
+#endif
+
 private:
     // pubnub context is not copyable
     context(context const&);
 
     // internal helper function
     futres doit(pubnub_res e) { return futres(d_pb, *this, e); }
-    /// The mutex protecting d_auth field
+
+    // internal helper function: copies all from @p range to @p all,
+    // reusing what is already in @p all
+    static std::size_t fill_all(message_range const& range, std::vector<std::string>& all)
+    {
+        std::size_t n = 0;
+        for (message_range::iterator it = range.begin(); it != range.end(); ++it, ++n) {
+            message_view msg = *it;
+            if (n < all.size()) {
+                all[n].assign(msg.data(), msg.size());
+            }
+            else {
+                all.push_back(std::string(msg.data(), msg.size()));
+            }
+        }
+        all.resize(n);
+        return n;
+    }
+    /// The mutex protecting d_auth (and d_executor) field
     mutable pubnub_mutex_t d_mutex;
     /// The publish key
     std::string d_pubk;
@@ -1532,6 +1613,10 @@ private:
     char d_message_to_send[PUBNUB_BUF_MAXLEN];
     /// The (C) Pubnub context
     pubnub_t* d_pb;
+#if defined(PUBNUB_CALLBACK_API) && ((__cplusplus >= 201103L) || (_MSC_VER >= 1600))
+    /// The executor of futres::then() continuations
+    std::shared_ptr<executor> d_executor;
+#endif
 };
 
 } // namespace pubnub
@@ -12,12 +12,122 @@ extern "C" {
 
 #include <thread>
 #include <condition_variable>
+#include <deque>
+#include <vector>
 
 #include <stdexcept>
 
 
 namespace pubnub {
 
+/// Starts a (detached) thread for each continuation
+class thread_per_call : public executor {
+public:
+    void execute(std::function<void()> f) override {
+        std::thread(f).detach();
+    }
+};
+
+
+/// Runs the continuation in the calling thread
+class inline_runner : public executor {
+public:
+    void execute(std::function<void()> f) override {
+        f();
+    }
+};
+
+
+/// A fixed pool of worker threads, sharing a FIFO queue
+class thread_pool : public executor {
+public:
+    explicit thread_pool(unsigned threads) : d_state(std::make_shared<state>()) {
+        if (0 == threads) {
+            threads = 1;
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+            std::shared_ptr<state> st = d_state;
+            d_workers.emplace_back([st] { work(*st); });
+        }
+    }
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lk(d_state->mutex);
+            d_state->stop = true;
+        }
+        d_state->cond.notify_all();
+        for (auto& t : d_workers) {
+            /* The last reference to the pool may be dropped in one
+               of its own continuations. That worker keeps its own
+               reference to the state, so it can finish after the
+               pool is gone. */
+            if (t.get_id() == std::this_thread::get_id()) {
+                t.detach();
+            }
+            else {
+                t.join();
+            }
+        }
+    }
+    void execute(std::function<void()> f) override {
+        {
+            std::lock_guard<std::mutex> lk(d_state->mutex);
+            d_state->queue.push_back(std::move(f));
+        }
+        d_state->cond.notify_one();
+    }
+
+private:
+    /// The state shared by the pool and its workers
+    struct state {
+        state() : stop(false) {}
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::deque<std::function<void()>> queue;
+        bool stop;
+    };
+
+    static void work(state& st) {
+        for (;;) {
+            std::function<void()> f;
+            {
+                std::unique_lock<std::mutex> lk(st.mutex);
+                st.cond.wait(lk, [&st] { return st.stop || !st.queue.empty(); });
+                if (st.queue.empty()) {
+                    return;
+                }
+                f = std::move(st.queue.front());
+                st.queue.pop_front();
+            }
+            f();
+        }
+    }
+
+    std::shared_ptr<state> d_state;
+    std::vector<std::thread> d_workers;
+};
+
+
+std::shared_ptr<executor> thread_per_call_executor()
+{
+    static std::shared_ptr<executor> exec(new thread_per_call);
+    return exec;
+}
+
+
+std::shared_ptr<executor> inline_executor()
+{
+    static std::shared_ptr<executor> exec(new inline_runner);
+    return exec;
+}
+
+
+std::shared_ptr<executor> make_thread_pool_executor(unsigned threads)
+{
+    return std::make_shared<thread_pool>(threads);
+}
+
+
 static void futres_callback(pubnub_t *pb,
                             enum pubnub_trans trans,
                             enum pubnub_res result,
@@ -30,6 +140,7 @@ public:
         d_triggered(false),
         d_pb(pb),
         d_parent(nullptr),
+        d_then_running(false),
         d_result(initial) {
         if (initial != PNR_IN_PROGRESS) {
             std::unique_lock<std::mutex> lk(d_mutex);
@@ -51,7 +162,7 @@ public:
         std::unique_lock<std::mutex> lk(d_mutex);
         if (PNR_STARTED == d_result) {
             d_cond.wait(lk, [&] { return d_triggered; });
-            return d_result = pubnub_last_result(d_pb);
+            return update_result(lk);
         }
         else {
             return d_result;
@@ -60,37 +171,90 @@ public:
     pubnub_res last_result() {
         std::unique_lock<std::mutex> lk(d_mutex);
         if (PNR_STARTED == d_result) {
-            return d_result = pubnub_last_result(d_pb);
+            return update_result(lk);
         }
         else {
             return d_result;
         }
     }
     void signal(pubnub_res rslt) {
+        bool run_then = false;
+#if defined(__cpp_impl_coroutine)
+        std::coroutine_handle<> coro;
+        std::shared_ptr<executor> coro_exec;
+#endif
         {
             std::lock_guard<std::mutex> lk(d_mutex);
-            if (d_thenf && d_parent) {
-                d_thread = std::thread([&]{ d_thenf(d_parent->d_ctx, rslt); });
+            if (d_thenf && d_parent && !d_then_running) {
+                d_then_running = run_then = true;
             }
+#if defined(__cpp_impl_coroutine)
+            std::swap(coro, d_coro);
+            std::swap(coro_exec, d_coro_executor);
+#endif
             d_triggered = true;
         }
-        d_cond.notify_one();
-        
+        d_cond.notify_all();
+        if (run_then) {
+            d_executor->execute([this, rslt] {
+                d_thenf(d_parent->d_ctx, rslt);
+                std::lock_guard<std::mutex> lk(d_mutex);
+                d_then_running = false;
+                d_cond.notify_all();
+            });
+        }
+#if defined(__cpp_impl_coroutine)
+        /* The resumed coroutine may destroy us, so this has to be
+           the last thing we do. */
+        if (coro) {
+            coro_exec->execute([coro] { coro.resume(); });
+        }
+#endif
     }
     bool is_ready() const {
         std::lock_guard<std::mutex> lk(d_mutex);
         return d_triggered;
     }
-    void then(std::function<void(context &, pubnub_res)> f, futres *parent) {
+#if defined(__cpp_impl_coroutine)
+    bool is_done() const {
+        std::lock_guard<std::mutex> lk(d_mutex);
+        return d_triggered || (d_result != PNR_STARTED);
+    }
+    /// Unless the transaction is already over, keeps the coroutine
+    /// @p h to be resumed on @p exec when it is.
+    /// @return true: coroutine suspended, false: resume it right away
+    bool suspend(std::coroutine_handle<> h, std::shared_ptr<executor> exec) {
+        std::lock_guard<std::mutex> lk(d_mutex);
+        if (d_triggered || (d_result != PNR_STARTED)) {
+            return false;
+        }
+        d_coro = h;
+        d_coro_executor = exec ? exec : thread_per_call_executor();
+        return true;
+    }
+#endif
+    void then(std::function<void(context &, pubnub_res)> f,
+              futres *parent,
+              std::shared_ptr<executor> exec) {
         PUBNUB_ASSERT_OPT(parent != nullptr);
         std::lock_guard<std::mutex> lk(d_mutex);
         d_thenf = f;
         d_parent = parent;
+        d_executor = exec ? exec : thread_per_call_executor();
     }
     
 private:
+    /// Gets the result from the C context. Doesn't hold our lock
+    /// while locking the context, as a continuation run by an
+    /// inline executor holds the context lock while taking ours.
+    pubnub_res update_result(std::unique_lock<std::mutex> &lk) {
+        lk.unlock();
+        pubnub_res rslt = pubnub_last_result(d_pb);
+        lk.lock();
+        return d_result = rslt;
+    }
     void wait4_then_thread_to_start() {
-        auto should_await = [=] {
+        auto should_await = [this] {
             std::lock_guard<std::mutex> lk(d_mutex);
             return !d_triggered && d_thenf && d_parent;
         }();
@@ -99,9 +263,8 @@ private:
         }
     }
     void wait4_then_thread_to_finish() {
-        if (d_thread.joinable()) {
-            d_thread.join();
-        }
+        std::unique_lock<std::mutex> lk(d_mutex);
+        d_cond.wait(lk, [&] { return !d_then_running; });
     }
 
     mutable std::mutex d_mutex;
@@ -112,7 +275,16 @@ private:
     
     std::function<void(context&, pubnub_res)> d_thenf;
     futres *d_parent;
-    std::thread d_thread;
+    /// Runs the `d_thenf` continuation
+    std::shared_ptr<executor> d_executor;
+    /// Set while the continuation is (to be) run by the executor
+    bool d_then_running;
+#if defined(__cpp_impl_coroutine)
+    /// The coroutine awaiting the outcome of the transaction
+    std::coroutine_handle<> d_coro;
+    /// Resumes the `d_coro` coroutine
+    std::shared_ptr<executor> d_coro_executor;
+#endif
     pubnub_res d_result;
 };
     
@@ -185,7 +357,34 @@ tribool futres::should_retry() const
 
 void futres::then(std::function<void(context &, pubnub_res)> f)
 {
-    d_pimpl->then(f, this);
+    d_pimpl->then(f, this, d_ctx.get_executor());
+}
+
+
+void futres::then(std::function<void(context &, pubnub_res)> f,
+                  std::shared_ptr<executor> exec)
+{
+    d_pimpl->then(f, this, exec);
+}
+
+
+#if defined(__cpp_impl_coroutine)
+bool futres::awaiter::await_ready() const
+{
+    return d_f.d_pimpl->is_done();
 }
 
+
+bool futres::awaiter::await_suspend(std::coroutine_handle<> h)
+{
+    return d_f.d_pimpl->suspend(h, d_exec ? d_exec : d_f.d_ctx.get_executor());
+}
+
+
+pubnub_res futres::awaiter::await_resume()
+{
+    return d_f.end_await();
+}
+#endif
+
 }
@@ -0,0 +1,242 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_MESSAGE_RANGE_HPP
+#define INC_PUBNUB_MESSAGE_RANGE_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <string>
+
+#if (__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+#define PUBNUB_HAS_STD_STRING_VIEW 1
+#include <string_view>
+#else
+#define PUBNUB_HAS_STD_STRING_VIEW 0
+#endif
+
+
+namespace pubnub {
+
+#if PUBNUB_HAS_STD_STRING_VIEW
+
+/** A (read-only) view of a message (or a channel, or some other
+    string) in the reply of a Pubnub transaction, without copying it.
+ */
+typedef std::string_view message_view;
+
+#else
+
+/** A (read-only) view of a message (or a channel, or some other
+    string) in the reply of a Pubnub transaction, without copying it.
+
+    With C++17 (or later), this is `std::string_view`. Before it, it
+    is this minimal "pointer and length" class, with just what you
+    need to read the message or make a `std::string` from it.
+ */
+class message_view {
+    char const* d_ptr;
+    std::size_t d_size;
+
+public:
+    typedef char const* const_iterator;
+
+    message_view()
+        : d_ptr("")
+        , d_size(0)
+    {
+    }
+    message_view(char const* ptr, std::size_t size)
+        : d_ptr(ptr)
+        , d_size(size)
+    {
+    }
+    message_view(char const* s)
+        : d_ptr(s)
+        , d_size(std::strlen(s))
+    {
+    }
+    char const*    data() const { return d_ptr; }
+    std::size_t    size() const { return d_size; }
+    std::size_t    length() const { return d_size; }
+    bool           empty() const { return 0 == d_size; }
+    const_iterator begin() const { return d_ptr; }
+    const_iterator end() const { return d_ptr + d_size; }
+    char           operator[](std::size_t i) const { return d_ptr[i]; }
+    operator std::string() const { return std::string(d_ptr, d_size); }
+
+    friend bool operator==(message_view const& l, message_view const& r)
+    {
+        return (l.d_size == r.d_size) && (0 == std::memcmp(l.d_ptr, r.d_ptr, l.d_size));
+    }
+    friend bool operator!=(message_view const& l, message_view const& r)
+    {
+        return !(l == r);
+    }
+    friend std::ostream& operator<<(std::ostream& out, message_view const& v)
+    {
+        return out.write(v.d_ptr, static_cast<std::streamsize>(v.d_size));
+    }
+};
+
+#endif /* PUBNUB_HAS_STD_STRING_VIEW */
+
+
+/** A range of the messages (or channels) from the reply of the last
+    transaction on a context, read one by one, as `message_view`s,
+    without copying them. Use it like any other range:
+
+        for (auto msg : pb.messages()) {
+            process(msg);
+        }
+
+    It is an "input range": reading it consumes the messages from the
+    context, just like `pubnub::context::get()` does, so you can read
+    it only once.
+
+    With the reply index (#PUBNUB_USE_REPLY_INDEX), the messages and
+    their lengths are taken from it (all of them are consumed as soon
+    as the reading starts), so they are not scanned again to find
+    their ends. Without it, each message is read with the getter and
+    measured with `strlen()`.
+
+    Lifetime: the views point into the reply of the transaction,
+    which is kept in the context. So, they are valid only until the
+    next transaction is started on the context (or it is
+    destroyed). If you need a message longer than that, make a
+    `std::string` from its view.
+ */
+class message_range {
+public:
+    /// Function to get the next message (string) from the context
+    typedef char const* (*getter)(pubnub_t*);
+
+#if PUBNUB_USE_REPLY_INDEX
+    /// Function to get (and consume) the messages not read yet, from
+    /// the reply index, like pubnub_consume_messages()
+    typedef int (*consumer)(pubnub_t*, pubnub_chamebl_t const**);
+#endif
+
+    class iterator {
+        pubnub_t*   d_pb;
+        getter      d_get;
+        char const* d_msg;
+#if PUBNUB_USE_REPLY_INDEX
+        /// The current and the end of the messages from the reply
+        /// index, both null if the getter is used
+        pubnub_chamebl_t const* d_item;
+        pubnub_chamebl_t const* d_end;
+#endif
+
+    public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef message_view            value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef message_view const*     pointer;
+        typedef message_view            reference;
+
+        iterator()
+            : d_pb(0)
+            , d_get(0)
+            , d_msg(0)
+#if PUBNUB_USE_REPLY_INDEX
+            , d_item(0)
+            , d_end(0)
+#endif
+        {
+        }
+#if PUBNUB_USE_REPLY_INDEX
+        iterator(pubnub_t* pb, getter get, consumer consume)
+            : d_pb(pb)
+            , d_get(get)
+            , d_msg(0)
+            , d_item(0)
+            , d_end(0)
+        {
+            pubnub_chamebl_t const* items;
+            int                     n = consume(pb, &items);
+            if (n > 0) {
+                d_item = items;
+                d_end  = items + n;
+                d_msg  = d_item->ptr;
+            }
+            else {
+                /* Not indexed, or nothing left to read */
+                d_msg = get(pb);
+            }
+        }
+        message_view operator*() const
+        {
+            return (d_item != 0) ? message_view(d_item->ptr, d_item->size)
+                                 : message_view(d_msg);
+        }
+        iterator& operator++()
+        {
+            if (d_item != 0) {
+                ++d_item;
+                d_msg = (d_item == d_end) ? 0 : d_item->ptr;
+            }
+            else {
+                d_msg = d_get(d_pb);
+            }
+            return *this;
+        }
+#else
+        iterator(pubnub_t* pb, getter get)
+            : d_pb(pb)
+            , d_get(get)
+            , d_msg(get(pb))
+        {
+        }
+        message_view operator*() const { return message_view(d_msg); }
+        iterator&    operator++()
+        {
+            d_msg = d_get(d_pb);
+            return *this;
+        }
+#endif
+        void operator++(int) { ++*this; }
+
+        /// All the iterators that reached the end are equal, and
+        /// different from all the others
+        friend bool operator==(iterator const& l, iterator const& r)
+        {
+            return l.d_msg == r.d_msg;
+        }
+        friend bool operator!=(iterator const& l, iterator const& r)
+        {
+            return !(l == r);
+        }
+    };
+
+#if PUBNUB_USE_REPLY_INDEX
+    message_range(pubnub_t* pb, getter get, consumer consume)
+        : d_pb(pb)
+        , d_get(get)
+        , d_consume(consume)
+    {
+    }
+    /// Starts reading (consuming) the messages. Call only once.
+    iterator begin() const { return iterator(d_pb, d_get, d_consume); }
+#else
+    message_range(pubnub_t* pb, getter get)
+        : d_pb(pb)
+        , d_get(get)
+    {
+    }
+    /// Starts reading (consuming) the messages. Call only once.
+    iterator begin() const { return iterator(d_pb, d_get); }
+#endif
+    iterator end() const { return iterator(); }
+
+private:
+    pubnub_t* d_pb;
+    getter    d_get;
+#if PUBNUB_USE_REPLY_INDEX
+    consumer d_consume;
+#endif
+};
+
+} // namespace pubnub
+
+#endif /* INC_PUBNUB_MESSAGE_RANGE_HPP */
@@ -6,6 +6,8 @@
 #error To use the subscribe V2 API you must define PUBNUB_USE_SUBSCRIBE_V2=1
 #endif
 
+#include "pubnub_message_range.hpp"
+
 #include <cstring>
 
 namespace pubnub {
@@ -27,10 +29,27 @@ public:
     std::string payload() const { return std::string(d_.payload.ptr, d_.payload.size); } 
     std::string metadata() const { return std::string(d_.metadata.ptr, d_.metadata.size); } 
     pubnub_message_type message_type() const { return d_.message_type; }
+
+    /* Views of the message data, which don't copy it. They are valid
+       until the next transaction is started on the context the
+       message was read from.
+     */
+    message_view tt_view() const { return view(d_.tt); }
+    message_view channel_view() const { return view(d_.channel); }
+    message_view match_or_group_view() const { return view(d_.match_or_group); }
+    message_view payload_view() const { return view(d_.payload); }
+    message_view metadata_view() const { return view(d_.metadata); }
+
     /** Message structure is considered empty if there is no timetoken info(whose
         existence is obligatory for any valid v2 message)
       */
     bool is_empty() const { return (0 == d_.tt.ptr) || (0 == d_.tt.size); }
+
+private:
+    static message_view view(struct pubnub_char_mem_block const& block)
+    {
+        return (0 == block.ptr) ? message_view() : message_view(block.ptr, block.size);
+    }
 };
 
 } // namespace pubnub
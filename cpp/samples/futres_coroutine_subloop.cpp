@@ -0,0 +1,152 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cstdlib>
+
+
+/* This sample shows how to `co_await` a `pubnub::futres` (C++20).
+
+   It starts a (large) number of subscribe loops, each on a context of
+   its own, written as coroutines. No thread is blocked while a loop
+   waits for messages: each coroutine is suspended until the outcome of
+   its subscribe and then resumed on a small pool of threads. Then we
+   publish a few messages and each loop stops when it got them all.
+
+   Usage: futres_coroutine_subloop [number_of_loops]
+
+   Each context has its own socket, so for thousands of loops you
+   may need to raise the limit of open files (`ulimit -n`).
+ */
+
+
+static const std::string chan("hello_world_coroutine");
+
+/// Number of messages we publish and each loop waits for
+static const unsigned messages_to_publish = 3;
+
+/// Number of coroutines (subscribe loops and the publisher) still running
+static std::atomic<unsigned> m_running;
+static std::mutex              m_done_m;
+static std::condition_variable m_done_cond;
+
+
+/** A minimal "fire and forget" coroutine type: starts right away and
+    nobody awaits it.
+ */
+struct task {
+    struct promise_type {
+        task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void               return_void() {}
+        void               unhandled_exception() { std::terminate(); }
+    };
+};
+
+
+static void coroutine_done()
+{
+    if (0 == --m_running) {
+        std::lock_guard<std::mutex> lk(m_done_m);
+        m_done_cond.notify_all();
+    }
+}
+
+
+/// A subscribe loop, as a coroutine
+static task subscribe_loop(pubnub::context& pb, unsigned id, std::atomic<unsigned>& connected)
+{
+    unsigned received = 0;
+
+    /* The first subscribe just "connects" (gets the time token) */
+    pubnub_res res = co_await pb.subscribe(chan);
+    if (res != PNR_OK) {
+        std::cout << "Loop " << id << ": subscribe failed: "
+                  << pubnub_res_2_string(res) << std::endl;
+        coroutine_done();
+        co_return;
+    }
+    ++connected;
+    while (received < messages_to_publish) {
+        res = co_await pb.subscribe(chan);
+        if (res != PNR_OK) {
+            std::cout << "Loop " << id << ": subscribe failed: "
+                      << pubnub_res_2_string(res) << std::endl;
+            break;
+        }
+        for (auto&& msg : pb.get_all()) {
+            ++received;
+            if (0 == id) {
+                std::cout << "Loop 0 got: " << msg << std::endl;
+            }
+        }
+    }
+    coroutine_done();
+}
+
+
+/// Publishes the messages, once all the (running) loops are "connected"
+static task publish_messages(pubnub::context& pb, std::atomic<unsigned>& connected)
+{
+    while (connected + 1 < m_running) {
+        /* Just a way to wait a little, without blocking a thread */
+        if (co_await pb.time() != PNR_OK) {
+            break;
+        }
+    }
+    for (unsigned i = 0; i < messages_to_publish; ++i) {
+        std::string msg = "\"Hello from a coroutine #" + std::to_string(i) + "\"";
+        pubnub_res  res = co_await pb.publish(chan, msg);
+        std::cout << "Publish #" << i << ": " << pubnub_res_2_string(res) << std::endl;
+    }
+    coroutine_done();
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned loops = 1000;
+    if (argc > 1) {
+        loops = std::strtoul(argv[1], nullptr, 10);
+    }
+    try {
+        /* All the coroutines are resumed on these few threads */
+        auto                  pool = pubnub::make_thread_pool_executor(4);
+        std::atomic<unsigned> connected(0);
+        std::vector<std::unique_ptr<pubnub::context>> contexts;
+
+        for (unsigned i = 0; i < loops; ++i) {
+            contexts.emplace_back(new pubnub::context("demo", "demo"));
+            contexts.back()->set_executor(pool);
+        }
+        pubnub::context publisher("demo", "demo");
+        publisher.set_executor(pool);
+
+        std::cout << "Starting " << loops << " subscribe loops" << std::endl;
+        m_running = loops + 1;
+        for (unsigned i = 0; i < loops; ++i) {
+            subscribe_loop(*contexts[i], i, connected);
+        }
+        publish_messages(publisher, connected);
+
+        std::unique_lock<std::mutex> lk(m_done_m);
+        m_done_cond.wait(lk, [] { return 0 == m_running; });
+        std::cout << "All " << loops << " subscribe loops done, "
+                  << connected << " of them connected" << std::endl;
+    }
+    catch (std::exception& exc) {
+        std::cout << "Caught exception: " << exc.what() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,36 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_SOCKET_WAIT_IO
+#define INC_SOCKET_WAIT_IO
+
+#include "pubnub_get_native_socket.h"
+
+#include <stdbool.h>
+
+/** Waits for up to @p timeout_ms milliseconds for the @p socket to
+    become ready for reading or, if @p out, for writing.
+    @return 0: timed out, +1: ready (or error/hang-up on the socket),
+    -1: error
+ */
+int pbpal_socket_wait_io(pbpal_native_socket_t socket, bool out, int timeout_ms);
+
+/** A socket to wait for in pbpal_sockets_wait_io() */
+struct pbpal_socket_wait {
+    /** The socket, if invalid, it is skipped */
+    pbpal_native_socket_t socket;
+    /** Wait for it to become writable (or readable, if false) */
+    bool out;
+    /** Set if the socket is ready (or there was an error/hang-up on
+        it) */
+    bool ready;
+};
+
+/** Waits for up to @p timeout_ms milliseconds for any of the @p n
+    sockets in @p waits to become ready.
+    @return The number of ready sockets, 0: timed out, -1: error
+ */
+int pbpal_sockets_wait_io(struct pbpal_socket_wait* waits, unsigned n, int timeout_ms);
+
+/** Wakes up anybody waiting on the @p socket, by shutting it down */
+void pbpal_socket_interrupt_wait_io(pbpal_native_socket_t socket);
+
+#endif /* INC_SOCKET_WAIT_IO */
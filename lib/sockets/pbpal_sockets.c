@@ -51,7 +51,7 @@ int pbpal_send(pubnub_t* pb, void const* data, size_t n)
     PUBNUB_ASSERT_INT_OPT(pb->sock_state, ==, STATE_NONE);
 
     pb->ptr        = (uint8_t*)data;
-    pb->len        = (uint16_t)n;
+    pb->len        = (unsigned)n;
     pb->sock_state = STATE_SENDING_DATA;
     pb->left       = sizeof pb->core.http_buf / sizeof pb->core.http_buf[0];
 
@@ -30,6 +30,46 @@ ifndef USE_OBJECTS_API
 USE_OBJECTS_API = 1
 endif
 
+ifndef USE_OBJECTS_CACHE
+USE_OBJECTS_CACHE = $(USE_OBJECTS_API)
+endif
+
+ifndef USE_REPLY_INDEX
+USE_REPLY_INDEX = 1
+endif
+
+ifndef USE_URL_CACHE
+USE_URL_CACHE = 1
+endif
+
+ifndef USE_PUBLISH_PIPELINE
+USE_PUBLISH_PIPELINE = 1
+endif
+
+ifndef USE_REQUEST_BODY
+USE_REQUEST_BODY = 1
+endif
+
+ifndef USE_JSON_WRITER
+USE_JSON_WRITER = 1
+endif
+
+ifndef USE_HISTORY_STREAM
+USE_HISTORY_STREAM = 1
+endif
+
+ifndef USE_SYNC_POLL
+USE_SYNC_POLL = 1
+endif
+
+ifndef USE_FREE_NOTIFY
+USE_FREE_NOTIFY = 1
+endif
+
+ifndef DYNAMIC_SCRATCH_BUFFERS
+DYNAMIC_SCRATCH_BUFFERS = 0
+endif
+
 ifeq ($(USE_PROXY), 1)
 SOURCEFILES += ../core/pubnub_proxy.c ../core/pubnub_proxy_core.c ../core/pbhttp_digest.c ../core/pbntlm_core.c ../core/pbntlm_packer_std.c
 OBJFILES += pubnub_proxy.o pubnub_proxy_core.o pbhttp_digest.o pbntlm_core.o pbntlm_packer_std.o
@@ -60,7 +100,47 @@ SOURCEFILES += ../core/pbcc_objects_api.c ../core/pubnub_objects_api.c
 OBJFILES += pbcc_objects_api.o pubnub_objects_api.o
 endif
 
-CFLAGS = -g -D PUBNUB_THREADSAFE -D PUBNUB_LOG_LEVEL=PUBNUB_LOG_LEVEL_WARNING -Wall -D PUBNUB_ONLY_PUBSUB_API=$(ONLY_PUBSUB_API) -D PUBNUB_PROXY_API=$(USE_PROXY) -D PUBNUB_USE_GZIP_COMPRESSION=$(USE_GZIP_COMPRESSION) -D PUBNUB_RECEIVE_GZIP_RESPONSE=$(RECEIVE_GZIP_RESPONSE) -D PUBNUB_USE_SUBSCRIBE_V2=$(USE_SUBSCRIBE_V2) -D PUBNUB_USE_OBJECTS_API=$(USE_OBJECTS_API)
+ifeq ($(USE_OBJECTS_CACHE), 1)
+SOURCEFILES += ../core/pubnub_objects_cache.c
+OBJFILES += pubnub_objects_cache.o
+endif
+
+ifeq ($(USE_REPLY_INDEX), 1)
+SOURCEFILES += ../core/pubnub_reply_index.c
+OBJFILES += pubnub_reply_index.o
+endif
+
+ifeq ($(USE_PUBLISH_PIPELINE), 1)
+SOURCEFILES += ../core/pubnub_publish_pipeline.c
+OBJFILES += pubnub_publish_pipeline.o
+endif
+
+ifeq ($(USE_REQUEST_BODY), 1)
+SOURCEFILES += ../core/pubnub_request_body.c
+OBJFILES += pubnub_request_body.o
+endif
+
+ifeq ($(USE_JSON_WRITER), 1)
+SOURCEFILES += ../core/pubnub_json_writer.c
+OBJFILES += pubnub_json_writer.o
+endif
+
+ifeq ($(USE_HISTORY_STREAM), 1)
+SOURCEFILES += ../core/pubnub_history_stream.c
+OBJFILES += pubnub_history_stream.o
+endif
+
+ifeq ($(USE_FREE_NOTIFY), 1)
+SOURCEFILES += ../posix/pubnub_free_notify_posix.c
+OBJFILES += pubnub_free_notify_posix.o
+endif
+
+ifeq ($(DYNAMIC_SCRATCH_BUFFERS), 1)
+SOURCEFILES += ../core/pbscratch_pool.c
+OBJFILES += pbscratch_pool.o
+endif
+
+CFLAGS = -g -D PUBNUB_THREADSAFE -D PUBNUB_LOG_LEVEL=PUBNUB_LOG_LEVEL_WARNING -Wall -D PUBNUB_ONLY_PUBSUB_API=$(ONLY_PUBSUB_API) -D PUBNUB_PROXY_API=$(USE_PROXY) -D PUBNUB_USE_GZIP_COMPRESSION=$(USE_GZIP_COMPRESSION) -D PUBNUB_RECEIVE_GZIP_RESPONSE=$(RECEIVE_GZIP_RESPONSE) -D PUBNUB_USE_SUBSCRIBE_V2=$(USE_SUBSCRIBE_V2) -D PUBNUB_USE_OBJECTS_API=$(USE_OBJECTS_API) -D PUBNUB_USE_OBJECTS_CACHE=$(USE_OBJECTS_CACHE) -D PUBNUB_USE_REPLY_INDEX=$(USE_REPLY_INDEX) -D PUBNUB_USE_URL_CACHE=$(USE_URL_CACHE) -D PUBNUB_USE_PUBLISH_PIPELINE=$(USE_PUBLISH_PIPELINE) -D PUBNUB_USE_REQUEST_BODY=$(USE_REQUEST_BODY) -D PUBNUB_USE_JSON_WRITER=$(USE_JSON_WRITER) -D PUBNUB_USE_HISTORY_STREAM=$(USE_HISTORY_STREAM) -D PUBNUB_USE_SYNC_POLL=$(USE_SYNC_POLL) -D PUBNUB_USE_FREE_NOTIFY=$(USE_FREE_NOTIFY) -D PUBNUB_DYNAMIC_SCRATCH_BUFFERS=$(DYNAMIC_SCRATCH_BUFFERS)
 # -g enables debugging, remove to get a smaller executable
 # -fsanitize=address Use AddressSanitizer
 # -fsanitize=thread Use ThreadSanitizer
@@ -85,12 +165,22 @@ all: pubnub_sync_sample metadata cancel_subscribe_sync_sample pubnub_sync_subloo
 SYNC_INTF_SOURCEFILES=../core/pubnub_ntf_sync.c ../core/pubnub_sync_subscribe_loop.c ../core/srand_from_pubnub_time.c
 SYNC_INTF_OBJFILES=pubnub_ntf_sync.o pubnub_sync_subscribe_loop.o srand_from_pubnub_time.o
 
+ifeq ($(USE_SYNC_POLL), 1)
+SYNC_INTF_SOURCEFILES += ../posix/posix_socket_wait_io.c pbpal_openssl_wait_io.c ../core/pubnub_fanout.c
+SYNC_INTF_OBJFILES += posix_socket_wait_io.o pbpal_openssl_wait_io.o pubnub_fanout.o
+endif
+
+ifeq ($(USE_OBJECTS_API), 1)
+SYNC_INTF_SOURCEFILES += ../core/pubnub_objects_pager.c
+SYNC_INTF_OBJFILES += pubnub_objects_pager.o
+endif
+
 pubnub_sync.a : $(SOURCEFILES) $(SYNC_INTF_SOURCEFILES)
 	$(CC) -c $(CFLAGS) $(INCLUDES) $(SOURCEFILES) $(SYNC_INTF_SOURCEFILES)
 	ar rcs pubnub_sync.a $(OBJFILES) $(SYNC_INTF_OBJFILES)
 
-CALLBACK_INTF_SOURCEFILES=pubnub_ntf_callback_posix.c pubnub_get_native_socket.c ../core/pubnub_timer_list.c ../lib/sockets/pbpal_ntf_callback_poller_poll.c ../lib/sockets/pbpal_adns_sockets.c ../lib/pubnub_dns_codec.c ../core/pbpal_ntf_callback_queue.c ../core/pbpal_ntf_callback_admin.c ../core/pbpal_ntf_callback_handle_timer_list.c  ../core/pubnub_callback_subscribe_loop.c
-CALLBACK_INTF_OBJFILES=pubnub_ntf_callback_posix.o pubnub_get_native_socket.o pubnub_timer_list.o pbpal_ntf_callback_poller_poll.o pbpal_adns_sockets.o pubnub_dns_codec.o pbpal_ntf_callback_queue.o pbpal_ntf_callback_admin.o pbpal_ntf_callback_handle_timer_list.o pubnub_callback_subscribe_loop.o
+CALLBACK_INTF_SOURCEFILES=pubnub_ntf_callback_posix.c pubnub_get_native_socket.c ../core/pubnub_timer_list.c ../lib/sockets/pbpal_ntf_callback_poller_poll.c ../lib/sockets/pbpal_adns_sockets.c ../lib/pubnub_dns_codec.c ../core/pbpal_ntf_callback_queue.c ../core/pbpal_ntf_callback_admin.c ../core/pbpal_ntf_callback_handle_timer_list.c  ../core/pubnub_callback_subscribe_loop.c ../core/pubnub_publisher.c ../core/pubnub_subscribe_mux.c ../core/pubnub_heartbeat_scheduler.c
+CALLBACK_INTF_OBJFILES=pubnub_ntf_callback_posix.o pubnub_get_native_socket.o pubnub_timer_list.o pbpal_ntf_callback_poller_poll.o pbpal_adns_sockets.o pubnub_dns_codec.o pbpal_ntf_callback_queue.o pbpal_ntf_callback_admin.o pbpal_ntf_callback_handle_timer_list.o pubnub_callback_subscribe_loop.o pubnub_publisher.o pubnub_subscribe_mux.o pubnub_heartbeat_scheduler.o
 
 ifndef USE_DNS_SERVERS
 USE_DNS_SERVERS = 1
@@ -0,0 +1,128 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "core/pubnub_ccore_pubsub.h"
+#if PUBNUB_USE_SUBSCRIBE_V2
+#include "core/pbcc_subscribe_v2.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+
+/** @file pbcc_prep_benchmark.c
+
+    Measures the cost of preparing (formatting the URL of) publish and
+    subscribe requests in the C core, which is done for every
+    transaction, with the keys, `uuid` and `auth` set. For each it
+    shows the time per prep and the URL prepared.
+
+    Build with `USE_URL_CACHE=0` to compare with the static URL
+    fragments formatted on every prep. The URLs shown should be the
+    same.
+
+    Usage: pbcc_prep_benchmark [preps]
+ */
+
+
+/** Default number of preps of each kind */
+#define DEFAULT_PREPS 1000000
+
+static struct pbcc_context m_pbcc;
+
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+static void report(char const* name, double elapsed_ns, unsigned long preps)
+{
+    printf("%-14s %8.1f ns per prep: %s\n", name, elapsed_ns / preps, m_pbcc.http_buf);
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned long preps = DEFAULT_PREPS;
+    unsigned long i;
+    double        start;
+    int           rslt = 0;
+
+    if (argc > 1) {
+        preps = strtoul(argv[1], NULL, 10);
+    }
+    if (0 == preps) {
+        preps = 1;
+    }
+
+    pbcc_init(&m_pbcc,
+              "pub-c-5d7b2ee7-9b4c-4d1e-a04c-1c2b3e4f5a6b",
+              "sub-c-8f9e0d1c-2b3a-4c5d-8e6f-7a8b9c0d1e2f");
+    pbcc_set_uuid(&m_pbcc, "3c4f5e6d-7a8b-4c9d-8e0f-1a2b3c4d5e6f");
+    pbcc_set_auth(&m_pbcc, "my-auth-key");
+    printf("%lu preps of each kind, URL cache %s\n",
+           preps,
+           PUBNUB_USE_URL_CACHE ? "on" : "off");
+
+    start = now_ns();
+    for (i = 0; i < preps; ++i) {
+        if (pbcc_publish_prep(
+                &m_pbcc, "bench", "\"hello\"", true, false, NULL, pubnubSendViaGET)
+            != PNR_STARTED) {
+            rslt = -1;
+        }
+    }
+    report("publish", now_ns() - start, preps);
+
+    start = now_ns();
+    for (i = 0; i < preps; ++i) {
+        if (pbcc_signal_prep(&m_pbcc, "bench", "\"hello\"") != PNR_STARTED) {
+            rslt = -1;
+        }
+    }
+    report("signal", now_ns() - start, preps);
+
+    start = now_ns();
+    for (i = 0; i < preps; ++i) {
+        if (pbcc_subscribe_prep(&m_pbcc, "bench", "group", NULL) != PNR_STARTED) {
+            rslt = -1;
+        }
+    }
+    report("subscribe", now_ns() - start, preps);
+
+#if PUBNUB_USE_SUBSCRIBE_V2
+    start = now_ns();
+    for (i = 0; i < preps; ++i) {
+        if (pbcc_subscribe_v2_prep(&m_pbcc, "bench", NULL, NULL, NULL) != PNR_STARTED) {
+            rslt = -1;
+        }
+    }
+    report("subscribe V2", now_ns() - start, preps);
+#endif
+
+    /* The cache has to follow the changes of the `uuid` and `auth` */
+    pbcc_set_uuid(&m_pbcc, NULL);
+    pbcc_set_auth(&m_pbcc, NULL);
+    if (pbcc_subscribe_prep(&m_pbcc, "bench", NULL, NULL) != PNR_STARTED) {
+        rslt = -1;
+    }
+    printf("%-14s %20s %s\n", "no uuid, auth", "", m_pbcc.http_buf);
+#if PUBNUB_USE_SUBSCRIBE_V2
+    if (pbcc_subscribe_v2_prep(&m_pbcc, "bench", NULL, NULL, NULL) != PNR_STARTED) {
+        rslt = -1;
+    }
+    printf("%-14s %20s %s\n", "V2 no uuid", "", m_pbcc.http_buf);
+#endif
+    if (rslt != 0) {
+        puts("Some prep(s) failed");
+    }
+
+    pbcc_deinit(&m_pbcc);
+
+    return rslt;
+}
@@ -0,0 +1,218 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "core/pbpal_ntf_callback_queue.h"
+#include "core/pubnub_assert.h"
+
+#include <pthread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/** @file pbpal_ntf_callback_queue_stress_test.c
+
+    Stress test of the queue of contexts to process of the callback
+    notifier: many producer threads (re)queue (and remove) contexts,
+    while one consumer thread processes the queue. Checks that:
+
+    - more contexts than the old fixed limit (1024) can be queued
+    - no request for processing is lost: every context is processed
+      after the last time it was requeued
+    - a context is never processed by two threads at the same time
+
+    The processing of a context (pbnc_fsm()) and freeing it
+    (pballoc_free_at_last()) are stubbed here.
+
+    Usage: pbpal_ntf_callback_queue_stress_test [iterations_per_producer]
+ */
+
+
+#define PRODUCERS 8
+#define CONTEXTS_PER_PRODUCER 256
+#define CONTEXTS (PRODUCERS * CONTEXTS_PER_PRODUCER)
+#define DEFAULT_ITERATIONS 200000
+
+
+/** Test data of a context, kept in its `user_data` */
+struct ctx_data {
+    /** Incremented by the producer before each requeue */
+    unsigned long requested;
+    /** The value of `requested` the consumer saw when it processed
+        the context (the last time) */
+    unsigned long seen;
+    /** Number of times the context was processed */
+    unsigned long processed;
+    /** Set while processing the context */
+    int in_fsm;
+};
+
+static struct pbpal_ntf_callback_queue m_queue;
+static pubnub_t*                       m_contexts;
+static struct ctx_data                 m_data[CONTEXTS];
+static unsigned long                   m_iterations = DEFAULT_ITERATIONS;
+static int                             m_producers_done;
+static int                             m_overlap;
+static unsigned                        m_freed;
+
+
+int pbnc_fsm(pubnub_t* pb)
+{
+    struct ctx_data* data = (struct ctx_data*)pb->user_data;
+
+    if (__atomic_exchange_n(&data->in_fsm, 1, __ATOMIC_ACQ_REL)) {
+        m_overlap = 1;
+    }
+    data->seen = __atomic_load_n(&data->requested, __ATOMIC_ACQUIRE);
+    ++data->processed;
+    __atomic_store_n(&data->in_fsm, 0, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+
+void pballoc_free_at_last(pubnub_t* pb)
+{
+    PUBNUB_UNUSED(pb);
+    ++m_freed;
+}
+
+
+static void* producer(void* arg)
+{
+    unsigned      first = *(unsigned*)arg;
+    unsigned      seed  = first;
+    unsigned long i;
+
+    for (i = 0; i < m_iterations; ++i) {
+        unsigned  n  = first + (unsigned)(rand_r(&seed) % CONTEXTS_PER_PRODUCER);
+        pubnub_t* pb = &m_contexts[n];
+
+        __atomic_add_fetch(&m_data[n].requested, 1, __ATOMIC_ACQ_REL);
+        switch (i % 16) {
+        case 0:
+            pbpal_ntf_callback_enqueue_for_processing(&m_queue, pb);
+            break;
+        case 1:
+            /* Removing and requeueing "revives" the context in the queue */
+            pbpal_ntf_callback_remove_from_queue(&m_queue, pb);
+            pbpal_ntf_callback_requeue_for_processing(&m_queue, pb);
+            break;
+        default:
+            pbpal_ntf_callback_requeue_for_processing(&m_queue, pb);
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+
+static void* consumer(void* arg)
+{
+    PUBNUB_UNUSED(arg);
+    while (!__atomic_load_n(&m_producers_done, __ATOMIC_ACQUIRE)) {
+        pbpal_ntf_callback_process_queue(&m_queue);
+    }
+    return NULL;
+}
+
+
+static int check_all_processed(char const* phase)
+{
+    unsigned i;
+    for (i = 0; i < CONTEXTS; ++i) {
+        if (m_data[i].seen != m_data[i].requested) {
+            printf("%s: context %u requested %lu, last processed at %lu\n",
+                   phase,
+                   i,
+                   m_data[i].requested,
+                   m_data[i].seen);
+            return -1;
+        }
+    }
+    if (m_overlap) {
+        printf("%s: a context was processed concurrently\n", phase);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main(int argc, char* argv[])
+{
+    pthread_t      producers[PRODUCERS];
+    unsigned       firsts[PRODUCERS];
+    pthread_t      consumer_thread;
+    unsigned       i;
+    unsigned long  processed = 0;
+    struct timespec start;
+    struct timespec end;
+
+    if (argc > 1) {
+        m_iterations = strtoul(argv[1], NULL, 10);
+    }
+    m_contexts = (pubnub_t*)calloc(CONTEXTS, sizeof m_contexts[0]);
+    if (NULL == m_contexts) {
+        printf("Failed to allocate contexts\n");
+        return -1;
+    }
+    for (i = 0; i < CONTEXTS; ++i) {
+        pubnub_mutex_init(m_contexts[i].monitor);
+        m_contexts[i].state     = PBS_IDLE;
+        m_contexts[i].user_data = &m_data[i];
+    }
+    pbpal_ntf_callback_queue_init(&m_queue);
+
+    /* All contexts in the queue at once, one of them being freed */
+    for (i = 0; i < CONTEXTS; ++i) {
+        m_data[i].requested = 1;
+        if (pbpal_ntf_callback_enqueue_for_processing(&m_queue, &m_contexts[i]) != +1) {
+            printf("Failed to enqueue context %u of %u\n", i, CONTEXTS);
+            return -1;
+        }
+    }
+    m_contexts[CONTEXTS - 1].state = PBS_NULL;
+    m_data[CONTEXTS - 1].seen      = 1;
+    pbpal_ntf_callback_process_queue(&m_queue);
+    if ((check_all_processed("all queued") != 0) || (m_freed != 1)) {
+        return -1;
+    }
+    m_contexts[CONTEXTS - 1].state = PBS_IDLE;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_create(&consumer_thread, NULL, consumer, NULL);
+    for (i = 0; i < PRODUCERS; ++i) {
+        firsts[i] = i * CONTEXTS_PER_PRODUCER;
+        pthread_create(&producers[i], NULL, producer, &firsts[i]);
+    }
+    for (i = 0; i < PRODUCERS; ++i) {
+        pthread_join(producers[i], NULL);
+    }
+    __atomic_store_n(&m_producers_done, 1, __ATOMIC_RELEASE);
+    pthread_join(consumer_thread, NULL);
+    /* Whatever was left after the consumer stopped */
+    pbpal_ntf_callback_process_queue(&m_queue);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if (check_all_processed("stress") != 0) {
+        return -1;
+    }
+    for (i = 0; i < CONTEXTS; ++i) {
+        processed += m_data[i].processed;
+    }
+    printf("%d producers, %lu requeues in %.0f ms, %lu contexts processed\n",
+           PRODUCERS,
+           PRODUCERS * m_iterations,
+           (end.tv_sec - start.tv_sec) * 1000.0
+               + (end.tv_nsec - start.tv_nsec) / 1000000.0,
+           processed);
+    pbpal_ntf_callback_queue_deinit(&m_queue);
+    for (i = 0; i < CONTEXTS; ++i) {
+        pubnub_mutex_destroy(m_contexts[i].monitor);
+    }
+    free(m_contexts);
+    puts("Callback queue stress test passed");
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_coreapi_ex.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/** @file pubnub_adaptive_publish_mock_test.c
+
+    Tests the adaptive publish method against a local mock HTTP
+    server, used as a "HTTP GET" proxy, which remembers the method of
+    the last request and counts the bytes of the bodies it reads.
+    Checks that messages which URL encoding does not inflate are sent
+    via GET, others via POST - compressed if they are long - and that
+    the publish counters of the context add up.
+ */
+
+
+/** Length of the long messages */
+#define LONG_LEN 4000
+
+static char m_long[LONG_LEN + 1];
+
+static char m_medium[200];
+
+/** The method of the last request, as received by the server */
+static char m_method[10];
+
+
+static char* responder(char const* head)
+{
+    size_t len = strcspn(head, " ");
+    if (len >= sizeof m_method) {
+        len = sizeof m_method - 1;
+    }
+    memcpy(m_method, head, len);
+    m_method[len] = '\0';
+    return NULL;
+}
+
+
+static int publish(pubnub_t*          pbp,
+                   char const*        name,
+                   char const*        message,
+                   enum pubnub_method method,
+                   char const*        expected_method)
+{
+    struct pubnub_publish_options opts = pubnub_publish_defopts();
+    enum pubnub_res               res;
+
+    opts.method = method;
+    res         = pubnub_publish_ex(pbp, "adaptive_test", message, opts);
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    if ((res != PNR_OK) || (strcmp(m_method, expected_method) != 0)) {
+        printf("%s: outcome %d('%s'), sent via %s instead of %s\n",
+               name,
+               res,
+               pubnub_res_2_string(res),
+               m_method,
+               expected_method);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main()
+{
+    struct pubnub_publish_stats stats;
+    uint16_t                    port;
+    pubnub_t*                   pbp;
+    unsigned long               body_bytes;
+    int                         i;
+    int                         rslt = 0;
+
+    for (i = 0; i < LONG_LEN; ++i) {
+        m_long[i] = (i % 20 == 0) ? '"' : 'a' + i % 7;
+    }
+    m_long[0]            = '"';
+    m_long[LONG_LEN - 1] = '"';
+    m_long[LONG_LEN]     = '\0';
+    snprintf(m_medium,
+             sizeof m_medium,
+             "{\"text\":\"Hello, world, \\\"with\\\" some {quotes} & spaces in it\","
+             "\"list\":[1, 2, 3, 4, 5, 6, 7, 8, 9]}");
+
+    mock_http_server_set_responder(responder);
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    if (publish(pbp, "Short", "\"hello-world\"", pubnubSendAdaptive, "GET") != 0) {
+        rslt = -1;
+    }
+    if (publish(pbp, "Medium", m_medium, pubnubSendAdaptive, "POST") != 0) {
+        rslt = -1;
+    }
+    if (publish(pbp, "Long", m_long, pubnubSendAdaptive, "POST") != 0) {
+        rslt = -1;
+    }
+    /* The default stays GET */
+    if (publish(pbp, "Default", m_medium, pubnubSendViaGET, "GET") != 0) {
+        rslt = -1;
+    }
+
+    pubnub_get_publish_stats(pbp, &stats);
+    body_bytes = mock_http_server_body_bytes(NULL);
+    printf("GET: %lu requests, %lu bytes; POST: %lu plain, %lu compressed, %lu bytes "
+           "(%lu in the bodies)\n",
+           stats.via_get,
+           stats.get_bytes,
+           stats.via_post,
+           stats.via_gzip,
+           stats.post_bytes,
+           body_bytes);
+    if ((stats.via_get != 2) || (stats.via_post + stats.via_gzip != 2)
+        || (stats.post_bytes <= body_bytes)
+        || (stats.get_bytes < 2 * strlen("/publish/demo/demo/0/adaptive_test/0/"))) {
+        printf("Counters: FAILED\n");
+        rslt = -1;
+    }
+#if PUBNUB_USE_GZIP_COMPRESSION
+    /* The long message compresses well, the medium one is not worth it */
+    if ((stats.via_gzip != 1) || (body_bytes >= LONG_LEN / 2)) {
+        printf("Compression: FAILED\n");
+        rslt = -1;
+    }
+#endif
+
+    pubnub_reset_publish_stats(pbp);
+    pubnub_get_publish_stats(pbp, &stats);
+    if (stats.via_get + stats.via_post + stats.via_gzip + stats.get_bytes + stats.post_bytes
+        != 0) {
+        printf("Reset: FAILED\n");
+        rslt = -1;
+    }
+
+    pubnub_free(pbp);
+    puts((0 == rslt) ? "Adaptive publish mock test passed"
+                     : "Adaptive publish mock test FAILED");
+
+    return rslt;
+}
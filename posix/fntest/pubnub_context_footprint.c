@@ -0,0 +1,152 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+#include "pubnub_sync.h"
+
+#include "core/pubnub_coreapi_ex.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+#include "core/pubnub_timers.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+
+/** @file pubnub_context_footprint.c
+
+    Measures the memory footprint of a Pubnub context: allocates (and
+    initializes) a number of contexts and reports the size of a
+    context and the resident memory (RSS) per context. Then it does a
+    (compressed) publish on a few of them, against a local mock HTTP
+    server used as a proxy, so that the "scratch" buffers are used,
+    and reports the RSS again.
+
+    Build with `DYNAMIC_SCRATCH_BUFFERS=1` to compare with the "scratch"
+    buffers taken from the shared pool.
+
+    Usage: pubnub_context_footprint [number_of_contexts]
+ */
+
+
+/** Default number of contexts to allocate */
+#define DEFAULT_CONTEXTS 10000
+
+/** Number of contexts to publish on */
+#define CONTEXTS_TO_PUBLISH_ON 16
+
+/** The message to publish - long enough to be compressed */
+static char const m_message[] =
+    "\"Hello world from the footprint benchmark! Hello world from the "
+    "footprint benchmark! Hello world from the footprint benchmark!\"";
+
+
+/** Returns the resident set size of the process, in bytes */
+static unsigned long resident_size(void)
+{
+    unsigned long size;
+    unsigned long resident = 0;
+    FILE*         f        = fopen("/proc/self/statm", "r");
+
+    if (NULL == f) {
+        return 0;
+    }
+    if (fscanf(f, "%lu %lu", &size, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(f);
+
+    return resident * (unsigned long)sysconf(_SC_PAGESIZE);
+}
+
+
+static void report_rss(char const* what, unsigned long rss, unsigned long rss0, unsigned n)
+{
+    printf("%-28s RSS %8lu KB, %7.1f KB per context\n",
+           what,
+           rss / 1024,
+           (rss - rss0) / 1024.0 / n);
+}
+
+
+int main(int argc, char* argv[])
+{
+    unsigned                      n = DEFAULT_CONTEXTS;
+    unsigned                      i;
+    unsigned long                 rss0;
+    uint16_t                      port;
+    pubnub_t**                    contexts;
+    struct pubnub_publish_options opts = pubnub_publish_defopts();
+    int                           rslt = 0;
+
+    if (argc > 1) {
+        n = (unsigned)strtoul(argv[1], NULL, 10);
+    }
+    if (n < CONTEXTS_TO_PUBLISH_ON) {
+        n = CONTEXTS_TO_PUBLISH_ON;
+    }
+    contexts = (pubnub_t**)malloc(n * sizeof contexts[0]);
+    if (NULL == contexts) {
+        printf("Failed to allocate the array of contexts\n");
+        return -1;
+    }
+    printf("sizeof(pubnub_t) = %lu bytes, dynamic scratch buffers: %s\n",
+           (unsigned long)sizeof(pubnub_t),
+           PUBNUB_DYNAMIC_SCRATCH_BUFFERS ? "yes" : "no");
+
+    rss0 = resident_size();
+    for (i = 0; i < n; ++i) {
+        contexts[i] = pubnub_alloc();
+        if (NULL == contexts[i]) {
+            printf("Failed to allocate context %u\n", i);
+            n = i;
+            break;
+        }
+        pubnub_init(contexts[i], "demo", "demo");
+    }
+    printf("%u contexts:\n", n);
+    report_rss("  allocated and initialized", resident_size(), rss0, n);
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    opts.method = pubnubSendViaPOSTwithGZIP;
+    for (i = 0; i < CONTEXTS_TO_PUBLISH_ON; ++i) {
+        enum pubnub_res res;
+        pubnub_set_proxy_manual(contexts[i], pbproxyHTTP_GET, "127.0.0.1", port);
+        pubnub_dont_use_http_keep_alive(contexts[i]);
+        res = pubnub_publish_ex(contexts[i], "hello_world", m_message, opts);
+        if (PNR_STARTED == res) {
+            res = pubnub_await(contexts[i]);
+        }
+        if (res != PNR_OK) {
+            printf("Publish on context %u failed: %d('%s')\n",
+                   i,
+                   res,
+                   pubnub_res_2_string(res));
+            rslt = -1;
+        }
+    }
+    report_rss("  after publish on a few", resident_size(), rss0, n);
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+    {
+        struct pbscratch_stats stats;
+        pbscratch_get_stats(&stats);
+        printf("  scratch pool: %u in use, %u max in use, %u free, %u bytes "
+               "each\n",
+               stats.in_use,
+               stats.in_use_max,
+               stats.free,
+               (unsigned)PBSCRATCH_BLOCK_SIZE);
+    }
+#endif
+
+    for (i = 0; i < n; ++i) {
+        pubnub_free(contexts[i]);
+    }
+    free(contexts);
+
+    return rslt;
+}
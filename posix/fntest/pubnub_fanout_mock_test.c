@@ -0,0 +1,290 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_fanout.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** @file pubnub_fanout_mock_test.c
+
+    Tests the fan-out against a local mock HTTP server, used as a
+    "HTTP GET" proxy, which answers message counts and here-now
+    requests for the channels in their URLs. The channel lists are
+    much longer than fit in a URL. Checks that they are split into
+    several requests, none of them too long, and that the results
+    are merged back in the order of the list.
+ */
+
+
+/** Number of channels in the (long) lists */
+#define CHANNELS 10000
+
+/** Number of contexts of the fan-out */
+#define POOL_SIZE 4
+
+/** Every channel with an index divisible by this is not in the
+    responses */
+#define MISSING_EVERY 10
+
+static char m_channels[CHANNELS * 8];
+static char m_timetokens[CHANNELS * 19];
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned        m_requests;
+static size_t          m_longest_url;
+
+
+static int message_count(int i)
+{
+    return 3 * i;
+}
+
+
+static int occupancy(int i)
+{
+    return i % 5;
+}
+
+
+/** Makes the response for the channel list (from @p s to the `?`):
+    @p fmt is the format of the (JSON) value of each channel, given
+    the value, and the list is between @p prefix and @p suffix.
+ */
+static char* respond(char const* s,
+                     char const* prefix,
+                     char const* fmt,
+                     int (*value)(int),
+                     char const* suffix)
+{
+    char const* end   = strchr(s, '?');
+    size_t      size  = 200;
+    int         first = 1;
+    char const* p;
+    char*       body;
+    size_t      len;
+
+    for (p = s; p < end; ++p) {
+        size += (',' == *p) ? 64 : 0;
+    }
+    size += 64;
+    body = (char*)malloc(size);
+    if (NULL == body) {
+        return NULL;
+    }
+    len = snprintf(body, size, "%s", prefix);
+    while (s < end) {
+        int i = atoi(s + 2);
+        if (i % MISSING_EVERY != 0) {
+            len += snprintf(body + len, size - len, first ? "\"ch%d\":" : ",\"ch%d\":", i);
+            len += snprintf(body + len, size - len, fmt, value(i));
+            first = 0;
+        }
+        s += strcspn(s, ",?");
+        if (',' == *s) {
+            ++s;
+        }
+    }
+    snprintf(body + len, size - len, "%s", suffix);
+
+    return body;
+}
+
+
+static char* responder(char const* head)
+{
+    char const* s   = strchr(head, ' ');
+    size_t      len = strcspn(s + 1, " ");
+    char const* list;
+
+    pthread_mutex_lock(&m_lock);
+    ++m_requests;
+    if (len > m_longest_url) {
+        m_longest_url = len;
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    list = strstr(head, "/message-counts/");
+    if (list != NULL) {
+        char const* tt = strstr(head, "channelsTimetoken=");
+        list += sizeof "/message-counts/" - 1;
+        if (tt != NULL) {
+            /* As many timetokens as channels */
+            char const* end = strchr(list, '?');
+            char const* p;
+            int         commas = 0;
+            for (p = list; p < end; ++p) {
+                commas += (',' == *p);
+            }
+            for (p = tt; (*p != '&') && (*p != ' '); ++p) {
+                commas -= (',' == *p);
+            }
+            if (commas != 0) {
+                return strdup("{\"status\":400,\"error\":true,\"error_message\":\"mismatch\"}");
+            }
+        }
+        return respond(list,
+                       "{\"status\":200,\"error\":false,\"error_message\":\"\",\"channels\":{",
+                       "%d",
+                       message_count,
+                       "}}");
+    }
+    list = strstr(head, "/channel/");
+    if (list != NULL) {
+        list += sizeof "/channel/" - 1;
+        if (NULL == memchr(list, ',', strchr(list, '?') - list)) {
+            int  i = atoi(list + 2);
+            char body[200];
+            snprintf(body,
+                     sizeof body,
+                     "{\"status\":200,\"message\":\"OK\",\"service\":\"Presence\","
+                     "\"uuids\":[],\"occupancy\":%d}",
+                     occupancy(i));
+            return strdup(body);
+        }
+        return respond(list,
+                       "{\"status\":200,\"message\":\"OK\",\"service\":\"Presence\","
+                       "\"payload\":{\"channels\":{",
+                       "{\"uuids\":[],\"occupancy\":%d}",
+                       occupancy,
+                       "},\"total_channels\":0,\"total_occupancy\":0}}");
+    }
+
+    return NULL;
+}
+
+
+static void reset(void)
+{
+    pthread_mutex_lock(&m_lock);
+    m_requests    = 0;
+    m_longest_url = 0;
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+/** Checks the outcome @p res, the @p values of the channels and that
+    the list was split into requests that fit in the URL.
+ */
+static int check(char const*     name,
+                 enum pubnub_res res,
+                 int const*      values,
+                 int             n,
+                 int (*value)(int))
+{
+    int i;
+    int wrong = 0;
+
+    printf("%s: outcome %d('%s'), %u requests, longest URL %lu\n",
+           name,
+           res,
+           pubnub_res_2_string(res),
+           m_requests,
+           (unsigned long)m_longest_url);
+    for (i = 0; i < n; ++i) {
+        int expected = (i % MISSING_EVERY != 0) ? value(i) : -1;
+        if ((values[i] != expected) && ((expected >= 0) || (values[i] >= 0))) {
+            if (wrong++ < 5) {
+                printf("%s: channel %d has %d instead of %d\n", name, i, values[i], expected);
+            }
+        }
+    }
+    if ((res != PNR_OK) || (wrong > 0) || (m_longest_url >= PUBNUB_BUF_MAXLEN)
+        || ((n > 1000) && (m_requests < 2))) {
+        printf("%s: FAILED\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main()
+{
+    static int       values[CHANNELS];
+    pubnub_fanout_t* fo;
+    uint16_t         port;
+    enum pubnub_res  res;
+    size_t           len    = 0;
+    size_t           tt_len = 0;
+    int              total;
+    int              expected_total = 0;
+    unsigned         i;
+    int              rslt = 0;
+
+    for (i = 0; i < CHANNELS; ++i) {
+        len += sprintf(m_channels + len, (i > 0) ? ",ch%u" : "ch%u", i);
+        tt_len += sprintf(m_timetokens + tt_len, (i > 0) ? ",%u" : "%u", 15700000 + i);
+        if (i % MISSING_EVERY != 0) {
+            expected_total += occupancy(i);
+        }
+    }
+
+    mock_http_server_set_responder(responder);
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(20);
+
+    fo = pubnub_fanout_create("demo", "demo", POOL_SIZE);
+    if (NULL == fo) {
+        printf("Failed to create the fan-out\n");
+        return -1;
+    }
+    for (i = 0; i < pubnub_fanout_size(fo); ++i) {
+        pubnub_set_proxy_manual(pubnub_fanout_context(fo, i), pbproxyHTTP_GET, "127.0.0.1", port);
+    }
+
+    reset();
+    res = pubnub_fanout_message_counts(fo, m_channels, "15700000000000000", values);
+    if (check("Message counts", res, values, CHANNELS, message_count) != 0) {
+        rslt = -1;
+    }
+
+    reset();
+    res = pubnub_fanout_message_counts(fo, m_channels, m_timetokens, values);
+    if (check("Message counts by channel timetokens", res, values, CHANNELS, message_count)
+        != 0) {
+        rslt = -1;
+    }
+
+    reset();
+    res = pubnub_fanout_here_now(fo, m_channels, values, &total);
+    if ((check("Here now", res, values, CHANNELS, occupancy) != 0) || (total != expected_total)) {
+        printf("Here now: total occupancy %d instead of %d\n", total, expected_total);
+        rslt = -1;
+    }
+
+    reset();
+    res = pubnub_fanout_here_now(fo, "ch7", values, &total);
+    if ((check("Here now one channel", res, values, 0, occupancy) != 0)
+        || (values[0] != occupancy(7))) {
+        rslt = -1;
+    }
+
+    res = pubnub_fanout_here_now(fo, "ch1,,ch2", values, NULL);
+    if (res != PNR_INVALID_PARAMETERS) {
+        printf("Empty channel name: outcome %d('%s')\n", res, pubnub_res_2_string(res));
+        rslt = -1;
+    }
+    res = pubnub_fanout_message_counts(fo, "ch1,ch2", "15700000,15700001,15700002", values);
+    if (res != PNR_INVALID_PARAMETERS) {
+        printf("Timetoken count mismatch: outcome %d('%s')\n", res, pubnub_res_2_string(res));
+        rslt = -1;
+    }
+
+    if (pubnub_fanout_destroy(fo, 1000) != 0) {
+        printf("Failed to destroy the fan-out\n");
+        rslt = -1;
+    }
+    puts((0 == rslt) ? "Fan-out mock test passed" : "Fan-out mock test FAILED");
+
+    return rslt;
+}
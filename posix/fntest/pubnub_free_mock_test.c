@@ -0,0 +1,137 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_callback.h"
+
+#include "core/pubnub_free_with_timeout.h"
+#include "core/pubnub_proxy.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/** @file pubnub_free_mock_test.c
+
+    Tests freeing many contexts of the callback interface, which have
+    transactions in progress (on a local mock HTTP server, as a "HTTP
+    GET" proxy, with a long RTT), with pubnub_free_all_with_timeout()
+    and pubnub_free_with_timeout(). Checks that the contexts are freed
+    and that it takes (much) less CPU time than it takes to free
+    them.
+ */
+
+
+/** Number of contexts to free at once */
+#define CONTEXTS 64
+
+/** RTT of the mock server, transactions won't finish by themselves */
+#define RTT_MS 10000
+
+/** Timeout for freeing the contexts */
+#define TIMEOUT_MS 2000
+
+/** Most CPU time freeing may take */
+#define MAX_CPU_MS 200
+
+
+static void on_outcome(pubnub_t* pb, enum pubnub_trans trans, enum pubnub_res result, void* user_data)
+{
+    (void)pb;
+    (void)trans;
+    (void)result;
+    (void)user_data;
+}
+
+
+static int start_publishes(pubnub_t** pbs, uint16_t port)
+{
+    int i;
+
+    for (i = 0; i < CONTEXTS; ++i) {
+        pbs[i] = pubnub_alloc();
+        if (NULL == pbs[i]) {
+            printf("Failed to allocate Pubnub context!\n");
+            return -1;
+        }
+        pubnub_init(pbs[i], "demo", "demo");
+        pubnub_set_proxy_manual(pbs[i], pbproxyHTTP_GET, "127.0.0.1", port);
+        pubnub_register_callback(pbs[i], on_outcome, NULL);
+        if (pubnub_publish(pbs[i], "free_test", "\"hello\"") != PNR_STARTED) {
+            printf("Failed to start a publish on context %d\n", i);
+            return -1;
+        }
+    }
+    /* Let them get to wait for the response */
+    usleep(200000);
+
+    return 0;
+}
+
+
+static int check(char const* name, int left, clock_t cpu, unsigned long start, unsigned long max_ms)
+{
+    unsigned long cpu_ms  = (unsigned long)((clock() - cpu) * 1000 / CLOCKS_PER_SEC);
+    unsigned long wall_ms = mock_http_server_ms_now() - start;
+
+    printf("%s: %d contexts left after %lu ms, CPU time %lu ms\n", name, left, wall_ms, cpu_ms);
+    if ((left != 0) || (wall_ms >= max_ms) || (cpu_ms > MAX_CPU_MS)) {
+        printf("%s: FAILED\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main()
+{
+    pubnub_t*     pbs[CONTEXTS];
+    uint16_t      port;
+    clock_t       cpu;
+    unsigned long start;
+    int           left;
+    int           i;
+    int           rslt = 0;
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(RTT_MS);
+
+    if (start_publishes(pbs, port) != 0) {
+        return -1;
+    }
+    start = mock_http_server_ms_now();
+    cpu   = clock();
+    left  = pubnub_free_all_with_timeout(pbs, CONTEXTS, TIMEOUT_MS);
+    for (i = 0; i < CONTEXTS; ++i) {
+        if (pbs[i] != NULL) {
+            printf("Context %d not freed\n", i);
+            rslt = -1;
+        }
+    }
+    if (check("Free all", left, cpu, start, TIMEOUT_MS) != 0) {
+        rslt = -1;
+    }
+
+    if (start_publishes(pbs, port) != 0) {
+        return -1;
+    }
+    start = mock_http_server_ms_now();
+    cpu   = clock();
+    left  = 0;
+    for (i = 0; i < CONTEXTS; ++i) {
+        if (pubnub_free_with_timeout(pbs[i], TIMEOUT_MS) != 0) {
+            ++left;
+        }
+    }
+    /* Each one waits for the callback thread to get to it */
+    if (check("Free one by one", left, cpu, start, CONTEXTS * TIMEOUT_MS) != 0) {
+        rslt = -1;
+    }
+
+    puts((0 == rslt) ? "Free mock test passed" : "Free mock test FAILED");
+
+    return rslt;
+}
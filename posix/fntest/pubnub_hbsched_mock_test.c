@@ -0,0 +1,288 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_callback.h"
+
+#include "core/pubnub_heartbeat_scheduler.h"
+#include "core/pubnub_proxy.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** @file pubnub_hbsched_mock_test.c
+
+    Tests the heartbeat scheduler against a local mock HTTP server,
+    used as a "HTTP GET" proxy, which records the heartbeats it gets.
+    Many UUIDs, each on a few channels, are kept present by a small
+    pool of contexts. Checks that each UUID gets about one heartbeat
+    per interval, with all its channels in it, that the heartbeats are
+    spread over the interval, and that subscribed and removed UUIDs
+    get none. Then, checks that UUIDs can be added while heartbeats
+    of the others are being sent.
+ */
+
+
+/** Number of UUIDs */
+#define UUIDS 200
+
+/** Number of contexts of the scheduler */
+#define POOL_SIZE 4
+
+/** The heartbeat interval */
+#define INTERVAL_MS 1000
+
+/** How long to run the scheduler for */
+#define RUN_MS 3500
+
+/** Length of the windows to check the spreading of heartbeats in */
+#define WINDOW_MS 100
+
+/** The UUID which is removed in the middle of the test */
+#define REMOVED_UUID 0
+
+/** The UUID which is subscribed during the whole test */
+#define SUBSCRIBED_UUID 1
+
+/** The UUID from which one of its channels is removed */
+#define TRIMMED_UUID 2
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned        m_heartbeats[UUIDS];
+static unsigned        m_wrong_channels;
+static unsigned        m_windows[RUN_MS / WINDOW_MS + 10];
+static unsigned long   m_start;
+
+
+static void expected_channels(char* s, size_t size, int i)
+{
+    if (TRIMMED_UUID == i) {
+        snprintf(s, size, "u%d-a,u%d-c", i, i);
+    }
+    else {
+        snprintf(s, size, "u%d-a,u%d-b,u%d-c", i, i, i);
+    }
+}
+
+
+static char* responder(char const* head)
+{
+    char const* channels = strstr(head, "/channel/");
+    char const* uuid     = strstr(head, "&uuid=u");
+    char        expected[64];
+    size_t      len;
+    int         i;
+    unsigned    window;
+
+    if ((NULL == channels) || (NULL == uuid) || (NULL == strstr(head, "/heartbeat?"))) {
+        return NULL;
+    }
+    channels += sizeof "/channel/" - 1;
+    len = strcspn(channels, "/");
+    i   = atoi(uuid + sizeof "&uuid=u" - 1);
+    if ((i < 0) || (i >= UUIDS)) {
+        return NULL;
+    }
+    expected_channels(expected, sizeof expected, i);
+
+    pthread_mutex_lock(&m_lock);
+    ++m_heartbeats[i];
+    if ((len != strlen(expected)) || (memcmp(channels, expected, len) != 0)) {
+        if (m_wrong_channels++ < 5) {
+            printf("UUID u%d heartbeat for channels '%.*s'\n", i, (int)len, channels);
+        }
+    }
+    window = (mock_http_server_ms_now() - m_start) / WINDOW_MS;
+    if (window < sizeof m_windows / sizeof m_windows[0]) {
+        ++m_windows[window];
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    return strdup("{\"status\": 200, \"message\": \"OK\", \"service\": \"Presence\"}");
+}
+
+
+/** Adds UUIDs while the heartbeats of the ones added before are
+    being sent (on a slow network), so that, when those are done,
+    there are more UUIDs to schedule than there were at any time.
+ */
+static int add_while_sending(uint16_t port)
+{
+    pubnub_hbsched_t* hbs;
+    char              uuid[16];
+    int               i;
+    int               rslt = 0;
+
+    mock_http_server_set_rtt(400);
+    hbs = pubnub_hbsched_create("demo", "demo", POOL_SIZE, 100);
+    if (NULL == hbs) {
+        printf("Failed to create the heartbeat scheduler\n");
+        return -1;
+    }
+    for (i = 0; i < (int)pubnub_hbsched_size(hbs); ++i) {
+        pubnub_set_proxy_manual(pubnub_hbsched_context(hbs, i), pbproxyHTTP_GET, "127.0.0.1", port);
+    }
+    for (i = 0; i < 64; ++i) {
+        snprintf(uuid, sizeof uuid, "g%d", i);
+        if (pubnub_hbsched_add(hbs, uuid, "g") != 0) {
+            rslt = -1;
+        }
+    }
+    usleep(250 * 1000);
+    for (i = 64; i < 68; ++i) {
+        snprintf(uuid, sizeof uuid, "g%d", i);
+        if (pubnub_hbsched_add(hbs, uuid, "g") != 0) {
+            rslt = -1;
+        }
+    }
+    /* Let the heartbeats that were being sent finish */
+    usleep(1000 * 1000);
+    if (pubnub_hbsched_destroy(hbs, 2000) != 0) {
+        printf("Failed to destroy the heartbeat scheduler\n");
+        rslt = -1;
+    }
+    if (rslt != 0) {
+        printf("Adding while sending FAILED\n");
+    }
+    return rslt;
+}
+
+
+static unsigned heartbeats_of(int i)
+{
+    unsigned rslt;
+    pthread_mutex_lock(&m_lock);
+    rslt = m_heartbeats[i];
+    pthread_mutex_unlock(&m_lock);
+    return rslt;
+}
+
+
+int main()
+{
+    pubnub_hbsched_t*             hbs;
+    struct pubnub_hbsched_metrics metrics;
+    uint16_t                      port;
+    unsigned                      removed_at;
+    unsigned                      total   = 0;
+    unsigned                      busiest = 0;
+    unsigned                      wrong   = 0;
+    char                          uuid[16];
+    char                          channel[24];
+    int                           i;
+    int                           rslt = 0;
+
+    mock_http_server_set_responder(responder);
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(5);
+
+    hbs = pubnub_hbsched_create("demo", "demo", POOL_SIZE, INTERVAL_MS);
+    if (NULL == hbs) {
+        printf("Failed to create the heartbeat scheduler\n");
+        return -1;
+    }
+    for (i = 0; i < (int)pubnub_hbsched_size(hbs); ++i) {
+        pubnub_set_proxy_manual(pubnub_hbsched_context(hbs, i), pbproxyHTTP_GET, "127.0.0.1", port);
+    }
+
+    m_start = mock_http_server_ms_now();
+    for (i = 0; i < UUIDS; ++i) {
+        char const* suffix;
+        snprintf(uuid, sizeof uuid, "u%d", i);
+        for (suffix = "abc"; *suffix != '\0'; ++suffix) {
+            snprintf(channel, sizeof channel, "u%d-%c", i, *suffix);
+            if (pubnub_hbsched_add(hbs, uuid, channel) != 0) {
+                printf("Failed to add UUID %s on channel %s\n", uuid, channel);
+                rslt = -1;
+            }
+        }
+    }
+    /* Adding again is OK, and changes nothing */
+    if (pubnub_hbsched_add(hbs, "u3", "u3-b") != 0) {
+        printf("Failed to add UUID u3 on channel u3-b again\n");
+        rslt = -1;
+    }
+    if ((pubnub_hbsched_add(hbs, "u3", "") == 0)
+        || (pubnub_hbsched_add(hbs, "u3", "x,y") == 0)) {
+        printf("Added an invalid channel\n");
+        rslt = -1;
+    }
+    pubnub_hbsched_set_subscribed(hbs, "u1", true);
+    if ((pubnub_hbsched_remove(hbs, "u2", "u2-b") != 0)
+        || (pubnub_hbsched_remove(hbs, "u2", "u2-b") == 0)) {
+        printf("Failed to remove channel u2-b of UUID u2 (once)\n");
+        rslt = -1;
+    }
+
+    usleep((RUN_MS / 2) * 1000);
+    if (pubnub_hbsched_remove_uuid(hbs, "u0") != 0) {
+        printf("Failed to remove UUID u0\n");
+        rslt = -1;
+    }
+    removed_at = heartbeats_of(REMOVED_UUID);
+    usleep((RUN_MS - RUN_MS / 2) * 1000);
+    pubnub_hbsched_get_metrics(hbs, &metrics);
+
+    if (pubnub_hbsched_destroy(hbs, 1000) != 0) {
+        printf("Failed to destroy the heartbeat scheduler\n");
+        rslt = -1;
+    }
+
+    pthread_mutex_lock(&m_lock);
+    for (i = 0; i < UUIDS; ++i) {
+        unsigned n = m_heartbeats[i];
+        total += n;
+        if ((REMOVED_UUID == i) || (SUBSCRIBED_UUID == i)) {
+            continue;
+        }
+        if ((n < RUN_MS / INTERVAL_MS) || (n > RUN_MS / INTERVAL_MS + 1)) {
+            if (wrong++ < 5) {
+                printf("UUID u%d got %u heartbeats\n", i, n);
+            }
+        }
+    }
+    for (i = 0; i < (int)(sizeof m_windows / sizeof m_windows[0]); ++i) {
+        if (m_windows[i] > busiest) {
+            busiest = m_windows[i];
+        }
+    }
+    printf("%u heartbeats (%lu sent, %lu failed, %lu skipped), busiest %d ms: "
+           "%u, u0 %u (%u at removal), u1 %u\n",
+           total,
+           metrics.sent,
+           metrics.failed,
+           metrics.skipped,
+           WINDOW_MS,
+           busiest,
+           m_heartbeats[REMOVED_UUID],
+           removed_at,
+           m_heartbeats[SUBSCRIBED_UUID]);
+    if ((wrong > 0) || (m_wrong_channels > 0) || (metrics.failed > 0)
+        || (metrics.skipped == 0) || (m_heartbeats[SUBSCRIBED_UUID] != 0)
+        || (m_heartbeats[REMOVED_UUID] > removed_at + 1)
+        || (metrics.uuids != UUIDS - 1)) {
+        rslt = -1;
+    }
+    /* Evenly spread, a window gets UUIDS * WINDOW_MS / INTERVAL_MS
+       heartbeats, if they were all sent at once, it would get UUIDS */
+    if (busiest > 3 * UUIDS * WINDOW_MS / INTERVAL_MS) {
+        printf("Heartbeats are not spread over the interval\n");
+        rslt = -1;
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    if (add_while_sending(port) != 0) {
+        rslt = -1;
+    }
+
+    puts((0 == rslt) ? "Heartbeat scheduler mock test passed"
+                     : "Heartbeat scheduler mock test FAILED");
+
+    return rslt;
+}
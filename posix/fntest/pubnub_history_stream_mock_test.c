@@ -0,0 +1,258 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_history_stream.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** @file pubnub_history_stream_mock_test.c
+
+    Tests the history stream against a local mock HTTP server, used as
+    a "HTTP GET" proxy, which serves a history of #MESSAGES messages,
+    in pages, by the timetokens in the requests. Each page is much
+    larger than the buffers of the context. Checks that all the
+    messages are given to the callback, in order, whether the stream
+    paginates by itself or not, and that it can be stopped.
+ */
+
+
+/** Number of messages in the history of the channel */
+#define MESSAGES 250
+
+/** Length of the padding in each message */
+#define PAD_LEN 2000
+
+/** Timetoken of the first message */
+#define FIRST_TT 15700000000000000ULL
+
+static char m_pad[PAD_LEN + 1];
+
+struct check_state {
+    /** Number of messages received */
+    int received;
+    /** Number of messages that were not as expected */
+    int wrong;
+    /** Stop after this many messages */
+    int stop_after;
+};
+
+
+/** Prints the message with index @p i to @p s, returns its length */
+static int format_message(char* s, size_t size, int i)
+{
+    return snprintf(s, size, "{\"i\":%d,\"s\":\"[x],\\\"y\\\"}\",\"pad\":\"%s\"}", i, m_pad);
+}
+
+
+static char const* param(char const* head, char const* name)
+{
+    char const* s = strstr(head, name);
+    return (NULL == s) ? NULL : s + strlen(name);
+}
+
+
+static char* responder(char const* head)
+{
+    char const*        s     = param(head, "&count=");
+    int                count = (s != NULL) ? atoi(s) : 100;
+    unsigned long long start;
+    int                last;
+    int                first;
+    int                i;
+    size_t             size;
+    char*              body;
+    size_t             len;
+
+    if (strstr(head, "/channel/plain?") != NULL) {
+        return strdup("[[\"a\",\"b\"],15700000000000000,15700000000000001]");
+    }
+    /* Newest to oldest: the messages before start */
+    s    = param(head, "&start=");
+    last = MESSAGES - 1;
+    if (s != NULL) {
+        start = strtoull(s, NULL, 10);
+        last  = (int)(start - FIRST_TT) - 1;
+    }
+    first = last - count + 1;
+    if (first < 0) {
+        first = 0;
+    }
+    size = (last - first + 1) * (PAD_LEN + 60) + 100;
+    body = (char*)malloc(size);
+    if (NULL == body) {
+        return NULL;
+    }
+    len = 0;
+    body[len++] = '[';
+    body[len++] = '[';
+    for (i = first; i <= last; ++i) {
+        if (i > first) {
+            len += snprintf(body + len, size - len, ", ");
+        }
+        len += format_message(body + len, size - len, i);
+    }
+    if (last < first) {
+        snprintf(body + len, size - len, "],0,0]");
+    }
+    else {
+        snprintf(body + len,
+                 size - len,
+                 "],%llu,%llu]",
+                 FIRST_TT + first,
+                 FIRST_TT + last);
+    }
+
+    return body;
+}
+
+
+static int on_message(pubnub_t* pb, pubnub_chamebl_t message, void* user_data)
+{
+    struct check_state* state = (struct check_state*)user_data;
+    static char         expected[PAD_LEN + 100];
+    int                 page  = state->received / 100;
+    int                 first = MESSAGES - 100 * (page + 1);
+    int                 i;
+
+    (void)pb;
+    /* Pages (of 100) come from the newest, messages in a page from
+       the oldest */
+    if (first < 0) {
+        first = 0;
+    }
+    i = atoi(message.ptr + sizeof "{\"i\":" - 1);
+    if (i != first + state->received % 100) {
+        printf("Message %d instead of %d\n", i, first + state->received % 100);
+        ++state->wrong;
+    }
+    if (((size_t)format_message(expected, sizeof expected, i) != message.size)
+        || (memcmp(expected, message.ptr, message.size) != 0)) {
+        printf("Unexpected message: %.*s\n", (int)message.size, message.ptr);
+        ++state->wrong;
+    }
+    ++state->received;
+
+    return (state->received == state->stop_after) ? 1 : 0;
+}
+
+
+static enum pubnub_res await(pubnub_t* pbp, enum pubnub_res res)
+{
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    return res;
+}
+
+
+static int check(char const*         name,
+                 enum pubnub_res     res,
+                 enum pubnub_res     expected,
+                 struct check_state* state,
+                 int                 expected_messages)
+{
+    printf("%s: outcome %d('%s'), %d messages\n",
+           name,
+           res,
+           pubnub_res_2_string(res),
+           state->received);
+    if ((res != expected) || (state->received != expected_messages)
+        || (state->wrong != 0)) {
+        printf("%s: FAILED\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+
+static void reset(struct check_state* state, int stop_after)
+{
+    state->received   = 0;
+    state->wrong      = 0;
+    state->stop_after = stop_after;
+}
+
+
+int main()
+{
+    struct pubnub_history_stream_options opt = pubnub_history_stream_defopts();
+    struct check_state                   state;
+    uint16_t                             port;
+    pubnub_t*                            pbp;
+    enum pubnub_res                      res;
+    int                                  pages;
+    int                                  rslt = 0;
+
+    memset(m_pad, 'p', PAD_LEN);
+    mock_http_server_set_responder(responder);
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    reset(&state, 0);
+    res = await(pbp, pubnub_history_stream(pbp, "stream", opt, on_message, &state));
+    if ((check("Paginating", res, PNR_OK, &state, MESSAGES) != 0)
+        || pubnub_history_stream_has_more(pbp)
+        || (pubnub_history_stream_message_count(pbp) != MESSAGES)) {
+        rslt = -1;
+    }
+
+    /* One page per transaction */
+    reset(&state, 0);
+    opt.paginate = false;
+    res   = await(pbp, pubnub_history_stream(pbp, "stream", opt, on_message, &state));
+    pages = 1;
+    while ((PNR_OK == res) && pubnub_history_stream_has_more(pbp)) {
+        res = await(pbp, pubnub_history_stream_next_page(pbp));
+        ++pages;
+    }
+    if ((check("Page by page", res, PNR_OK, &state, MESSAGES) != 0) || (pages != 3)) {
+        rslt = -1;
+    }
+    opt.paginate = true;
+
+    reset(&state, 120);
+    res = await(pbp, pubnub_history_stream(pbp, "stream", opt, on_message, &state));
+    if ((check("Stopped", res, PNR_OK, &state, 120) != 0)
+        || pubnub_history_stream_has_more(pbp)) {
+        rslt = -1;
+    }
+
+    reset(&state, 0);
+    opt.max_message_len = PAD_LEN;
+    res = await(pbp, pubnub_history_stream(pbp, "stream", opt, on_message, &state));
+    if (check("Message too long", res, PNR_REPLY_TOO_BIG, &state, 0) != 0) {
+        rslt = -1;
+    }
+
+    /* The usual history is not affected by the stream */
+    res = await(pbp, pubnub_history(pbp, "plain", 10, false));
+    if ((PNR_OK != res) || (strcmp(pubnub_get(pbp), "[\"a\",\"b\"]") != 0)) {
+        printf("Plain history after the stream failed: %d('%s')\n",
+               res,
+               pubnub_res_2_string(res));
+        rslt = -1;
+    }
+
+    pubnub_free(pbp);
+    puts((0 == rslt) ? "History stream mock test passed" : "History stream mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,240 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_json_writer.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/** @file pubnub_json_writer_mock_test.c
+
+    Tests the JSON writer: escaping, nesting and the errors (buffer
+    too small, elements not well nested). Then publishes messages
+    built with it against a local mock HTTP server, used as a "HTTP
+    GET" proxy, which counts the bytes of the bodies it reads. Checks
+    that a long message is sent via POST from the buffer of the
+    writer, even if it is larger than the buffer of the context.
+ */
+
+
+/** Size of the buffer of the long message, larger than
+    #PUBNUB_BUF_MAXLEN */
+#define LONG_SIZE (3 * PUBNUB_BUF_MAXLEN)
+
+static char m_long[LONG_SIZE];
+
+
+static int expect(char const* name, struct pubnub_json_writer const* w, char const* json)
+{
+    enum pubnub_res res = pubnub_jw_result(w);
+    if ((res != PNR_OK) || (strcmp(pubnub_jw_str(w), json) != 0)
+        || (pubnub_jw_len(w) != strlen(json))) {
+        printf("%s: outcome %d('%s'), '%s' instead of '%s'\n",
+               name,
+               res,
+               pubnub_res_2_string(res),
+               pubnub_jw_str(w),
+               json);
+        return -1;
+    }
+    return 0;
+}
+
+
+static int expect_error(char const*                      name,
+                        struct pubnub_json_writer const* w,
+                        enum pubnub_res                  expected)
+{
+    enum pubnub_res res = pubnub_jw_result(w);
+    if (res != expected) {
+        printf("%s: outcome %d('%s') instead of %d('%s')\n",
+               name,
+               res,
+               pubnub_res_2_string(res),
+               expected,
+               pubnub_res_2_string(expected));
+        return -1;
+    }
+    return 0;
+}
+
+
+static int test_writer(void)
+{
+    struct pubnub_json_writer w;
+    char                      buf[200];
+    char                      small[10];
+    int                       rslt = 0;
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_begin_object(&w);
+    pubnub_jw_key(&w, "text");
+    pubnub_jw_string(&w, "say \"hi\"\\\n\t\x01");
+    pubnub_jw_key(&w, "n");
+    pubnub_jw_int(&w, -42);
+    pubnub_jw_key(&w, "list");
+    pubnub_jw_begin_array(&w);
+    pubnub_jw_double(&w, 0.5);
+    pubnub_jw_bool(&w, true);
+    pubnub_jw_null(&w);
+    pubnub_jw_begin_object(&w);
+    pubnub_jw_end_object(&w);
+    pubnub_jw_raw(&w, "[1,2]");
+    pubnub_jw_end_array(&w);
+    pubnub_jw_key(&w, "part");
+    pubnub_jw_string_n(&w, "abcdef", 3);
+    pubnub_jw_end_object(&w);
+    if (expect("Escaping",
+               &w,
+               "{\"text\":\"say \\\"hi\\\"\\\\\\n\\t\\u0001\",\"n\":-42,"
+               "\"list\":[0.5,true,null,{},[1,2]],\"part\":\"abc\"}")
+        != 0) {
+        rslt = -1;
+    }
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_string(&w, "top");
+    if (expect("Top level string", &w, "\"top\"") != 0) {
+        rslt = -1;
+    }
+
+    pubnub_jw_init(&w, small, sizeof small);
+    pubnub_jw_begin_array(&w);
+    pubnub_jw_string(&w, "too long for it");
+    pubnub_jw_end_array(&w);
+    if ((expect_error("Too small", &w, PNR_TX_BUFF_TOO_SMALL) != 0)
+        || (pubnub_jw_len(&w) >= sizeof small)) {
+        rslt = -1;
+    }
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_begin_object(&w);
+    pubnub_jw_int(&w, 1);
+    pubnub_jw_end_object(&w);
+    if (expect_error("Value without a key", &w, PNR_INVALID_PARAMETERS) != 0) {
+        rslt = -1;
+    }
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_begin_array(&w);
+    pubnub_jw_key(&w, "k");
+    if (expect_error("Key in an array", &w, PNR_INVALID_PARAMETERS) != 0) {
+        rslt = -1;
+    }
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_begin_array(&w);
+    pubnub_jw_end_object(&w);
+    if (expect_error("Mismatched end", &w, PNR_INVALID_PARAMETERS) != 0) {
+        rslt = -1;
+    }
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_begin_object(&w);
+    if (expect_error("Not ended", &w, PNR_INVALID_PARAMETERS) != 0) {
+        rslt = -1;
+    }
+
+    return rslt;
+}
+
+
+static int publish(pubnub_t*                        pbp,
+                   char const*                      name,
+                   struct pubnub_json_writer const* w,
+                   enum pubnub_method               method,
+                   enum pubnub_res                  expected)
+{
+    struct pubnub_publish_options opts = pubnub_publish_defopts();
+    enum pubnub_res               res;
+
+    opts.method = method;
+    res         = pubnub_publish_json(pbp, "json_test", w, opts);
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    if (res != expected) {
+        printf("%s: outcome %d('%s') instead of %d('%s')\n",
+               name,
+               res,
+               pubnub_res_2_string(res),
+               expected,
+               pubnub_res_2_string(expected));
+        return -1;
+    }
+    return 0;
+}
+
+
+int main()
+{
+    struct pubnub_publish_stats stats;
+    struct pubnub_json_writer   w;
+    char                        buf[100];
+    uint16_t                    port;
+    pubnub_t*                   pbp;
+    unsigned long               body_bytes;
+    int                         i;
+    int                         rslt = test_writer();
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    pubnub_jw_init(&w, buf, sizeof buf);
+    pubnub_jw_begin_array(&w);
+    pubnub_jw_string(&w, "hello");
+    if (publish(pbp, "Incomplete", &w, pubnubSendViaGET, PNR_INVALID_PARAMETERS) != 0) {
+        rslt = -1;
+    }
+    pubnub_jw_end_array(&w);
+    if (publish(pbp, "Short", &w, pubnubSendAdaptive, PNR_OK) != 0) {
+        rslt = -1;
+    }
+
+    /* Longer than the buffer of the context, so it can only be sent
+       from the buffer of the writer */
+    pubnub_jw_init(&w, m_long, sizeof m_long);
+    pubnub_jw_begin_array(&w);
+    for (i = 0; pubnub_jw_len(&w) < LONG_SIZE - 100; ++i) {
+        pubnub_jw_begin_object(&w);
+        pubnub_jw_key(&w, "i");
+        pubnub_jw_int(&w, i);
+        pubnub_jw_end_object(&w);
+    }
+    pubnub_jw_end_array(&w);
+    if (publish(pbp, "Long", &w, pubnubSendViaPOST, PNR_OK) != 0) {
+        rslt = -1;
+    }
+
+    pubnub_get_publish_stats(pbp, &stats);
+    body_bytes = mock_http_server_body_bytes(NULL);
+    printf("GET: %lu requests; POST: %lu requests, %lu bytes in the bodies\n",
+           stats.via_get,
+           stats.via_post,
+           body_bytes);
+    if ((stats.via_get != 1) || (stats.via_post != 1) || (body_bytes != pubnub_jw_len(&w))) {
+        printf("Publish: FAILED\n");
+        rslt = -1;
+    }
+
+    pubnub_free(pbp);
+    puts((0 == rslt) ? "JSON writer mock test passed" : "JSON writer mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,435 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_mock_http_server.h"
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/** Maximum number of requests the mock server keeps unanswered on a
+    connection */
+#define MAX_PENDING 1024
+
+/** Size of the buffer for reading requests. Heads of requests longer
+    than half of it are not given to the responder whole, so it
+    should hold the longest URL (#PUBNUB_BUF_MAXLEN) and headers.
+ */
+#define MOCK_HEAD_MAXLEN 65536
+
+static char const m_publish_response[] =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/javascript; charset=\"UTF-8\"\r\n"
+    "Content-Length: 30\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "[1,\"Sent\",\"15700000000000000\"]";
+
+static volatile unsigned m_rtt_ms;
+static int               m_listen_sock;
+
+/** The request bodies read: number of bytes and their sum */
+static pthread_mutex_t m_body_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned long   m_body_bytes;
+static unsigned long   m_body_sum;
+
+/** The response we send, with its length. Set only before requests
+    are made, so it is not guarded.
+ */
+static char const* m_response     = m_publish_response;
+static size_t      m_response_len = sizeof m_publish_response - 1;
+
+/** Makes the body of the reply to each request, if set */
+static mock_http_responder_t m_responder;
+
+static char const m_reply_header[] = "HTTP/1.1 200 OK\r\n"
+                                     "Content-Type: text/javascript; charset=\"UTF-8\"\r\n"
+                                     "Content-Length: %lu\r\n"
+                                     "Connection: keep-alive\r\n"
+                                     "\r\n"
+                                     "%s";
+
+
+unsigned long mock_http_server_ms_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+
+void mock_http_server_set_rtt(unsigned rtt_ms)
+{
+    m_rtt_ms = rtt_ms;
+}
+
+
+unsigned mock_http_server_rtt(void)
+{
+    return m_rtt_ms;
+}
+
+
+/** Returns the (allocated) HTTP response with the @p body, and its
+    length in @p response_len, or NULL if it can't be allocated.
+ */
+static char* make_response(char const* body, size_t* response_len)
+{
+    size_t body_len = strlen(body);
+    size_t size     = sizeof m_reply_header + body_len + 20;
+    char*  response = (char*)malloc(size);
+    int    len;
+
+    if (NULL == response) {
+        return NULL;
+    }
+    len = snprintf(response, size, m_reply_header, (unsigned long)body_len, body);
+    if ((len < 0) || ((size_t)len >= size)) {
+        free(response);
+        return NULL;
+    }
+    *response_len = (size_t)len;
+
+    return response;
+}
+
+
+int mock_http_server_set_reply(char const* body)
+{
+    size_t len;
+    char*  response = make_response(body, &len);
+
+    if (NULL == response) {
+        return -1;
+    }
+    if (m_response != m_publish_response) {
+        free((char*)m_response);
+    }
+    m_response     = response;
+    m_response_len = len;
+
+    return 0;
+}
+
+
+void mock_http_server_set_responder(mock_http_responder_t responder)
+{
+    m_responder = responder;
+}
+
+
+unsigned long mock_http_server_body_bytes(unsigned long* sum)
+{
+    unsigned long rslt;
+    pthread_mutex_lock(&m_body_lock);
+    rslt = m_body_bytes;
+    if (sum != NULL) {
+        *sum = m_body_sum;
+    }
+    pthread_mutex_unlock(&m_body_lock);
+    return rslt;
+}
+
+
+/** What is being read from a connection */
+enum rx_state {
+    rxHEADERS,
+    /** The body, of a known length */
+    rxBODY,
+    /** The header (size) of a chunk of a chunked body */
+    rxCHUNK_SIZE,
+    /** The data of a chunk */
+    rxCHUNK_DATA,
+    /** The CRLF after the data of a chunk */
+    rxCHUNK_END,
+    /** The (empty) trailer after the last chunk */
+    rxTRAILER
+};
+
+
+static void body_read(char const* data, size_t n)
+{
+    unsigned long sum = 0;
+    size_t        i;
+    for (i = 0; i < n; ++i) {
+        sum += (unsigned char)data[i];
+    }
+    pthread_mutex_lock(&m_body_lock);
+    m_body_bytes += n;
+    m_body_sum += sum;
+    pthread_mutex_unlock(&m_body_lock);
+}
+
+
+/** The replies to the requests read on a connection, waiting to be
+    sent (after the RTT).
+ */
+struct pending_replies {
+    unsigned long due[MAX_PENDING];
+    /** The reply made by the responder, NULL for #m_response */
+    char*    reply[MAX_PENDING];
+    size_t   reply_len[MAX_PENDING];
+    unsigned head;
+    unsigned count;
+    /** The reply to the request being read */
+    char*  next_reply;
+    size_t next_reply_len;
+};
+
+
+/** Makes the reply to the request whose head (request line and
+    headers) is @p head, if there is a responder.
+ */
+static void request_head_read(struct pending_replies* p, char const* head)
+{
+    p->next_reply = NULL;
+    if (m_responder != NULL) {
+        char* body = m_responder(head);
+        if ((body != NULL) && (0 == strncmp(body, "HTTP/", 5))) {
+            /* A whole response (status line and headers), as is */
+            p->next_reply     = body;
+            p->next_reply_len = strlen(body);
+        }
+        else if (body != NULL) {
+            p->next_reply = make_response(body, &p->next_reply_len);
+            free(body);
+        }
+    }
+}
+
+
+/** Queues the reply to the request that was read (up to its end) */
+static void request_read(struct pending_replies* p)
+{
+    if (p->count < MAX_PENDING) {
+        unsigned i = (p->head + p->count) % MAX_PENDING;
+        p->due[i]       = mock_http_server_ms_now() + m_rtt_ms;
+        p->reply[i]     = p->next_reply;
+        p->reply_len[i] = p->next_reply_len;
+        ++p->count;
+    }
+    else {
+        free(p->next_reply);
+    }
+    p->next_reply = NULL;
+}
+
+
+/** Reads the parts of the requests in @p in (of @p *in_len bytes) we
+    can, removing them from it, and queues the replies to the requests
+    read (up to their end) in @p p.
+ */
+static void read_requests(char*                   in,
+                          size_t*                 in_len,
+                          enum rx_state*          state,
+                          size_t*                 left,
+                          struct pending_replies* p)
+{
+    for (;;) {
+        size_t used = 0;
+        char*  end;
+
+        switch (*state) {
+        case rxHEADERS:
+            end = strstr(in, "\r\n\r\n");
+            if (NULL == end) {
+                return;
+            }
+            used  = end + 4 - in;
+            *end  = '\0';
+            *left = 0;
+            request_head_read(p, in);
+            if (strstr(in, "\r\nTransfer-Encoding: chunked") != NULL) {
+                *state = rxCHUNK_SIZE;
+            }
+            else if ((end = strstr(in, "\r\nContent-Length: ")) != NULL) {
+                *left = strtoul(end + sizeof "\r\nContent-Length: " - 1, NULL, 10);
+            }
+            if (*left > 0) {
+                *state = rxBODY;
+            }
+            else if (rxHEADERS == *state) {
+                request_read(p);
+            }
+            break;
+        case rxBODY:
+        case rxCHUNK_DATA:
+            used = (*in_len < *left) ? *in_len : *left;
+            if (0 == used) {
+                return;
+            }
+            body_read(in, used);
+            *left -= used;
+            if (0 == *left) {
+                if (rxBODY == *state) {
+                    *state = rxHEADERS;
+                    request_read(p);
+                }
+                else {
+                    *state = rxCHUNK_END;
+                }
+            }
+            break;
+        case rxCHUNK_SIZE:
+        case rxCHUNK_END:
+        case rxTRAILER:
+            end = strstr(in, "\r\n");
+            if (NULL == end) {
+                return;
+            }
+            used = end + 2 - in;
+            if (rxCHUNK_SIZE == *state) {
+                *left  = strtoul(in, NULL, 16);
+                *state = (*left > 0) ? rxCHUNK_DATA : rxTRAILER;
+            }
+            else if (rxCHUNK_END == *state) {
+                *state = rxCHUNK_SIZE;
+            }
+            else {
+                *state = rxHEADERS;
+                request_read(p);
+            }
+            break;
+        }
+        memmove(in, in + used, *in_len - used + 1);
+        *in_len -= used;
+    }
+}
+
+
+static void serve_connection(int fd, struct pending_replies* p)
+{
+    char          in[MOCK_HEAD_MAXLEN];
+    size_t        in_len = 0;
+    enum rx_state state  = rxHEADERS;
+    size_t        left   = 0;
+
+    for (;;) {
+        struct pollfd pfd;
+        int           timeout = -1;
+        unsigned long now     = mock_http_server_ms_now();
+
+        while ((p->count > 0) && (p->due[p->head] <= now)) {
+            char*       reply    = p->reply[p->head];
+            char const* response = (reply != NULL) ? reply : m_response;
+            size_t      len      = (reply != NULL) ? p->reply_len[p->head] : m_response_len;
+            ssize_t     sent     = send(fd, response, len, 0);
+
+            free(reply);
+            p->reply[p->head] = NULL;
+            p->head           = (p->head + 1) % MAX_PENDING;
+            --p->count;
+            if (sent < 0) {
+                return;
+            }
+        }
+        if (p->count > 0) {
+            timeout = (int)(p->due[p->head] - now);
+        }
+        pfd.fd     = fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, timeout) > 0) {
+            ssize_t n = recv(fd, in + in_len, sizeof in - in_len - 1, 0);
+            if (n <= 0) {
+                return;
+            }
+#if defined TCP_QUICKACK
+            {
+                /* The client sends a request in several small pieces,
+                   don't let delayed ACKs (and Nagle on the client side)
+                   dominate the measurement.
+                */
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_QUICKACK, &one, sizeof one);
+            }
+#endif
+            in_len += n;
+            in[in_len] = '\0';
+            read_requests(in, &in_len, &state, &left, p);
+            if ((rxHEADERS == state) && (in_len > sizeof in / 2)) {
+                /* A long request (URL), we only need to find its end */
+                memmove(in, in + in_len - 3, 4);
+                in_len = 3;
+            }
+        }
+    }
+}
+
+
+static void* connection_thread(void* arg)
+{
+    int                     fd = (int)(intptr_t)arg;
+    struct pending_replies* p  = (struct pending_replies*)calloc(1, sizeof *p);
+
+    if (p != NULL) {
+        serve_connection(fd, p);
+        while (p->count > 0) {
+            free(p->reply[p->head]);
+            p->head = (p->head + 1) % MAX_PENDING;
+            --p->count;
+        }
+        free(p->next_reply);
+        free(p);
+    }
+    close(fd);
+    return NULL;
+}
+
+
+static void* mock_server(void* arg)
+{
+    (void)arg;
+    for (;;) {
+        pthread_t thread;
+        int       one = 1;
+        int       fd  = accept(m_listen_sock, NULL, NULL);
+        if (fd < 0) {
+            break;
+        }
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof one);
+        if (pthread_create(&thread, NULL, connection_thread, (void*)(intptr_t)fd) != 0) {
+            close(fd);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+
+int mock_http_server_start(uint16_t* port)
+{
+    struct sockaddr_in addr;
+    socklen_t          addr_len = sizeof addr;
+    pthread_t          thread;
+
+    m_listen_sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (m_listen_sock < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof addr);
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+    if ((bind(m_listen_sock, (struct sockaddr*)&addr, sizeof addr) != 0)
+        || (listen(m_listen_sock, 64) != 0)
+        || (getsockname(m_listen_sock, (struct sockaddr*)&addr, &addr_len) != 0)) {
+        close(m_listen_sock);
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    if (pthread_create(&thread, NULL, mock_server, NULL) != 0) {
+        close(m_listen_sock);
+        return -1;
+    }
+    pthread_detach(thread);
+
+    return 0;
+}
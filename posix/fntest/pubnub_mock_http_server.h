@@ -0,0 +1,74 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#if !defined INC_PUBNUB_MOCK_HTTP_SERVER
+#define INC_PUBNUB_MOCK_HTTP_SERVER
+
+#include <stdint.h>
+
+
+/** @file pubnub_mock_http_server.h
+
+    A mock HTTP server, for measurements on the local machine. It
+    answers every request it reads with a successful publish response
+    (or the reply set with mock_http_server_set_reply(), or made by
+    the responder set with mock_http_server_set_responder()), after a
+    simulated round-trip time (RTT). It supports HTTP/1.1
+    pipelining, request bodies (`Content-Length` or chunked) and any
+    number of simultaneous connections.
+
+    Since the port of the Pubnub origin can't be changed, it should be
+    used as a "HTTP GET" proxy:
+
+        pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+*/
+
+
+/** Starts the mock HTTP server on the loopback interface, on a port
+    chosen by the OS, which is returned in @p port.
+    @retval 0 server started
+    @retval -1 failed to start the server
+ */
+int mock_http_server_start(uint16_t* port);
+
+/** Sets the simulated round-trip time, in milliseconds, for the
+    requests read from now on.
+ */
+void mock_http_server_set_rtt(unsigned rtt_ms);
+
+/** Sets the (JSON) @p body of the reply to send to every request,
+    for example, a subscribe response with a number of messages. Must
+    be called before making any requests.
+    @retval 0 reply set
+    @retval -1 failed to allocate the reply
+ */
+int mock_http_server_set_reply(char const* body);
+
+/** Prototype of a function that makes the (JSON) body of the reply
+    to a request, given the @p head of the request (request line and
+    headers). Returns the body allocated with malloc() (the server
+    frees it), or NULL to send the usual reply. If it starts with
+    `HTTP/`, it is sent as is, as the whole response (status line,
+    headers and body), for example, to send `304 Not Modified`.
+    Called from the threads of the server.
+ */
+typedef char* (*mock_http_responder_t)(char const* head);
+
+/** Sets the @p responder, which makes the reply to each request, so
+    the reply can depend on the request (for example, pages of a
+    history). Must be called before making any requests.
+ */
+void mock_http_server_set_responder(mock_http_responder_t responder);
+
+/** Returns the number of bytes of request bodies (of any length,
+    or chunked) read by the server so far, and, in @p sum (if not
+    NULL), the sum of (the values of) those bytes.
+ */
+unsigned long mock_http_server_body_bytes(unsigned long* sum);
+
+/** Returns the simulated round-trip time, in milliseconds */
+unsigned mock_http_server_rtt(void);
+
+/** Returns the time from a monotonic clock, in milliseconds */
+unsigned long mock_http_server_ms_now(void);
+
+
+#endif /* !defined INC_PUBNUB_MOCK_HTTP_SERVER */
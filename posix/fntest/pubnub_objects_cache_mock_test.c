@@ -0,0 +1,317 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_objects_api.h"
+#include "core/pubnub_objects_cache.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/** @file pubnub_objects_cache_mock_test.c
+
+    Tests the Objects API response cache against a local mock HTTP
+    server, used as a "HTTP GET" proxy, which keeps a version of each
+    of #USERS users (and of their list), sends it as the `ETag` of
+    the responses and answers `304 Not Modified` to requests with the
+    current version in `If-None-Match`. Checks that repeated fetches
+    are served from the cache, with the same response, that local
+    changes invalidate it, and that it stays within its size limit.
+ */
+
+
+/** Number of users the server knows */
+#define USERS 10
+
+/** Length of the padding in each user object */
+#define PAD_LEN 1000
+
+static char m_pad[PAD_LEN + 1];
+
+/** Versions of the users, changed on each change */
+static int m_version[USERS];
+
+/** Version of the list of users, changed on each change of a user */
+static int m_list_version;
+
+/** Number of `304` responses sent */
+static int m_not_modified;
+
+/** Number of requests with `If-None-Match` */
+static int m_conditional;
+
+
+static char* make_reply(char const* etag, char const* body)
+{
+    size_t size = strlen(body) + strlen(etag) + 200;
+    char*  s    = (char*)malloc(size);
+    if (s != NULL) {
+        snprintf(s,
+                 size,
+                 "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                 "ETag: %s\r\nContent-Length: %lu\r\n\r\n%s",
+                 etag,
+                 (unsigned long)strlen(body),
+                 body);
+    }
+    return s;
+}
+
+
+static char* responder(char const* head)
+{
+    char const* users = strstr(head, "/users");
+    char const* inm   = strstr(head, "If-None-Match: ");
+    char        etag[40];
+    char        body[PAD_LEN + 200];
+    int         user = -1;
+
+    if (NULL == users) {
+        return NULL;
+    }
+    if ('/' == users[6]) {
+        user = atoi(users + 8);
+        if ((user < 0) || (user >= USERS)) {
+            return strdup("{\"status\":\"error\",\"error\":{\"message\":\"no user\"}}");
+        }
+    }
+    if (0 != strncmp(head, "GET ", 4)) {
+        /* Create, update or delete */
+        if (user >= 0) {
+            ++m_version[user];
+        }
+        ++m_list_version;
+        return strdup("{\"status\":\"ok\",\"data\":{}}");
+    }
+    if (user >= 0) {
+        snprintf(etag, sizeof etag, "\"u%d-v%d\"", user, m_version[user]);
+        snprintf(body,
+                 sizeof body,
+                 "{\"status\":\"ok\",\"data\":{\"id\":\"u%d\",\"v\":%d,\"pad\":\"%s\"}}",
+                 user,
+                 m_version[user],
+                 m_pad);
+    }
+    else {
+        snprintf(etag, sizeof etag, "\"list-v%d\"", m_list_version);
+        snprintf(body,
+                 sizeof body,
+                 "{\"status\":\"ok\",\"data\":[],\"v\":%d}",
+                 m_list_version);
+    }
+    if (inm != NULL) {
+        ++m_conditional;
+        if (0 == strncmp(inm + 15, etag, strlen(etag))) {
+            ++m_not_modified;
+            return strdup("HTTP/1.1 304 Not Modified\r\nContent-Length: 0\r\n\r\n");
+        }
+    }
+
+    return make_reply(etag, body);
+}
+
+
+static enum pubnub_res await(pubnub_t* pbp, enum pubnub_res res)
+{
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    return res;
+}
+
+
+/** Fetches the user @p i, expecting its version to be @p version and
+    the response to be (or not) from the cache, as @p hit says.
+ */
+static int fetch_user(pubnub_t* pbp, int i, int version, bool hit)
+{
+    char            id[20];
+    char            expected[PAD_LEN + 200];
+    char const*     reply;
+    enum pubnub_res res;
+
+    snprintf(id, sizeof id, "u%d", i);
+    snprintf(expected,
+             sizeof expected,
+             "{\"status\":\"ok\",\"data\":{\"id\":\"u%d\",\"v\":%d,\"pad\":\"%s\"}}",
+             i,
+             version,
+             m_pad);
+    res   = await(pbp, pubnub_fetch_user(pbp, NULL, 0, id));
+    reply = pubnub_get(pbp);
+    if ((res != PNR_OBJECTS_API_OK) || (NULL == reply) || (strcmp(reply, expected) != 0)
+        || (pubnub_objects_cache_hit(pbp) != hit)) {
+        printf("Fetch user %d: outcome %d('%s'), hit=%d, reply='%.60s'\n",
+               i,
+               res,
+               pubnub_res_2_string(res),
+               pubnub_objects_cache_hit(pbp),
+               reply ? reply : "(null)");
+        return -1;
+    }
+    return 0;
+}
+
+
+static int fetch_list(pubnub_t* pbp, bool hit)
+{
+    enum pubnub_res res = await(
+        pbp, pubnub_fetch_all_users(pbp, NULL, 0, 10, NULL, NULL, pbccNotSet));
+    pubnub_get(pbp);
+    if ((res != PNR_OBJECTS_API_OK) || (pubnub_objects_cache_hit(pbp) != hit)) {
+        printf("Fetch all users: outcome %d('%s'), hit=%d\n",
+               res,
+               pubnub_res_2_string(res),
+               pubnub_objects_cache_hit(pbp));
+        return -1;
+    }
+    return 0;
+}
+
+
+static void print_metrics(char const* name, pubnub_objects_cache_t* cache)
+{
+    struct pubnub_objects_cache_metrics m;
+
+    pubnub_objects_cache_get_metrics(cache, &m);
+    printf("%s: lookups=%lu hits=%lu misses=%lu evictions=%lu invalidations=%lu "
+           "entries=%u bytes=%lu\n",
+           name,
+           m.lookups,
+           m.hits,
+           m.misses,
+           m.evictions,
+           m.invalidations,
+           m.entries,
+           (unsigned long)m.bytes);
+}
+
+
+int main()
+{
+    struct pubnub_objects_cache_metrics m;
+    pubnub_objects_cache_t*             cache;
+    pubnub_objects_cache_t*             small;
+    uint16_t                            port;
+    pubnub_t*                           pbp;
+    enum pubnub_res                     res;
+    int                                 i;
+    int                                 rslt = 0;
+
+    memset(m_pad, 'p', PAD_LEN);
+    mock_http_server_set_responder(responder);
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    /* Without a cache, no conditional requests */
+    for (i = 0; i < 2; ++i) {
+        if (fetch_user(pbp, 0, 0, false) != 0) {
+            rslt = -1;
+        }
+    }
+    if (m_conditional != 0) {
+        printf("Conditional requests without a cache\n");
+        rslt = -1;
+    }
+
+    cache = pubnub_objects_cache_create(64 * 1024);
+    if (NULL == cache) {
+        printf("Failed to create the cache!\n");
+        return -1;
+    }
+    pubnub_set_objects_cache(pbp, cache);
+
+    for (i = 0; i < USERS; ++i) {
+        if (fetch_user(pbp, i, 0, false) != 0) {
+            rslt = -1;
+        }
+    }
+    for (i = 0; i < USERS; ++i) {
+        if (fetch_user(pbp, i, 0, true) != 0) {
+            rslt = -1;
+        }
+    }
+    print_metrics("Fetched twice", cache);
+    pubnub_objects_cache_get_metrics(cache, &m);
+    if ((m.hits != USERS) || (m.misses != USERS) || (m.entries != USERS)
+        || (m_not_modified != USERS)) {
+        printf("Fetched twice: FAILED\n");
+        rslt = -1;
+    }
+
+    /* A local change invalidates the user (and the list) */
+    if ((fetch_list(pbp, false) != 0) || (fetch_list(pbp, true) != 0)) {
+        rslt = -1;
+    }
+    res = await(pbp, pubnub_delete_user(pbp, "u3"));
+    pubnub_get(pbp);
+    if (res != PNR_OBJECTS_API_OK) {
+        printf("Delete user: outcome %d('%s')\n", res, pubnub_res_2_string(res));
+        rslt = -1;
+    }
+    if ((fetch_user(pbp, 3, 1, false) != 0) || (fetch_user(pbp, 3, 1, true) != 0)
+        || (fetch_list(pbp, false) != 0)) {
+        rslt = -1;
+    }
+    /* Other users stay cached */
+    res = await(pbp, pubnub_delete_user(pbp, "u5"));
+    pubnub_get(pbp);
+    if ((res != PNR_OBJECTS_API_OK) || (fetch_user(pbp, 4, 0, true) != 0)
+        || (fetch_user(pbp, 5, 1, false) != 0) || (fetch_list(pbp, false) != 0)) {
+        rslt = -1;
+    }
+    print_metrics("Invalidated", cache);
+    pubnub_objects_cache_get_metrics(cache, &m);
+    if (m.invalidations != 4) {
+        printf("Invalidated: FAILED\n");
+        rslt = -1;
+    }
+
+    /* A small cache evicts the least recently used responses */
+    small = pubnub_objects_cache_create(4 * PAD_LEN);
+    if (NULL == small) {
+        printf("Failed to create the small cache!\n");
+        return -1;
+    }
+    pubnub_set_objects_cache(pbp, small);
+    for (i = 0; i < USERS; ++i) {
+        if (fetch_user(pbp, i, m_version[i], false) != 0) {
+            rslt = -1;
+        }
+    }
+    if (fetch_user(pbp, USERS - 1, m_version[USERS - 1], true) != 0) {
+        rslt = -1;
+    }
+    if (fetch_user(pbp, 0, m_version[0], false) != 0) {
+        rslt = -1;
+    }
+    print_metrics("Small", small);
+    pubnub_objects_cache_get_metrics(small, &m);
+    if ((m.bytes > 4 * PAD_LEN) || (m.evictions < USERS - 3) || (m.hits != 1)) {
+        printf("Small: FAILED\n");
+        rslt = -1;
+    }
+
+    pubnub_free(pbp);
+    pubnub_objects_cache_destroy(small);
+    pubnub_objects_cache_destroy(cache);
+    puts((0 == rslt) ? "Objects cache mock test passed" : "Objects cache mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,224 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_objects_pager.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+
+/** @file pubnub_objects_pager_mock_test.c
+
+    Tests the Objects API pager against a local mock HTTP server, used
+    as a "HTTP GET" proxy, which serves lists of #USERS users (and of
+    members of spaces), in pages, by the `start` cursor in the
+    requests. Checks that all the objects are yielded, in order, and
+    that the next page is fetched while the objects of the current
+    one are processed, so that going through the list does not take
+    the round-trip time of every page.
+ */
+
+
+/** Number of users in the lists */
+#define USERS 250
+
+/** Number of objects in a page */
+#define LIMIT 20
+
+/** Round-trip time, in milliseconds */
+#define RTT_MS 60
+
+/** Time to "process" each object, in microseconds */
+#define WORK_US 3000
+
+/** The members of this space can't be fetched after the first page */
+#define BROKEN_SPACE "broken"
+
+
+static char const* param(char const* head, char const* name)
+{
+    char const* s = strstr(head, name);
+    return (NULL == s) ? NULL : s + strlen(name);
+}
+
+
+static char* responder(char const* head)
+{
+    char const* s     = param(head, "start=c");
+    int         first = (s != NULL) ? atoi(s) : 0;
+    int         limit;
+    int         last;
+    int         i;
+    size_t      size;
+    size_t      len;
+    char*       body;
+
+    if ((NULL == strstr(head, "/users")) && (NULL == strstr(head, "/spaces/"))) {
+        return NULL;
+    }
+    if ((first > 0) && (strstr(head, "/spaces/" BROKEN_SPACE "/") != NULL)) {
+        return strdup("{\"status\":\"error\",\"error\":{\"message\":\"broken\"}}");
+    }
+    s     = param(head, "limit=");
+    limit = (s != NULL) ? atoi(s) : 100;
+    last  = (first + limit < USERS) ? first + limit : USERS;
+    size  = (last - first) * 60 + 200;
+    body  = (char*)malloc(size);
+    if (NULL == body) {
+        return NULL;
+    }
+    len = snprintf(body, size, "{\"status\":\"ok\",\"data\":[");
+    for (i = first; i < last; ++i) {
+        len += snprintf(body + len,
+                        size - len,
+                        "%s{\"id\":\"u%d\",\"name\":\"User [%d]\"}",
+                        (i > first) ? ", " : "",
+                        i,
+                        i);
+    }
+    len += snprintf(body + len, size - len, "],\"totalCount\":%d", USERS);
+    if (first > 0) {
+        len += snprintf(body + len, size - len, ",\"prev\":\"c%d\"", first - limit);
+    }
+    if (last < USERS) {
+        len += snprintf(body + len, size - len, ",\"next\":\"c%d\"", last);
+    }
+    snprintf(body + len, size - len, "}");
+
+    return body;
+}
+
+
+/** Goes through the list, checking the objects, returns the number
+    of objects yielded */
+static int go_through(pubnub_objects_pager_t* pg, int* wrong, unsigned work_us)
+{
+    pubnub_chamebl_t object;
+    char             expected[60];
+    int              n = 0;
+
+    while (pubnub_objects_pager_next(pg, &object)) {
+        int len = snprintf(
+            expected, sizeof expected, "{\"id\":\"u%d\",\"name\":\"User [%d]\"}", n, n);
+        if (((size_t)len != object.size) || (memcmp(expected, object.ptr, len) != 0)) {
+            printf("Object %d: '%.*s'\n", n, (int)object.size, object.ptr);
+            ++*wrong;
+        }
+        ++n;
+        if (work_us > 0) {
+            usleep(work_us);
+        }
+    }
+    return n;
+}
+
+
+static int check(char const*             name,
+                 pubnub_objects_pager_t* pg,
+                 int                     n,
+                 int                     wrong,
+                 enum pubnub_res         expected_result,
+                 int                     expected_n)
+{
+    enum pubnub_res res = pubnub_objects_pager_result(pg);
+    printf("%s: outcome %d('%s'), %d objects, %u pages\n",
+           name,
+           res,
+           pubnub_res_2_string(res),
+           n,
+           pubnub_objects_pager_page_count(pg));
+    if ((res != expected_result) || (n != expected_n) || (wrong != 0)) {
+        printf("%s: FAILED\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main()
+{
+    pubnub_chamebl_t        object;
+    pubnub_objects_pager_t* pg;
+    uint16_t                port;
+    unsigned                i;
+    unsigned long           t0;
+    unsigned long           elapsed;
+    unsigned long           serial;
+    int                     wrong = 0;
+    int                     n;
+    int                     rslt  = 0;
+
+    mock_http_server_set_responder(responder);
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(RTT_MS);
+
+    pg = pubnub_objects_pager_create("demo", "demo");
+    if (NULL == pg) {
+        printf("Failed to create the Objects pager!\n");
+        return -1;
+    }
+    for (i = 0; i < 2; ++i) {
+        pubnub_set_proxy_manual(
+            pubnub_objects_pager_context(pg, i), pbproxyHTTP_GET, "127.0.0.1", port);
+    }
+
+    t0 = mock_http_server_ms_now();
+    pubnub_objects_pager_start(pg, pbolUsers, NULL, NULL, 0, LIMIT);
+    n       = go_through(pg, &wrong, WORK_US);
+    elapsed = mock_http_server_ms_now() - t0;
+    if (check("Users", pg, n, wrong, PNR_OBJECTS_API_OK, USERS) != 0) {
+        rslt = -1;
+    }
+    /* Without prefetching, each page would take the RTT and the
+       processing of its objects, one after the other */
+    serial = (USERS + LIMIT - 1) / LIMIT * (RTT_MS + LIMIT * WORK_US / 1000);
+    printf("Users: %lu ms (%lu ms page by page)\n", elapsed, serial);
+    if (elapsed * 10 > serial * 8) {
+        printf("Users: not pipelined, FAILED\n");
+        rslt = -1;
+    }
+
+    mock_http_server_set_rtt(0);
+    wrong = 0;
+    pubnub_objects_pager_start(pg, pbolMembersInSpace, "space", NULL, 0, 0);
+    n = go_through(pg, &wrong, 0);
+    if (check("Members", pg, n, wrong, PNR_OBJECTS_API_OK, USERS) != 0) {
+        rslt = -1;
+    }
+
+    wrong = 0;
+    pubnub_objects_pager_start(pg, pbolMembersInSpace, BROKEN_SPACE, NULL, 0, LIMIT);
+    n = go_through(pg, &wrong, 0);
+    if (check("Broken", pg, n, wrong, PNR_OBJECTS_API_ERROR, LIMIT) != 0) {
+        rslt = -1;
+    }
+
+    /* Restarting in the middle of a list */
+    wrong = 0;
+    pubnub_objects_pager_start(pg, pbolUsers, NULL, NULL, 0, LIMIT);
+    for (i = 0; i < LIMIT + 5; ++i) {
+        pubnub_objects_pager_next(pg, &object);
+    }
+    pubnub_objects_pager_start(pg, pbolUsers, NULL, NULL, 0, LIMIT);
+    n = go_through(pg, &wrong, 0);
+    if (check("Restarted", pg, n, wrong, PNR_OBJECTS_API_OK, USERS) != 0) {
+        rslt = -1;
+    }
+
+    if (pubnub_objects_pager_destroy(pg, 1000) != 0) {
+        printf("Failed to destroy the Objects pager\n");
+        rslt = -1;
+    }
+    puts((0 == rslt) ? "Objects pager mock test passed" : "Objects pager mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,242 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_publish_pipeline.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+#include "core/pubnub_timers.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/** @file pubnub_publish_pipeline_mock_test.c
+
+    Tests the publish pipeline against a local mock HTTP server,
+    which answers every request it reads after a simulated round-trip
+    time (RTT). The mock server is used as a "HTTP GET" proxy, so the
+    context can be left with its default origin and port.
+
+    Prints the publish throughput for a few RTTs and pipeline depths,
+    and fails if any publish was not reported as sent. Does the same
+    for a batch publish to many channels, some of them with options
+    (and a few with options that a batch can't do, which should
+    fail).
+ */
+
+
+/** Number of messages published in every measurement */
+#define MESSAGES_TO_PUBLISH 256
+
+/** Number of messages (channels) in the batch */
+#define BATCH_SIZE 500
+
+/** Every this many batch items can't be published in a batch */
+#define BATCH_UNSUPPORTED_EVERY 100
+
+static unsigned m_sent;
+static unsigned m_failed;
+static unsigned m_batches_done;
+
+
+static void pipeline_cb(pubnub_t*               pb,
+                        enum pubnub_res         result,
+                        enum pubnub_publish_res publish_result,
+                        void*                   item_data,
+                        void*                   user_data)
+{
+    (void)pb;
+    (void)item_data;
+    (void)user_data;
+    if ((PNR_OK == result) && (PNPUB_SENT == publish_result)) {
+        ++m_sent;
+    }
+    else {
+        printf("Publish failed: %d('%s'), publish result %d\n",
+               result,
+               pubnub_res_2_string(result),
+               publish_result);
+        ++m_failed;
+    }
+}
+
+
+static int measure(uint16_t port, unsigned depth)
+{
+    unsigned        enqueued = 0;
+    unsigned long   t0;
+    unsigned long   elapsed;
+    enum pubnub_res res;
+    pubnub_t*       pbp = pubnub_alloc();
+
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_transaction_timeout(pbp, PUBNUB_DEFAULT_NON_SUBSCRIBE_TIMEOUT);
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+    pubnub_publish_pipeline_enable(pbp, depth, pipeline_cb, NULL);
+
+    m_sent = m_failed = 0;
+    t0                = mock_http_server_ms_now();
+    while (enqueued < MESSAGES_TO_PUBLISH) {
+        while ((enqueued < MESSAGES_TO_PUBLISH)
+               && (PNR_OK
+                   == pubnub_publish_pipeline_enqueue(
+                          pbp, "hello_world", "\"Hello world from pipeline!\"", NULL))) {
+            ++enqueued;
+        }
+        res = pubnub_publish_pipeline_start(pbp);
+        if (PNR_STARTED == res) {
+            res = pubnub_await(pbp);
+        }
+        if (res != PNR_OK) {
+            printf("Pipeline transaction failed: %d('%s')\n",
+                   res,
+                   pubnub_res_2_string(res));
+            break;
+        }
+    }
+    elapsed = mock_http_server_ms_now() - t0;
+
+    printf("RTT %4u ms, depth %2u: %4u sent, %u failed in %5lu ms, %8.1f "
+           "msg/s\n",
+           mock_http_server_rtt(),
+           depth,
+           m_sent,
+           m_failed,
+           elapsed,
+           (elapsed > 0) ? m_sent * 1000.0 / elapsed : 0.0);
+    pubnub_free(pbp);
+
+    return ((MESSAGES_TO_PUBLISH == m_sent) && (0 == m_failed)) ? 0 : -1;
+}
+
+
+static void batch_done(pubnub_t*                         pb,
+                       struct pubnub_publish_batch_item* items,
+                       size_t                            count,
+                       unsigned                          failed,
+                       void*                             user_data)
+{
+    size_t i;
+    (void)pb;
+    (void)user_data;
+    ++m_batches_done;
+    for (i = 0; i < count; ++i) {
+        bool unsupported = (0 == i % BATCH_UNSUPPORTED_EVERY);
+        if (unsupported ? (items[i].result != PNR_INVALID_PARAMETERS)
+                        : ((items[i].result != PNR_OK)
+                           || (items[i].publish_result != PNPUB_SENT))) {
+            printf("Batch item %lu unexpected result: %d('%s')\n",
+                   (unsigned long)i,
+                   items[i].result,
+                   pubnub_res_2_string(items[i].result));
+            ++m_failed;
+        }
+        else if (!unsupported) {
+            ++m_sent;
+        }
+    }
+    if (failed != BATCH_SIZE / BATCH_UNSUPPORTED_EVERY) {
+        printf("Batch reported %u failed items\n", failed);
+        ++m_failed;
+    }
+}
+
+
+static int measure_batch(uint16_t port, unsigned depth)
+{
+    static char                             channels[BATCH_SIZE][20];
+    static struct pubnub_publish_batch_item items[BATCH_SIZE];
+    struct pubnub_publish_options           no_store = pubnub_publish_defopts();
+    struct pubnub_publish_options           encrypt  = pubnub_publish_defopts();
+    unsigned long                           t0;
+    unsigned long                           elapsed;
+    enum pubnub_res                         res;
+    unsigned                                i;
+    pubnub_t*                               pbp = pubnub_alloc();
+
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    /* The timeout is for the whole batch */
+    pubnub_set_transaction_timeout(pbp, 60000);
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    no_store.store     = false;
+    no_store.meta      = "{\"batch\":1}";
+    encrypt.cipher_key = "enigma";
+    for (i = 0; i < BATCH_SIZE; ++i) {
+        snprintf(channels[i], sizeof channels[i], "batch_%u", i);
+        items[i].channel = channels[i];
+        items[i].message = "\"Hello world from batch!\"";
+        items[i].options = (0 == i % BATCH_UNSUPPORTED_EVERY) ? &encrypt
+                           : (0 == i % 3)                     ? &no_store
+                                                              : NULL;
+    }
+
+    m_sent = m_failed = m_batches_done = 0;
+    t0                                 = mock_http_server_ms_now();
+    res = pubnub_publish_batch(pbp, items, BATCH_SIZE, depth, batch_done, NULL);
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    elapsed = mock_http_server_ms_now() - t0;
+    if (res != PNR_OK) {
+        printf("Batch transaction failed: %d('%s')\n", res, pubnub_res_2_string(res));
+    }
+
+    printf("RTT %4u ms, batch depth %2u: %4u sent, %u failed in %5lu ms, %8.1f "
+           "msg/s\n",
+           mock_http_server_rtt(),
+           depth,
+           m_sent,
+           m_failed,
+           elapsed,
+           (elapsed > 0) ? m_sent * 1000.0 / elapsed : 0.0);
+    pubnub_free(pbp);
+
+    return ((PNR_OK == res) && (1 == m_batches_done)
+            && (BATCH_SIZE - BATCH_SIZE / BATCH_UNSUPPORTED_EVERY == m_sent)
+            && (0 == m_failed))
+               ? 0
+               : -1;
+}
+
+
+int main()
+{
+    static unsigned const rtts[]   = { 0, 10, 40 };
+    static unsigned const depths[] = { 1, 4, 16, PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN };
+    uint16_t              port;
+    size_t                i;
+    size_t                j;
+    int                   rslt = 0;
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    printf("Mock HTTP server listening on 127.0.0.1:%u\n", port);
+    for (i = 0; i < sizeof rtts / sizeof rtts[0]; ++i) {
+        mock_http_server_set_rtt(rtts[i]);
+        for (j = 0; j < sizeof depths / sizeof depths[0]; ++j) {
+            if (measure(port, depths[j]) != 0) {
+                rslt = -1;
+            }
+        }
+        if ((measure_batch(port, 4) != 0)
+            || (measure_batch(port, PUBNUB_PUBLISH_PIPELINE_QUEUE_LEN) != 0)) {
+            rslt = -1;
+        }
+    }
+    puts((0 == rslt) ? "Pipeline mock test passed" : "Pipeline mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,196 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_callback.h"
+
+#include "core/pubnub_publisher.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+#include "core/pubnub_timers.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+
+
+/** @file pubnub_publisher_mock_test.c
+
+    Tests the publisher (context pool) against a local mock HTTP
+    server, which answers every request it reads after a simulated
+    round-trip time (RTT). The mock server is used as a "HTTP GET"
+    proxy, so the contexts can be left with their default origin and
+    port.
+
+    Prints the publish throughput for a few RTTs and pool sizes, and
+    fails if any publish was not successful.
+ */
+
+
+/** Number of messages published in every measurement */
+#define MESSAGES_TO_PUBLISH 256
+
+/** Size of the queue of the publisher */
+#define QUEUE_LEN 64
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned        m_sent;
+static unsigned        m_failed;
+
+
+static void publisher_cb(pubnub_t* pb, enum pubnub_res result, void* request_data)
+{
+    (void)pb;
+    (void)request_data;
+    pthread_mutex_lock(&m_lock);
+    if (PNR_OK == result) {
+        ++m_sent;
+    }
+    else {
+        printf("Publish failed: %d('%s')\n", result, pubnub_res_2_string(result));
+        ++m_failed;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+static unsigned done_count(void)
+{
+    unsigned rslt;
+    pthread_mutex_lock(&m_lock);
+    rslt = m_sent + m_failed;
+    pthread_mutex_unlock(&m_lock);
+    return rslt;
+}
+
+
+static int measure(uint16_t port, unsigned size)
+{
+    unsigned                        i;
+    unsigned long                   t0;
+    unsigned long                   elapsed;
+    struct pubnub_publisher_metrics metrics;
+    pubnub_publisher_t* pbpub = pubnub_publisher_create("demo", "demo", size, QUEUE_LEN);
+
+    if (NULL == pbpub) {
+        printf("Failed to create the publisher!\n");
+        return -1;
+    }
+    for (i = 0; i < pubnub_publisher_size(pbpub); ++i) {
+        pubnub_t* pbp = pubnub_publisher_context(pbpub, i);
+        pubnub_set_transaction_timeout(pbp, PUBNUB_DEFAULT_NON_SUBSCRIBE_TIMEOUT);
+        pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+    }
+
+    m_sent = m_failed = 0;
+    t0                = mock_http_server_ms_now();
+    for (i = 0; i < MESSAGES_TO_PUBLISH;) {
+        enum pubnub_res res = pubnub_publisher_publish(
+            pbpub, "hello_world", "\"Hello world from publisher!\"", publisher_cb, NULL);
+        if (PNR_STARTED == res) {
+            ++i;
+        }
+        else if (PNR_QUEUE_FULL == res) {
+            usleep(1000);
+        }
+        else {
+            printf("Publisher rejected the request: %d('%s')\n",
+                   res,
+                   pubnub_res_2_string(res));
+            break;
+        }
+    }
+    while (done_count() < i) {
+        usleep(1000);
+    }
+    elapsed = mock_http_server_ms_now() - t0;
+    pubnub_publisher_get_metrics(pbpub, &metrics);
+
+    printf("RTT %4u ms, pool %2u: %4u sent, %u failed in %5lu ms, %8.1f "
+           "msg/s (rejected %lu, max queued %u)\n",
+           mock_http_server_rtt(),
+           size,
+           m_sent,
+           m_failed,
+           elapsed,
+           (elapsed > 0) ? m_sent * 1000.0 / elapsed : 0.0,
+           metrics.rejected,
+           metrics.queued_max);
+    if (pubnub_publisher_destroy(pbpub, 1000) != 0) {
+        printf("Failed to destroy the publisher\n");
+        return -1;
+    }
+
+    return ((MESSAGES_TO_PUBLISH == m_sent) && (0 == m_failed)
+            && (metrics.published == m_sent))
+               ? 0
+               : -1;
+}
+
+
+/** Destroys a publisher while its contexts are busy, first without
+    waiting, which may fail to free some of them, and then again,
+    which has to free the rest of them and the publisher.
+ */
+static int destroy_while_busy(uint16_t port)
+{
+    unsigned            i;
+    int                 first;
+    pubnub_publisher_t* pbpub = pubnub_publisher_create("demo", "demo", 4, QUEUE_LEN);
+
+    if (NULL == pbpub) {
+        printf("Failed to create the publisher!\n");
+        return -1;
+    }
+    for (i = 0; i < pubnub_publisher_size(pbpub); ++i) {
+        pubnub_set_proxy_manual(
+            pubnub_publisher_context(pbpub, i), pbproxyHTTP_GET, "127.0.0.1", port);
+    }
+    mock_http_server_set_rtt(400);
+    m_sent = m_failed = 0;
+    for (i = 0; i < 2 * pubnub_publisher_size(pbpub); ++i) {
+        pubnub_publisher_publish(pbpub, "hello_world", "\"busy\"", publisher_cb, NULL);
+    }
+    usleep(100 * 1000);
+
+    first = pubnub_publisher_destroy(pbpub, 0);
+    if ((first != 0) && (pubnub_publisher_destroy(pbpub, 2000) != 0)) {
+        printf("Failed to destroy the busy publisher\n");
+        return -1;
+    }
+    printf("Busy publisher destroyed %s, %u requests cancelled\n",
+           (0 == first) ? "at once" : "on the second try",
+           m_failed);
+
+    return 0;
+}
+
+
+int main()
+{
+    static unsigned const rtts[]  = { 0, 10, 40 };
+    static unsigned const sizes[] = { 1, 4, 16 };
+    uint16_t              port;
+    size_t                i;
+    size_t                j;
+    int                   rslt = 0;
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    printf("Mock HTTP server listening on 127.0.0.1:%u\n", port);
+    for (i = 0; i < sizeof rtts / sizeof rtts[0]; ++i) {
+        mock_http_server_set_rtt(rtts[i]);
+        for (j = 0; j < sizeof sizes / sizeof sizes[0]; ++j) {
+            if (measure(port, sizes[j]) != 0) {
+                rslt = -1;
+            }
+        }
+    }
+    if (destroy_while_busy(port) != 0) {
+        rslt = -1;
+    }
+    puts((0 == rslt) ? "Publisher mock test passed" : "Publisher mock test FAILED");
+
+    return rslt;
+}
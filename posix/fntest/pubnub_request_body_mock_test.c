@@ -0,0 +1,179 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_request_body.h"
+#include "core/pubnub_coreapi_ex.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/** @file pubnub_request_body_mock_test.c
+
+    Tests publishing via POST with the body given by the user, from
+    its buffer (zero copy) and from a producer of chunks, against a
+    local mock HTTP server used as a "HTTP GET" proxy. The body is
+    much larger than the buffer of the context. The mock server counts
+    the bytes of the bodies it reads (and sums them), so we can check
+    that the whole body was sent.
+ */
+
+
+/** Length of the body to publish */
+#define BODY_LEN 200000
+
+/** Length of the chunks to produce */
+#define CHUNK_LEN 4096
+
+static char m_body[BODY_LEN];
+
+struct producer_state {
+    size_t sent;
+    /** Fail after this many bytes were produced */
+    size_t fail_after;
+};
+
+
+static int producer(void* user_data, void const** chunk, size_t* len)
+{
+    struct producer_state* state = (struct producer_state*)user_data;
+    size_t                 left  = BODY_LEN - state->sent;
+
+    if ((state->sent >= state->fail_after) && (left > 0)) {
+        return -1;
+    }
+    *len   = (left < CHUNK_LEN) ? left : CHUNK_LEN;
+    *chunk = m_body + state->sent;
+    state->sent += *len;
+
+    return 0;
+}
+
+
+static int publish(pubnub_t* pbp, char const* message, enum pubnub_res expected)
+{
+    struct pubnub_publish_options opts = pubnub_publish_defopts();
+    enum pubnub_res               res;
+
+    opts.method = pubnubSendViaPOST;
+    res         = pubnub_publish_ex(pbp, "body_test", message, opts);
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    if (res != expected) {
+        printf("Publish outcome %d('%s') instead of %d('%s')\n",
+               res,
+               pubnub_res_2_string(res),
+               expected,
+               pubnub_res_2_string(expected));
+        return -1;
+    }
+    return 0;
+}
+
+
+/** Checks that the server read the whole @p m_body since it read @p
+    bytes (with @p sum)
+ */
+static int check_body_read(char const* name, unsigned long bytes, unsigned long sum)
+{
+    unsigned long new_sum;
+    unsigned long expected_sum = 0;
+    unsigned long new_bytes    = mock_http_server_body_bytes(&new_sum);
+    size_t        i;
+
+    for (i = 0; i < BODY_LEN; ++i) {
+        expected_sum += (unsigned char)m_body[i];
+    }
+    printf("%s: server read %lu body bytes\n", name, new_bytes - bytes);
+    if ((new_bytes - bytes != BODY_LEN) || (new_sum - sum != expected_sum)) {
+        printf("%s: the body was not sent as given\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+
+int main()
+{
+    struct producer_state state;
+    unsigned long         bytes;
+    unsigned long         sum;
+    uint16_t              port;
+    pubnub_t*             pbp;
+    size_t                i;
+    int                   rslt = 0;
+
+    m_body[0] = '"';
+    for (i = 1; i < BODY_LEN - 1; ++i) {
+        m_body[i] = 'a' + i % 26;
+    }
+    m_body[BODY_LEN - 1] = '"';
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(0);
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    /* A usual POST body still works, and can't be larger than the
+       context buffer */
+    bytes = mock_http_server_body_bytes(NULL);
+    if ((publish(pbp, "\"hello\"", PNR_OK) != 0)
+        || (mock_http_server_body_bytes(NULL) - bytes != sizeof "\"hello\"" - 1)) {
+        printf("Failed to publish a small message via POST\n");
+        rslt = -1;
+    }
+    m_body[PUBNUB_BUF_MAXLEN] = '\0';
+    if (publish(pbp, m_body, PNR_TX_BUFF_TOO_SMALL) != 0) {
+        rslt = -1;
+    }
+    m_body[PUBNUB_BUF_MAXLEN] = 'a' + PUBNUB_BUF_MAXLEN % 26;
+
+    bytes = mock_http_server_body_bytes(&sum);
+    if ((pubnub_set_request_body(pbp, m_body, BODY_LEN) != PNR_OK)
+        || (publish(pbp, "", PNR_OK) != 0) || (check_body_read("Zero copy", bytes, sum) != 0)) {
+        rslt = -1;
+    }
+
+    state.sent       = 0;
+    state.fail_after = BODY_LEN;
+    bytes            = mock_http_server_body_bytes(&sum);
+    if ((pubnub_set_request_body_producer(pbp, producer, &state) != PNR_OK)
+        || (publish(pbp, "", PNR_OK) != 0) || (check_body_read("Chunked", bytes, sum) != 0)) {
+        rslt = -1;
+    }
+
+    /* The body is used only by the next transaction */
+    bytes = mock_http_server_body_bytes(NULL);
+    if ((publish(pbp, "\"hello\"", PNR_OK) != 0)
+        || (mock_http_server_body_bytes(NULL) - bytes != sizeof "\"hello\"" - 1)) {
+        printf("Failed to publish a small message via POST after a chunked one\n");
+        rslt = -1;
+    }
+
+    state.sent       = 0;
+    state.fail_after = 3 * CHUNK_LEN;
+    if ((pubnub_set_request_body_producer(pbp, producer, &state) != PNR_OK)
+        || (publish(pbp, "", PNR_IO_ERROR) != 0)) {
+        printf("Failing producer not reported\n");
+        rslt = -1;
+    }
+
+    pubnub_free(pbp);
+    puts((0 == rslt) ? "Request body mock test passed" : "Request body mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,173 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_callback.h"
+
+#include "core/pubnub_callback_subscribe_loop.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+#include "core/pubnub_free_with_timeout.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+
+
+/** @file pubnub_subloop_ring_mock_test.c
+
+    Tests the decoupled subscribe loop (with a ring buffer) against a
+    local mock HTTP server, which is used as a "HTTP GET" proxy and
+    answers every subscribe with the same messages.
+
+    The consumer is (made) much slower than the subscribes, so the
+    loop has to drop messages, but it should subscribe just as often
+    as without a consumer at all. Checks that every message received
+    was either given to the consumer or dropped.
+ */
+
+
+/** Number of messages in every subscribe response */
+#define MESSAGES 10
+
+/** How long to run the loop, in milliseconds */
+#define RUN_MS 1000
+
+/** Simulated round-trip time, in milliseconds */
+#define RTT_MS 10
+
+static char const m_reply[] = "[[\"msg\",\"msg\",\"msg\",\"msg\",\"msg\",\"msg\",\"msg\","
+                              "\"msg\",\"msg\",\"msg\"],\"15700000000000001\"]";
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  m_cond = PTHREAD_COND_INITIALIZER;
+static unsigned        m_notified;
+static unsigned        m_consumed;
+static unsigned        m_wrong;
+static volatile int    m_stop;
+
+
+static void subloop_callback(pubnub_t* pbp, char const* message, enum pubnub_res result)
+{
+    (void)pbp;
+    if ((PNR_OK != result) || (strcmp(message, "\"msg\"") != 0)) {
+        printf("Unexpected outcome %d('%s'), message '%s'\n",
+               result,
+               pubnub_res_2_string(result),
+               message ? message : "(null)");
+        ++m_wrong;
+    }
+    ++m_consumed;
+    /* A slow consumer */
+    usleep(2000);
+}
+
+
+static void notify(pubnub_subloop_t* pbsld, void* user_data)
+{
+    (void)pbsld;
+    (void)user_data;
+    pthread_mutex_lock(&m_lock);
+    ++m_notified;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+static void* consumer(void* arg)
+{
+    pubnub_subloop_t* pbsld = (pubnub_subloop_t*)arg;
+    unsigned          seen  = 0;
+
+    pthread_mutex_lock(&m_lock);
+    while (!m_stop) {
+        while ((seen == m_notified) && !m_stop) {
+            pthread_cond_wait(&m_cond, &m_lock);
+        }
+        seen = m_notified;
+        pthread_mutex_unlock(&m_lock);
+        pubnub_subloop_drain(pbsld, 0);
+        pthread_mutex_lock(&m_lock);
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    return NULL;
+}
+
+
+int main()
+{
+    uint16_t          port;
+    pubnub_t*         pbp;
+    pubnub_subloop_t* pbsld;
+    pthread_t         thread;
+    unsigned long     dropped;
+    unsigned          received;
+    int               rslt = 0;
+
+    if ((mock_http_server_set_reply(m_reply) != 0)
+        || (mock_http_server_start(&port) != 0)) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(RTT_MS);
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+
+    pbsld = pubnub_subloop_define(pbp, "ring", pubnub_subscribe_defopts(), subloop_callback);
+    if ((NULL == pbsld)
+        || (pubnub_subloop_set_ring(pbsld, 1024, pbsloDropOldest, notify, NULL) != PNR_OK)) {
+        printf("Failed to define a decoupled subscribe loop\n");
+        return -1;
+    }
+    pthread_create(&thread, NULL, consumer, pbsld);
+    pubnub_subloop_start(pbsld);
+
+    usleep(RUN_MS * 1000);
+    pubnub_subloop_stop(pbsld);
+    /* Let the subscribe which was just done (if any) put its messages
+       in the ring */
+    usleep(100 * 1000);
+
+    pthread_mutex_lock(&m_lock);
+    m_stop = 1;
+    pthread_cond_signal(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+    pthread_join(thread, NULL);
+    pubnub_subloop_drain(pbsld, 0);
+
+    /* With "drop oldest", every subscribe puts its messages in the ring */
+    received = m_notified * MESSAGES;
+    dropped  = pubnub_subloop_dropped(pbsld);
+    printf("%u subscribes in %u ms (RTT %u ms): %u messages, %u consumed, %lu "
+           "dropped\n",
+           m_notified,
+           RUN_MS,
+           RTT_MS,
+           received,
+           m_consumed,
+           dropped);
+    /* The consumer takes 2 ms per message, so, if it held back the
+       loop, we would have at most RUN_MS / (MESSAGES * 2) subscribes.
+    */
+    if ((m_notified <= RUN_MS / (MESSAGES * 2)) || (0 == dropped)
+        || (m_consumed + dropped != received) || (m_wrong != 0)) {
+        rslt = -1;
+    }
+
+    pubnub_subloop_undef(pbsld);
+    if (pubnub_free_with_timeout(pbp, 1000) != 0) {
+        printf("Failed to free the Pubnub context\n");
+        rslt = -1;
+    }
+    puts((0 == rslt) ? "Decoupled subscribe loop mock test passed"
+                     : "Decoupled subscribe loop mock test FAILED");
+
+    return rslt;
+}
@@ -0,0 +1,253 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_callback.h"
+
+#include "core/pubnub_subscribe_mux.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <pthread.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdio.h>
+
+
+/** @file pubnub_subscribe_mux_mock_test.c
+
+    Tests the subscribe multiplexer against a local mock HTTP server,
+    which is used as a "HTTP GET" proxy. The mock server answers every
+    subscribe with the same (V2) response, which has a message on a
+    "low" and a "high" channel (which end up on different contexts), a
+    message on a channel group and one on a channel we are not
+    subscribed to.
+
+    Subscribes to thousands of channels and checks that they need
+    only a few contexts, that every message is given to the handler of
+    its channel (group) and that removing channels (which restarts
+    the subscribes) doesn't break anything.
+ */
+
+
+/** Number of channels to subscribe to */
+#define CHANNELS 6000
+
+/** How long to let the multiplexer receive messages, in milliseconds */
+#define RECEIVE_MS 500
+
+#define LOW_CHANNEL "mux_test_channel_00001"
+#define HIGH_CHANNEL "mux_test_channel_05999"
+#define GROUP "mux_test_group"
+
+static char const m_reply[] =
+    "{\"t\":{\"t\":\"15700000000000001\",\"r\":1},\"m\":["
+    "{\"a\":\"1\",\"f\":0,\"p\":{\"t\":\"15700000000000000\",\"r\":1},"
+    "\"k\":\"demo\",\"c\":\"" LOW_CHANNEL "\",\"d\":\"low\",\"b\":\"" LOW_CHANNEL "\"},"
+    "{\"a\":\"1\",\"f\":0,\"p\":{\"t\":\"15700000000000000\",\"r\":1},"
+    "\"k\":\"demo\",\"c\":\"" HIGH_CHANNEL "\",\"d\":\"high\",\"b\":\"" HIGH_CHANNEL "\"},"
+    "{\"a\":\"1\",\"f\":0,\"p\":{\"t\":\"15700000000000000\",\"r\":1},"
+    "\"k\":\"demo\",\"c\":\"in_group\",\"d\":\"grouped\",\"b\":\"" GROUP "\"},"
+    "{\"a\":\"1\",\"f\":0,\"p\":{\"t\":\"15700000000000000\",\"r\":1},"
+    "\"k\":\"demo\",\"c\":\"stranger\",\"d\":\"unknown\"}"
+    "]}";
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned        m_low;
+static unsigned        m_high;
+static unsigned        m_group;
+static unsigned        m_default;
+static unsigned        m_other;
+static unsigned        m_wrong;
+static uint16_t        m_port;
+
+
+static bool payload_is(struct pubnub_v2_message const* msg, char const* s)
+{
+    size_t len = strlen(s);
+    return (msg->payload.size == len + 2) && (0 == memcmp(msg->payload.ptr + 1, s, len));
+}
+
+
+static void channel_handler(pubnub_t* pb, struct pubnub_v2_message const* msg, void* user_data)
+{
+    char const* channel = (char const*)user_data;
+    (void)pb;
+    pthread_mutex_lock(&m_lock);
+    if ((msg->channel.size != strlen(channel))
+        || (memcmp(msg->channel.ptr, channel, msg->channel.size) != 0)) {
+        ++m_wrong;
+    }
+    else if (0 == strcmp(channel, LOW_CHANNEL)) {
+        m_low += payload_is(msg, "low");
+    }
+    else if (0 == strcmp(channel, HIGH_CHANNEL)) {
+        m_high += payload_is(msg, "high");
+    }
+    else {
+        ++m_other;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+static void group_handler(pubnub_t* pb, struct pubnub_v2_message const* msg, void* user_data)
+{
+    (void)pb;
+    (void)user_data;
+    pthread_mutex_lock(&m_lock);
+    if (payload_is(msg, "grouped")) {
+        ++m_group;
+    }
+    else {
+        ++m_wrong;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+static void default_handler(pubnub_t* pb, struct pubnub_v2_message const* msg, void* user_data)
+{
+    (void)pb;
+    (void)user_data;
+    pthread_mutex_lock(&m_lock);
+    /* "grouped" only after the channel group is removed */
+    if (payload_is(msg, "unknown") || payload_is(msg, "grouped")) {
+        ++m_default;
+    }
+    else {
+        ++m_wrong;
+    }
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+static void error_handler(pubnub_t* pb, enum pubnub_res result, void* user_data)
+{
+    (void)user_data;
+    printf("pb=%p subscribe failed: %d('%s')\n", pb, result, pubnub_res_2_string(result));
+}
+
+
+static void context_init(pubnub_t* pb, void* user_data)
+{
+    (void)user_data;
+    pubnub_set_proxy_manual(pb, pbproxyHTTP_GET, "127.0.0.1", m_port);
+}
+
+
+static void reset_counters(void)
+{
+    pthread_mutex_lock(&m_lock);
+    m_low = m_high = m_group = m_default = m_other = m_wrong = 0;
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+int main()
+{
+    static char     names[CHANNELS][sizeof LOW_CHANNEL];
+    pubnub_submux_t* mux;
+    unsigned         contexts;
+    unsigned         i;
+    int              rslt = 0;
+
+    if ((mock_http_server_set_reply(m_reply) != 0)
+        || (mock_http_server_start(&m_port) != 0)) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+    mock_http_server_set_rtt(20);
+
+    mux = pubnub_submux_create(
+        "demo", "demo", pubnub_subscribe_v2_defopts(), error_handler, NULL);
+    if (NULL == mux) {
+        printf("Failed to create the subscribe multiplexer\n");
+        return -1;
+    }
+    pubnub_submux_set_context_init(mux, context_init, NULL);
+    pubnub_submux_set_default_handler(mux, default_handler, NULL);
+
+    if ((pubnub_submux_add_channel(mux, "a,b", channel_handler, NULL) != PNR_INVALID_CHANNEL)
+        || (pubnub_submux_add_channel(mux, "", channel_handler, NULL)
+            != PNR_INVALID_CHANNEL)) {
+        printf("Invalid channel names accepted\n");
+        rslt = -1;
+    }
+    for (i = 0; i < CHANNELS; ++i) {
+        snprintf(names[i], sizeof names[i], "mux_test_channel_%05u", i);
+        if (pubnub_submux_add_channel(mux, names[i], channel_handler, names[i]) != PNR_OK) {
+            printf("Failed to add channel '%s'\n", names[i]);
+            rslt = -1;
+        }
+    }
+    if (pubnub_submux_add_channel_group(mux, GROUP, group_handler, NULL) != PNR_OK) {
+        printf("Failed to add channel group '%s'\n", GROUP);
+        rslt = -1;
+    }
+    contexts = pubnub_submux_context_count(mux);
+    printf("%u channels and a channel group on %u contexts\n", CHANNELS, contexts);
+    /* Each name takes 23 characters in the URL */
+    if ((contexts < 2) || (contexts > 1 + CHANNELS * 23 / (PUBNUB_BUF_MAXLEN - 512))) {
+        printf("Unexpected number of contexts\n");
+        rslt = -1;
+    }
+
+    usleep(RECEIVE_MS * 1000);
+    pthread_mutex_lock(&m_lock);
+    printf("Received: low %u, high %u, group %u, default %u, other %u, wrong %u\n",
+           m_low,
+           m_high,
+           m_group,
+           m_default,
+           m_other,
+           m_wrong);
+    if ((0 == m_low) || (0 == m_high) || (0 == m_group) || (0 == m_default)
+        || (m_other != 0) || (m_wrong != 0)) {
+        rslt = -1;
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    /* Remove all but the "low" and "high" channels, which restarts
+       all the subscribes, many times.
+    */
+    for (i = 0; i < CHANNELS; ++i) {
+        if ((0 == strcmp(names[i], LOW_CHANNEL)) || (0 == strcmp(names[i], HIGH_CHANNEL))) {
+            continue;
+        }
+        if (pubnub_submux_remove_channel(mux, names[i]) != PNR_OK) {
+            printf("Failed to remove channel '%s'\n", names[i]);
+            rslt = -1;
+        }
+    }
+    if ((pubnub_submux_remove_channel(mux, names[0]) != PNR_INVALID_CHANNEL)
+        || (pubnub_submux_remove_channel_group(mux, GROUP) != PNR_OK)) {
+        printf("Unexpected outcome of removing a channel (group)\n");
+        rslt = -1;
+    }
+    usleep(RECEIVE_MS * 1000);
+    reset_counters();
+    usleep(RECEIVE_MS * 1000);
+    pthread_mutex_lock(&m_lock);
+    printf("After removal: low %u, high %u, group %u, default %u, other %u, wrong %u\n",
+           m_low,
+           m_high,
+           m_group,
+           m_default,
+           m_other,
+           m_wrong);
+    /* The group message now goes to the default handler */
+    if ((0 == m_low) || (0 == m_high) || (m_group != 0) || (m_default < 2 * m_low)
+        || (m_other != 0) || (m_wrong != 0)) {
+        rslt = -1;
+    }
+    pthread_mutex_unlock(&m_lock);
+
+    if (pubnub_submux_destroy(mux, 1000) != 0) {
+        printf("Failed to destroy the subscribe multiplexer\n");
+        rslt = -1;
+    }
+    puts((0 == rslt) ? "Subscribe multiplexer mock test passed"
+                     : "Subscribe multiplexer mock test FAILED");
+
+    return rslt;
+}
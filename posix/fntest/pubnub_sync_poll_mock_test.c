@@ -0,0 +1,215 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_sync.h"
+
+#include "core/pubnub_blocking_io.h"
+#include "core/pubnub_proxy.h"
+#include "core/pubnub_helper.h"
+
+#include "pubnub_mock_http_server.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/** @file pubnub_sync_poll_mock_test.c
+
+    Tests that pubnub_await() on a context with non-blocking I/O
+    sleeps while waiting for the response, instead of spinning, and
+    that it doesn't keep the context locked while sleeping, so the
+    transaction can be cancelled from another thread. Also, that
+    pubnub_await_any() and pubnub_await_all() wait on several contexts
+    at once. Uses a local mock HTTP server, as a "HTTP GET" proxy,
+    with a long RTT.
+ */
+
+
+/** The RTT while measuring the CPU time used by pubnub_await() */
+#define RTT_MS 1500
+
+/** Most CPU time pubnub_await() may use while waiting for #RTT_MS */
+#define MAX_CPU_MS 200
+
+/** The RTT while cancelling */
+#define CANCEL_RTT_MS 5000
+
+/** Cancel after this many milliseconds */
+#define CANCEL_AFTER_MS 200
+
+/** Most time pubnub_await() may take to return after the cancel */
+#define MAX_CANCEL_MS 300
+
+/** Number of contexts to wait on at once */
+#define CONTEXTS 8
+
+
+static enum pubnub_res publish(pubnub_t* pbp)
+{
+    return pubnub_publish(pbp, "poll_test", "\"hello\"");
+}
+
+
+/** Tests waiting on the @p CONTEXTS contexts @p pbs */
+static int await_multi(pubnub_t** pbs)
+{
+    unsigned long start;
+    unsigned long wall_ms;
+    unsigned long cpu_ms;
+    clock_t       cpu;
+    uint32_t      ok;
+    int           first;
+    int           i;
+    int           rslt = 0;
+
+    mock_http_server_set_rtt(RTT_MS);
+    start = mock_http_server_ms_now();
+    cpu   = clock();
+    for (i = 0; i < CONTEXTS; ++i) {
+        if (publish(pbs[i]) != PNR_STARTED) {
+            printf("Failed to start a publish on context %d\n", i);
+            return -1;
+        }
+    }
+    ok      = pubnub_await_all(pbs, CONTEXTS);
+    cpu_ms  = (unsigned long)((clock() - cpu) * 1000 / CLOCKS_PER_SEC);
+    wall_ms = mock_http_server_ms_now() - start;
+    printf("Await all: OK bitmap %X after %lu ms, CPU time %lu ms\n",
+           (unsigned)ok,
+           wall_ms,
+           cpu_ms);
+    if ((ok != (1u << CONTEXTS) - 1) || (wall_ms < RTT_MS)
+        || (wall_ms > 2 * RTT_MS) || (cpu_ms > MAX_CPU_MS)) {
+        printf("Await all: FAILED\n");
+        rslt = -1;
+    }
+
+    /* The last one is answered long before the others */
+    mock_http_server_set_rtt(CANCEL_RTT_MS);
+    for (i = 0; i < CONTEXTS - 1; ++i) {
+        publish(pbs[i]);
+    }
+    usleep(CANCEL_AFTER_MS * 1000);
+    mock_http_server_set_rtt(0);
+    start = mock_http_server_ms_now();
+    publish(pbs[CONTEXTS - 1]);
+    first   = pubnub_await_any(pbs, CONTEXTS);
+    wall_ms = mock_http_server_ms_now() - start;
+    printf("Await any: context %d after %lu ms\n", first, wall_ms);
+    if ((first != CONTEXTS - 1) || (pubnub_last_result(pbs[first]) != PNR_OK)
+        || (wall_ms > MAX_CANCEL_MS)) {
+        printf("Await any: FAILED\n");
+        rslt = -1;
+    }
+    for (i = 0; i < CONTEXTS - 1; ++i) {
+        pubnub_cancel(pbs[i]);
+    }
+    ok = pubnub_await_all(pbs, CONTEXTS);
+    if (ok != 1u << (CONTEXTS - 1)) {
+        printf("Await all after cancel: OK bitmap %X, FAILED\n", (unsigned)ok);
+        rslt = -1;
+    }
+
+    return rslt;
+}
+
+
+static void* cancel_thread(void* arg)
+{
+    usleep(CANCEL_AFTER_MS * 1000);
+    pubnub_cancel((pubnub_t*)arg);
+    return NULL;
+}
+
+
+int main()
+{
+    uint16_t        port;
+    pubnub_t*       pbp;
+    pubnub_t*       pbs[CONTEXTS];
+    int             i;
+    pthread_t       thread;
+    enum pubnub_res res;
+    clock_t         cpu;
+    unsigned long   start;
+    unsigned long   cpu_ms;
+    unsigned long   wall_ms;
+    int             rslt = 0;
+
+    if (mock_http_server_start(&port) != 0) {
+        printf("Failed to start the mock HTTP server\n");
+        return -1;
+    }
+
+    pbp = pubnub_alloc();
+    if (NULL == pbp) {
+        printf("Failed to allocate Pubnub context!\n");
+        return -1;
+    }
+    pubnub_init(pbp, "demo", "demo");
+    pubnub_set_proxy_manual(pbp, pbproxyHTTP_GET, "127.0.0.1", port);
+    pubnub_set_non_blocking_io(pbp);
+
+    mock_http_server_set_rtt(RTT_MS);
+    start = mock_http_server_ms_now();
+    cpu   = clock();
+    res   = publish(pbp);
+    if (PNR_STARTED == res) {
+        res = pubnub_await(pbp);
+    }
+    cpu_ms  = (unsigned long)((clock() - cpu) * 1000 / CLOCKS_PER_SEC);
+    wall_ms = mock_http_server_ms_now() - start;
+    printf("Await: outcome %d('%s') after %lu ms, CPU time %lu ms\n",
+           res,
+           pubnub_res_2_string(res),
+           wall_ms,
+           cpu_ms);
+    if ((res != PNR_OK) || (wall_ms < RTT_MS) || (cpu_ms > MAX_CPU_MS)) {
+        printf("Await: FAILED\n");
+        rslt = -1;
+    }
+
+    mock_http_server_set_rtt(CANCEL_RTT_MS);
+    res = publish(pbp);
+    if (PNR_STARTED == res) {
+        if (pthread_create(&thread, NULL, cancel_thread, pbp) != 0) {
+            printf("Failed to create the cancel thread\n");
+            return -1;
+        }
+        start = mock_http_server_ms_now();
+        res   = pubnub_await(pbp);
+        pthread_join(thread, NULL);
+    }
+    wall_ms = mock_http_server_ms_now() - start;
+    printf("Cancel: outcome %d('%s') after %lu ms\n",
+           res,
+           pubnub_res_2_string(res),
+           wall_ms);
+    if ((res != PNR_CANCELLED) || (wall_ms > CANCEL_AFTER_MS + MAX_CANCEL_MS)) {
+        printf("Cancel: FAILED\n");
+        rslt = -1;
+    }
+
+    pubnub_free(pbp);
+
+    for (i = 0; i < CONTEXTS; ++i) {
+        pbs[i] = pubnub_alloc();
+        if (NULL == pbs[i]) {
+            printf("Failed to allocate Pubnub context!\n");
+            return -1;
+        }
+        pubnub_init(pbs[i], "demo", "demo");
+        pubnub_set_proxy_manual(pbs[i], pbproxyHTTP_GET, "127.0.0.1", port);
+        pubnub_set_non_blocking_io(pbs[i]);
+    }
+    if (await_multi(pbs) != 0) {
+        rslt = -1;
+    }
+    for (i = 0; i < CONTEXTS; ++i) {
+        pubnub_free(pbs[i]);
+    }
+
+    puts((0 == rslt) ? "Sync poll mock test passed" : "Sync poll mock test FAILED");
+
+    return rslt;
+}
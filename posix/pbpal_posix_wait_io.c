@@ -0,0 +1,78 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "core/pbpal.h"
+#include "lib/sockets/pbpal_socket_wait_io.h"
+#include "core/pubnub_assert.h"
+#include "core/pubnub_ntf_sync.h"
+
+#include "pubnub_internal.h"
+
+
+int pbpal_wait_io(pubnub_t* pb, bool out, int timeout_ms)
+{
+    pbpal_native_socket_t socket;
+    int                   rslt;
+
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    socket = pb->pal.socket;
+    if (SOCKET_INVALID == socket) {
+        return -1;
+    }
+    pubnub_mutex_unlock(pb->monitor);
+    rslt = pbpal_socket_wait_io(socket, out, timeout_ms);
+    pubnub_mutex_lock(pb->monitor);
+
+    return rslt;
+}
+
+
+void pbpal_interrupt_wait_io(pubnub_t* pb)
+{
+    PUBNUB_ASSERT(pb_valid_ctx_ptr(pb));
+    if (pb->pal.socket != SOCKET_INVALID) {
+        pbpal_socket_interrupt_wait_io(pb->pal.socket);
+    }
+}
+
+int pbpal_wait_io_any(pubnub_t* const*          pbs,
+                      enum pbpal_io_wait const* waits,
+                      bool*                     ready,
+                      unsigned                  n,
+                      int                       timeout_ms)
+{
+    struct pbpal_socket_wait sw[PUBNUB_AWAIT_MAX_CONTEXTS];
+    unsigned                 i;
+    int                      have_ready = 0;
+    int                      rslt;
+
+    PUBNUB_ASSERT_OPT(n <= PUBNUB_AWAIT_MAX_CONTEXTS);
+    for (i = 0; i < n; ++i) {
+        pubnub_t* pb = pbs[i];
+
+        ready[i]     = false;
+        sw[i].socket = SOCKET_INVALID;
+        sw[i].out    = (pbpalWaitOut == waits[i]);
+        if (pbpalWaitNone == waits[i]) {
+            continue;
+        }
+        pubnub_mutex_lock(pb->monitor);
+        if (SOCKET_INVALID == pb->pal.socket) {
+            ready[i] = true;
+            ++have_ready;
+        }
+        else {
+            sw[i].socket = pb->pal.socket;
+        }
+        pubnub_mutex_unlock(pb->monitor);
+    }
+    rslt = pbpal_sockets_wait_io(sw, n, (have_ready > 0) ? 0 : timeout_ms);
+    if (rslt < 0) {
+        return -1;
+    }
+    for (i = 0; i < n; ++i) {
+        if (sw[i].ready) {
+            ready[i] = true;
+        }
+    }
+
+    return rslt + have_ready;
+}
@@ -30,6 +30,46 @@ ifndef USE_OBJECTS_API
 USE_OBJECTS_API = 1
 endif
 
+ifndef USE_OBJECTS_CACHE
+USE_OBJECTS_CACHE = $(USE_OBJECTS_API)
+endif
+
+ifndef USE_REPLY_INDEX
+USE_REPLY_INDEX = 1
+endif
+
+ifndef USE_URL_CACHE
+USE_URL_CACHE = 1
+endif
+
+ifndef USE_PUBLISH_PIPELINE
+USE_PUBLISH_PIPELINE = 1
+endif
+
+ifndef USE_REQUEST_BODY
+USE_REQUEST_BODY = 1
+endif
+
+ifndef USE_JSON_WRITER
+USE_JSON_WRITER = 1
+endif
+
+ifndef USE_HISTORY_STREAM
+USE_HISTORY_STREAM = 1
+endif
+
+ifndef USE_SYNC_POLL
+USE_SYNC_POLL = 1
+endif
+
+ifndef USE_FREE_NOTIFY
+USE_FREE_NOTIFY = 1
+endif
+
+ifndef DYNAMIC_SCRATCH_BUFFERS
+DYNAMIC_SCRATCH_BUFFERS = 0
+endif
+
 ifeq ($(USE_PROXY), 1)
 SOURCEFILES += ../core/pubnub_proxy.c ../core/pubnub_proxy_core.c ../core/pbhttp_digest.c ../core/pbntlm_core.c ../core/pbntlm_packer_std.c
 OBJFILES += pubnub_proxy.o pubnub_proxy_core.o pbhttp_digest.o pbntlm_core.o pbntlm_packer_std.o
@@ -60,6 +100,46 @@ SOURCEFILES += ../core/pbcc_objects_api.c ../core/pubnub_objects_api.c
 OBJFILES += pbcc_objects_api.o pubnub_objects_api.o
 endif
 
+ifeq ($(USE_OBJECTS_CACHE), 1)
+SOURCEFILES += ../core/pubnub_objects_cache.c
+OBJFILES += pubnub_objects_cache.o
+endif
+
+ifeq ($(USE_REPLY_INDEX), 1)
+SOURCEFILES += ../core/pubnub_reply_index.c
+OBJFILES += pubnub_reply_index.o
+endif
+
+ifeq ($(USE_PUBLISH_PIPELINE), 1)
+SOURCEFILES += ../core/pubnub_publish_pipeline.c
+OBJFILES += pubnub_publish_pipeline.o
+endif
+
+ifeq ($(USE_REQUEST_BODY), 1)
+SOURCEFILES += ../core/pubnub_request_body.c
+OBJFILES += pubnub_request_body.o
+endif
+
+ifeq ($(USE_JSON_WRITER), 1)
+SOURCEFILES += ../core/pubnub_json_writer.c
+OBJFILES += pubnub_json_writer.o
+endif
+
+ifeq ($(USE_HISTORY_STREAM), 1)
+SOURCEFILES += ../core/pubnub_history_stream.c
+OBJFILES += pubnub_history_stream.o
+endif
+
+ifeq ($(USE_FREE_NOTIFY), 1)
+SOURCEFILES += pubnub_free_notify_posix.c
+OBJFILES += pubnub_free_notify_posix.o
+endif
+
+ifeq ($(DYNAMIC_SCRATCH_BUFFERS), 1)
+SOURCEFILES += ../core/pbscratch_pool.c
+OBJFILES += pbscratch_pool.o
+endif
+
 OS := $(shell uname)
 ifeq ($(OS),Darwin)
 SOURCEFILES += monotonic_clock_get_time_darwin.c
@@ -71,23 +151,33 @@ OBJFILES += monotonic_clock_get_time_posix.o
 LDLIBS=-lrt -lpthread
 endif
 
-CFLAGS =-g -Wall -D PUBNUB_THREADSAFE -D PUBNUB_LOG_LEVEL=PUBNUB_LOG_LEVEL_WARNING -D PUBNUB_ONLY_PUBSUB_API=$(ONLY_PUBSUB_API) -D PUBNUB_PROXY_API=$(USE_PROXY) -D PUBNUB_USE_GZIP_COMPRESSION=$(USE_GZIP_COMPRESSION) -D PUBNUB_RECEIVE_GZIP_RESPONSE=$(RECEIVE_GZIP_RESPONSE) -D PUBNUB_USE_SUBSCRIBE_V2=$(USE_SUBSCRIBE_V2) -D PUBNUB_USE_OBJECTS_API=$(USE_OBJECTS_API)
+CFLAGS =-g -Wall -D PUBNUB_THREADSAFE -D PUBNUB_LOG_LEVEL=PUBNUB_LOG_LEVEL_WARNING -D PUBNUB_ONLY_PUBSUB_API=$(ONLY_PUBSUB_API) -D PUBNUB_PROXY_API=$(USE_PROXY) -D PUBNUB_USE_GZIP_COMPRESSION=$(USE_GZIP_COMPRESSION) -D PUBNUB_RECEIVE_GZIP_RESPONSE=$(RECEIVE_GZIP_RESPONSE) -D PUBNUB_USE_SUBSCRIBE_V2=$(USE_SUBSCRIBE_V2) -D PUBNUB_USE_OBJECTS_API=$(USE_OBJECTS_API) -D PUBNUB_USE_OBJECTS_CACHE=$(USE_OBJECTS_CACHE) -D PUBNUB_USE_REPLY_INDEX=$(USE_REPLY_INDEX) -D PUBNUB_USE_URL_CACHE=$(USE_URL_CACHE) -D PUBNUB_USE_PUBLISH_PIPELINE=$(USE_PUBLISH_PIPELINE) -D PUBNUB_USE_REQUEST_BODY=$(USE_REQUEST_BODY) -D PUBNUB_USE_JSON_WRITER=$(USE_JSON_WRITER) -D PUBNUB_USE_HISTORY_STREAM=$(USE_HISTORY_STREAM) -D PUBNUB_USE_SYNC_POLL=$(USE_SYNC_POLL) -D PUBNUB_USE_FREE_NOTIFY=$(USE_FREE_NOTIFY) -D PUBNUB_DYNAMIC_SCRATCH_BUFFERS=$(DYNAMIC_SCRATCH_BUFFERS)
 # -g enables debugging, remove to get a smaller executable
 # -fsanitize-address Use AddressSanitizer
 
 INCLUDES=-I .. -I .
 
-all: pubnub_sync_sample metadata cancel_subscribe_sync_sample pubnub_advanced_history_sample pubnub_sync_subloop_sample pubnub_sync_publish_retry pubnub_publish_via_post_sample pubnub_callback_sample pubnub_callback_subloop_sample subscribe_publish_callback_sample pubnub_fntest pubnub_console_sync pubnub_console_callback subscribe_publish_from_callback publish_callback_subloop_sample publish_queue_callback_subloop 
+all: pubnub_sync_sample metadata cancel_subscribe_sync_sample pubnub_advanced_history_sample pubnub_sync_subloop_sample pubnub_sync_publish_retry pubnub_publish_via_post_sample pubnub_callback_sample pubnub_callback_subloop_sample subscribe_publish_callback_sample pubnub_fntest pubnub_console_sync pubnub_console_callback subscribe_publish_from_callback publish_callback_subloop_sample publish_queue_callback_subloop pubnub_publish_pipeline_mock_test pubnub_request_body_mock_test pubnub_history_stream_mock_test pubnub_objects_cache_mock_test pubnub_objects_pager_mock_test pubnub_adaptive_publish_mock_test pubnub_json_writer_mock_test pubnub_sync_poll_mock_test pubnub_fanout_mock_test pubnub_publisher_mock_test pubnub_subscribe_mux_mock_test pubnub_hbsched_mock_test pubnub_subloop_ring_mock_test pubnub_free_mock_test pubnub_context_footprint pbcc_prep_benchmark pbpal_ntf_callback_queue_stress_test
 
 SYNC_INTF_SOURCEFILES=../core/pubnub_ntf_sync.c ../core/pubnub_sync_subscribe_loop.c ../core/srand_from_pubnub_time.c
 SYNC_INTF_OBJFILES=pubnub_ntf_sync.o pubnub_sync_subscribe_loop.o srand_from_pubnub_time.o
 
+ifeq ($(USE_SYNC_POLL), 1)
+SYNC_INTF_SOURCEFILES += posix_socket_wait_io.c pbpal_posix_wait_io.c ../core/pubnub_fanout.c
+SYNC_INTF_OBJFILES += posix_socket_wait_io.o pbpal_posix_wait_io.o pubnub_fanout.o
+endif
+
+ifeq ($(USE_OBJECTS_API), 1)
+SYNC_INTF_SOURCEFILES += ../core/pubnub_objects_pager.c
+SYNC_INTF_OBJFILES += pubnub_objects_pager.o
+endif
+
 pubnub_sync.a : $(SOURCEFILES) $(SYNC_INTF_SOURCEFILES)
 	$(CC) -c $(CFLAGS) $(INCLUDES) $(SOURCEFILES) $(SYNC_INTF_SOURCEFILES)
 	ar rcs pubnub_sync.a $(OBJFILES) $(SYNC_INTF_OBJFILES)
 
-CALLBACK_INTF_SOURCEFILES=pubnub_ntf_callback_posix.c pubnub_get_native_socket.c ../core/pubnub_timer_list.c ../lib/sockets/pbpal_ntf_callback_poller_poll.c ../lib/sockets/pbpal_adns_sockets.c ../lib/pubnub_dns_codec.c ../core/pbpal_ntf_callback_queue.c ../core/pbpal_ntf_callback_admin.c ../core/pbpal_ntf_callback_handle_timer_list.c  ../core/pubnub_callback_subscribe_loop.c
-CALLBACK_INTF_OBJFILES=pubnub_ntf_callback_posix.o pubnub_get_native_socket.o pubnub_timer_list.o pbpal_ntf_callback_poller_poll.o pbpal_adns_sockets.o pubnub_dns_codec.o pbpal_ntf_callback_queue.o pbpal_ntf_callback_admin.o pbpal_ntf_callback_handle_timer_list.o pubnub_callback_subscribe_loop.o
+CALLBACK_INTF_SOURCEFILES=pubnub_ntf_callback_posix.c pubnub_get_native_socket.c ../core/pubnub_timer_list.c ../lib/sockets/pbpal_ntf_callback_poller_poll.c ../lib/sockets/pbpal_adns_sockets.c ../lib/pubnub_dns_codec.c ../core/pbpal_ntf_callback_queue.c ../core/pbpal_ntf_callback_admin.c ../core/pbpal_ntf_callback_handle_timer_list.c  ../core/pubnub_callback_subscribe_loop.c ../core/pubnub_publisher.c ../core/pubnub_subscribe_mux.c ../core/pubnub_heartbeat_scheduler.c
+CALLBACK_INTF_OBJFILES=pubnub_ntf_callback_posix.o pubnub_get_native_socket.o pubnub_timer_list.o pbpal_ntf_callback_poller_poll.o pbpal_adns_sockets.o pubnub_dns_codec.o pbpal_ntf_callback_queue.o pbpal_ntf_callback_admin.o pbpal_ntf_callback_handle_timer_list.o pubnub_callback_subscribe_loop.o pubnub_publisher.o pubnub_subscribe_mux.o pubnub_heartbeat_scheduler.o
 
 ifndef USE_DNS_SERVERS
 USE_DNS_SERVERS = 1
@@ -155,6 +245,57 @@ publish_queue_callback_subloop: ../core/samples/publish_queue_callback_subloop.c
 pubnub_fntest: ../core/fntest/pubnub_fntest.c ../core/fntest/pubnub_fntest_basic.c ../core/fntest/pubnub_fntest_medium.c fntest/pubnub_fntest_posix.c fntest/pubnub_fntest_runner.c pubnub_sync.a
 	$(CC) -o $@ $(CFLAGS) $(INCLUDES) ../core/fntest/pubnub_fntest.c ../core/fntest/pubnub_fntest_basic.c ../core/fntest/pubnub_fntest_medium.c  fntest/pubnub_fntest_posix.c fntest/pubnub_fntest_runner.c pubnub_sync.a $(LDLIBS) -lpthread
 
+pubnub_publish_pipeline_mock_test: fntest/pubnub_publish_pipeline_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_publish_pipeline_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_request_body_mock_test: fntest/pubnub_request_body_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_request_body_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_history_stream_mock_test: fntest/pubnub_history_stream_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_history_stream_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_objects_cache_mock_test: fntest/pubnub_objects_cache_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_objects_cache_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_objects_pager_mock_test: fntest/pubnub_objects_pager_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_objects_pager_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_adaptive_publish_mock_test: fntest/pubnub_adaptive_publish_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_adaptive_publish_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_json_writer_mock_test: fntest/pubnub_json_writer_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_json_writer_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_sync_poll_mock_test: fntest/pubnub_sync_poll_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_sync_poll_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_fanout_mock_test: fntest/pubnub_fanout_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_fanout_mock_test.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pubnub_context_footprint: fntest/pubnub_context_footprint.c fntest/pubnub_mock_http_server.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pubnub_context_footprint.c fntest/pubnub_mock_http_server.c pubnub_sync.a $(LDLIBS) -lpthread
+
+pbpal_ntf_callback_queue_stress_test: fntest/pbpal_ntf_callback_queue_stress_test.c ../core/pbpal_ntf_callback_queue.c ../core/pubnub_assert_std.c
+	$(CC) -o $@ -D PUBNUB_CALLBACK_API $(CFLAGS) $(CFLAGS_CALLBACK) $(INCLUDES) fntest/pbpal_ntf_callback_queue_stress_test.c ../core/pbpal_ntf_callback_queue.c ../core/pubnub_assert_std.c -lpthread
+
+pbcc_prep_benchmark: fntest/pbcc_prep_benchmark.c pubnub_sync.a
+	$(CC) -o $@ $(CFLAGS) $(INCLUDES) fntest/pbcc_prep_benchmark.c pubnub_sync.a $(LDLIBS)
+
+pubnub_publisher_mock_test: fntest/pubnub_publisher_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a
+	$(CC) -o $@ -D PUBNUB_CALLBACK_API $(CFLAGS) $(CFLAGS_CALLBACK) $(INCLUDES) fntest/pubnub_publisher_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a $(LDLIBS) -lpthread
+
+pubnub_subscribe_mux_mock_test: fntest/pubnub_subscribe_mux_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a
+	$(CC) -o $@ -D PUBNUB_CALLBACK_API $(CFLAGS) $(CFLAGS_CALLBACK) $(INCLUDES) fntest/pubnub_subscribe_mux_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a $(LDLIBS) -lpthread
+
+pubnub_hbsched_mock_test: fntest/pubnub_hbsched_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a
+	$(CC) -o $@ -D PUBNUB_CALLBACK_API $(CFLAGS) $(CFLAGS_CALLBACK) $(INCLUDES) fntest/pubnub_hbsched_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a $(LDLIBS) -lpthread
+
+pubnub_subloop_ring_mock_test: fntest/pubnub_subloop_ring_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a
+	$(CC) -o $@ -D PUBNUB_CALLBACK_API $(CFLAGS) $(CFLAGS_CALLBACK) $(INCLUDES) fntest/pubnub_subloop_ring_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a $(LDLIBS) -lpthread
+
+pubnub_free_mock_test: fntest/pubnub_free_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a
+	$(CC) -o $@ -D PUBNUB_CALLBACK_API $(CFLAGS) $(CFLAGS_CALLBACK) $(INCLUDES) fntest/pubnub_free_mock_test.c fntest/pubnub_mock_http_server.c pubnub_callback.a $(LDLIBS) -lpthread
+
 CONSOLE_SOURCEFILES=../core/samples/console/pubnub_console.c ../core/samples/console/pnc_helpers.c ../core/samples/console/pnc_readers.c ../core/samples/console/pnc_subscriptions.c
 
 pubnub_console_sync: $(CONSOLE_SOURCEFILES) ../core/samples/console/pnc_ops_sync.c pubnub_sync.a
@@ -165,4 +306,4 @@ pubnub_console_callback: $(CONSOLE_SOURCEFILES) ../core/samples/console/pnc_ops_
 
 
 clean:
-	rm pubnub_advanced_history_sample pubnub_sync_sample pubnub_sync_subloop_sample cancel_subscribe_sync_sample pubnub_sync_publish_retry pubnub_publish_via_post_sample pubnub_callback_sample pubnub_callback_subloop_sample subscribe_publish_callback_sample pubnub_fntest pubnub_console_sync pubnub_console_callback pubnub_sync.a pubnub_callback.a subscribe_publish_from_callback publish_callback_subloop_sample publish_queue_callback_subloop *.o *.dSYM
+	rm pubnub_advanced_history_sample pubnub_sync_sample pubnub_sync_subloop_sample cancel_subscribe_sync_sample pubnub_sync_publish_retry pubnub_publish_via_post_sample pubnub_callback_sample pubnub_callback_subloop_sample subscribe_publish_callback_sample pubnub_fntest pubnub_console_sync pubnub_console_callback pubnub_sync.a pubnub_callback.a subscribe_publish_from_callback publish_callback_subloop_sample publish_queue_callback_subloop pubnub_publish_pipeline_mock_test pubnub_request_body_mock_test pubnub_history_stream_mock_test pubnub_objects_cache_mock_test pubnub_objects_pager_mock_test pubnub_adaptive_publish_mock_test pubnub_json_writer_mock_test pubnub_sync_poll_mock_test pubnub_fanout_mock_test pubnub_publisher_mock_test pubnub_subscribe_mux_mock_test pubnub_hbsched_mock_test pubnub_subloop_ring_mock_test pubnub_free_mock_test pubnub_context_footprint pbcc_prep_benchmark pbpal_ntf_callback_queue_stress_test *.o *.dSYM
@@ -0,0 +1,71 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "lib/sockets/pbpal_socket_wait_io.h"
+#include "core/pubnub_log.h"
+#include "core/pubnub_assert.h"
+#include "core/pubnub_ntf_sync.h"
+#include "pubnub_internal.h"
+
+#include <poll.h>
+#include <errno.h>
+#include <sys/socket.h>
+
+
+int pbpal_socket_wait_io(pbpal_native_socket_t socket, bool out, int timeout_ms)
+{
+    struct pollfd pfd;
+    int           rslt;
+
+    pfd.fd      = (int)socket;
+    pfd.events  = out ? POLLOUT : POLLIN;
+    pfd.revents = 0;
+    rslt        = poll(&pfd, 1, timeout_ms);
+    if (rslt < 0) {
+        if (EINTR == errno) {
+            return +1;
+        }
+        PUBNUB_LOG_ERROR("pbpal_socket_wait_io(socket=%d): poll() failed, errno=%d\n",
+                         (int)socket,
+                         errno);
+        return -1;
+    }
+
+    return (rslt > 0) ? +1 : 0;
+}
+
+
+int pbpal_sockets_wait_io(struct pbpal_socket_wait* waits, unsigned n, int timeout_ms)
+{
+    struct pollfd pfd[PUBNUB_AWAIT_MAX_CONTEXTS];
+    unsigned      i;
+    int           rslt;
+
+    PUBNUB_ASSERT_OPT(n <= PUBNUB_AWAIT_MAX_CONTEXTS);
+    for (i = 0; i < n; ++i) {
+        /* poll() ignores negative descriptors */
+        pfd[i].fd      = (int)waits[i].socket;
+        pfd[i].events  = waits[i].out ? POLLOUT : POLLIN;
+        pfd[i].revents = 0;
+        waits[i].ready = false;
+    }
+    rslt = poll(pfd, n, timeout_ms);
+    if (rslt < 0) {
+        if (EINTR == errno) {
+            return 0;
+        }
+        PUBNUB_LOG_ERROR("pbpal_sockets_wait_io(n=%u): poll() failed, errno=%d\n",
+                         n,
+                         errno);
+        return -1;
+    }
+    for (i = 0; i < n; ++i) {
+        waits[i].ready = (pfd[i].revents != 0);
+    }
+
+    return rslt;
+}
+
+
+void pbpal_socket_interrupt_wait_io(pbpal_native_socket_t socket)
+{
+    shutdown((int)socket, SHUT_RDWR);
+}
@@ -0,0 +1,96 @@
+/* -*- c-file-style:"stroustrup"; indent-tabs-mode: nil -*- */
+#include "pubnub_internal.h"
+
+#include "core/pubnub_free_notify.h"
+
+#include <pthread.h>
+#include <time.h>
+
+
+static pthread_mutex_t m_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  m_cond;
+static pthread_once_t  m_once = PTHREAD_ONCE_INIT;
+static unsigned        m_count;
+/** Number of threads between pbfree_wait_begin() and pbfree_wait_end() */
+static unsigned        m_waiters;
+
+/** The clock of the deadlines of the waits on #m_cond */
+#if defined(__APPLE__)
+#define WAIT_CLOCK CLOCK_REALTIME
+#else
+#define WAIT_CLOCK CLOCK_MONOTONIC
+#endif
+
+
+static void init_cond(void)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attr, WAIT_CLOCK);
+#endif
+    pthread_cond_init(&m_cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+
+void pbfree_notify(void)
+{
+    if (0 == __atomic_load_n(&m_waiters, __ATOMIC_SEQ_CST)) {
+        /* A waiter that starts after this will try to free before it
+           waits, and see what this would notify about */
+        return;
+    }
+    pthread_once(&m_once, init_cond);
+    pthread_mutex_lock(&m_lock);
+    ++m_count;
+    pthread_cond_broadcast(&m_cond);
+    pthread_mutex_unlock(&m_lock);
+}
+
+
+void pbfree_wait_begin(void)
+{
+    __atomic_add_fetch(&m_waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+
+void pbfree_wait_end(void)
+{
+    __atomic_sub_fetch(&m_waiters, 1, __ATOMIC_SEQ_CST);
+}
+
+
+unsigned pbfree_notification_count(void)
+{
+    unsigned count;
+
+    pthread_mutex_lock(&m_lock);
+    count = m_count;
+    pthread_mutex_unlock(&m_lock);
+
+    return count;
+}
+
+
+void pbfree_wait(unsigned count, unsigned timeout_ms)
+{
+    struct timespec deadline;
+
+    pthread_once(&m_once, init_cond);
+    clock_gettime(WAIT_CLOCK, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_nsec -= 1000000000L;
+        ++deadline.tv_sec;
+    }
+    pthread_mutex_lock(&m_lock);
+    while (m_count == count) {
+        if (pthread_cond_timedwait(&m_cond, &m_lock, &deadline) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&m_lock);
+}
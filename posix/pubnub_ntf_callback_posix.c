@@ -35,6 +35,21 @@ struct SocketWatcherData {
 
 static struct SocketWatcherData m_watcher;
 
+/** Maximum number of tickers (functions called periodically from
+    the callback thread) */
+#define PBNTF_MAX_TICKERS 8
+
+struct pbntf_ticker {
+    pbntf_ticker_t tick;
+    void*          data;
+};
+
+/** The tickers. They are called with the lock held, so that a ticker
+    is not called after it was removed. */
+static pthread_mutex_t     m_tickerlock = PTHREAD_MUTEX_INITIALIZER;
+static struct pbntf_ticker m_tickers[PBNTF_MAX_TICKERS] pubnub_guarded_by(m_tickerlock);
+static unsigned            m_ticker_count pubnub_guarded_by(m_tickerlock);
+
 
 static int elapsed_ms(struct timespec prev_timspec, struct timespec timspec)
 {
@@ -44,6 +59,50 @@ static int elapsed_ms(struct timespec prev_timspec, struct timespec timspec)
 }
 
 
+static void call_tickers(int elapsed)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&m_tickerlock);
+    for (i = 0; i < m_ticker_count; ++i) {
+        m_tickers[i].tick(m_tickers[i].data, elapsed);
+    }
+    pthread_mutex_unlock(&m_tickerlock);
+}
+
+
+int pbntf_add_ticker(pbntf_ticker_t tick, void* data)
+{
+    int rslt = -1;
+
+    pthread_mutex_lock(&m_tickerlock);
+    if (m_ticker_count < PBNTF_MAX_TICKERS) {
+        m_tickers[m_ticker_count].tick = tick;
+        m_tickers[m_ticker_count].data = data;
+        ++m_ticker_count;
+        rslt = 0;
+    }
+    pthread_mutex_unlock(&m_tickerlock);
+
+    return rslt;
+}
+
+
+void pbntf_remove_ticker(pbntf_ticker_t tick, void* data)
+{
+    unsigned i;
+
+    pthread_mutex_lock(&m_tickerlock);
+    for (i = 0; i < m_ticker_count; ++i) {
+        if ((m_tickers[i].tick == tick) && (m_tickers[i].data == data)) {
+            m_tickers[i] = m_tickers[--m_ticker_count];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&m_tickerlock);
+}
+
+
 int pbntf_watch_in_events(pubnub_t* pbp)
 {
     return pbpal_ntf_watch_in_events(m_watcher.poll, pbp);
@@ -95,6 +154,7 @@ void* socket_watcher_thread(void* arg)
                 pthread_mutex_lock(&m_watcher.timerlock);
                 pbntf_handle_timer_list(elapsed, &m_watcher.timer_head);
                 pthread_mutex_unlock(&m_watcher.timerlock);
+                call_tickers(elapsed);
 
                 prev_timspec = timspec;
             }
@@ -55,6 +55,27 @@
 
 #endif
 
+#if !defined(PUBNUB_DYNAMIC_SCRATCH_BUFFERS)
+/** Set to 0 to keep the "scratch" buffers that are needed only by
+    some transactions (or phases of them) in the context - the buffers
+    for the compressed and encrypted message and the path saved for
+    the proxy. Set to anything !=0 to take them from a pool shared by
+    all contexts, only when a transaction needs them, and give them
+    back on the outcome of the transaction. This substantially reduces
+    the memory footprint of a context that doesn't use them (like a
+    subscriber), at the cost of (locked) access to the pool.
+ */
+#define PUBNUB_DYNAMIC_SCRATCH_BUFFERS 0
+#endif
+
+#if PUBNUB_DYNAMIC_SCRATCH_BUFFERS
+/** The maximum number of free "scratch" buffers kept in the shared
+    pool. Buffers given back to a pool that has this many free ones
+    are released to the system.
+ */
+#define PUBNUB_SCRATCH_POOL_MAX_FREE 4
+#endif
+
 /** This is the URL of the Pubnub server. Change only for testing
     purposes.
 */